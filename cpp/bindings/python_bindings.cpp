@@ -1,12 +1,93 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include <memory>
+#include <optional>
 #include "flowgen/flow_record.hpp"
 #include "flowgen/generator.hpp"
 #include "flowgen/utils.hpp"
+#include "flowgen/sinks.hpp"
+#include "flowgen/aggregators.hpp"
+#include "flowgen/fanout.hpp"
+#include "flowgen/profile.hpp"
+#include "flowgen/keyspace.hpp"
+#include "flowgen/plugins.hpp"
 
 namespace py = pybind11;
 
+namespace {
+
+template<typename T>
+using column_t = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+// Borrow a 1-D column's data, checking its length against the others
+template<typename T>
+const T* column_data(const column_t<T>& column, size_t count, const char* name) {
+    if (column.ndim() != 1 || static_cast<size_t>(column.shape(0)) != count) {
+        throw std::runtime_error(std::string("Column '") + name + "' must be 1-D with the same length as timestamp");
+    }
+    return column.data();
+}
+
+template<typename T>
+const T* optional_column_data(const std::optional<column_t<T>>& column, size_t count, const char* name) {
+    return column ? column_data(*column, count, name) : nullptr;
+}
+
+// Aggregate NumPy columns without holding the GIL
+void add_numpy_columns(flowgen::FlowAggregator& agg,
+                       const column_t<uint64_t>& timestamp,
+                       const column_t<uint32_t>& source_ip,
+                       const column_t<uint32_t>& destination_ip,
+                       const column_t<uint16_t>& source_port,
+                       const column_t<uint16_t>& destination_port,
+                       const column_t<uint8_t>& protocol,
+                       const std::optional<column_t<uint32_t>>& packet_length,
+                       const std::optional<column_t<uint32_t>>& packet_count,
+                       const std::optional<column_t<uint64_t>>& byte_count,
+                       const std::optional<column_t<uint64_t>>& duration_ns) {
+    if (timestamp.ndim() != 1) {
+        throw std::runtime_error("Column 'timestamp' must be 1-D");
+    }
+
+    flowgen::FlowColumns columns;
+    columns.count = static_cast<size_t>(timestamp.shape(0));
+    columns.timestamp = timestamp.data();
+    columns.source_ip = column_data(source_ip, columns.count, "source_ip");
+    columns.destination_ip = column_data(destination_ip, columns.count, "destination_ip");
+    columns.source_port = column_data(source_port, columns.count, "source_port");
+    columns.destination_port = column_data(destination_port, columns.count, "destination_port");
+    columns.protocol = column_data(protocol, columns.count, "protocol");
+    columns.packet_length = optional_column_data(packet_length, columns.count, "packet_length");
+    columns.packet_count = optional_column_data(packet_count, columns.count, "packet_count");
+    columns.byte_count = optional_column_data(byte_count, columns.count, "byte_count");
+    columns.duration_ns = optional_column_data(duration_ns, columns.count, "duration_ns");
+
+    py::gil_scoped_release release;
+    agg.add_columns(columns);
+}
+
+// IPv4 keys stay 32-bit ints; IPv6 keys become 128-bit ints (ipaddress.ip_address() accepts both)
+py::object ip_value(const flowgen::IpAddress& ip) {
+    if (ip.is_ipv4()) {
+        return py::int_(ip.ipv4());
+    }
+    py::object hi = py::int_(ip.hi);
+    return hi.attr("__lshift__")(64).attr("__or__")(py::int_(ip.lo));
+}
+
+py::tuple group_key_tuple(const flowgen::GroupKey& key, uint32_t fields) {
+    py::list values;
+    if (fields & flowgen::GROUP_SRC_IP) values.append(ip_value(key.source_ip));
+    if (fields & flowgen::GROUP_DST_IP) values.append(ip_value(key.destination_ip));
+    if (fields & flowgen::GROUP_SRC_PORT) values.append(key.source_port);
+    if (fields & flowgen::GROUP_DST_PORT) values.append(key.destination_port);
+    if (fields & flowgen::GROUP_PROTOCOL) values.append(key.protocol);
+    return py::tuple(values);
+}
+
+} // namespace
+
 PYBIND11_MODULE(_flowgen_core, m) {
     m.doc() = "FlowGen C++ core library - high-performance network flow generation";
 
@@ -50,29 +131,78 @@ PYBIND11_MODULE(_flowgen_core, m) {
                    ", ts=" + std::to_string(f.timestamp) + ")";
         });
 
+    py::class_<flowgen::DualStackFlowRecord>(m, "DualStackFlowRecord")
+        .def(py::init<>())
+        .def_property_readonly("source_ip", [](const flowgen::DualStackFlowRecord& f) {
+            return ip_value(f.source_ip);
+        })
+        .def_property_readonly("destination_ip", [](const flowgen::DualStackFlowRecord& f) {
+            return ip_value(f.destination_ip);
+        })
+        .def_property_readonly("source_ip_str", &flowgen::DualStackFlowRecord::source_ip_str)
+        .def_property_readonly("destination_ip_str", &flowgen::DualStackFlowRecord::destination_ip_str)
+        .def_property_readonly("is_ipv6", &flowgen::DualStackFlowRecord::is_ipv6)
+        .def_readwrite("source_port", &flowgen::DualStackFlowRecord::source_port)
+        .def_readwrite("destination_port", &flowgen::DualStackFlowRecord::destination_port)
+        .def_readwrite("protocol", &flowgen::DualStackFlowRecord::protocol)
+        .def_readwrite("timestamp", &flowgen::DualStackFlowRecord::timestamp)
+        .def_readwrite("packet_length", &flowgen::DualStackFlowRecord::packet_length)
+        .def("to_csv", &flowgen::DualStackFlowRecord::to_csv);
+
     // TrafficPattern binding
     py::class_<flowgen::GeneratorConfig::TrafficPattern>(m, "TrafficPattern")
         .def(py::init<>())
         .def_readwrite("type", &flowgen::GeneratorConfig::TrafficPattern::type)
-        .def_readwrite("percentage", &flowgen::GeneratorConfig::TrafficPattern::percentage);
+        .def_readwrite("percentage", &flowgen::GeneratorConfig::TrafficPattern::percentage)
+        .def_readwrite("config", &flowgen::GeneratorConfig::TrafficPattern::config);
+
+    // Communication graph options (GeneratorConfig.communication_graph)
+    py::class_<flowgen::CommunicationGraphOptions>(m, "CommunicationGraphOptions")
+        .def(py::init<>())
+        .def_readwrite("clients", &flowgen::CommunicationGraphOptions::clients)
+        .def_readwrite("servers", &flowgen::CommunicationGraphOptions::servers)
+        .def_readwrite("degree_exponent", &flowgen::CommunicationGraphOptions::degree_exponent)
+        .def_readwrite("max_degree", &flowgen::CommunicationGraphOptions::max_degree)
+        .def_readwrite("server_skew", &flowgen::CommunicationGraphOptions::server_skew)
+        .def_readwrite("locality", &flowgen::CommunicationGraphOptions::locality);
+
+    // Rate/mix schedule (GeneratorConfig.schedule)
+    py::class_<flowgen::SchedulePoint>(m, "SchedulePoint")
+        .def(py::init<>())
+        .def_readwrite("time_s", &flowgen::SchedulePoint::time_s)
+        .def_readwrite("rate", &flowgen::SchedulePoint::rate)
+        .def_readwrite("mix", &flowgen::SchedulePoint::mix);
+
+    py::class_<flowgen::ScheduleOptions>(m, "ScheduleOptions")
+        .def(py::init<>())
+        .def_readwrite("interpolation", &flowgen::ScheduleOptions::interpolation)
+        .def_readwrite("period_s", &flowgen::ScheduleOptions::period_s)
+        .def_readwrite("resolution_s", &flowgen::ScheduleOptions::resolution_s)
+        .def_readwrite("points", &flowgen::ScheduleOptions::points);
 
     // GeneratorConfig binding
     py::class_<flowgen::GeneratorConfig>(m, "GeneratorConfig")
         .def(py::init<>())
         .def_readwrite("bandwidth_gbps", &flowgen::GeneratorConfig::bandwidth_gbps)
-        .def_readwrite("flows_per_second", &flowgen::GeneratorConfig::flows_per_second)
-        .def_readwrite("max_flows", &flowgen::GeneratorConfig::max_flows)
-        .def_readwrite("duration_seconds", &flowgen::GeneratorConfig::duration_seconds)
         .def_readwrite("start_timestamp_ns", &flowgen::GeneratorConfig::start_timestamp_ns)
         .def_readwrite("source_subnets", &flowgen::GeneratorConfig::source_subnets)
         .def_readwrite("destination_subnets", &flowgen::GeneratorConfig::destination_subnets)
         .def_readwrite("source_weights", &flowgen::GeneratorConfig::source_weights)
+        .def_readwrite("source_popularity", &flowgen::GeneratorConfig::source_popularity)
+        .def_readwrite("destination_popularity", &flowgen::GeneratorConfig::destination_popularity)
+        .def_readwrite("communication_graph", &flowgen::GeneratorConfig::communication_graph)
         .def_readwrite("min_packet_size", &flowgen::GeneratorConfig::min_packet_size)
         .def_readwrite("max_packet_size", &flowgen::GeneratorConfig::max_packet_size)
         .def_readwrite("average_packet_size", &flowgen::GeneratorConfig::average_packet_size)
         .def_readwrite("bidirectional_mode", &flowgen::GeneratorConfig::bidirectional_mode)
         .def_readwrite("bidirectional_probability", &flowgen::GeneratorConfig::bidirectional_probability)
+        .def_readwrite("pacing", &flowgen::GeneratorConfig::pacing)
         .def_readwrite("traffic_patterns", &flowgen::GeneratorConfig::traffic_patterns)
+        .def_readwrite("schedule", &flowgen::GeneratorConfig::schedule)
+        .def_readwrite("overlays", &flowgen::GeneratorConfig::overlays)
+        .def_readwrite("plugin_dir", &flowgen::GeneratorConfig::plugin_dir)
+        .def_readwrite("seed", &flowgen::GeneratorConfig::seed)
+        .def_readwrite("model_seed", &flowgen::GeneratorConfig::model_seed)
         .def("validate", [](const flowgen::GeneratorConfig& cfg) {
             std::string error;
             bool valid = cfg.validate(&error);
@@ -82,48 +212,325 @@ PYBIND11_MODULE(_flowgen_core, m) {
             return valid;
         });
 
-    // Stats binding
-    py::class_<flowgen::FlowGenerator::Stats>(m, "GeneratorStats")
-        .def_readonly("flows_generated", &flowgen::FlowGenerator::Stats::flows_generated)
-        .def_readonly("elapsed_time_seconds", &flowgen::FlowGenerator::Stats::elapsed_time_seconds)
-        .def_readonly("flows_per_second", &flowgen::FlowGenerator::Stats::flows_per_second)
-        .def_readonly("current_timestamp_ns", &flowgen::FlowGenerator::Stats::current_timestamp_ns);
+    // Achieved versus configured utilization (FlowGenerator.pacing_report)
+    py::class_<flowgen::PacingReport>(m, "PacingReport")
+        .def_readonly("flows", &flowgen::PacingReport::flows)
+        .def_readonly("bytes", &flowgen::PacingReport::bytes)
+        .def_readonly("elapsed_ns", &flowgen::PacingReport::elapsed_ns)
+        .def_readonly("target_gbps", &flowgen::PacingReport::target_gbps)
+        .def_readonly("achieved_gbps", &flowgen::PacingReport::achieved_gbps)
+        .def_readonly("utilization", &flowgen::PacingReport::utilization);
 
     // FlowGenerator binding (non-copyable, use std::unique_ptr holder)
+    // The lightweight generator never runs dry - stop conditions are
+    // applied by the caller (see flowgen.FlowGenerator in __init__.py).
     py::class_<flowgen::FlowGenerator, std::unique_ptr<flowgen::FlowGenerator>>(m, "FlowGenerator")
         .def(py::init<>())
         .def("initialize", &flowgen::FlowGenerator::initialize,
              "Initialize generator with configuration")
-        .def("next", [](flowgen::FlowGenerator& gen) -> py::object {
+        .def("next", [](flowgen::FlowGenerator& gen) {
             flowgen::FlowRecord flow;
-            if (gen.next(flow)) {
-                return py::cast(flow);
-            } else {
-                return py::none();
+            gen.next(flow);
+            return flow;
+        }, "Generate next flow record")
+        .def("next_batch", [](flowgen::FlowGenerator& gen, size_t count) {
+            std::vector<flowgen::FlowRecord> flows(count);
+            {
+                py::gil_scoped_release release;
+                gen.next_batch(flows.data(), count);
+            }
+            return flows;
+        }, "Generate a list of flow records", py::arg("count"))
+        .def("next_dual_stack", [](flowgen::FlowGenerator& gen) {
+            flowgen::DualStackFlowRecord flow;
+            gen.next(flow);
+            return flow;
+        }, "Generate next flow with IPv4/IPv6 addresses")
+        .def("next_batch_dual_stack", [](flowgen::FlowGenerator& gen, size_t count) {
+            std::vector<flowgen::DualStackFlowRecord> flows(count);
+            {
+                py::gil_scoped_release release;
+                gen.next_batch(flows.data(), nullptr, count);
             }
-        }, "Generate next flow record, returns None when done")
-        .def("is_done", &flowgen::FlowGenerator::is_done,
-             "Check if generation is complete")
+            return flows;
+        }, "Generate a list of dual-stack flow records", py::arg("count"))
+        .def("dual_stack", &flowgen::FlowGenerator::dual_stack,
+             "Check whether IPv6 prefixes are configured")
         .def("reset", &flowgen::FlowGenerator::reset,
-             "Reset generator to initial state")
-        .def("get_stats", &flowgen::FlowGenerator::get_stats,
-             "Get generator statistics")
-        .def("flow_count", &flowgen::FlowGenerator::flow_count,
-             "Get number of flows generated")
+             "Reset generator to initial state (False if a pattern could not rewind)")
         .def("current_timestamp_ns", &flowgen::FlowGenerator::current_timestamp_ns,
              "Get current timestamp in nanoseconds")
+        .def("pacing_report", &flowgen::FlowGenerator::pacing_report,
+             "Achieved versus target link utilization")
         .def("__iter__", [](flowgen::FlowGenerator& gen) -> flowgen::FlowGenerator* {
             return &gen;
         }, py::return_value_policy::reference)
-        .def("__next__", [](flowgen::FlowGenerator& gen) -> flowgen::FlowRecord {
+        .def("__next__", [](flowgen::FlowGenerator& gen) {
             flowgen::FlowRecord flow;
-            if (gen.next(flow)) {
-                return flow;
-            } else {
-                throw py::stop_iteration();
-            }
+            gen.next(flow);
+            return flow;
         });
 
+    // Output sinks
+    py::enum_<flowgen::SinkFormat>(m, "SinkFormat")
+        .value("CSV", flowgen::SinkFormat::CSV)
+        .value("JSON", flowgen::SinkFormat::JSON)
+        .value("JSON_LINES", flowgen::SinkFormat::JSON_LINES)
+        .value("BINARY", flowgen::SinkFormat::BINARY)
+        .value("CLICKHOUSE_ROWBINARY", flowgen::SinkFormat::CLICKHOUSE_ROWBINARY)
+        .value("CLICKHOUSE_NATIVE", flowgen::SinkFormat::CLICKHOUSE_NATIVE)
+        .value("POSTGRES_BINARY", flowgen::SinkFormat::POSTGRES_BINARY);
+
+    py::class_<flowgen::FlowSchema>(m, "FlowSchema")
+        .def(py::init<>())
+        .def_static("parse", &flowgen::FlowSchema::parse,
+                    "Parse a comma-separated field list (tcp_flags, tos, vlan, input_if, "
+                    "output_if, src_as, dst_as, next_hop) or 'all'",
+                    py::arg("spec"))
+        .def_readwrite("fields", &flowgen::FlowSchema::fields)
+        .def("empty", &flowgen::FlowSchema::empty)
+        .def("__str__", &flowgen::FlowSchema::to_string);
+
+    py::class_<flowgen::SinkOptions>(m, "SinkOptions")
+        .def(py::init<>())
+        .def_readwrite("format", &flowgen::SinkOptions::format)
+        .def_readwrite("include_header", &flowgen::SinkOptions::include_header)
+        .def_readwrite("pretty", &flowgen::SinkOptions::pretty)
+        .def_readwrite("compress", &flowgen::SinkOptions::compress)
+        .def_readwrite("rotate_flows", &flowgen::SinkOptions::rotate_flows)
+        .def_readwrite("buffer_size", &flowgen::SinkOptions::buffer_size)
+        .def_readwrite("schema", &flowgen::SinkOptions::schema);
+
+    py::class_<flowgen::FlowSink>(m, "FlowSink")
+        .def("write", [](flowgen::FlowSink& sink, const std::vector<flowgen::FlowRecord>& flows) {
+            py::gil_scoped_release release;
+            sink.write(flows.data(), flows.size());
+        }, "Write a list of flow records", py::arg("flows"))
+        .def("close", [](flowgen::FlowSink& sink) {
+            py::gil_scoped_release release;
+            sink.close();
+        }, "Flush and close the sink")
+        .def("flows_written", &flowgen::FlowSink::flows_written,
+             "Get number of flows written");
+
+    m.def("open_sink", &flowgen::create_file_sink,
+          "Open a native file sink",
+          py::arg("path"), py::arg("options") = flowgen::SinkOptions());
+
+    m.def("parse_sink_format", &flowgen::parse_sink_format,
+          "Parse sink format name (csv, json, jsonl, binary, rowbinary, native, pgcopy)",
+          py::arg("format"));
+
+    m.def("sink_table_ddl", &flowgen::sink_table_ddl,
+          "CREATE TABLE statement for a rowbinary, native or pgcopy sink",
+          py::arg("format"), py::arg("schema") = flowgen::FlowSchema(), py::arg("table") = "flows");
+
+    m.def("sink_compression_available", &flowgen::sink_compression_available,
+          "Check whether gzip sinks are available");
+
+    m.def("export_flows", [](flowgen::FlowGenerator& gen, const std::string& path,
+                             uint64_t count, const flowgen::SinkOptions& options,
+                             uint64_t end_timestamp_ns) {
+        // Generation and serialization run entirely in C++ without the GIL
+        py::gil_scoped_release release;
+        auto sink = flowgen::create_file_sink(path, options);
+        uint64_t written = flowgen::export_flows(gen, *sink, count, 4096, end_timestamp_ns);
+        sink->close();
+        return written;
+    }, "Generate count flows straight into a file, stopping early at the first "
+       "flow that starts at or after end_timestamp_ns",
+       py::arg("generator"), py::arg("path"), py::arg("count"),
+       py::arg("options") = flowgen::SinkOptions(),
+       py::arg("end_timestamp_ns") = UINT64_MAX);
+
+    m.def("write_flows", [](const std::vector<flowgen::FlowRecord>& flows,
+                            const std::string& path,
+                            const flowgen::SinkOptions& options) {
+        py::gil_scoped_release release;
+        auto sink = flowgen::create_file_sink(path, options);
+        sink->write(flows.data(), flows.size());
+        sink->close();
+        return sink->flows_written();
+    }, "Write a list of flow records to a file",
+       py::arg("flows"), py::arg("path"),
+       py::arg("options") = flowgen::SinkOptions());
+
+    // Aggregators - results stay in C++ until explicitly read back
+    py::enum_<flowgen::AggregateMetric>(m, "AggregateMetric")
+        .value("FLOWS", flowgen::AggregateMetric::FLOWS)
+        .value("PACKETS", flowgen::AggregateMetric::PACKETS)
+        .value("BYTES", flowgen::AggregateMetric::BYTES);
+
+    py::class_<flowgen::FlowAggregator>(m, "FlowAggregator")
+        .def("update", [](flowgen::FlowAggregator& agg, flowgen::FlowGenerator& gen,
+                          uint64_t count, size_t batch_size) {
+            py::gil_scoped_release release;
+            return flowgen::aggregate_flows(gen, count, {&agg}, batch_size);
+        }, "Generate and aggregate count flows",
+           py::arg("generator"), py::arg("count"), py::arg("batch_size") = 4096)
+        .def("add_columns", &add_numpy_columns,
+             "Aggregate flows from NumPy column arrays",
+             py::arg("timestamp"), py::arg("source_ip"), py::arg("destination_ip"),
+             py::arg("source_port"), py::arg("destination_port"), py::arg("protocol"),
+             py::arg("packet_length") = py::none(), py::arg("packet_count") = py::none(),
+             py::arg("byte_count") = py::none(), py::arg("duration_ns") = py::none());
+
+    py::class_<flowgen::PortTable, flowgen::FlowAggregator>(m, "PortTable")
+        .def(py::init<>())
+        .def("merge", &flowgen::PortTable::merge, py::arg("other"))
+        .def("clear", &flowgen::PortTable::clear)
+        .def("__len__", &flowgen::PortTable::size)
+        .def("ports", [](const flowgen::PortTable& table) {
+            // (port, flow_count, tx_bytes, rx_bytes, tx_packets, rx_packets)
+            std::vector<std::tuple<uint16_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t>> rows;
+            table.for_each([&rows](uint16_t port, const flowgen::PortCounters& c) {
+                rows.emplace_back(port, c.flow_count, c.tx_bytes, c.rx_bytes,
+                                  c.tx_packets, c.rx_packets);
+            });
+            return rows;
+        }, "Get (port, flow_count, tx_bytes, rx_bytes, tx_packets, rx_packets) rows");
+
+    py::class_<flowgen::GroupBy, flowgen::FlowAggregator>(m, "GroupBy")
+        .def(py::init([](const std::string& fields) {
+            return std::make_unique<flowgen::GroupBy>(flowgen::parse_group_fields(fields));
+        }), py::arg("fields"))
+        .def("merge", &flowgen::GroupBy::merge, py::arg("other"))
+        .def("__len__", [](const flowgen::GroupBy& g) { return g.groups().size(); })
+        .def("top", [](const flowgen::GroupBy& g, size_t n, flowgen::AggregateMetric metric) {
+            py::list rows;
+            for (const auto& [key, c] : g.top(n, metric)) {
+                rows.append(py::make_tuple(group_key_tuple(key, g.fields()),
+                                           c.flow_count, c.packet_count, c.byte_count));
+            }
+            return rows;
+        }, "Get (key, flow_count, packet_count, byte_count) rows, largest first (n=0 for all)",
+           py::arg("n") = 0, py::arg("metric") = flowgen::AggregateMetric::BYTES);
+
+    py::class_<flowgen::HeavyHitters, flowgen::FlowAggregator>(m, "HeavyHitters")
+        .def(py::init([](size_t capacity, const std::string& fields, flowgen::AggregateMetric metric) {
+            return std::make_unique<flowgen::HeavyHitters>(capacity, flowgen::parse_group_fields(fields), metric);
+        }), py::arg("capacity") = 1024, py::arg("fields") = "src_ip",
+            py::arg("metric") = flowgen::AggregateMetric::BYTES)
+        .def("merge", &flowgen::HeavyHitters::merge, py::arg("other"))
+        .def("capacity", &flowgen::HeavyHitters::capacity)
+        .def("top", [](const flowgen::HeavyHitters& hh, size_t n) {
+            py::list rows;
+            for (const auto& e : hh.top(n)) {
+                rows.append(py::make_tuple(group_key_tuple(e.key, hh.fields()), e.count, e.error));
+            }
+            return rows;
+        }, "Get (key, count, error) rows, heaviest first (n=0 for all)",
+           py::arg("n") = 0);
+
+    py::class_<flowgen::TimeSeries, flowgen::FlowAggregator>(m, "TimeSeries")
+        .def(py::init<uint64_t>(), py::arg("bucket_ns"))
+        .def("merge", &flowgen::TimeSeries::merge, py::arg("other"))
+        .def("bucket_ns", &flowgen::TimeSeries::bucket_ns)
+        .def("buckets", [](const flowgen::TimeSeries& ts) {
+            // (start_ns, flow_count, packet_count, byte_count)
+            std::vector<std::tuple<uint64_t, uint64_t, uint64_t, uint64_t>> rows;
+            uint64_t start = ts.start_ns();
+            for (const auto& c : ts.buckets()) {
+                rows.emplace_back(start, c.flow_count, c.packet_count, c.byte_count);
+                start += ts.bucket_ns();
+            }
+            return rows;
+        }, "Get (start_ns, flow_count, packet_count, byte_count) rows");
+
+    py::class_<flowgen::EntropyTimeSeries, flowgen::FlowAggregator>(m, "EntropyTimeSeries")
+        .def(py::init<uint64_t, size_t, flowgen::AggregateMetric>(),
+             py::arg("window_ns"), py::arg("registers") = flowgen::EntropySketch::DEFAULT_REGISTERS,
+             py::arg("metric") = flowgen::AggregateMetric::FLOWS)
+        .def("merge", &flowgen::EntropyTimeSeries::merge, py::arg("other"))
+        .def("window_ns", &flowgen::EntropyTimeSeries::window_ns)
+        .def("windows", [](const flowgen::EntropyTimeSeries& es) {
+            // (start_ns, flow_count, src_ip, dst_ip, dst_port entropy in bits)
+            std::vector<std::tuple<uint64_t, uint64_t, double, double, double>> rows;
+            uint64_t start = es.start_ns();
+            for (const auto& w : es.windows()) {
+                rows.emplace_back(start, w.flow_count, w.src_ip.entropy(),
+                                  w.dst_ip.entropy(), w.dst_port.entropy());
+                start += es.window_ns();
+            }
+            return rows;
+        }, "Get (start_ns, flow_count, src_ip, dst_ip, dst_port) entropy rows (bits)");
+
+    m.def("aggregate_flows", [](flowgen::FlowGenerator& gen, uint64_t count,
+                                const std::vector<flowgen::FlowAggregator*>& aggregators,
+                                size_t batch_size) {
+        py::gil_scoped_release release;
+        return flowgen::aggregate_flows(gen, count, aggregators, batch_size);
+    }, "Generate count flows once and feed every aggregator",
+       py::arg("generator"), py::arg("count"), py::arg("aggregators"),
+       py::arg("batch_size") = 4096);
+
+    m.def("fanout_flows", [](flowgen::FlowGenerator& gen, uint64_t count,
+                             const std::vector<flowgen::FlowAggregator*>& aggregators,
+                             const std::vector<flowgen::FlowSink*>& sinks,
+                             size_t batch_size, bool threaded) {
+        std::vector<std::unique_ptr<flowgen::FlowConsumer>> owned;
+        std::vector<flowgen::FlowConsumer*> consumers;
+        for (flowgen::FlowAggregator* agg : aggregators) {
+            owned.push_back(std::make_unique<flowgen::AggregatorConsumer>(*agg));
+            consumers.push_back(owned.back().get());
+        }
+        for (flowgen::FlowSink* sink : sinks) {
+            owned.push_back(std::make_unique<flowgen::SinkConsumer>(*sink));
+            consumers.push_back(owned.back().get());
+        }
+        flowgen::FanoutOptions options;
+        options.batch_size = batch_size;
+        options.threaded = threaded;
+        py::gil_scoped_release release;
+        return flowgen::fanout_flows(gen, count, consumers, options);
+    }, "Generate count flows once, feeding every aggregator and sink (sinks are closed)",
+       py::arg("generator"), py::arg("count"), py::arg("aggregators") = std::vector<flowgen::FlowAggregator*>(),
+       py::arg("sinks") = std::vector<flowgen::FlowSink*>(), py::arg("batch_size") = 4096,
+       py::arg("threaded") = false);
+
+    // Learned traffic profiles (use as pattern type "profile:<path>")
+    py::class_<flowgen::ProfileLearnOptions>(m, "ProfileLearnOptions")
+        .def(py::init<>())
+        .def_readwrite("prefix_length", &flowgen::ProfileLearnOptions::prefix_length)
+        .def_readwrite("max_prefixes", &flowgen::ProfileLearnOptions::max_prefixes)
+        .def_readwrite("max_services", &flowgen::ProfileLearnOptions::max_services)
+        .def_readwrite("reservoir_size", &flowgen::ProfileLearnOptions::reservoir_size)
+        .def_readwrite("resolution", &flowgen::ProfileLearnOptions::resolution);
+
+    m.def("learn_profile", [](const std::string& input, const std::string& output,
+                              const flowgen::ProfileLearnOptions& options) {
+        py::gil_scoped_release release;
+        flowgen::TrafficProfile profile = flowgen::learn_profile(input, options);
+        profile.save(output);
+        return profile.flow_count;
+    }, "Learn a traffic profile from a flow CSV/binary file and save it",
+       py::arg("input"), py::arg("output"),
+       py::arg("options") = flowgen::ProfileLearnOptions());
+
+    // Distribution specs (pattern config keys packet_size, packet_count, duration_ms)
+    m.def("sample_distribution", [](const std::string& spec, size_t count) {
+        flowgen::InverseCdfTable table = flowgen::parse_distribution(spec);
+        std::vector<double> values(count);
+        for (auto& v : values) {
+            v = table.sample();
+        }
+        return values;
+    }, "Draw samples from a distribution spec such as 'pareto(1.2, 64, 1500)'",
+       py::arg("spec"), py::arg("count"));
+
+    m.def("hash_five_tuple", [](const flowgen::FlowRecord& flow, const std::string& hash) {
+        return flowgen::hash_five_tuple(flowgen::parse_key_hash(hash), flow);
+    }, "Hash a flow's 5-tuple with toeplitz, crc32 or xxhash32 (as used by the keyspace pattern)",
+       py::arg("flow"), py::arg("hash"));
+
+    m.def("load_plugin", [](const std::string& path) {
+        flowgen::PluginRegistry::instance().load(path);
+    }, "Load a pattern plugin library (see plugin_abi.h)", py::arg("path"));
+
+    m.def("plugin_pattern_types", []() {
+        return flowgen::PluginRegistry::instance().pattern_types();
+    }, "Pattern types registered by loaded plugins");
+
     // Utility functions
     m.def("calculate_flows_per_second", &flowgen::utils::calculate_flows_per_second,
           "Calculate flows per second from bandwidth",
@@ -151,5 +558,5 @@ PYBIND11_MODULE(_flowgen_core, m) {
 
     m.def("seed_random", [](uint64_t seed) {
         flowgen::utils::Random::instance().seed(seed);
-    }, "Seed the random number generator");
+    }, "Seed the calling thread's random number generator (used by generators without a seed)");
 }
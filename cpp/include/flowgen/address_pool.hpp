@@ -0,0 +1,207 @@
+#ifndef FLOWGEN_ADDRESS_POOL_HPP
+#define FLOWGEN_ADDRESS_POOL_HPP
+
+#include "alias_table.hpp"
+#include "ip_address.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Zipf / Zipf-Mandelbrot sampler over ranks [0, n)
+ *
+ * P(rank k) is proportional to 1 / (k + 1 + offset)^exponent. Uses
+ * rejection-inversion (Hoermann & Derflinger), so memory is constant
+ * and the expected cost is O(1) for any n, including whole /8s.
+ */
+class ZipfSampler {
+public:
+    ZipfSampler() = default;
+
+    /**
+     * Throws std::runtime_error unless n > 0, exponent > 0, offset >= 0
+     */
+    ZipfSampler(uint64_t n, double exponent, double offset = 0.0);
+
+    /**
+     * Sample a rank using the global random generator
+     */
+    uint64_t sample() const;
+
+    uint64_t size() const { return n_; }
+
+private:
+    uint64_t n_ = 0;
+    double exponent_ = 1.0;
+    double offset_ = 0.0;
+    double h_integral_x1_ = 0.0;
+    double h_integral_n_ = 0.0;
+    double s_ = 0.0;
+
+    double h(double x) const;
+    double h_integral(double x) const;
+    double h_integral_inverse(double x) const;
+};
+
+/**
+ * Keyed pseudo-random bijection on [0, n)
+ *
+ * A balanced Feistel network over the next even bit width, with cycle
+ * walking to stay inside the domain. Used to scatter popularity ranks
+ * across a subnet so the busiest hosts are not the lowest addresses.
+ */
+class FeistelPermutation {
+public:
+    FeistelPermutation() = default;
+    FeistelPermutation(uint64_t n, uint64_t key);
+
+    uint64_t operator()(uint64_t index) const;
+
+private:
+    uint64_t n_ = 1;
+    uint64_t key_ = 0;
+    unsigned half_bits_ = 1;
+    uint64_t half_mask_ = 1;
+};
+
+/**
+ * Host selection within one subnet
+ *
+ * Popularity specs:
+ *   uniform                  every host equally likely (default)
+ *   zipf(exponent[, offset]) Zipf-Mandelbrot over host ranks
+ *   hotspot(hosts, fraction) fraction of flows go to a set of hot hosts
+ *
+ * Ranks are mapped to addresses through a FeistelPermutation keyed by
+ * the subnet, so the same hosts are hot in every generator instance.
+ * Network and broadcast addresses are skipped as in random_ipv4_uint32().
+ */
+class SubnetHosts {
+public:
+    /**
+     * Throws std::runtime_error on a malformed subnet or spec
+     */
+    SubnetHosts(const std::string& subnet, const std::string& popularity = "uniform");
+
+    uint32_t sample() const;
+
+    uint32_t base() const { return base_; }
+    uint64_t host_count() const { return host_count_; }
+
+private:
+    enum class Model { UNIFORM, ZIPF, HOTSPOT };
+
+    uint32_t base_;         // First usable address
+    uint64_t host_count_;   // Usable addresses
+    Model model_;
+    ZipfSampler zipf_;
+    uint64_t hot_hosts_;
+    double hot_fraction_;
+    FeistelPermutation permutation_;
+};
+
+/**
+ * Weighted set of subnets with per-subnet host popularity
+ *
+ * Built once per generator from the configured subnets; sampling is an
+ * alias-table lookup plus one SubnetHosts draw, with no string parsing.
+ */
+class AddressPool {
+public:
+    AddressPool() = default;
+
+    /**
+     * @param subnets CIDR subnets
+     * @param weights Optional subnet weights (empty = equal)
+     * @param popularity Empty (uniform), one spec for all subnets, or one per subnet
+     *
+     * Throws std::runtime_error on invalid input.
+     */
+    AddressPool(const std::vector<std::string>& subnets,
+                const std::vector<double>& weights = {},
+                const std::vector<std::string>& popularity = {});
+
+    uint32_t sample() const;
+
+    /**
+     * Pick a subnet index by weight (sample one of its hosts via subnets())
+     */
+    size_t sample_subnet() const {
+        return subnets_.size() == 1 ? 0 : selector_.sample();
+    }
+
+    bool empty() const { return subnets_.empty(); }
+    const std::vector<SubnetHosts>& subnets() const { return subnets_; }
+
+    /**
+     * Usable addresses over all subnets
+     */
+    uint64_t host_count() const {
+        uint64_t count = 0;
+        for (const SubnetHosts& subnet : subnets_) {
+            count += subnet.host_count();
+        }
+        return count;
+    }
+
+private:
+    std::vector<SubnetHosts> subnets_;
+    AliasTable selector_;
+};
+
+/**
+ * Weighted set of IPv6 prefixes
+ *
+ * Prefixes are parsed once into base/mask pairs, so a host is an alias
+ * lookup plus two masked 64-bit words. map() derives the host from an
+ * IPv4 surrogate address instead of random bits: the same surrogate
+ * always maps to the same IPv6 host, which keeps host popularity,
+ * sessions and communication graphs intact for IPv6 flows.
+ */
+class Ipv6Pool {
+public:
+    Ipv6Pool() = default;
+
+    /**
+     * @param prefixes IPv6 CIDR prefixes
+     * @param weights Optional prefix weights (empty = equal)
+     *
+     * Throws std::runtime_error on invalid input.
+     */
+    explicit Ipv6Pool(const std::vector<std::string>& prefixes,
+                      const std::vector<double>& weights = {});
+
+    /**
+     * Random host from a weighted prefix
+     */
+    IpAddress sample() const;
+
+    /**
+     * Deterministic host for an IPv4 surrogate address
+     */
+    IpAddress map(uint32_t surrogate) const;
+
+    bool empty() const { return prefixes_.empty(); }
+
+private:
+    struct Prefix {
+        IpAddress base;
+        IpAddress host_mask;
+    };
+
+    std::vector<Prefix> prefixes_;
+    AliasTable selector_;
+    uint64_t key_ = 0;
+
+    IpAddress host(const Prefix& prefix, uint64_t hi_bits, uint64_t lo_bits) const {
+        return IpAddress{prefix.base.hi | (hi_bits & prefix.host_mask.hi),
+                         prefix.base.lo | (lo_bits & prefix.host_mask.lo)};
+    }
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_ADDRESS_POOL_HPP
@@ -0,0 +1,438 @@
+#ifndef FLOWGEN_AGGREGATORS_HPP
+#define FLOWGEN_AGGREGATORS_HPP
+
+#include "flow_record.hpp"
+#include "flow_stats.hpp"
+#include "generator.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Column view over a set of flows (e.g. NumPy arrays)
+ *
+ * Required: timestamp, source_ip, destination_ip, source_port,
+ * destination_port, protocol. Optional columns may be null:
+ * packet_count defaults to 1, byte_count to packet_length (or 0).
+ */
+struct FlowColumns {
+    size_t count = 0;
+    const uint64_t* timestamp = nullptr;
+    const uint32_t* source_ip = nullptr;
+    const uint32_t* destination_ip = nullptr;
+    const uint16_t* source_port = nullptr;
+    const uint16_t* destination_port = nullptr;
+    const uint8_t* protocol = nullptr;
+    const uint32_t* packet_length = nullptr;
+    const uint32_t* packet_count = nullptr;
+    const uint64_t* byte_count = nullptr;
+    const uint64_t* duration_ns = nullptr;
+};
+
+/**
+ * Base class for streaming flow aggregators
+ *
+ * Aggregators are not thread-safe; use one per thread and merge.
+ */
+class FlowAggregator {
+public:
+    virtual ~FlowAggregator() = default;
+
+    /**
+     * Add one enriched flow
+     */
+    virtual void add(const FlowRecord& flow, const FlowStats& stats) = 0;
+
+    /**
+     * Add one enriched dual-stack flow
+     *
+     * Aggregators that key on addresses override this; the default
+     * drops to the IPv4 record.
+     */
+    virtual void add(const DualStackFlowRecord& flow, const FlowStats& stats) {
+        add(flow.to_ipv4(), stats);
+    }
+
+    /**
+     * Add flows from column arrays
+     */
+    virtual void add_columns(const FlowColumns& columns);
+};
+
+// ========== Port table ==========
+
+/**
+ * Per-port counters (tx = port used as source, rx = as destination)
+ */
+struct PortCounters {
+    uint64_t flow_count = 0;
+    uint64_t tx_bytes = 0;
+    uint64_t rx_bytes = 0;
+    uint64_t tx_packets = 0;
+    uint64_t rx_packets = 0;
+};
+
+/**
+ * Direct-indexed port statistics table
+ *
+ * Ports are stored in lazily allocated pages of 256 entries, so
+ * updates are a single array index and sparse port sets stay small.
+ */
+class PortTable : public FlowAggregator {
+public:
+    PortTable() = default;
+    PortTable(const PortTable& other);
+    PortTable& operator=(const PortTable& other);
+    PortTable(PortTable&&) = default;
+    PortTable& operator=(PortTable&&) = default;
+
+    using FlowAggregator::add;
+    void add(const FlowRecord& flow, const FlowStats& stats) override;
+
+    /**
+     * Merge counters from another table
+     */
+    void merge(const PortTable& other);
+
+    /**
+     * Get counters for a port, or nullptr if the port was never seen
+     */
+    const PortCounters* find(uint16_t port) const;
+
+    /**
+     * Visit seen ports in ascending order: fn(port, counters)
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t page = 0; page < PAGE_COUNT; ++page) {
+            if (!pages_[page]) continue;
+            for (size_t i = 0; i < PAGE_SIZE; ++i) {
+                const PortCounters& c = (*pages_[page])[i];
+                if (c.flow_count > 0) {
+                    fn(static_cast<uint16_t>(page * PAGE_SIZE + i), c);
+                }
+            }
+        }
+    }
+
+    /**
+     * Get number of ports seen
+     */
+    size_t size() const;
+
+    void clear();
+
+private:
+    static constexpr size_t PAGE_SIZE = 256;
+    static constexpr size_t PAGE_COUNT = 65536 / PAGE_SIZE;
+    using Page = std::array<PortCounters, PAGE_SIZE>;
+
+    PortCounters& at(uint16_t port);
+
+    std::array<std::unique_ptr<Page>, PAGE_COUNT> pages_;
+};
+
+// ========== Group-by ==========
+
+/**
+ * Fields that make up a group-by / heavy-hitter key (bitmask)
+ */
+enum GroupField : uint32_t {
+    GROUP_SRC_IP   = 1u << 0,
+    GROUP_DST_IP   = 1u << 1,
+    GROUP_SRC_PORT = 1u << 2,
+    GROUP_DST_PORT = 1u << 3,
+    GROUP_PROTOCOL = 1u << 4
+};
+
+/**
+ * Parse comma-separated group fields, e.g. "src_ip,dst_port"
+ */
+uint32_t parse_group_fields(const std::string& spec);
+
+/**
+ * Aggregation key - fields not in the group mask are zero
+ *
+ * Addresses are 128-bit, so IPv4 and IPv6 flows group side by side
+ * (IPv4 as IPv4-mapped addresses).
+ */
+struct GroupKey {
+    IpAddress source_ip;
+    IpAddress destination_ip;
+    uint16_t source_port = 0;
+    uint16_t destination_port = 0;
+    uint8_t protocol = 0;
+
+    static GroupKey from_flow(const FlowRecord& flow, uint32_t fields);
+    static GroupKey from_flow(const DualStackFlowRecord& flow, uint32_t fields);
+
+    bool operator==(const GroupKey& other) const {
+        return source_ip == other.source_ip &&
+               destination_ip == other.destination_ip &&
+               source_port == other.source_port &&
+               destination_port == other.destination_port &&
+               protocol == other.protocol;
+    }
+};
+
+struct GroupKeyHash {
+    size_t operator()(const GroupKey& key) const {
+        uint64_t h = IpAddressHash()(key.source_ip) ^
+                     (IpAddressHash()(key.destination_ip) * 0xD6E8FEB86659FD93ULL);
+        uint64_t l = (static_cast<uint64_t>(key.source_port) << 24) |
+                     (static_cast<uint64_t>(key.destination_port) << 8) | key.protocol;
+        h ^= l * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+        return static_cast<size_t>(h);
+    }
+};
+
+struct GroupCounters {
+    uint64_t flow_count = 0;
+    uint64_t packet_count = 0;
+    uint64_t byte_count = 0;
+};
+
+/**
+ * Metric used to rank groups and weight heavy hitters
+ */
+enum class AggregateMetric {
+    FLOWS,
+    PACKETS,
+    BYTES
+};
+
+AggregateMetric parse_aggregate_metric(const std::string& metric_str);
+
+/**
+ * Exact group-by over any subset of the 5-tuple
+ */
+class GroupBy : public FlowAggregator {
+public:
+    explicit GroupBy(uint32_t fields);
+
+    void add(const FlowRecord& flow, const FlowStats& stats) override;
+    void add(const DualStackFlowRecord& flow, const FlowStats& stats) override;
+
+    void merge(const GroupBy& other);
+
+    /**
+     * Get the N largest groups by metric (0 = all, unsorted order not guaranteed)
+     */
+    std::vector<std::pair<GroupKey, GroupCounters>> top(size_t n, AggregateMetric metric) const;
+
+    const std::unordered_map<GroupKey, GroupCounters, GroupKeyHash>& groups() const { return groups_; }
+    uint32_t fields() const { return fields_; }
+
+private:
+    uint32_t fields_;
+    std::unordered_map<GroupKey, GroupCounters, GroupKeyHash> groups_;
+};
+
+// ========== Heavy hitters ==========
+
+/**
+ * Space-Saving heavy-hitter sketch (top talkers) in bounded memory
+ *
+ * Tracks at most `capacity` keys. Each reported count overestimates
+ * the true weight by at most `error`.
+ */
+class HeavyHitters : public FlowAggregator {
+public:
+    struct Entry {
+        GroupKey key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    HeavyHitters(size_t capacity, uint32_t fields, AggregateMetric metric);
+
+    void add(const FlowRecord& flow, const FlowStats& stats) override;
+    void add(const DualStackFlowRecord& flow, const FlowStats& stats) override;
+
+    /**
+     * Add weight to a key
+     */
+    void update(const GroupKey& key, uint64_t weight);
+
+    void merge(const HeavyHitters& other);
+
+    /**
+     * Get the N heaviest entries, largest first (0 = all)
+     */
+    std::vector<Entry> top(size_t n) const;
+
+    size_t capacity() const { return capacity_; }
+    uint32_t fields() const { return fields_; }
+
+private:
+    void sift_down(size_t pos);
+    void swap_entries(size_t a, size_t b);
+
+    size_t capacity_;
+    uint32_t fields_;
+    AggregateMetric metric_;
+    std::vector<Entry> heap_;  // min-heap on count
+    std::unordered_map<GroupKey, size_t, GroupKeyHash> index_;
+};
+
+// ========== Time series ==========
+
+/**
+ * Fixed-width time buckets of flow/packet/byte counts
+ *
+ * Flows are bucketed by first-packet timestamp.
+ */
+class TimeSeries : public FlowAggregator {
+public:
+    explicit TimeSeries(uint64_t bucket_ns);
+
+    using FlowAggregator::add;
+    void add(const FlowRecord& flow, const FlowStats& stats) override;
+
+    void merge(const TimeSeries& other);
+
+    uint64_t bucket_ns() const { return bucket_ns_; }
+
+    /**
+     * Start timestamp of buckets()[0]
+     */
+    uint64_t start_ns() const { return first_bucket_ * bucket_ns_; }
+
+    const std::vector<GroupCounters>& buckets() const { return buckets_; }
+
+private:
+    GroupCounters& bucket_for(uint64_t bucket_index);
+
+    uint64_t bucket_ns_;
+    uint64_t first_bucket_;
+    std::vector<GroupCounters> buckets_;
+};
+
+// ========== Entropy ==========
+
+/**
+ * Mergeable streaming estimate of the empirical (Shannon) entropy of a
+ * weighted item stream, in constant memory
+ *
+ * Uses the stable-projection sketch of Clifford & Cosma: each register
+ * accumulates weight x a maximally skewed 1-stable variate derived from
+ * a hash of (item, register), and the entropy is
+ * -ln(mean(exp(register / total))). The error is about 0.25 bits with
+ * the default 128 registers and shrinks as 1/sqrt(registers); each
+ * update costs one hash and one division per register. Sketches with
+ * the same register count add register-wise, so per-thread sketches
+ * merge exactly.
+ */
+class EntropySketch {
+public:
+    static constexpr size_t DEFAULT_REGISTERS = 128;
+
+    explicit EntropySketch(size_t registers = DEFAULT_REGISTERS);
+
+    /**
+     * Add weight to an item (any 64-bit key)
+     */
+    void update(uint64_t item, uint64_t weight = 1);
+
+    void merge(const EntropySketch& other);
+
+    /**
+     * Estimated entropy in bits (0 for an empty sketch)
+     */
+    double entropy() const;
+
+    uint64_t total() const { return total_; }
+    size_t registers() const { return registers_.size(); }
+
+private:
+    std::vector<double> registers_;
+    uint64_t total_;
+};
+
+/**
+ * Per-window entropy of source address, destination address and
+ * destination port
+ *
+ * Each window holds one EntropySketch per dimension, so memory per
+ * window is fixed whatever the address cardinality. Updates go through
+ * a small direct-mapped buffer that combines repeated items (popular
+ * ports, flood targets) before they reach the sketches. Flows are
+ * bucketed by first-packet timestamp and weighted by the metric.
+ */
+class EntropyTimeSeries : public FlowAggregator {
+public:
+    struct Window {
+        uint64_t flow_count = 0;
+        EntropySketch src_ip;
+        EntropySketch dst_ip;
+        EntropySketch dst_port;
+    };
+
+    EntropyTimeSeries(uint64_t window_ns,
+                      size_t registers = EntropySketch::DEFAULT_REGISTERS,
+                      AggregateMetric metric = AggregateMetric::FLOWS);
+
+    void add(const FlowRecord& flow, const FlowStats& stats) override;
+    void add(const DualStackFlowRecord& flow, const FlowStats& stats) override;
+
+    void merge(const EntropyTimeSeries& other);
+
+    uint64_t window_ns() const { return window_ns_; }
+
+    /**
+     * Start timestamp of windows()[0]
+     */
+    uint64_t start_ns() const { return first_window_ * window_ns_; }
+
+    /**
+     * Windows in time order, with buffered updates folded in
+     */
+    const std::vector<Window>& windows() const;
+
+private:
+    static constexpr size_t PENDING_SLOTS = 256;
+
+    struct Pending {
+        uint64_t item = 0;
+        uint64_t weight = 0;  // 0 = empty
+    };
+
+    Window& window_for(uint64_t window_index);
+    void add_items(uint64_t timestamp, uint64_t src_item, uint64_t dst_item,
+                   uint16_t dst_port, const FlowStats& stats);
+    void flush() const;
+
+    uint64_t window_ns_;
+    size_t registers_;
+    AggregateMetric metric_;
+    uint64_t first_window_;
+    mutable std::vector<Window> windows_;
+
+    // Updates not yet in the sketches, all for window pending_window_
+    mutable std::vector<Pending> pending_;  // 3 x PENDING_SLOTS
+    mutable uint64_t pending_window_;
+    mutable bool has_pending_;
+};
+
+/**
+ * Generate and enrich flows once, feeding every aggregator
+ *
+ * Dual-stack generators feed DualStackFlowRecords.
+ *
+ * @return Number of flows aggregated
+ */
+uint64_t aggregate_flows(FlowGenerator& generator, uint64_t count,
+                         const std::vector<FlowAggregator*>& aggregators,
+                         size_t batch_size = 4096);
+
+} // namespace flowgen
+
+#endif // FLOWGEN_AGGREGATORS_HPP
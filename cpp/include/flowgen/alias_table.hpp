@@ -0,0 +1,74 @@
+#ifndef FLOWGEN_ALIAS_TABLE_HPP
+#define FLOWGEN_ALIAS_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Walker/Vose alias table for O(1) weighted sampling
+ *
+ * Built once from a weight vector; each sample costs one uniform
+ * variate, one multiply and one table lookup.
+ */
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    /**
+     * Build from non-negative weights (need not be normalized)
+     */
+    explicit AliasTable(const std::vector<double>& weights);
+
+    /**
+     * Rebuild from non-negative weights
+     *
+     * Throws std::runtime_error if weights are empty, negative or all zero.
+     */
+    void build(const std::vector<double>& weights);
+
+    /**
+     * Build into caller-owned arrays of n entries
+     *
+     * Lets many small tables share flat storage (e.g. one per CSR row);
+     * sample them with sample_from(). Throws like build().
+     */
+    static void build_into(const double* weights, size_t n, double* prob, uint32_t* alias);
+
+    /**
+     * Sample a table stored in flat arrays by build_into()
+     */
+    static size_t sample_from(const double* prob, const uint32_t* alias, size_t n, double u) {
+        double scaled = u * static_cast<double>(n);
+        size_t i = static_cast<size_t>(scaled);
+        if (i >= n) {
+            i = n - 1;
+        }
+        return (scaled - static_cast<double>(i)) < prob[i] ? i : alias[i];
+    }
+
+    /**
+     * Map a uniform variate u in [0, 1) to an index
+     */
+    size_t sample(double u) const {
+        return sample_from(prob_.data(), alias_.data(), prob_.size(), u);
+    }
+
+    /**
+     * Sample an index using the global random generator
+     */
+    size_t sample() const;
+
+    size_t size() const { return prob_.size(); }
+    bool empty() const { return prob_.empty(); }
+
+private:
+    std::vector<double> prob_;
+    std::vector<uint32_t> alias_;
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_ALIAS_TABLE_HPP
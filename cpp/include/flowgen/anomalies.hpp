@@ -0,0 +1,104 @@
+#ifndef FLOWGEN_ANOMALIES_HPP
+#define FLOWGEN_ANOMALIES_HPP
+
+#include "address_pool.hpp"
+#include "flow_record.hpp"
+#include "flow_stats.hpp"
+#include "patterns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Time-bounded attack or anomaly overlay
+ *
+ * Compact spec: "<type> key=value ..." (spaces or commas between
+ * fields), e.g.
+ *   "syn_flood target=10.0.0.5:443 rate=10 start=2s duration=5s"
+ *   "horizontal_scan target=10.1.0.0/16 port=22 rate=2"
+ *
+ * Types: syn_flood, udp_amplification, horizontal_scan, vertical_scan,
+ * flash_crowd.
+ *
+ * Keys:
+ *   target         IP, IP:port or CIDR (required)
+ *   port           Target port (reflector service port for amplification)
+ *   rate           Overlay flow rate as a multiple of the active schedule
+ *                  segment's base rate (byte pacing: its mean flow bytes at
+ *                  the link rate); paced overlay bytes count against the link
+ *   sources        Distinct attacking sources (0 = new spoofed source per flow)
+ *   source_subnet  CIDR the sources are drawn from (default: any IPv4)
+ *   start          Offset from the generator start (ns, us, ms, s; default s)
+ *   duration       Length of the overlay (0 = until the end)
+ */
+struct AnomalySpec {
+    enum class Kind {
+        SYN_FLOOD,
+        UDP_AMPLIFICATION,
+        HORIZONTAL_SCAN,
+        VERTICAL_SCAN,
+        FLASH_CROWD
+    };
+
+    Kind kind = Kind::SYN_FLOOD;
+    std::string name;
+    uint32_t target_base = 0;      // First target address
+    uint32_t target_count = 1;     // Addresses in the target range
+    uint16_t port = 0;             // 0 = type default
+    double rate = 1.0;
+    size_t sources = 0;
+    std::string source_subnet;
+    uint64_t start_ns = 0;
+    uint64_t duration_ns = 0;
+
+    /**
+     * Parse a compact spec (throws std::runtime_error)
+     */
+    static AnomalySpec parse(const std::string& spec);
+};
+
+/**
+ * Flow generator for one anomaly overlay
+ *
+ * Source addresses are precomputed, and scan cursors are plain
+ * counters, so generate() does not allocate.
+ */
+class AnomalyPattern : public PatternGenerator {
+public:
+    explicit AnomalyPattern(const AnomalySpec& spec);
+
+    FlowRecord generate(
+        uint64_t timestamp_ns,
+        const std::vector<std::string>& src_subnets,
+        const std::vector<std::string>& dst_subnets,
+        const std::vector<double>& src_weights,
+        uint32_t min_pkt_size,
+        uint32_t max_pkt_size
+    ) override;
+
+    bool generate_stats(const FlowRecord& flow, FlowStats& stats) override;
+
+    uint8_t tcp_flags(const FlowRecord& flow) const override;
+
+    bool reset() override;
+
+    std::string type() const override { return spec_.name; }
+
+    const AnomalySpec& spec() const { return spec_; }
+
+private:
+    AnomalySpec spec_;
+    std::vector<uint32_t> sources_;
+    AddressPool spec_source_pool_;  // Used when sources == 0 and a subnet is given
+    uint64_t cursor_;               // Scan position
+
+    uint32_t pick_source();
+    uint32_t pick_target();
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_ANOMALIES_HPP
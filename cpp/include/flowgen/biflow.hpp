@@ -0,0 +1,174 @@
+#ifndef FLOWGEN_BIFLOW_HPP
+#define FLOWGEN_BIFLOW_HPP
+
+#include "fanout.hpp"
+#include "flow_stats.hpp"
+#include "ip_address.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Bidirectional flow record (RFC 5103)
+ *
+ * The forward direction is the earlier of the two flows (the
+ * initiator). Reverse counters are zero when no reverse flow matched.
+ */
+struct BiflowRecord {
+    uint64_t timestamp = 0;          // Forward flow start
+    IpAddress source_ip;             // Forward direction
+    IpAddress destination_ip;
+    uint16_t source_port = 0;
+    uint16_t destination_port = 0;
+    uint8_t protocol = 0;
+    bool matched = false;            // Reverse flow joined
+    FlowStats forward = {};
+    uint64_t reverse_timestamp = 0;  // Reverse flow start (matched only)
+    FlowStats reverse = {};
+
+    /**
+     * Column names of to_csv(); reverse_* columns are the RFC 5103
+     * reverse information elements
+     */
+    static std::string csv_header();
+
+    std::string to_csv() const;
+};
+
+/**
+ * Options for BiflowStitcher
+ */
+struct BiflowOptions {
+    uint64_t tolerance_ns = 1000000000ULL;  // Largest start-time gap between directions
+    size_t partitions = 16;                 // Hash-join partitions
+    size_t max_pending = 0;                 // Unmatched flows held (0 = bounded by time only)
+};
+
+/**
+ * Streaming biflow stitcher
+ *
+ * Joins each flow with a reverse-direction flow of the same
+ * canonicalized 5-tuple (lower endpoint first) whose start lies within
+ * tolerance_ns. Flows are routed to hash-join partitions by the
+ * canonical key, and each partition holds its unmatched flows in a
+ * hash table plus an arrival-ordered expiry queue. Flows that are not
+ * joined are emitted as unidirectional biflows once the stream's
+ * watermark (latest start seen minus tolerance_ns) passes them, or
+ * when their partition exceeds its share of max_pending, so state is
+ * bounded by the flows of one tolerance window whatever the stream
+ * length. A second flow in the same direction closes the pending one.
+ *
+ * Input should be in start-time order, up to tolerance_ns of disorder
+ * (generator output is). Biflows are emitted in completion order, not
+ * sorted by start time. finish() emits everything still pending.
+ */
+class BiflowStitcher : public FlowConsumer {
+public:
+    /**
+     * Receives each run of completed biflows
+     */
+    using Output = std::function<void(const BiflowRecord* biflows, size_t count)>;
+
+    BiflowStitcher(const BiflowOptions& options, Output output);
+
+    void consume(const FlowBatch& batch, const FlowStats* stats) override;
+    void finish() override;
+
+    uint64_t flows_in() const { return flows_in_; }
+    uint64_t biflows_matched() const { return matched_; }
+    uint64_t biflows_unmatched() const { return unmatched_; }
+
+    /**
+     * Flows currently waiting for a reverse flow
+     */
+    size_t pending() const;
+
+private:
+    struct Key {
+        IpAddress low_ip;
+        IpAddress high_ip;
+        uint16_t low_port;
+        uint16_t high_port;
+        uint8_t protocol;
+        uint64_t hash;
+
+        bool operator==(const Key& other) const {
+            return low_ip == other.low_ip && high_ip == other.high_ip &&
+                   low_port == other.low_port && high_port == other.high_port &&
+                   protocol == other.protocol;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    struct Pending {
+        BiflowRecord record;  // Forward side filled in
+        uint64_t sequence;    // Identifies this entry in the expiry queue
+    };
+
+    struct Expiry {
+        uint64_t timestamp;
+        uint64_t sequence;
+        Key key;
+    };
+
+    struct Partition {
+        std::unordered_map<Key, Pending, KeyHash> table;
+        std::deque<Expiry> expiry;
+    };
+
+    void emit_unmatched(const BiflowRecord& record);
+    void expire(Partition& partition, uint64_t watermark, size_t limit);
+    void flush_output();
+
+    BiflowOptions options_;
+    Output output_;
+    std::vector<Partition> partitions_;
+    size_t partition_limit_;
+    uint64_t latest_ = 0;
+    uint64_t sequence_ = 0;
+    uint64_t flows_in_ = 0;
+    uint64_t matched_ = 0;
+    uint64_t unmatched_ = 0;
+    std::vector<BiflowRecord> completed_;
+};
+
+/**
+ * Buffered CSV writer for biflows (BiflowRecord::csv_header() columns)
+ */
+class BiflowCsvWriter {
+public:
+    /**
+     * Open a file and write the header (throws std::runtime_error)
+     */
+    explicit BiflowCsvWriter(const std::string& path);
+    ~BiflowCsvWriter();
+
+    BiflowCsvWriter(const BiflowCsvWriter&) = delete;
+    BiflowCsvWriter& operator=(const BiflowCsvWriter&) = delete;
+
+    void write(const BiflowRecord* biflows, size_t count);
+    void close();
+
+    uint64_t biflows_written() const { return written_; }
+
+private:
+    void flush();
+
+    FILE* fp_;
+    std::string buffer_;
+    uint64_t written_ = 0;
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_BIFLOW_HPP
@@ -0,0 +1,82 @@
+#ifndef FLOWGEN_COMMUNICATION_GRAPH_HPP
+#define FLOWGEN_COMMUNICATION_GRAPH_HPP
+
+#include "address_pool.hpp"
+#include "alias_table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Options for the client-server communication graph
+ *
+ * Disabled while clients is 0.
+ */
+struct CommunicationGraphOptions {
+    size_t clients = 0;            // Client nodes (0 = graph disabled)
+    size_t servers = 1000;         // Server nodes
+    double degree_exponent = 2.1;  // Power-law exponent of client out-degree (> 1)
+    size_t max_degree = 256;       // Cap on servers per client
+    double server_skew = 1.0;      // Zipf exponent of server popularity (0 = uniform)
+    double locality = 0.0;         // Fraction of edges kept within the paired subnet
+
+    bool enabled() const { return clients > 0; }
+
+    /**
+     * Check option ranges
+     */
+    bool validate(std::string* error = nullptr) const;
+};
+
+/**
+ * Sparse bipartite client -> server graph
+ *
+ * Built once at initialize(): client out-degrees follow a power law,
+ * edge targets follow server popularity, and with locality > 0 clients
+ * in source subnet i prefer servers in destination subnet
+ * i % destination_subnets. Edges are stored in CSR form with a per-row
+ * alias table, so drawing a flow's endpoints is two alias lookups and
+ * the number of distinct conversations is bounded by edge_count().
+ * Sampling is const, so generators sharing a model seed share one
+ * graph and the bound holds for the whole run.
+ */
+class CommunicationGraph {
+public:
+    CommunicationGraph() = default;
+
+    /**
+     * Build from address pools (throws std::runtime_error)
+     */
+    CommunicationGraph(const CommunicationGraphOptions& options,
+                       const AddressPool& client_pool,
+                       const AddressPool& server_pool);
+
+    /**
+     * Draw one edge weighted by conversation intensity
+     */
+    void sample(uint32_t& client_ip, uint32_t& server_ip) const;
+
+    size_t client_count() const { return client_addresses_.size(); }
+    size_t server_count() const { return server_addresses_.size(); }
+    size_t edge_count() const { return edge_targets_.size(); }
+    bool empty() const { return client_addresses_.empty(); }
+
+private:
+    std::vector<uint32_t> client_addresses_;
+    std::vector<uint32_t> server_addresses_;
+
+    // CSR: edges of client c are [row_offsets_[c], row_offsets_[c + 1])
+    std::vector<uint32_t> row_offsets_;
+    std::vector<uint32_t> edge_targets_;   // Server index
+    std::vector<double> edge_prob_;        // Per-row alias tables
+    std::vector<uint32_t> edge_alias_;
+
+    AliasTable client_selector_;           // Clients by total edge weight
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_COMMUNICATION_GRAPH_HPP
@@ -0,0 +1,150 @@
+#ifndef FLOWGEN_DISTRIBUTIONS_HPP
+#define FLOWGEN_DISTRIBUTIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Inverse-CDF lookup table
+ *
+ * Stores values at evenly spaced quantiles; sampling maps a uniform
+ * variate onto the table with linear interpolation, so any
+ * distribution costs the same constant time per draw. Tables built
+ * from a quantile function keep it for the last segment, where
+ * interpolation would flatten a heavy tail.
+ */
+class InverseCdfTable {
+public:
+    static constexpr size_t DEFAULT_RESOLUTION = 64;
+    static constexpr size_t PARAMETRIC_RESOLUTION = 1024;
+
+    InverseCdfTable() = default;
+
+    /**
+     * Build from quantile values (sorted ascending, evenly spaced in [0, 1])
+     */
+    explicit InverseCdfTable(std::vector<double> points);
+
+    /**
+     * Build from raw samples (empirical distribution)
+     *
+     * @param samples Observed values (any order)
+     * @param resolution Number of quantile points to keep
+     */
+    static InverseCdfTable from_samples(std::vector<double> samples,
+                                        size_t resolution = DEFAULT_RESOLUTION);
+
+    /**
+     * Tabulate a quantile function q(u)
+     *
+     * Draws in the last segment evaluate q(u) directly, so the top
+     * 1/(resolution - 1) of the mass keeps its true shape and mean
+     * instead of a straight line to the 1 - 1e-6 quantile. All values
+     * are clamped to max_value.
+     */
+    static InverseCdfTable from_quantile_function(const std::function<double(double)>& quantile,
+                                                  size_t resolution = PARAMETRIC_RESOLUTION,
+                                                  double max_value = 1e300);
+
+    // Parametric distributions (max_value truncates heavy tails)
+    static InverseCdfTable constant(double value);
+    static InverseCdfTable uniform(double min, double max);
+    static InverseCdfTable bimodal(double min1, double max1, double min2, double max2,
+                                   double first_fraction);
+    static InverseCdfTable exponential(double mean, double max_value = 1e300);
+    static InverseCdfTable pareto(double alpha, double scale, double max_value = 1e300);
+    static InverseCdfTable lognormal(double mu, double sigma, double max_value = 1e300);
+    static InverseCdfTable weibull(double shape, double scale, double max_value = 1e300);
+
+    /**
+     * Map a uniform variate u in [0, 1) to a value (0 for an empty table)
+     */
+    double sample(double u) const {
+        if (points_.empty()) {
+            return 0.0;
+        }
+        size_t last = points_.size() - 1;
+        double x = u * static_cast<double>(last);
+        size_t i = static_cast<size_t>(x);
+        if (i + 1 >= last) {
+            if (tail_) {
+                return sample_tail(u);
+            }
+            if (i >= last) {
+                return points_[last];
+            }
+        }
+        return points_[i] + (x - static_cast<double>(i)) * (points_[i + 1] - points_[i]);
+    }
+
+    /**
+     * Sample using the global random generator
+     */
+    double sample() const;
+
+    const std::vector<double>& points() const { return points_; }
+    bool empty() const { return points_.empty(); }
+
+    /**
+     * Mean of the tabulated distribution
+     */
+    double mean() const;
+
+private:
+    // Largest uniform variate below 1 (53-bit mantissa)
+    static constexpr double TAIL_LAST_QUANTILE = 1.0 - 0x1.0p-53;
+
+    double sample_tail(double u) const;
+
+    std::vector<double> points_;
+    std::function<double(double)> tail_;  // Quantile function of the last segment, if any
+    double max_value_ = 1e300;
+    double tail_mean_ = 0.0;              // Mean of the last segment
+};
+
+/**
+ * Parsed "name(a, b, ...)" spec
+ *
+ * A bare number parses as constant(x); a bare word as a name with no
+ * arguments. Names are lower-cased.
+ */
+struct DistributionSpec {
+    std::string name;
+    std::vector<double> args;
+
+    /**
+     * Throw std::runtime_error unless min_args <= args.size() <= max_args
+     */
+    void expect_args(size_t min_args, size_t max_args) const;
+};
+
+/**
+ * Split a spec string into name and arguments (throws std::runtime_error)
+ */
+DistributionSpec parse_distribution_spec(const std::string& spec);
+
+/**
+ * Build a table from a distribution spec string
+ *
+ * Specs (a bare number is a constant):
+ *   constant(x)
+ *   uniform(min, max)
+ *   bimodal(min1, max1, min2, max2, first_fraction)
+ *   exponential(mean[, max])
+ *   pareto(alpha, scale[, max])
+ *   lognormal(mu, sigma[, max])
+ *   weibull(shape, scale[, max])
+ *   empirical(v1, v2, ...)    (quantile points, linearly interpolated)
+ *
+ * Throws std::runtime_error on malformed specs.
+ */
+InverseCdfTable parse_distribution(const std::string& spec);
+
+} // namespace flowgen
+
+#endif // FLOWGEN_DISTRIBUTIONS_HPP
@@ -0,0 +1,173 @@
+#ifndef FLOWGEN_FANOUT_HPP
+#define FLOWGEN_FANOUT_HPP
+
+#include "aggregators.hpp"
+#include "flow_stats.hpp"
+#include "generator.hpp"
+#include "ip_address.hpp"
+#include "schema.hpp"
+#include "sinks.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Consumer of generated flow batches
+ *
+ * Batches are shared by reference between all consumers of a run and
+ * must not be modified or retained after consume() returns.
+ */
+class FlowConsumer {
+public:
+    virtual ~FlowConsumer() = default;
+
+    /**
+     * Optional fields this consumer needs in each batch
+     */
+    virtual FlowSchema schema() const { return {}; }
+
+    /**
+     * Process one batch; stats[i] belongs to batch.flows[i]
+     *
+     * Batches carry at least the fields in schema(), plus
+     * FlowField::IPV6 when the generator is dual-stack.
+     */
+    virtual void consume(const FlowBatch& batch, const FlowStats* stats) = 0;
+
+    /**
+     * Called once after the last batch
+     */
+    virtual void finish() {}
+};
+
+/**
+ * Feeds batches to a FlowAggregator
+ *
+ * Batches with FlowField::IPV6 are added as DualStackFlowRecords.
+ */
+class AggregatorConsumer : public FlowConsumer {
+public:
+    explicit AggregatorConsumer(FlowAggregator& aggregator) : aggregator_(aggregator) {}
+
+    void consume(const FlowBatch& batch, const FlowStats* stats) override;
+
+private:
+    FlowAggregator& aggregator_;
+};
+
+/**
+ * Writes batches to a FlowSink; finish() closes the sink
+ */
+class SinkConsumer : public FlowConsumer {
+public:
+    explicit SinkConsumer(FlowSink& sink) : sink_(sink) {}
+
+    FlowSchema schema() const override { return sink_.schema(); }
+    void consume(const FlowBatch& batch, const FlowStats* stats) override;
+    void finish() override { sink_.close(); }
+
+private:
+    FlowSink& sink_;
+};
+
+/**
+ * Flow predicate over the 5-tuple and statistics
+ *
+ * Parsed from comma-separated key=value terms that must all match:
+ *   protocol=6 (or tcp, udp, icmp)
+ *   src_port=443, dst_port=53, port=22 (either side)
+ *   src_net=10.0.0.0/8, dst_net=2001:db8::/32, net=... (either side)
+ *   min_bytes=1000000, min_packets=10
+ * Prefixes are matched against the flow's real address family, so an
+ * IPv4 prefix never matches an IPv6 flow.
+ */
+class FlowFilter {
+public:
+    FlowFilter() = default;
+
+    /**
+     * Parse a filter spec (throws std::runtime_error); "" matches everything
+     */
+    static FlowFilter parse(const std::string& spec);
+
+    /**
+     * Test row index of a batch
+     */
+    bool matches(const FlowBatch& batch, size_t index, const FlowStats& stats) const;
+
+private:
+    struct Prefix {
+        IpAddress base;
+        IpAddress mask;
+
+        bool contains(const IpAddress& ip) const {
+            return (ip.hi & mask.hi) == base.hi && (ip.lo & mask.lo) == base.lo;
+        }
+    };
+
+    enum class Side { SOURCE, DESTINATION, EITHER };
+
+    int protocol_ = -1;
+    int source_port_ = -1;
+    int destination_port_ = -1;
+    int port_ = -1;
+    std::vector<std::pair<Side, Prefix>> prefixes_;
+    uint64_t min_bytes_ = 0;
+    uint64_t min_packets_ = 0;
+};
+
+/**
+ * Passes the rows that match a FlowFilter on to another consumer
+ *
+ * Matching rows are compacted into a batch owned by the filter, so
+ * the downstream consumer sees dense batches.
+ */
+class FilterConsumer : public FlowConsumer {
+public:
+    FilterConsumer(FlowFilter filter, FlowConsumer& downstream)
+        : filter_(std::move(filter)), downstream_(downstream) {}
+
+    FlowSchema schema() const override { return downstream_.schema(); }
+    void consume(const FlowBatch& batch, const FlowStats* stats) override;
+    void finish() override { downstream_.finish(); }
+
+private:
+    FlowFilter filter_;
+    FlowConsumer& downstream_;
+    FlowBatch selected_;
+    std::vector<FlowStats> selected_stats_;
+};
+
+/**
+ * Options for fanout_flows()
+ */
+struct FanoutOptions {
+    size_t batch_size = 4096;   // Flows per shared batch
+    bool threaded = false;      // One thread per consumer instead of inline calls
+    size_t queue_depth = 4;     // Batches in flight when threaded
+};
+
+/**
+ * Generate and enrich flows once, feeding every consumer
+ *
+ * Each batch is generated with the union of the consumers' schemas and
+ * handed to every consumer by reference. Inline, consumers run in
+ * order on the calling thread. Threaded, each consumer runs on its own
+ * thread over a ring of queue_depth batches, so the slowest consumer
+ * sets the pace and generation overlaps consumption. Consumers see
+ * batches in generation order either way. finish() is called on every
+ * consumer once all batches are consumed. The first exception thrown
+ * by a consumer stops the run and is rethrown.
+ *
+ * @return Number of flows generated
+ */
+uint64_t fanout_flows(FlowGenerator& generator, uint64_t count,
+                      const std::vector<FlowConsumer*>& consumers,
+                      const FanoutOptions& options = {});
+
+} // namespace flowgen
+
+#endif // FLOWGEN_FANOUT_HPP
@@ -1,6 +1,7 @@
 #ifndef FLOWGEN_FLOW_RECORD_HPP
 #define FLOWGEN_FLOW_RECORD_HPP
 
+#include "ip_address.hpp"
 #include <string>
 #include <cstdint>
 
@@ -53,6 +54,54 @@ struct FlowRecord {
     static std::string csv_header();
 };
 
+/**
+ * Dual-stack flow record with 128-bit addresses
+ *
+ * IPv4 flows hold IPv4-mapped addresses (see IpAddress). Both
+ * addresses of a flow are always the same family.
+ */
+struct DualStackFlowRecord {
+    IpAddress source_ip;
+    IpAddress destination_ip;
+    uint64_t timestamp;     // Unix epoch timestamp in nanoseconds
+    uint32_t packet_length; // Packet size in bytes
+    uint16_t source_port;
+    uint16_t destination_port;
+    uint8_t protocol;
+
+    DualStackFlowRecord() = default;
+
+    /**
+     * IPv4 record
+     */
+    explicit DualStackFlowRecord(const FlowRecord& flow)
+        : source_ip(IpAddress::from_ipv4(flow.source_ip)),
+          destination_ip(IpAddress::from_ipv4(flow.destination_ip)),
+          timestamp(flow.timestamp),
+          packet_length(flow.packet_length),
+          source_port(flow.source_port),
+          destination_port(flow.destination_port),
+          protocol(flow.protocol) {}
+
+    bool is_ipv6() const { return !source_ip.is_ipv4(); }
+
+    /**
+     * Same flow with 32-bit addresses (IPv6 addresses keep their low 32 bits)
+     */
+    FlowRecord to_ipv4() const {
+        return FlowRecord(source_ip.ipv4(), destination_ip.ipv4(), source_port,
+                          destination_port, protocol, timestamp, packet_length);
+    }
+
+    std::string source_ip_str() const { return source_ip.to_string(); }
+    std::string destination_ip_str() const { return destination_ip.to_string(); }
+
+    /**
+     * Convert to CSV string (same columns as FlowRecord::csv_header())
+     */
+    std::string to_csv() const;
+};
+
 } // namespace flowgen
 
 #endif // FLOWGEN_FLOW_RECORD_HPP
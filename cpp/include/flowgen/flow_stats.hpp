@@ -0,0 +1,31 @@
+#ifndef FLOWGEN_FLOW_STATS_HPP
+#define FLOWGEN_FLOW_STATS_HPP
+
+#include <cstdint>
+
+namespace flowgen {
+
+/**
+ * Flow statistics for realistic packet/byte count generation
+ */
+struct FlowStats {
+    uint32_t packet_count;
+    uint64_t byte_count;
+    uint64_t duration_ns;  // Flow duration in nanoseconds
+};
+
+/**
+ * Generate realistic flow statistics based on protocol and port
+ *
+ * @param avg_packet_size Average packet size (FlowRecord::packet_length)
+ * @param protocol IP protocol number
+ * @param dst_port Destination port
+ * @return Packet count, byte count and duration for the flow
+ */
+FlowStats generate_flow_stats(uint32_t avg_packet_size,
+                              uint8_t protocol,
+                              uint16_t dst_port);
+
+} // namespace flowgen
+
+#endif // FLOWGEN_FLOW_STATS_HPP
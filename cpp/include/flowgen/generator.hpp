@@ -1,8 +1,15 @@
 #ifndef FLOWGEN_GENERATOR_HPP
 #define FLOWGEN_GENERATOR_HPP
 
+#include "anomalies.hpp"
 #include "flow_record.hpp"
+#include "flow_stats.hpp"
+#include "pacing.hpp"
 #include "patterns.hpp"
+#include "schedule.hpp"
+#include "schema.hpp"
+#include "utils.hpp"
+#include <map>
 #include <vector>
 #include <memory>
 #include <string>
@@ -22,11 +29,39 @@ struct GeneratorConfig {
     // Timestamp (nanoseconds since Unix epoch)
     uint64_t start_timestamp_ns = 0;
 
-    // Network configuration
+    // Random stream: nonzero gives the generator its own stream seeded
+    // with this value, so the same config reproduces the same flows
+    // whatever other generators or threads do; 0 draws from the calling
+    // thread's utils::Random::instance()
+    uint64_t seed = 0;
+
+    // Seed of the state that models one network for a whole run (host
+    // populations, key spaces, the communication graph). Generators with
+    // the same nonzero model_seed and network configuration share one
+    // read-only copy built from it, so several streams of a run see the
+    // same hosts; 0 builds a private copy from the generator's own random
+    // stream.
+    uint64_t model_seed = 0;
+
+    // Network configuration - IPv4 subnets and/or IPv6 prefixes. The
+    // IPv6 share of source_weights sets the fraction of IPv6 flows; see
+    // FlowGenerator::next(DualStackFlowRecord&).
     std::vector<std::string> source_subnets;
     std::vector<std::string> destination_subnets;
     std::vector<double> source_weights;
 
+    // Host popularity within subnets: empty (uniform), one spec for all
+    // subnets or one per subnet - "uniform", "zipf(s[, q])", "hotspot(n, f)"
+    std::vector<std::string> source_popularity;
+    std::vector<std::string> destination_popularity;
+
+    // Optional fixed client-server graph for endpoint selection
+    CommunicationGraphOptions communication_graph;
+
+    // Flow spacing: "flows" (each flow counts as one average-size packet)
+    // or "bytes" (token bucket over each flow's enriched bytes, see BytePacer)
+    std::string pacing = "flows";
+
     // Packet configuration
     uint32_t min_packet_size = 64;
     uint32_t max_packet_size = 1500;
@@ -40,15 +75,40 @@ struct GeneratorConfig {
     struct TrafficPattern {
         std::string type;
         double percentage;
+        std::map<std::string, std::string> config;  // Pattern parameters (see PatternDistributions)
     };
     std::vector<TrafficPattern> traffic_patterns;
 
+    // Directory of pattern plugins (*.so) loaded before patterns are
+    // created, in addition to $FLOWGEN_PLUGIN_PATH (see plugins.hpp)
+    std::string plugin_dir;
+
+    // Optional time-varying rate and mix (multiplies bandwidth_gbps,
+    // mix weights are per traffic pattern)
+    ScheduleOptions schedule;
+
+    // Time-bounded attack/anomaly overlays on top of the pattern mix
+    // (AnomalySpec compact specs, e.g. "syn_flood target=10.0.0.5:80 rate=10 start=5s duration=30s")
+    std::vector<std::string> overlays;
+
     /**
      * Validate configuration
      */
     bool validate(std::string* error = nullptr) const;
 };
 
+/**
+ * Achieved versus configured link utilization
+ */
+struct PacingReport {
+    uint64_t flows = 0;
+    uint64_t bytes = 0;           // Enriched bytes generated (packet_length for flows without statistics)
+    uint64_t elapsed_ns = 0;      // Simulated time covered so far
+    double target_gbps = 0.0;     // Configured bandwidth, time-averaged over the schedule
+    double achieved_gbps = 0.0;   // Bytes delivered so far (in-flight flows pro rata under byte pacing)
+    double utilization = 0.0;     // achieved_gbps / target_gbps
+};
+
 /**
  * Lightweight flow generator
  *
@@ -79,28 +139,133 @@ public:
      */
     void next(FlowRecord& flow);
 
+    /**
+     * Generate next flow record with packet/byte/duration statistics
+     *
+     * Statistics come from the selected pattern when it models them
+     * (e.g. learned profiles), otherwise from generate_flow_stats().
+     */
+    void next(FlowRecord& flow, FlowStats& stats);
+
+    /**
+     * Generate a batch of flow records
+     *
+     * Fills flows[0..count) in timestamp order.
+     */
+    void next_batch(FlowRecord* flows, size_t count);
+
+    /**
+     * Generate a batch of flow records with statistics
+     */
+    void next_batch(FlowRecord* flows, FlowStats* stats, size_t count);
+
+    /**
+     * Generate a batch with the optional fields selected by batch.schema
+     *
+     * Resizes the batch to count flows. Field values come from the
+     * FieldDistributions of the pattern (or overlay) that produced each
+     * flow; columns not in the schema are left empty.
+     */
+    void next_batch(FlowBatch& batch, size_t count);
+
+    /**
+     * Generate a batch with optional fields and statistics (stats may be null)
+     */
+    void next_batch(FlowBatch& batch, FlowStats* stats, size_t count);
+
+    /**
+     * Generate next flow with dual-stack addresses
+     *
+     * With IPv6 prefixes configured, each flow is generated as IPv4 and
+     * then, for the configured share of client/server pairs, moved to
+     * IPv6 by mapping its addresses into the prefixes (Ipv6Pool::map()).
+     * The IPv4-only API returns such flows with their IPv4 surrogate
+     * addresses. Overlay flows are always IPv4.
+     */
+    void next(DualStackFlowRecord& flow);
+    void next(DualStackFlowRecord& flow, FlowStats& stats);
+
+    /**
+     * Generate a batch of dual-stack flows (stats may be null)
+     */
+    void next_batch(DualStackFlowRecord* flows, FlowStats* stats, size_t count);
+
+    /**
+     * Check whether IPv6 prefixes are configured
+     */
+    bool dual_stack() const { return ipv6_fraction_ > 0.0; }
+
     /**
      * Reset generator to initial state
+     *
+     * Rewinds time, the random stream and every pattern (see
+     * PatternGenerator::reset()). A seeded generator then replays the
+     * same flows, unless a pattern could not rewind: then this returns
+     * false.
      */
-    void reset();
+    bool reset();
 
     /**
      * Get current timestamp in nanoseconds
      */
     uint64_t current_timestamp_ns() const { return current_timestamp_ns_; }
 
+    /**
+     * Achieved versus target utilization since initialize()/reset()
+     */
+    PacingReport pacing_report() const;
+
 private:
     bool initialized_;
     GeneratorConfig config_;
 
     std::vector<std::unique_ptr<PatternGenerator>> pattern_generators_;
-    std::vector<double> pattern_weights_;
+    AddressPool source_pool_;
+    AddressPool destination_pool_;
+    Ipv6Pool source_pool6_;
+    Ipv6Pool destination_pool6_;
+    double ipv6_fraction_;          // Share of client/server pairs that use IPv6
+    std::shared_ptr<const CommunicationGraph> graph_;  // Null when disabled
+    RateSchedule schedule_;
 
-    uint64_t inter_arrival_time_ns_;  // nanoseconds between flows
+    // Overlay flows run on their own clock at rate x the active segment's
+    // base rate and are merged with the base stream in timestamp order
+    struct Overlay {
+        std::unique_ptr<AnomalyPattern> pattern;
+        uint64_t start_ns;
+        uint64_t end_ns;
+        double rate;
+        uint64_t next_ns;
+    };
+    std::vector<Overlay> overlays_;
+
+    // Own random stream when config_.seed is set (see rng())
+    utils::Random rng_;
+
+    uint64_t inter_arrival_time_ns_;  // nanoseconds between flows at bandwidth_gbps
     uint64_t start_timestamp_ns_;
     uint64_t current_timestamp_ns_;
 
-    PatternGenerator* select_pattern();
+    bool byte_pacing_;
+    BytePacer pacer_;
+    uint64_t flows_generated_;
+    uint64_t bytes_generated_;
+    double target_bytes_;
+    uint64_t base_flows_;             // Pattern flows (no overlays), for overlay pacing
+    uint64_t base_bytes_;
+
+    PatternGenerator* last_pattern_;  // Producer of the most recent flow
+    bool last_swapped_;               // Most recent flow had its direction swapped
+    bool last_overlay_;               // Most recent flow came from an overlay
+
+    // Stream installed as utils::Random::instance() while generating
+    utils::Random& rng() { return config_.seed != 0 ? rng_ : utils::Random::instance(); }
+
+    Overlay* due_overlay();
+    void generate(FlowRecord& flow, FlowStats* stats);
+    void generate_overlay(Overlay& overlay, FlowRecord& flow, FlowStats* stats);
+    void fill_fields(FlowBatch& batch, size_t index) const;
+    void map_addresses(const FlowRecord& flow, IpAddress& source, IpAddress& destination) const;
 };
 
 } // namespace flowgen
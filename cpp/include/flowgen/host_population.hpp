@@ -0,0 +1,159 @@
+#ifndef FLOWGEN_HOST_POPULATION_HPP
+#define FLOWGEN_HOST_POPULATION_HPP
+
+#include "address_pool.hpp"
+#include "alias_table.hpp"
+#include "patterns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Service offered by servers in a host population
+ */
+struct ServiceSpec {
+    uint8_t protocol = 6;
+    uint16_t port = 0;
+    double weight = 1.0;
+};
+
+/**
+ * Parse "tcp/443:40,udp/53:20,..." (throws std::runtime_error)
+ *
+ * Protocol may be tcp, udp or a number; the weight defaults to 1.
+ */
+std::vector<ServiceSpec> parse_service_list(const std::string& spec);
+
+/**
+ * Options for building a host population
+ */
+struct HostPopulationOptions {
+    static constexpr size_t MAX_SERVICES = 16;
+
+    size_t clients = 100000;
+    size_t servers = 5000;
+    size_t services_per_client = 3;        // Preferred services per client (max)
+    std::string activity = "pareto(1.2, 1, 10000)";  // Relative flow rate per client
+    double server_skew = 1.0;              // Zipf exponent over servers of a service
+    std::vector<ServiceSpec> services;     // Empty = built-in service mix
+};
+
+/**
+ * Materialized client and server hosts
+ *
+ * State is kept in struct-of-arrays form: a client costs 8 bytes
+ * (address, ephemeral port cursor, preferred service bitmask) and a
+ * server 4 bytes (servers are grouped by service, so the service is
+ * implicit in the index).
+ *
+ * Client activity is quantized into power-of-two classes and clients
+ * are stored grouped by class, so picking an active client is an alias
+ * lookup over classes plus a uniform index - constant time with no
+ * per-host weight. Servers of a service are picked by Zipf rank, giving
+ * popular servers and realistic client fan-out.
+ *
+ * A built population is read-only, so generators of one run can share
+ * it. Each user keeps its own ephemeral port cursors (2 bytes per
+ * client, see port_cursors()).
+ */
+class HostPopulation {
+public:
+    struct Flow {
+        uint32_t source_ip;
+        uint32_t destination_ip;
+        uint16_t source_port;
+        uint16_t destination_port;
+        uint8_t protocol;
+    };
+
+    /**
+     * Build from address pools (throws std::runtime_error)
+     */
+    HostPopulation(const HostPopulationOptions& options,
+                   const AddressPool& client_pool,
+                   const AddressPool& server_pool);
+
+    /**
+     * Pick an active client, one of its services and a server
+     *
+     * Advances the client's entry in port_cursors.
+     */
+    Flow next(std::vector<uint16_t>& port_cursors) const;
+
+    /**
+     * Ephemeral port cursors for one user, rotated by offset within the
+     * ephemeral range so users of a shared population do not replay
+     * each other's ports
+     */
+    std::vector<uint16_t> port_cursors(size_t offset = 0) const;
+
+    size_t client_count() const { return client_addresses_.size(); }
+    size_t server_count() const { return server_addresses_.size(); }
+    const std::vector<ServiceSpec>& services() const { return services_; }
+
+private:
+    static constexpr size_t ACTIVITY_CLASSES = 32;
+    static constexpr uint16_t EPHEMERAL_FIRST = 49152;
+    static constexpr size_t EPHEMERAL_PORTS = 65536 - EPHEMERAL_FIRST;
+
+    std::vector<ServiceSpec> services_;
+
+    // Clients, grouped by activity class
+    std::vector<uint32_t> client_addresses_;
+    std::vector<uint16_t> client_port_cursors_;  // Initial cursors
+    std::vector<uint16_t> client_services_;     // Bitmask over services_
+    std::vector<size_t> class_begin_;           // ACTIVITY_CLASSES + 1 offsets
+    std::vector<uint8_t> active_classes_;       // Non-empty classes
+    AliasTable class_selector_;
+
+    // Servers, grouped by service
+    std::vector<uint32_t> server_addresses_;
+    std::vector<size_t> service_begin_;         // services_.size() + 1 offsets
+    std::vector<ZipfSampler> server_rank_;
+};
+
+/**
+ * Pattern driven by a host population
+ *
+ * Config type "host_population". Pattern config keys (all optional):
+ * clients, servers, services_per_client, activity (distribution spec),
+ * server_skew and services ("tcp/443:40,udp/53:20"). The population is
+ * built by configure() from the generator's address pools (or on first
+ * use from the subnets when no pools are set); with a shared model seed
+ * (see set_shared_model()) every generator of the run draws from one
+ * population. reset() restores the ephemeral port cursors.
+ */
+class HostPopulationPattern : public PatternGenerator {
+public:
+    void configure(const std::map<std::string, std::string>& config) override;
+
+    FlowRecord generate(
+        uint64_t timestamp_ns,
+        const std::vector<std::string>& src_subnets,
+        const std::vector<std::string>& dst_subnets,
+        const std::vector<double>& src_weights,
+        uint32_t min_pkt_size,
+        uint32_t max_pkt_size
+    ) override;
+
+    bool reset() override;
+
+    std::string type() const override { return "host_population"; }
+
+private:
+    void build(const AddressPool& client_pool, const AddressPool& server_pool);
+
+    HostPopulationOptions options_;
+    std::shared_ptr<const HostPopulation> population_;
+    std::vector<uint16_t> port_cursors_;  // This pattern's cursor per client
+    size_t port_offset_ = 0;              // Rotation of port_cursors_ (see port_cursors())
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_HOST_POPULATION_HPP
@@ -0,0 +1,93 @@
+#ifndef FLOWGEN_IP_ADDRESS_HPP
+#define FLOWGEN_IP_ADDRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace flowgen {
+
+/**
+ * 128-bit IP address
+ *
+ * IPv4 addresses are stored IPv4-mapped (::ffff:a.b.c.d), so one type
+ * and one comparison cover both families.
+ */
+struct IpAddress {
+    uint64_t hi = 0;  // Bits 127..64
+    uint64_t lo = 0;  // Bits 63..0
+
+    static constexpr uint64_t IPV4_MAPPED = 0x0000FFFF00000000ULL;
+
+    static IpAddress from_ipv4(uint32_t ip) { return IpAddress{0, IPV4_MAPPED | ip}; }
+
+    bool is_ipv4() const { return hi == 0 && (lo & 0xFFFFFFFF00000000ULL) == IPV4_MAPPED; }
+
+    /**
+     * IPv4 address (host byte order), or the low 32 bits of an IPv6 address
+     */
+    uint32_t ipv4() const { return static_cast<uint32_t>(lo); }
+
+    bool operator==(const IpAddress& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const IpAddress& other) const { return !(*this == other); }
+    bool operator<(const IpAddress& other) const {
+        return hi != other.hi ? hi < other.hi : lo < other.lo;
+    }
+
+    /**
+     * Dotted quad for IPv4, RFC 5952 text for IPv6
+     */
+    std::string to_string() const;
+};
+
+struct IpAddressHash {
+    size_t operator()(const IpAddress& ip) const {
+        uint64_t h = ip.hi ^ (ip.lo * 0x9E3779B97F4A7C15ULL);
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+        return static_cast<size_t>(h);
+    }
+};
+
+/**
+ * Buffer size that fits any text written by format_ip()/format_ipv6()
+ */
+constexpr size_t IP_ADDRESS_STRLEN = 46;
+
+/**
+ * Write an address in RFC 5952 form ("2001:db8::1", "::ffff:192.0.2.1")
+ *
+ * Lowercase hex without leading zeros; the longest run of two or more
+ * zero groups (the first on a tie) becomes "::". Returns the end of
+ * the written text (not NUL-terminated).
+ */
+char* format_ipv6(char* out, const IpAddress& ip);
+
+/**
+ * Like format_ipv6(), but IPv4-mapped addresses are written as a dotted quad
+ */
+char* format_ip(char* out, const IpAddress& ip);
+
+/**
+ * Parse an IPv4 or IPv6 address (throws std::runtime_error)
+ */
+IpAddress parse_ip_address(const std::string& text);
+
+/**
+ * Parse an IPv6 CIDR prefix such as "2001:db8::/32" (throws std::runtime_error)
+ *
+ * Host bits of the address are cleared. A bare address is a /128.
+ */
+void parse_ipv6_prefix(const std::string& prefix, IpAddress& base, unsigned& length);
+
+/**
+ * Check whether a subnet or address string is IPv6
+ */
+inline bool is_ipv6_subnet(const std::string& subnet) {
+    return subnet.find(':') != std::string::npos;
+}
+
+} // namespace flowgen
+
+#endif // FLOWGEN_IP_ADDRESS_HPP
@@ -0,0 +1,152 @@
+#ifndef FLOWGEN_KEYSPACE_HPP
+#define FLOWGEN_KEYSPACE_HPP
+
+#include "address_pool.hpp"
+#include "flow_record.hpp"
+#include "patterns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * 5-tuple hash functions used by collectors and NICs
+ */
+enum class KeyHash {
+    NONE,
+    TOEPLITZ,   // RSS Toeplitz over IPs and ports with the common default key
+    CRC32,      // IEEE CRC-32 over the 13-byte 5-tuple
+    XXHASH32    // xxHash32 (seed 0) over the 13-byte 5-tuple
+};
+
+/**
+ * Parse "toeplitz", "crc32", "xxhash32" ("xxhash") or "none"
+ */
+KeyHash parse_key_hash(const std::string& name);
+
+/**
+ * Hash a flow's 5-tuple (fields serialized in network byte order)
+ */
+uint32_t hash_five_tuple(KeyHash hash, const FlowRecord& flow);
+
+/**
+ * Options for a precomputed key space
+ */
+struct KeySpaceOptions {
+    size_t keys = 100000;              // Exact distinct 5-tuples in the working set
+    KeyHash hash = KeyHash::NONE;      // Hash for collision targeting and bucket order
+    uint32_t buckets = 65536;          // Consumer table size (power of two)
+    double collision_fraction = 0.0;   // Share of keys forced into collision buckets
+    size_t collision_buckets = 1;      // Number of targeted buckets
+    std::string order = "random";      // random, sorted or bucket
+    double hit_rate = 0.0;             // Share of flows repeating a recent key
+    size_t reuse_distance = 1024;      // Repeats come from the last N flows
+
+    /**
+     * Parse from a pattern config map (throws std::runtime_error)
+     */
+    static KeySpaceOptions parse(const std::map<std::string, std::string>& config);
+};
+
+/**
+ * Precomputed set of distinct 5-tuples replayed in a fixed order
+ *
+ * Built once: keys are drawn from the address pools, de-duplicated
+ * exactly, and a collision_fraction of them is rejection-sampled until
+ * (hash & (buckets - 1)) lands in one of collision_buckets target
+ * buckets. The set is then ordered (shuffled, sorted by tuple, or
+ * grouped by bucket so colliding keys arrive back to back). Requests
+ * larger than the reachable tuple space (or its share in the target
+ * buckets) are rejected before searching.
+ *
+ * next() walks the key set cyclically; with probability hit_rate it
+ * instead repeats a key emitted within the last reuse_distance flows,
+ * so a consumer LRU of at least reuse_distance entries sees a hit rate
+ * of about hit_rate when keys >> reuse_distance.
+ *
+ * A built key space is read-only, so generators of one run can share
+ * it; each user keeps its own Cursor.
+ */
+class KeySpace {
+public:
+    /**
+     * Replay position of one user
+     */
+    struct Cursor {
+        size_t position = 0;
+        std::vector<uint32_t> recent;  // Ring of recently emitted key indices
+        size_t recent_count = 0;
+        size_t recent_head = 0;
+    };
+
+    /**
+     * Build the key set (throws std::runtime_error)
+     */
+    KeySpace(const KeySpaceOptions& options,
+             const AddressPool& source_pool,
+             const AddressPool& destination_pool);
+
+    /**
+     * Cursor starting at key start (modulo size()) with no recent keys
+     */
+    Cursor cursor(size_t start = 0) const;
+
+    /**
+     * Next key for cursor (5-tuple fields of flow; other fields untouched)
+     */
+    void next(Cursor& cursor, FlowRecord& flow) const;
+
+    size_t size() const { return keys_.size(); }
+    const std::vector<FlowRecord>& keys() const { return keys_; }
+
+private:
+    std::vector<FlowRecord> keys_;
+    double hit_rate_;
+    size_t reuse_distance_;
+};
+
+/**
+ * Pattern replaying a KeySpace
+ *
+ * Config type "keyspace". Pattern config keys: keys, hash, buckets,
+ * collision_fraction, collision_buckets, order, hit_rate and
+ * reuse_distance (see KeySpaceOptions). The key space is built by
+ * configure() from the generator's address pools (or on first use from
+ * the subnets when no pools are set), so an infeasible request fails
+ * FlowGenerator::initialize(). With a shared model seed (see
+ * set_shared_model()) every generator of the run replays one key set,
+ * each from its own starting key.
+ */
+class KeySpacePattern : public PatternGenerator {
+public:
+    void configure(const std::map<std::string, std::string>& config) override;
+
+    FlowRecord generate(
+        uint64_t timestamp_ns,
+        const std::vector<std::string>& src_subnets,
+        const std::vector<std::string>& dst_subnets,
+        const std::vector<double>& src_weights,
+        uint32_t min_pkt_size,
+        uint32_t max_pkt_size
+    ) override;
+
+    bool reset() override;
+
+    std::string type() const override { return "keyspace"; }
+
+private:
+    void build(const AddressPool& source_pool, const AddressPool& destination_pool);
+
+    KeySpaceOptions options_;
+    std::shared_ptr<const KeySpace> keyspace_;
+    KeySpace::Cursor cursor_;
+    size_t start_ = 0;  // First key of cursor_
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_KEYSPACE_HPP
@@ -0,0 +1,73 @@
+#ifndef FLOWGEN_PACING_HPP
+#define FLOWGEN_PACING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Token bucket over enriched flow bytes
+ *
+ * Tokens refill at the link rate. A flow's first packet is charged
+ * when it starts, and its remaining bytes are charged evenly over its
+ * duration. admit() returns the earliest time the bucket is back to
+ * zero, which is when the next flow may start. Over a long run, the
+ * bytes generated therefore match the link rate. Single-packet flows
+ * fall back to the old one-packet-per-flow spacing.
+ *
+ * In-flight flows are kept in a min-heap ordered by end time, so
+ * admit() costs O(log n) in the number of overlapping flows.
+ */
+class BytePacer {
+public:
+    /**
+     * @param burst_bytes Bucket depth (credit kept while the link is underused)
+     */
+    explicit BytePacer(uint64_t burst_bytes = 1500);
+
+    /**
+     * Charge a flow and return the earliest start of the next flow
+     *
+     * @param start_ns Flow start (earlier than the last call counts as now)
+     * @param first_bytes Bytes of the first packet (charged immediately)
+     * @param bytes Total flow bytes
+     * @param duration_ns Flow duration (0 = charge everything at start)
+     * @param bytes_per_ns Link rate
+     */
+    uint64_t admit(uint64_t start_ns, uint64_t first_bytes, uint64_t bytes,
+                   uint64_t duration_ns, double bytes_per_ns);
+
+    /**
+     * Drop all in-flight charges and credit
+     */
+    void clear();
+
+    size_t in_flight() const { return heap_.size(); }
+
+    /**
+     * Charged bytes still to be spread over in-flight flows (O(n))
+     */
+    double pending_bytes() const;
+
+private:
+    struct Charge {
+        uint64_t end_ns;
+        double bytes_per_ns;
+    };
+
+    std::vector<Charge> heap_;   // Min-heap on end_ns
+    double burst_bytes_;
+    double balance_;             // Tokens at now_ns_ (negative = debt)
+    double spread_rate_;         // Sum of in-flight charge rates
+    uint64_t now_ns_;
+
+    void advance(uint64_t to_ns, double bytes_per_ns);
+    void pop();
+    static bool later_end(const Charge& a, const Charge& b);
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_PACING_HPP
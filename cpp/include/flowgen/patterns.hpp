@@ -1,13 +1,47 @@
 #ifndef FLOWGEN_PATTERNS_HPP
 #define FLOWGEN_PATTERNS_HPP
 
+#include "address_pool.hpp"
+#include "communication_graph.hpp"
+#include "distributions.hpp"
 #include "flow_record.hpp"
+#include "flow_stats.hpp"
+#include "schema.hpp"
+#include "session_table.hpp"
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
 
 namespace flowgen {
 
+/**
+ * Per-pattern distribution overrides
+ *
+ * Parsed from a pattern's config map, where each recognised key holds
+ * a distribution spec (see parse_distribution()):
+ *   packet_size  - average packet length in bytes (clamped to the
+ *                  configured min/max packet size)
+ *   packet_count - packets per flow
+ *   duration_ms  - flow duration in milliseconds
+ * Unset entries keep the pattern's built-in model. Other keys are
+ * ignored so pattern configs can carry unrelated settings.
+ */
+struct PatternDistributions {
+    InverseCdfTable packet_size;
+    InverseCdfTable packet_count;
+    InverseCdfTable duration_ms;
+
+    bool empty() const {
+        return packet_size.empty() && packet_count.empty() && duration_ms.empty();
+    }
+
+    /**
+     * Parse overrides from a config map (throws std::runtime_error)
+     */
+    static PatternDistributions parse(const std::map<std::string, std::string>& config);
+};
+
 /**
  * Base class for traffic pattern generators
  */
@@ -15,6 +49,55 @@ class PatternGenerator {
 public:
     virtual ~PatternGenerator() = default;
 
+    /**
+     * Apply pattern-specific configuration (throws std::runtime_error)
+     */
+    virtual void configure(const std::map<std::string, std::string>& config);
+
+    /**
+     * Distribution overrides applied by the generator
+     */
+    const PatternDistributions& distributions() const { return distributions_; }
+
+    /**
+     * Sources for the optional schema fields
+     */
+    const FieldDistributions& fields() const { return fields_; }
+
+    /**
+     * Active session table, or null when session reuse is disabled
+     */
+    SessionTable* sessions() { return sessions_.get(); }
+
+    /**
+     * Use pre-built address pools instead of parsing subnets per flow
+     *
+     * Pools are owned by the caller and must outlive the pattern.
+     */
+    void set_address_pools(const AddressPool* source, const AddressPool* destination) {
+        source_pool_ = source;
+        destination_pool_ = destination;
+    }
+
+    /**
+     * Draw endpoints from a communication graph (null to disable)
+     *
+     * The graph is owned by the caller and must outlive the pattern.
+     */
+    void set_communication_graph(const CommunicationGraph* graph) { graph_ = graph; }
+
+    /**
+     * Share large read-only state (host populations) across generators
+     *
+     * Patterns given the same nonzero seed and scope build that state
+     * once, from the seed (see utils::shared_seeded); seed 0 keeps it
+     * private and drawn from the generator's own stream.
+     */
+    void set_shared_model(uint64_t seed, const std::string& scope) {
+        model_seed_ = seed;
+        model_scope_ = scope;
+    }
+
     /**
      * Generate a single flow record
      */
@@ -27,10 +110,74 @@ public:
         uint32_t max_pkt_size
     ) = 0;
 
+    /**
+     * Fill statistics for the flow just returned by generate()
+     *
+     * Patterns with their own packet/duration model override this.
+     * Returns false to fall back to generate_flow_stats().
+     */
+    virtual bool generate_stats(const FlowRecord& /*flow*/, FlowStats& /*stats*/) {
+        return false;
+    }
+
+    /**
+     * Fill statistics for a flow that continues an active session
+     *
+     * The flow was copied from the session table, not returned by the
+     * latest generate(), so state kept for that call does not apply.
+     * Returns false to fall back to generate_flow_stats().
+     */
+    virtual bool session_stats(const FlowRecord& /*flow*/, FlowStats& /*stats*/) {
+        return false;
+    }
+
+    /**
+     * Rewind per-run state (sessions, cursors, buffers) for FlowGenerator::reset()
+     *
+     * Patterns with state of their own override this and call the base,
+     * which drops the session table. Returns false when the pattern
+     * cannot rewind, so a seeded generator would not replay its flows.
+     */
+    virtual bool reset() {
+        if (sessions_) {
+            sessions_->clear();
+        }
+        return true;
+    }
+
+    /**
+     * Cumulative TCP flags for a flow when none are configured
+     *
+     * Default: a complete connection (FIN|SYN|PSH|ACK) for TCP, 0 otherwise.
+     */
+    virtual uint8_t tcp_flags(const FlowRecord& flow) const {
+        return flow.protocol == 6 ? TCP_FLAGS_COMPLETE : 0;  // TCP
+    }
+
     /**
      * Get pattern type name
      */
     virtual std::string type() const = 0;
+
+protected:
+    static constexpr uint8_t TCP_FLAGS_COMPLETE = 0x1B;  // FIN|SYN|PSH|ACK
+
+    PatternDistributions distributions_;
+    FieldDistributions fields_;
+    std::unique_ptr<SessionTable> sessions_;
+    const AddressPool* source_pool_ = nullptr;
+    const AddressPool* destination_pool_ = nullptr;
+    const CommunicationGraph* graph_ = nullptr;
+    uint64_t model_seed_ = 0;
+    std::string model_scope_;
+
+    /**
+     * Pick flow endpoints: graph edge if set, else pools, else the subnets
+     */
+    void select_endpoints(const std::vector<std::string>& src_subnets,
+                          const std::vector<std::string>& dst_subnets,
+                          const std::vector<double>& src_weights,
+                          uint32_t& src_ip, uint32_t& dst_ip) const;
 };
 
 /**
@@ -154,6 +301,9 @@ public:
 
 /**
  * Factory function to create pattern generators
+ *
+ * "profile:<path>" replays a learned TrafficProfile (see profile.hpp).
+ * Other names are looked up in the PluginRegistry (see plugins.hpp).
  */
 std::unique_ptr<PatternGenerator> create_pattern_generator(const std::string& pattern_type);
 
@@ -0,0 +1,277 @@
+#ifndef FLOWGEN_PIPELINE_HPP
+#define FLOWGEN_PIPELINE_HPP
+
+#include "fanout.hpp"
+#include "flow_stats.hpp"
+#include "generator.hpp"
+#include "schema.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Producer of flow batches at the head of a Pipeline
+ */
+class FlowSource {
+public:
+    virtual ~FlowSource() = default;
+
+    /**
+     * Prepare to produce batches carrying at least the requested fields
+     *
+     * Called once before the first next(). Throws std::runtime_error if
+     * a requested field cannot be produced.
+     *
+     * @return Schema of every batch this source produces
+     */
+    virtual FlowSchema open(const FlowSchema& requested) = 0;
+
+    /**
+     * Fill the batch with up to max_count flows
+     *
+     * Resizes the batch (whose schema is the one open() returned) and
+     * writes one FlowStats per flow to stats[0..n).
+     *
+     * @return Flows produced, 0 once the source is exhausted
+     */
+    virtual size_t next(FlowBatch& batch, FlowStats* stats, size_t max_count) = 0;
+};
+
+/**
+ * Source generating count flows with a FlowGenerator
+ *
+ * Batches carry the requested fields, plus FlowField::IPV6 when the
+ * generator is dual-stack.
+ */
+class GeneratorSource : public FlowSource {
+public:
+    GeneratorSource(FlowGenerator& generator, uint64_t count)
+        : generator_(generator), count_(count) {}
+
+    FlowSchema open(const FlowSchema& requested) override;
+    size_t next(FlowBatch& batch, FlowStats* stats, size_t max_count) override;
+
+private:
+    FlowGenerator& generator_;
+    uint64_t count_;
+    uint64_t generated_ = 0;
+};
+
+/**
+ * Source reading a BINARY sink file (see BinaryFlowHeader)
+ *
+ * Version 1 and 2 files are accepted and batches carry the fields in
+ * the file's schema. Binary records hold no flow statistics, so each
+ * flow is reported as a single packet of packet_length bytes.
+ */
+class BinaryFileSource : public FlowSource {
+public:
+    /**
+     * Open a file and read its header (throws std::runtime_error)
+     */
+    explicit BinaryFileSource(const std::string& path);
+    ~BinaryFileSource() override;
+
+    BinaryFileSource(const BinaryFileSource&) = delete;
+    BinaryFileSource& operator=(const BinaryFileSource&) = delete;
+
+    /**
+     * Fields stored in the file
+     */
+    FlowSchema schema() const { return schema_; }
+
+    FlowSchema open(const FlowSchema& requested) override;
+    size_t next(FlowBatch& batch, FlowStats* stats, size_t max_count) override;
+
+private:
+    std::string path_;
+    FILE* fp_;
+    FlowSchema schema_;
+    uint16_t record_size_;
+    std::vector<unsigned char> buffer_;
+};
+
+/**
+ * In-place stage between a Pipeline's source and its sinks
+ *
+ * A transform may rewrite, drop or add rows of the batch it is given,
+ * keeping stats the same length as the batch. The batch is owned by
+ * the pipeline and is handed to the next stage afterwards.
+ */
+class FlowTransform {
+public:
+    virtual ~FlowTransform() = default;
+
+    /**
+     * Optional fields this transform reads
+     */
+    virtual FlowSchema schema() const { return {}; }
+
+    /**
+     * Transform one batch; stats[i] belongs to batch.flows[i]
+     */
+    virtual void apply(FlowBatch& batch, std::vector<FlowStats>& stats) = 0;
+
+    /**
+     * Emit rows still held once the source is exhausted
+     *
+     * Called with an empty batch after the last apply(), and again as
+     * long as it returns true. Stateless transforms keep the default.
+     *
+     * @return Whether there are more rows to flush
+     */
+    virtual bool flush(FlowBatch& /*batch*/, std::vector<FlowStats>& /*stats*/) { return false; }
+};
+
+/**
+ * Drops the rows that do not match a FlowFilter
+ */
+class FilterTransform : public FlowTransform {
+public:
+    explicit FilterTransform(FlowFilter filter) : filter_(std::move(filter)) {}
+
+    void apply(FlowBatch& batch, std::vector<FlowStats>& stats) override;
+
+private:
+    FlowFilter filter_;
+    std::vector<uint8_t> selected_;
+};
+
+/**
+ * Transform calling a function on each batch, e.g. for enrichment
+ */
+class FunctionTransform : public FlowTransform {
+public:
+    using Function = std::function<void(FlowBatch&, std::vector<FlowStats>&)>;
+
+    /**
+     * @param function Called with every batch
+     * @param reads Optional fields the function needs in each batch
+     */
+    explicit FunctionTransform(Function function, FlowSchema reads = {})
+        : function_(std::move(function)), reads_(reads) {}
+
+    FlowSchema schema() const override { return reads_; }
+    void apply(FlowBatch& batch, std::vector<FlowStats>& stats) override { function_(batch, stats); }
+
+private:
+    Function function_;
+    FlowSchema reads_;
+};
+
+/**
+ * Keep the rows whose selected[i] is non-zero in a batch and its stats
+ *
+ * @return Rows kept
+ */
+size_t retain_rows(FlowBatch& batch, std::vector<FlowStats>& stats,
+                   const std::vector<uint8_t>& selected);
+
+/**
+ * Key a PartitionConsumer routes flows by
+ */
+enum class PartitionKey {
+    FLOW,                // 5-tuple, direction-independent (both directions together)
+    SOURCE_IP,
+    DESTINATION_IP
+};
+
+/**
+ * Splits batches across consumers by a hash of each flow's key
+ *
+ * Flows with the same key always reach the same partition, so
+ * partitions can be aggregated or written independently. Each
+ * partition receives its rows as a dense batch, in input order.
+ */
+class PartitionConsumer : public FlowConsumer {
+public:
+    PartitionConsumer(std::vector<FlowConsumer*> partitions, PartitionKey key = PartitionKey::FLOW);
+
+    FlowSchema schema() const override;
+    void consume(const FlowBatch& batch, const FlowStats* stats) override;
+    void finish() override;
+
+    /**
+     * Partition index of row index of a batch
+     */
+    size_t partition_of(const FlowBatch& batch, size_t index) const;
+
+private:
+    std::vector<FlowConsumer*> partitions_;
+    PartitionKey key_;
+    std::vector<FlowBatch> batches_;
+    std::vector<std::vector<FlowStats>> stats_;
+};
+
+/**
+ * Options for Pipeline::run()
+ */
+struct PipelineOptions {
+    size_t batch_size = 4096;   // Flows requested from the source per batch
+    bool threaded = false;      // One thread per sink instead of inline calls
+    size_t queue_depth = 4;     // Batches in flight when threaded
+};
+
+/**
+ * Counters of a pipeline run
+ */
+struct PipelineStats {
+    uint64_t flows_in = 0;      // Flows produced by the source
+    uint64_t flows_out = 0;     // Flows handed to the sinks
+    uint64_t batches = 0;       // Batches handed to the sinks
+};
+
+/**
+ * Source -> transforms -> sinks runtime
+ *
+ * Each batch is read from the source, passed through the transforms in
+ * order, and handed by reference to every sink. Batches carry the
+ * union of the transforms' and sinks' optional fields. The source and
+ * transforms run on the calling thread. Sinks run inline in order, or
+ * with PipelineOptions::threaded each on its own thread over a ring of
+ * queue_depth batches: the slowest sink applies backpressure to the
+ * source, and every sink sees batches in source order. Empty batches
+ * are not delivered. finish() is called on every sink at the end; the
+ * first exception thrown by any stage stops the run and is rethrown.
+ *
+ * Stages are not owned and must outlive run().
+ */
+class Pipeline {
+public:
+    explicit Pipeline(FlowSource& source) : source_(source) {}
+
+    /**
+     * Append a transform after the ones already added
+     */
+    Pipeline& add_transform(FlowTransform& transform) {
+        transforms_.push_back(&transform);
+        return *this;
+    }
+
+    /**
+     * Add a sink fed with every transformed batch
+     */
+    Pipeline& add_sink(FlowConsumer& sink) {
+        sinks_.push_back(&sink);
+        return *this;
+    }
+
+    /**
+     * Run until the source is exhausted
+     */
+    PipelineStats run(const PipelineOptions& options = {});
+
+private:
+    FlowSource& source_;
+    std::vector<FlowTransform*> transforms_;
+    std::vector<FlowConsumer*> sinks_;
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_PIPELINE_HPP
@@ -0,0 +1,158 @@
+#ifndef FLOWGEN_PLUGIN_ABI_H
+#define FLOWGEN_PLUGIN_ABI_H
+
+/*
+ * Stable C ABI for traffic pattern plugins
+ *
+ * A plugin is a shared library that exports flowgen_plugin_init(). It
+ * returns a static table of pattern types; each type creates instances
+ * that fill whole batches of flow columns per call. The generator calls
+ * into the plugin once per batch, not once per flow.
+ *
+ * Rules:
+ *   - Only add fields at the end of these structs. Bump
+ *     FLOWGEN_PLUGIN_ABI_VERSION for any other change, and when
+ *     flowgen_pattern_type grows (plugins return arrays of it).
+ *     The host still loads plugins built for older versions.
+ *   - Plugins must draw randomness from the environment, so that
+ *     seeded runs stay reproducible.
+ *   - Strings and tables passed to create() are only valid during the
+ *     call. The environment stays valid until destroy().
+ *
+ * Minimal plugin:
+ *
+ *   static void* create(const flowgen_pattern_env* env, ...) { ... }
+ *   static void generate(void* self, flowgen_pattern_batch* batch) { ... }
+ *   static void destroy(void* self) { ... }
+ *   static void reset(void* self) { ... }
+ *
+ *   static const flowgen_pattern_type types[] = {
+ *       {"my_pattern", create, generate, destroy, reset},
+ *   };
+ *   static const flowgen_plugin plugin = {
+ *       FLOWGEN_PLUGIN_ABI_VERSION, "my_plugin", 1, types,
+ *   };
+ *
+ *   FLOWGEN_PLUGIN_EXPORT const flowgen_plugin* flowgen_plugin_init(uint32_t abi_version) {
+ *       return abi_version == FLOWGEN_PLUGIN_ABI_VERSION ? &plugin : NULL;
+ *   }
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLOWGEN_PLUGIN_ABI_VERSION 2u
+
+#if defined(_WIN32)
+#define FLOWGEN_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define FLOWGEN_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+/*
+ * Services the generator provides to a pattern instance
+ *
+ * All fill functions take the matching context pointer as their first
+ * argument and write n values.
+ */
+typedef struct flowgen_pattern_env {
+    uint32_t abi_version;
+
+    /* Generator RNG stream */
+    void* rng;
+    void (*random_u32)(void* rng, uint32_t* out, size_t n);
+    void (*random_unit)(void* rng, double* out, size_t n);       /* [0, 1) */
+
+    /*
+     * Endpoints from the generator's compiled tables: weighted subnets
+     * with host popularity, or the communication graph when configured
+     */
+    void* endpoints;
+    void (*sample_endpoints)(void* endpoints, uint32_t* source_ip,
+                             uint32_t* destination_ip, size_t n);
+    void (*sample_sources)(void* endpoints, uint32_t* out, size_t n);
+    void (*sample_destinations)(void* endpoints, uint32_t* out, size_t n);
+
+    /* Packet size bounds, set before each generate() call */
+    uint32_t min_packet_size;
+    uint32_t max_packet_size;
+} flowgen_pattern_env;
+
+/*
+ * One batch of flow columns
+ *
+ * The plugin fills every flow column for [0, count). Statistics
+ * columns are optional: set stats_filled to 1 after filling them, or
+ * leave it 0 to let the generator derive statistics per flow.
+ */
+typedef struct flowgen_pattern_batch {
+    size_t count;
+    uint64_t start_ns;          /* Timestamp of the first flow (hint) */
+
+    uint32_t* source_ip;        /* IPv4, host byte order */
+    uint32_t* destination_ip;
+    uint16_t* source_port;
+    uint16_t* destination_port;
+    uint8_t* protocol;
+    uint32_t* packet_length;
+
+    uint32_t* packet_count;
+    uint64_t* byte_count;
+    uint64_t* duration_ns;
+    int stats_filled;
+} flowgen_pattern_batch;
+
+/*
+ * A pattern type exported by a plugin
+ */
+typedef struct flowgen_pattern_type {
+    const char* name;   /* Traffic pattern type in configs, e.g. "iot_telemetry" */
+
+    /*
+     * Create an instance from the pattern's config map (config_count
+     * key/value pairs). Returns NULL and writes a message into error
+     * (error_size bytes) on invalid config.
+     */
+    void* (*create)(const flowgen_pattern_env* env,
+                    const char* const* keys, const char* const* values, size_t config_count,
+                    char* error, size_t error_size);
+
+    void (*generate)(void* instance, flowgen_pattern_batch* batch);
+
+    void (*destroy)(void* instance);
+
+    /*
+     * Optional (since version 2): drop per-run state such as buffered
+     * flows, so that a generator reset and reseed replays the same
+     * stream. NULL if the instance cannot rewind; FlowGenerator::reset()
+     * then reports failure.
+     */
+    void (*reset)(void* instance);
+} flowgen_pattern_type;
+
+/*
+ * Table returned by flowgen_plugin_init()
+ */
+typedef struct flowgen_plugin {
+    uint32_t abi_version;
+    const char* name;
+    size_t type_count;
+    const flowgen_pattern_type* types;
+} flowgen_plugin;
+
+/*
+ * Entry point each plugin exports. Return NULL if abi_version is not supported.
+ */
+typedef const flowgen_plugin* (*flowgen_plugin_init_fn)(uint32_t abi_version);
+
+#define FLOWGEN_PLUGIN_INIT_SYMBOL "flowgen_plugin_init"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLOWGEN_PLUGIN_ABI_H */
@@ -0,0 +1,140 @@
+#ifndef FLOWGEN_PLUGINS_HPP
+#define FLOWGEN_PLUGINS_HPP
+
+#include "patterns.hpp"
+#include "plugin_abi.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Environment variable listing plugin directories (':'-separated)
+ */
+constexpr const char* PLUGIN_PATH_ENV = "FLOWGEN_PLUGIN_PATH";
+
+/**
+ * Pattern types registered by shared-library plugins (see plugin_abi.h)
+ *
+ * Process-wide: libraries are opened once with dlopen() and stay loaded
+ * for the life of the process, since pattern instances may outlive the
+ * generator that created them. Directories in $FLOWGEN_PLUGIN_PATH are
+ * loaded on the first lookup. Built-in pattern types take precedence
+ * over plugin types of the same name.
+ */
+class PluginRegistry {
+public:
+    static PluginRegistry& instance();
+
+    /**
+     * Load one plugin library (throws std::runtime_error)
+     *
+     * Loading the same path again is a no-op. Plugins built for an
+     * older ABI version load without the hooks added since. Fails if
+     * the library lacks flowgen_plugin_init, rejects the ABI version, or registers
+     * a pattern type that is already registered by another plugin.
+     */
+    void load(const std::string& path);
+
+    /**
+     * Load every *.so (*.dylib on macOS) in a directory, in name order (throws std::runtime_error)
+     */
+    void load_directory(const std::string& directory);
+
+    /**
+     * Registered type by name (case-insensitive), or null
+     */
+    const flowgen_pattern_type* find(const std::string& type);
+
+    /**
+     * Names of all registered pattern types
+     */
+    std::vector<std::string> pattern_types();
+
+private:
+    PluginRegistry() = default;
+
+    void load_environment();
+
+    std::mutex mutex_;
+    bool environment_loaded_ = false;
+    std::vector<std::string> loaded_paths_;
+    std::map<std::string, const flowgen_pattern_type*> types_;
+    std::deque<flowgen_pattern_type> legacy_types_;  // Upgraded copies of version 1 types
+};
+
+/**
+ * Pattern generator backed by a plugin pattern type
+ *
+ * The plugin fills BATCH_SIZE flows per call into column buffers, which
+ * are then handed out one flow at a time with the generator's
+ * timestamp. Plugin instances are created in configure() from the
+ * pattern's config map; distribution overrides, optional fields and
+ * sessions in that map apply as for built-in patterns.
+ */
+class PluginPattern : public PatternGenerator {
+public:
+    static constexpr size_t BATCH_SIZE = 256;
+
+    PluginPattern(std::string name, const flowgen_pattern_type* plugin_type);
+    ~PluginPattern() override;
+
+    PluginPattern(const PluginPattern&) = delete;
+    PluginPattern& operator=(const PluginPattern&) = delete;
+
+    void configure(const std::map<std::string, std::string>& config) override;
+
+    // Drops buffered flows and calls the plugin's reset hook; false if
+    // the plugin type has none
+    bool reset() override;
+
+    FlowRecord generate(
+        uint64_t timestamp_ns,
+        const std::vector<std::string>& src_subnets,
+        const std::vector<std::string>& dst_subnets,
+        const std::vector<double>& src_weights,
+        uint32_t min_pkt_size,
+        uint32_t max_pkt_size
+    ) override;
+
+    // Buffered plugin stats belong to generated flows only; continued
+    // sessions fall back to the generator's per-service model
+    bool generate_stats(const FlowRecord& flow, FlowStats& stats) override;
+
+    std::string type() const override { return name_; }
+
+private:
+    std::string name_;
+    const flowgen_pattern_type* plugin_type_;
+    void* instance_ = nullptr;
+    flowgen_pattern_env env_;
+
+    std::vector<uint32_t> source_ip_;
+    std::vector<uint32_t> destination_ip_;
+    std::vector<uint16_t> source_port_;
+    std::vector<uint16_t> destination_port_;
+    std::vector<uint8_t> protocol_;
+    std::vector<uint32_t> packet_length_;
+    std::vector<uint32_t> packet_count_;
+    std::vector<uint64_t> byte_count_;
+    std::vector<uint64_t> duration_ns_;
+    bool stats_filled_ = false;
+    size_t position_ = 0;   // Next buffered flow
+    size_t count_ = 0;      // Buffered flows
+
+    void refill(uint64_t timestamp_ns);
+
+    static void sample_endpoints(void* self, uint32_t* source_ip, uint32_t* destination_ip, size_t n);
+    static void sample_sources(void* self, uint32_t* out, size_t n);
+    static void sample_destinations(void* self, uint32_t* out, size_t n);
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_PLUGINS_HPP
@@ -0,0 +1,185 @@
+#ifndef FLOWGEN_PROFILE_HPP
+#define FLOWGEN_PROFILE_HPP
+
+#include "alias_table.hpp"
+#include "distributions.hpp"
+#include "flow_record.hpp"
+#include "flow_stats.hpp"
+#include "patterns.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Learned model of one service, keyed by (protocol, destination port)
+ */
+struct ServiceProfile {
+    uint8_t protocol = 0;
+    uint16_t port = 0;
+    double weight = 0.0;             // Fraction of flows
+
+    InverseCdfTable source_port;
+    InverseCdfTable packet_length;   // Average packet size per flow
+    InverseCdfTable packet_count;    // Empty if the input had no packet counts
+    InverseCdfTable duration_ns;     // Empty if the input had no packet counts
+};
+
+/**
+ * Popularity of an address prefix
+ */
+struct PrefixWeight {
+    uint32_t prefix = 0;
+    double weight = 0.0;
+};
+
+/**
+ * Empirical traffic profile learned from a real flow file
+ *
+ * Stored as a small line-oriented text file (see save()).
+ */
+struct TrafficProfile {
+    uint64_t flow_count = 0;         // Flows the profile was learned from
+    uint8_t prefix_length = 24;
+    std::vector<PrefixWeight> source_prefixes;
+    std::vector<PrefixWeight> destination_prefixes;
+    std::vector<ServiceProfile> services;
+
+    /**
+     * Check whether per-flow packet counts and durations were learned
+     */
+    bool has_flow_stats() const;
+
+    /**
+     * Write profile to a file (throws std::runtime_error on failure)
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * Read profile from a file (throws std::runtime_error on failure)
+     */
+    static TrafficProfile load(const std::string& path);
+};
+
+/**
+ * Options for learning a profile
+ */
+struct ProfileLearnOptions {
+    uint8_t prefix_length = 24;      // Subnet popularity granularity
+    size_t max_prefixes = 4096;      // Most popular prefixes kept per direction
+    size_t max_services = 1024;      // Most popular services kept
+    size_t reservoir_size = 4096;    // Samples kept per service
+    size_t resolution = InverseCdfTable::DEFAULT_RESOLUTION;
+};
+
+/**
+ * Streaming profile learner
+ *
+ * Counts services and prefixes exactly and keeps a fixed-size
+ * reservoir of per-flow samples per service, so memory is bounded
+ * regardless of input size. Services and prefixes beyond the
+ * configured limits are dropped and the rest renormalized.
+ */
+class ProfileLearner {
+public:
+    explicit ProfileLearner(const ProfileLearnOptions& options = {});
+
+    /**
+     * Add one flow; stats may be null if the input has no flow statistics
+     */
+    void add(const FlowRecord& flow, const FlowStats* stats);
+
+    /**
+     * Build the profile from everything added so far
+     */
+    TrafficProfile build() const;
+
+    uint64_t flow_count() const { return flow_count_; }
+
+private:
+    struct Sample {
+        double source_port;
+        double packet_length;
+        double packet_count;
+        double duration_ns;
+    };
+
+    struct ServiceState {
+        uint64_t count = 0;
+        std::vector<Sample> reservoir;
+    };
+
+    ProfileLearnOptions options_;
+    uint32_t prefix_mask_;
+    uint64_t flow_count_;
+    bool has_stats_;
+    std::mt19937_64 rng_;
+    std::unordered_map<uint32_t, ServiceState> services_;
+    std::unordered_map<uint32_t, uint64_t> source_prefixes_;
+    std::unordered_map<uint32_t, uint64_t> destination_prefixes_;
+};
+
+/**
+ * Learn a profile from a flow file
+ *
+ * Accepts BINARY sink files (detected by magic) or CSV with a header
+ * row. CSV columns are matched by name, so both FlowRecord CSV and
+ * flowdump CSV (packet_count, byte_count, first/last_timestamp) work.
+ */
+TrafficProfile learn_profile(const std::string& path,
+                             const ProfileLearnOptions& options = {});
+
+/**
+ * Pattern replaying a learned profile
+ *
+ * Config type "profile:<path>". Services, ports, sizes and prefixes
+ * are drawn from alias tables and inverse-CDF tables; the configured
+ * subnets are ignored in favour of the learned prefix popularity.
+ */
+class ProfilePattern : public PatternGenerator {
+public:
+    explicit ProfilePattern(std::shared_ptr<const TrafficProfile> profile);
+
+    FlowRecord generate(
+        uint64_t timestamp_ns,
+        const std::vector<std::string>& src_subnets,
+        const std::vector<std::string>& dst_subnets,
+        const std::vector<double>& src_weights,
+        uint32_t min_pkt_size,
+        uint32_t max_pkt_size
+    ) override;
+
+    bool generate_stats(const FlowRecord& flow, FlowStats& stats) override;
+
+    /**
+     * Statistics from the service matching the flow's protocol and
+     * destination port
+     */
+    bool session_stats(const FlowRecord& flow, FlowStats& stats) override;
+
+    std::string type() const override { return "profile"; }
+
+private:
+    bool fill_stats(const ServiceProfile& service, const FlowRecord& flow, FlowStats& stats) const;
+
+    std::shared_ptr<const TrafficProfile> profile_;
+    AliasTable services_;
+    AliasTable source_prefixes_;
+    AliasTable destination_prefixes_;
+    uint32_t host_mask_;
+    size_t last_service_;
+    std::unordered_map<uint32_t, size_t> service_index_;  // protocol << 16 | port
+};
+
+/**
+ * Load a profile, sharing one copy per path across generators
+ */
+std::shared_ptr<const TrafficProfile> load_shared_profile(const std::string& path);
+
+} // namespace flowgen
+
+#endif // FLOWGEN_PROFILE_HPP
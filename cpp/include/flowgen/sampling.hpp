@@ -0,0 +1,97 @@
+#ifndef FLOWGEN_SAMPLING_HPP
+#define FLOWGEN_SAMPLING_HPP
+
+#include "pipeline.hpp"
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * How SamplerTransform picks 1 in N flows
+ */
+enum class FlowSamplingMode {
+    COUNT,    // Every Nth flow, deterministic
+    RANDOM,   // Each flow with probability 1/N from a seeded stream
+    HASH      // Flows whose 5-tuple hash selects them; consistent across shards
+};
+
+/**
+ * Options for SamplerTransform
+ *
+ * Parsed from comma-separated key=value terms:
+ *   flows=100       Keep 1 in 100 flows (default 1: no flow sampling)
+ *   mode=count      Flow sampling mode: count, random or hash
+ *   packets=1000    1:1000 packet sampling (default 1: none)
+ *   seed=7          Seed of random/hash selection and packet sampling
+ *   rescale=0       Report raw sampled packet/byte counts
+ */
+struct SamplingOptions {
+    FlowSamplingMode mode = FlowSamplingMode::COUNT;
+    uint32_t flow_rate = 1;     // 1:N flow sampling
+    uint32_t packet_rate = 1;   // 1:N packet sampling
+    uint64_t seed = 0;
+    bool rescale = true;        // Multiply sampled packet/byte counts by packet_rate
+
+    /**
+     * Parse a sampling spec (throws std::runtime_error)
+     */
+    static SamplingOptions parse(const std::string& spec);
+};
+
+/**
+ * Sampled-NetFlow/sFlow style sampling stage
+ *
+ * Flow sampling keeps whole flows. Count mode keeps every Nth flow of
+ * the stream (starting at seed % N), random mode draws from its own
+ * seeded generator, and hash mode keeps a flow when a seeded hash of
+ * its direction-independent 5-tuple falls in 1/N of the hash space, so
+ * both directions and every shard of a run agree on the same flows.
+ *
+ * Packet sampling then samples each kept flow's packets independently
+ * with probability 1/N (binomial, by geometric skips or a normal
+ * approximation for large counts). Flows left with no sampled packet
+ * are dropped; the others carry the sampled packet count and the
+ * matching share of bytes, multiplied by N when rescale is set.
+ *
+ * Each batch is scored into a selection bitmap in one pass and then
+ * compacted in place, so sinks after the sampler only serialize the
+ * kept flows. Output is deterministic for a given seed and input.
+ */
+class SamplerTransform : public FlowTransform {
+public:
+    explicit SamplerTransform(const SamplingOptions& options);
+
+    void apply(FlowBatch& batch, std::vector<FlowStats>& stats) override;
+
+    uint64_t flows_seen() const { return flows_seen_; }
+    uint64_t flows_kept() const { return flows_kept_; }
+
+private:
+    // splitmix64 stream
+    uint64_t next_random() {
+        state_ += 0x9E3779B97F4A7C15ULL;
+        return utils::mix64(state_);
+    }
+
+    // Uniform in (0, 1]
+    double next_uniform() { return ((next_random() >> 11) + 1) * 0x1.0p-53; }
+
+    uint32_t sample_packets(uint32_t packets);
+
+    SamplingOptions options_;
+    uint64_t state_;
+    uint64_t position_;          // Flows seen so far, for count mode
+    uint64_t hash_threshold_;    // Hash mode keeps hashes below this
+    double log_skip_;            // log(1 - 1/packet_rate)
+    uint64_t flows_seen_ = 0;
+    uint64_t flows_kept_ = 0;
+    std::vector<uint8_t> selected_;
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_SAMPLING_HPP
@@ -0,0 +1,119 @@
+#ifndef FLOWGEN_SCHEDULE_HPP
+#define FLOWGEN_SCHEDULE_HPP
+
+#include "alias_table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * One control point of a rate/mix schedule
+ */
+struct SchedulePoint {
+    double time_s = 0.0;              // Offset from the start timestamp
+    double rate = 1.0;                // Multiplier on bandwidth_gbps (> 0)
+    std::vector<double> mix;          // Pattern weights (empty = configured percentages)
+};
+
+/**
+ * Time-varying rate and traffic mix
+ *
+ * Disabled while points is empty. Before the first point, and for any
+ * point without a mix, the configured bandwidth and percentages apply.
+ */
+struct ScheduleOptions {
+    std::string interpolation = "step";  // "step" (piecewise constant) or "linear"
+    double period_s = 0.0;               // Repeat every period_s (0 = hold the last point)
+    double resolution_s = 1.0;           // Segment length for linear interpolation
+    std::vector<SchedulePoint> points;   // Sorted by time_s
+
+    bool enabled() const { return !points.empty(); }
+
+    /**
+     * Check points against the number of traffic patterns
+     */
+    bool validate(size_t pattern_count, std::string* error = nullptr) const;
+};
+
+/**
+ * Piecewise-constant segment of a compiled schedule
+ */
+struct ScheduleSegment {
+    uint64_t end_ns;             // Segment end, relative to the cycle start
+    uint64_t inter_arrival_ns;   // Flow spacing within the segment
+    double bandwidth_gbps;
+    uint32_t mix_offset;         // Start of this segment's alias table
+};
+
+/**
+ * Rate/mix schedule compiled into a segment table
+ *
+ * Linear schedules are sampled at each segment midpoint, so every
+ * segment is constant. Each segment has its own alias table over the
+ * patterns, stored in flat shared arrays. Lookups are expected to move
+ * forward in time: segment_at() is one compare per flow and steps to
+ * the next segment only at a boundary.
+ */
+class RateSchedule {
+public:
+    RateSchedule() = default;
+
+    /**
+     * Compile a schedule (throws std::runtime_error)
+     *
+     * Without points this is a single segment with the base rate and mix.
+     */
+    RateSchedule(const ScheduleOptions& options,
+                 double base_bandwidth_gbps,
+                 const std::vector<double>& base_mix,
+                 uint32_t average_packet_size);
+
+    /**
+     * Restart at the given absolute timestamp
+     */
+    void rewind(uint64_t origin_ns);
+
+    /**
+     * Segment covering the absolute timestamp now_ns (non-decreasing)
+     */
+    const ScheduleSegment& segment_at(uint64_t now_ns) {
+        if (now_ns >= segment_end_ns_) {
+            seek(now_ns);
+        }
+        return segments_[cursor_];
+    }
+
+    /**
+     * Pick a pattern index using a segment's mix
+     */
+    size_t sample_pattern(const ScheduleSegment& segment, double u) const {
+        return AliasTable::sample_from(prob_.data() + segment.mix_offset,
+                                       alias_.data() + segment.mix_offset,
+                                       pattern_count_, u);
+    }
+
+    size_t segment_count() const { return segments_.size(); }
+    const std::vector<ScheduleSegment>& segments() const { return segments_; }
+
+private:
+    std::vector<ScheduleSegment> segments_;
+    std::vector<double> prob_;
+    std::vector<uint32_t> alias_;
+    size_t pattern_count_ = 0;
+    uint64_t period_ns_ = 0;
+
+    size_t cursor_ = 0;
+    uint64_t cycle_start_ns_ = 0;
+    uint64_t segment_end_ns_ = 0;   // Absolute end of the current segment
+
+    void add_segment(uint64_t end_ns, double bandwidth_gbps, const std::vector<double>& mix,
+                     uint32_t average_packet_size);
+    void seek(uint64_t now_ns);
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_SCHEDULE_HPP
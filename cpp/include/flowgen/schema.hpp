@@ -0,0 +1,204 @@
+#ifndef FLOWGEN_SCHEMA_HPP
+#define FLOWGEN_SCHEMA_HPP
+
+#include "address_pool.hpp"
+#include "alias_table.hpp"
+#include "distributions.hpp"
+#include "flow_record.hpp"
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Optional flow record fields (NetFlow v9 / IPFIX names in brackets)
+ */
+enum class FlowField : uint8_t {
+    TCP_FLAGS,   // Cumulative TCP flags [tcpControlBits]
+    TOS,         // Type of service / DSCP byte [ipClassOfService]
+    VLAN,        // VLAN ID [vlanId]
+    INPUT_IF,    // Input interface index [ingressInterface]
+    OUTPUT_IF,   // Output interface index [egressInterface]
+    SRC_AS,      // Source AS number [bgpSourceAsNumber]
+    DST_AS,      // Destination AS number [bgpDestinationAsNumber]
+    NEXT_HOP,    // IPv4 next hop [ipNextHopIPv4Address]
+    IPV6,        // 128-bit addresses in place of src_ip/dst_ip [sourceIPv6Address, ...]
+    COUNT
+};
+
+/**
+ * Column name of a field ("tcp_flags", "tos", "vlan", "input_if",
+ * "output_if", "src_as", "dst_as", "next_hop", "ipv6")
+ */
+const char* flow_field_name(FlowField field);
+
+/**
+ * Bytes of a field's column in binary records (1, 2 or 4; IPV6 adds
+ * its 32 address bytes separately)
+ */
+size_t field_width(FlowField field);
+
+/**
+ * Set of optional fields carried alongside the base 5-tuple
+ *
+ * A bitmap indexed by FlowField. Fields are always serialized in
+ * FlowField order, so the schema alone fixes the column layout.
+ * IPV6 adds no column: it switches src_ip/dst_ip to the dual-stack
+ * address columns, so IPv6 flows are written with their real addresses.
+ */
+struct FlowSchema {
+    uint32_t fields = 0;
+
+    bool has(FlowField field) const { return (fields >> static_cast<unsigned>(field)) & 1u; }
+    bool empty() const { return fields == 0; }
+    size_t size() const;
+
+    FlowSchema& enable(FlowField field) {
+        fields |= 1u << static_cast<unsigned>(field);
+        return *this;
+    }
+
+    /**
+     * Parse a comma-separated field list, "all" or "" (throws std::runtime_error)
+     */
+    static FlowSchema parse(const std::string& spec);
+
+    /**
+     * Comma-separated field names in column order
+     */
+    std::string to_string() const;
+};
+
+/**
+ * Flow records plus the optional columns selected by a schema
+ *
+ * Optional fields are stored as separate columns and only the columns
+ * enabled in the schema are ever sized, so disabled fields cost no
+ * memory and are never generated.
+ */
+struct FlowBatch {
+    FlowSchema schema;
+    std::vector<FlowRecord> flows;
+
+    std::vector<uint8_t> tcp_flags;
+    std::vector<uint8_t> tos;
+    std::vector<uint16_t> vlan;
+    std::vector<uint32_t> input_if;
+    std::vector<uint32_t> output_if;
+    std::vector<uint32_t> src_as;
+    std::vector<uint32_t> dst_as;
+    std::vector<uint32_t> next_hop;
+    std::vector<IpAddress> source_ip6;       // IPV6 (IPv4 flows IPv4-mapped)
+    std::vector<IpAddress> destination_ip6;
+
+    FlowBatch() = default;
+    explicit FlowBatch(FlowSchema batch_schema, size_t count = 0) : schema(batch_schema) {
+        resize(count);
+    }
+
+    /**
+     * Resize the flows and every enabled column
+     */
+    void resize(size_t count);
+
+    /**
+     * Append row index of another batch with the same schema
+     */
+    void append(const FlowBatch& source, size_t index);
+
+    /**
+     * Keep the rows whose selected[i] is non-zero, in order
+     *
+     * selected must have size() entries. Compacts every enabled column
+     * in place without allocating.
+     *
+     * @return Rows kept
+     */
+    size_t retain(const uint8_t* selected);
+
+    size_t size() const { return flows.size(); }
+
+    /**
+     * Source and destination of row index (IPv4 flows IPv4-mapped)
+     */
+    IpAddress source_address(size_t index) const {
+        return schema.has(FlowField::IPV6) ? source_ip6[index]
+                                           : IpAddress::from_ipv4(flows[index].source_ip);
+    }
+    IpAddress destination_address(size_t index) const {
+        return schema.has(FlowField::IPV6) ? destination_ip6[index]
+                                           : IpAddress::from_ipv4(flows[index].destination_ip);
+    }
+};
+
+/**
+ * Direction-independent 5-tuple hash of row index (see utils::canonical_flow_hash)
+ */
+inline uint64_t canonical_flow_hash(const FlowBatch& batch, size_t index) {
+    const FlowRecord& flow = batch.flows[index];
+    return utils::canonical_flow_hash(batch.source_address(index), flow.source_port,
+                                      batch.destination_address(index), flow.destination_port,
+                                      flow.protocol);
+}
+
+/**
+ * Source of values for one optional integer field
+ *
+ * Parsed from either a distribution spec (see parse_distribution(),
+ * samples are rounded) or a weighted value list "0:80,46:15,10:5"
+ * (weights optional). Samples are clamped to the field's width.
+ */
+class FieldValues {
+public:
+    FieldValues() = default;
+
+    /**
+     * Parse a spec (throws std::runtime_error)
+     */
+    FieldValues(const std::string& spec, uint32_t max_value);
+
+    bool empty() const { return table_.empty() && values_.empty(); }
+
+    uint32_t sample() const;
+
+private:
+    InverseCdfTable table_;
+    std::vector<uint32_t> values_;
+    AliasTable selector_;
+    uint32_t max_value_ = 0;
+};
+
+/**
+ * Per-pattern sources for the optional fields
+ *
+ * Parsed from a pattern's config map, one key per field (see
+ * FieldValues for the value syntax):
+ *   tcp_flags, tos, vlan, input_if, output_if, src_as, dst_as
+ *   next_hop - comma-separated CIDR list next hops are drawn from
+ *
+ * Unset fields are 0, except tcp_flags which the pattern derives from
+ * the flow (see PatternGenerator::tcp_flags()).
+ */
+struct FieldDistributions {
+    FieldValues tcp_flags;
+    FieldValues tos;
+    FieldValues vlan;
+    FieldValues input_if;
+    FieldValues output_if;
+    FieldValues src_as;
+    FieldValues dst_as;
+    AddressPool next_hop;
+
+    /**
+     * Parse from a config map (throws std::runtime_error)
+     */
+    static FieldDistributions parse(const std::map<std::string, std::string>& config);
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_SCHEMA_HPP
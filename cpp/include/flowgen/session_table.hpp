@@ -0,0 +1,115 @@
+#ifndef FLOWGEN_SESSION_TABLE_HPP
+#define FLOWGEN_SESSION_TABLE_HPP
+
+#include "distributions.hpp"
+#include "flow_record.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace flowgen {
+
+/**
+ * Session reuse settings for a pattern
+ *
+ * Parsed from pattern config keys:
+ *   session_reuse  - probability a flow continues an active session
+ *                    (0 disables sessions, the default)
+ *   session_ms     - session lifetime distribution spec in milliseconds
+ *   max_sessions   - active session table capacity
+ */
+struct SessionOptions {
+    double reuse = 0.0;
+    std::string lifetime_ms = "lognormal(9.2, 1.5, 3600000)";  // Median ~10 s
+    size_t max_sessions = 65536;
+
+    bool enabled() const { return reuse > 0.0; }
+
+    /**
+     * Parse from a pattern config map (throws std::runtime_error)
+     */
+    static SessionOptions parse(const std::map<std::string, std::string>& config);
+};
+
+/**
+ * Bounded table of active sessions with timing-wheel expiry
+ *
+ * A flow either continues a random active session (same 5-tuple and
+ * packet length, later timestamp) or opens a new one. Sessions live in
+ * a slab indexed by a dense active list, so picking one is O(1); expiry
+ * is driven by a single-level timing wheel with per-entry rounds, so
+ * advancing time costs O(expired + slots passed). Sessions expire when
+ * the wheel reaches their 1 ms tick. When the table is
+ * full, a new session replaces a random active one.
+ */
+class SessionTable {
+public:
+    explicit SessionTable(const SessionOptions& options);
+
+    /**
+     * Try to continue an active session at time now_ns
+     *
+     * Expires due sessions, then with probability reuse copies a random
+     * active session's 5-tuple and packet length into flow and stamps it
+     * with now_ns. Returns false if a new session should be generated.
+     */
+    bool continue_session(uint64_t now_ns, FlowRecord& flow);
+
+    /**
+     * Register a newly generated flow as a session starting at now_ns
+     */
+    void open(const FlowRecord& flow, uint64_t now_ns);
+
+    /**
+     * Drop all sessions and zero the counters (e.g. after the generator rewinds time)
+     */
+    void clear();
+
+    size_t active() const { return active_.size(); }
+    uint64_t opened() const { return opened_; }
+    uint64_t continued() const { return continued_; }
+    uint64_t expired() const { return expired_; }
+    uint64_t evicted() const { return evicted_; }
+
+private:
+    static constexpr size_t WHEEL_SLOTS = 4096;
+    static constexpr uint64_t TICK_NS = 1000000;  // 1 ms
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    struct Session {
+        FlowRecord flow;
+        uint64_t expiry_ns;
+        uint32_t generation;
+        uint32_t position;  // Index in active_, NONE when free
+    };
+
+    struct WheelEntry {
+        uint32_t session;
+        uint32_t generation;
+    };
+
+    double reuse_;
+    size_t capacity_;
+    InverseCdfTable lifetime_ms_;
+
+    std::vector<Session> slab_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> active_;
+    std::vector<std::vector<WheelEntry>> wheel_;
+    uint64_t current_tick_;
+    bool started_;
+
+    uint64_t opened_;
+    uint64_t continued_;
+    uint64_t expired_;
+    uint64_t evicted_;
+
+    void advance(uint64_t now_ns);
+    void release(uint32_t id);
+};
+
+} // namespace flowgen
+
+#endif // FLOWGEN_SESSION_TABLE_HPP
@@ -0,0 +1,173 @@
+#ifndef FLOWGEN_SINKS_HPP
+#define FLOWGEN_SINKS_HPP
+
+#include "flow_record.hpp"
+#include "generator.hpp"
+#include "schema.hpp"
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace flowgen {
+
+/**
+ * Output sink formats
+ */
+enum class SinkFormat {
+    CSV,         // Same columns as FlowRecord::to_csv()
+    JSON,        // Single JSON array
+    JSON_LINES,  // One JSON object per line
+    BINARY,      // Fixed-size little-endian records (see BinaryFlowHeader)
+    CLICKHOUSE_ROWBINARY,  // ClickHouse RowBinary(WithNamesAndTypes)
+    CLICKHOUSE_NATIVE,     // ClickHouse Native blocks
+    POSTGRES_BINARY        // PostgreSQL COPY ... WITH (FORMAT binary)
+};
+
+/**
+ * Output sink options
+ */
+struct SinkOptions {
+    SinkFormat format = SinkFormat::CSV;
+    bool include_header = true;     // CSV header row, RowBinary names and types
+    bool pretty = false;            // Indented JSON (JSON format only)
+    bool compress = false;          // gzip output, ".gz" is appended to file names
+    uint64_t rotate_flows = 0;      // Start a new file every N flows (0 = single file)
+    size_t buffer_size = 1 << 20;   // Bytes buffered before each write
+    FlowSchema schema;              // Optional fields appended to each record
+};
+
+/**
+ * Header written at the start of BINARY sink files
+ *
+ * Followed by fixed-size records of record_size bytes, laid out as
+ * timestamp(u64) src_ip(u32) dst_ip(u32) src_port(u16) dst_port(u16)
+ * protocol(u8) pad(3) packet_length(u32) pad(4), little-endian.
+ *
+ * With a non-empty schema the header is version 2 and carries the
+ * FlowSchema bitmap as a trailing u32. Each record then continues with
+ * the enabled fields in FlowField order - tcp_flags(u8) tos(u8)
+ * vlan(u16) input_if(u32) output_if(u32) src_as(u32) dst_as(u32)
+ * next_hop(u32), then with FlowField::IPV6 the 128-bit source and
+ * destination addresses (network byte order, IPv4-mapped for IPv4
+ * flows) - zero-padded to a multiple of 8 bytes.
+ */
+struct BinaryFlowHeader {
+    static constexpr uint32_t MAGIC = 0x47574C46;  // "FLWG"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint16_t VERSION_SCHEMA = 2;
+    static constexpr uint16_t RECORD_SIZE = 32;
+
+    uint32_t magic = MAGIC;
+    uint16_t version = VERSION;
+    uint16_t record_size = RECORD_SIZE;
+    uint32_t fields = 0;  // Version 2 only
+
+    /**
+     * Header for records carrying the given optional fields
+     */
+    static BinaryFlowHeader for_schema(const FlowSchema& schema);
+};
+
+/**
+ * Base class for flow output sinks
+ *
+ * Sinks serialize flows into an internal buffer and write it out in
+ * large blocks, so no per-flow allocation or stream formatting occurs.
+ */
+class FlowSink {
+public:
+    virtual ~FlowSink() = default;
+
+    /**
+     * Write a contiguous batch of flows
+     */
+    virtual void write(const FlowRecord* flows, size_t count) = 0;
+
+    /**
+     * Write a single flow
+     */
+    void write(const FlowRecord& flow) { write(&flow, 1); }
+
+    /**
+     * Write a batch including the optional fields in schema()
+     *
+     * The batch must carry every field in schema() (throws
+     * std::runtime_error otherwise); extra fields are ignored.
+     */
+    virtual void write(const FlowBatch& batch) { write(batch.flows.data(), batch.size()); }
+
+    /**
+     * Optional fields serialized with each record
+     */
+    virtual FlowSchema schema() const { return {}; }
+
+    /**
+     * Flush buffered data and close the underlying file(s)
+     */
+    virtual void close() = 0;
+
+    /**
+     * Get number of flows written so far
+     */
+    uint64_t flows_written() const { return flows_written_; }
+
+protected:
+    uint64_t flows_written_ = 0;
+};
+
+/**
+ * Create a file sink
+ *
+ * With rotation enabled, files are named <stem>_<NNNNNN><ext>.
+ * Throws std::runtime_error if the file cannot be opened or the
+ * requested options are not supported by this build.
+ */
+std::unique_ptr<FlowSink> create_file_sink(const std::string& path,
+                                           const SinkOptions& options = {});
+
+/**
+ * Parse sink format from string ("csv", "json", "jsonl", "binary",
+ * "rowbinary", "native", "pgcopy")
+ */
+SinkFormat parse_sink_format(const std::string& format_str);
+
+/**
+ * CREATE TABLE statement matching a bulk-load sink's columns
+ *
+ * The ClickHouse and PostgreSQL formats carry typed columns: timestamp
+ * (DateTime64(9, 'UTC') / timestamptz, the latter truncated to
+ * microseconds), src_ip and dst_ip (IPv4, or IPv6 with FlowField::IPV6 /
+ * inet), ports, protocol and length, then the schema's optional fields
+ * (next_hop as an address). PostgreSQL integers are one size wider than
+ * the unsigned flow fields. Throws std::runtime_error for other formats.
+ */
+std::string sink_table_ddl(SinkFormat format, const FlowSchema& schema,
+                           const std::string& table = "flows");
+
+/**
+ * Check whether gzip compression is available in this build
+ */
+bool sink_compression_available();
+
+/**
+ * Generate flows straight into a sink
+ *
+ * Optional fields in sink.schema() are generated along with the flows.
+ * IPv6 flows from a dual-stack generator are written with their IPv6
+ * addresses; binary sinks need FlowField::IPV6 in their schema for that.
+ *
+ * @param generator Initialized generator
+ * @param sink Destination sink
+ * @param count Number of flows to generate
+ * @param batch_size Flows generated per sink write
+ * @param end_timestamp_ns Stop at the first flow starting at or after
+ *                         this, if that comes before count flows
+ * @return Number of flows written
+ */
+uint64_t export_flows(FlowGenerator& generator, FlowSink& sink,
+                      uint64_t count, size_t batch_size = 4096,
+                      uint64_t end_timestamp_ns = UINT64_MAX);
+
+} // namespace flowgen
+
+#endif // FLOWGEN_SINKS_HPP
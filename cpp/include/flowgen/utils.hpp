@@ -1,22 +1,50 @@
 #ifndef FLOWGEN_UTILS_HPP
 #define FLOWGEN_UTILS_HPP
 
+#include "ip_address.hpp"
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <random>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 
 namespace flowgen {
 namespace utils {
 
 /**
- * Random number generator singleton
+ * Random number generator
+ *
+ * instance() returns the calling thread's current generator: the one
+ * installed by the innermost live Scope, otherwise a per-thread default
+ * seeded from the clock. A FlowGenerator with GeneratorConfig::seed set
+ * installs its own stream while it runs, so its output depends only on
+ * the seed, not on other generators or thread scheduling.
  */
 class Random {
 public:
+    Random();  // Seeded from the clock
+    explicit Random(uint64_t seed_value);
+
     static Random& instance();
 
+    /**
+     * Makes a generator the calling thread's instance() until destroyed
+     */
+    class Scope {
+    public:
+        explicit Scope(Random& rng);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Random* previous_;
+    };
+
     void seed(uint64_t seed_value);
 
     int randint(int min, int max);
@@ -24,10 +52,61 @@ public:
     uint32_t rand32();
 
 private:
-    Random();
     std::mt19937_64 gen_;
 };
 
+/**
+ * splitmix64 finalizer: a fast, well-mixed 64-bit hash of x
+ */
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Hash of one endpoint (address and port)
+ */
+inline uint64_t endpoint_hash(const IpAddress& ip, uint16_t port) {
+    return mix64(ip.hi ^ mix64(ip.lo ^ port));
+}
+
+/**
+ * Direction-independent 5-tuple hash
+ *
+ * The endpoints are ordered by their hashes, so both directions of a
+ * conversation hash alike.
+ */
+inline uint64_t canonical_flow_hash(const IpAddress& source, uint16_t source_port,
+                                    const IpAddress& destination, uint16_t destination_port,
+                                    uint8_t protocol) {
+    uint64_t a = endpoint_hash(source, source_port);
+    uint64_t b = endpoint_hash(destination, destination_port);
+    return mix64(std::min(a, b) ^ mix64(std::max(a, b) + protocol));
+}
+
+/**
+ * Read-only state shared by every generator of a run
+ *
+ * Returns the live object stored under (key, seed), or calls build()
+ * with Random(seed) as the current generator and stores the result, so
+ * the object is the same whichever generator or thread asks first.
+ * Entries are held weakly and freed with their last user. Concurrent
+ * callers of one key wait for a single build.
+ */
+std::shared_ptr<const void> shared_seeded(const std::string& key, uint64_t seed,
+                                          const std::function<std::shared_ptr<const void>()>& build);
+
+template <typename T>
+std::shared_ptr<const T> shared_seeded(const std::string& key, uint64_t seed,
+                                       const std::function<std::shared_ptr<const T>()>& build) {
+    return std::static_pointer_cast<const T>(
+        shared_seeded(key, seed, std::function<std::shared_ptr<const void>()>(build)));
+}
+
 /**
  * Convert IPv4 string to uint32_t (host byte order)
  *
@@ -71,8 +150,10 @@ std::string random_ipv4(const std::string& subnet = "");
 /**
  * Generate random IPv6 address
  *
- * @param subnet CIDR subnet, empty for random
- * @return IPv6 address string
+ * For repeated draws build an Ipv6Pool once instead.
+ *
+ * @param subnet CIDR prefix (e.g., "2001:db8::/32"), empty for random
+ * @return IPv6 address string (RFC 5952)
  */
 std::string random_ipv6(const std::string& subnet = "");
 
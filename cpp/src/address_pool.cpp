@@ -0,0 +1,267 @@
+#include "flowgen/address_pool.hpp"
+#include "flowgen/distributions.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+// log1p(x) / x, stable near zero
+double helper1(double x) {
+    if (std::abs(x) > 1e-8) {
+        return std::log1p(x) / x;
+    }
+    return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+// expm1(x) / x, stable near zero
+double helper2(double x) {
+    if (std::abs(x) > 1e-8) {
+        return std::expm1(x) / x;
+    }
+    return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+// Uniform integer in [0, n) from the global generator
+uint64_t uniform_index(uint64_t n) {
+    uint64_t i = static_cast<uint64_t>(utils::Random::instance().uniform() * static_cast<double>(n));
+    return i < n ? i : n - 1;
+}
+
+} // namespace
+
+// ZipfSampler
+
+ZipfSampler::ZipfSampler(uint64_t n, double exponent, double offset)
+    : n_(n), exponent_(exponent), offset_(offset) {
+    if (n == 0) {
+        throw std::runtime_error("zipf: population must be non-empty");
+    }
+    if (exponent <= 0.0) {
+        throw std::runtime_error("zipf: exponent must be > 0");
+    }
+    if (offset < 0.0) {
+        throw std::runtime_error("zipf: offset must be >= 0");
+    }
+
+    // Ranks are 1-based internally
+    h_integral_x1_ = h_integral(1.5) - h(1.0);
+    h_integral_n_ = h_integral(static_cast<double>(n_) + 0.5);
+    s_ = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+}
+
+double ZipfSampler::h(double x) const {
+    return std::exp(-exponent_ * std::log(x + offset_));
+}
+
+double ZipfSampler::h_integral(double x) const {
+    double log_x = std::log(x + offset_);
+    return helper2((1.0 - exponent_) * log_x) * log_x;
+}
+
+double ZipfSampler::h_integral_inverse(double x) const {
+    double t = x * (1.0 - exponent_);
+    if (t < -1.0) {
+        t = -1.0;  // Guard against rounding just below the domain
+    }
+    return std::exp(helper1(t) * x) - offset_;
+}
+
+uint64_t ZipfSampler::sample() const {
+    auto& rng = utils::Random::instance();
+    double n = static_cast<double>(n_);
+
+    while (true) {
+        double u = h_integral_n_ + rng.uniform() * (h_integral_x1_ - h_integral_n_);
+        double x = h_integral_inverse(u);
+
+        double k = std::floor(x + 0.5);
+        if (k < 1.0) {
+            k = 1.0;
+        } else if (k > n) {
+            k = n;
+        }
+
+        if (k - x <= s_ || u >= h_integral(k + 0.5) - h(k)) {
+            return static_cast<uint64_t>(k) - 1;
+        }
+    }
+}
+
+// FeistelPermutation
+
+FeistelPermutation::FeistelPermutation(uint64_t n, uint64_t key)
+    : n_(n == 0 ? 1 : n), key_(key) {
+    unsigned bits = 2;
+    while (bits < 64 && (1ULL << bits) < n_) {
+        bits += 2;
+    }
+    half_bits_ = bits / 2;
+    half_mask_ = (1ULL << half_bits_) - 1;
+}
+
+uint64_t FeistelPermutation::operator()(uint64_t index) const {
+    constexpr int ROUNDS = 4;
+    uint64_t x = index;
+
+    // Cycle walk: the network permutes [0, 2^bits), retry until back in range
+    do {
+        uint64_t left = x >> half_bits_;
+        uint64_t right = x & half_mask_;
+        for (int round = 0; round < ROUNDS; ++round) {
+            uint64_t f = utils::mix64(right ^ key_ ^ (static_cast<uint64_t>(round) << 56)) &
+                         half_mask_;
+            uint64_t next = left ^ f;
+            left = right;
+            right = next;
+        }
+        x = (left << half_bits_) | right;
+    } while (x >= n_);
+
+    return x;
+}
+
+// SubnetHosts
+
+SubnetHosts::SubnetHosts(const std::string& subnet, const std::string& popularity)
+    : model_(Model::UNIFORM), hot_hosts_(0), hot_fraction_(0.0) {
+    auto [network, size] = utils::parse_subnet(subnet);
+
+    if (size <= 2) {
+        base_ = network + 1;
+        host_count_ = 1;
+    } else {
+        base_ = network + 1;
+        host_count_ = static_cast<uint64_t>(size) - 2;
+    }
+
+    DistributionSpec spec = parse_distribution_spec(popularity.empty() ? "uniform" : popularity);
+    try {
+        if (spec.name == "uniform") {
+            spec.expect_args(0, 0);
+            model_ = Model::UNIFORM;
+        } else if (spec.name == "zipf") {
+            spec.expect_args(1, 2);
+            model_ = Model::ZIPF;
+            zipf_ = ZipfSampler(host_count_, spec.args[0], spec.args.size() > 1 ? spec.args[1] : 0.0);
+        } else if (spec.name == "hotspot") {
+            spec.expect_args(2, 2);
+            if (spec.args[0] < 1.0) {
+                throw std::runtime_error("hotspot: host count must be >= 1");
+            }
+            if (spec.args[1] < 0.0 || spec.args[1] > 1.0) {
+                throw std::runtime_error("hotspot: fraction must be between 0 and 1");
+            }
+            model_ = Model::HOTSPOT;
+            hot_hosts_ = std::min(static_cast<uint64_t>(spec.args[0]), host_count_);
+            hot_fraction_ = spec.args[1];
+        } else {
+            throw std::runtime_error("Unknown host popularity '" + spec.name +
+                                     "' (valid: uniform, zipf, hotspot)");
+        }
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(subnet + ": " + e.what());
+    }
+
+    // Keyed by the subnet so every generator agrees on which hosts are hot
+    permutation_ = FeistelPermutation(host_count_,
+                                      utils::mix64(network ^ (static_cast<uint64_t>(size) << 32)));
+}
+
+uint32_t SubnetHosts::sample() const {
+    uint64_t rank;
+    switch (model_) {
+        case Model::ZIPF:
+            rank = permutation_(zipf_.sample());
+            break;
+        case Model::HOTSPOT:
+            if (hot_hosts_ >= host_count_ || utils::Random::instance().uniform() < hot_fraction_) {
+                rank = uniform_index(hot_hosts_);
+            } else {
+                rank = hot_hosts_ + uniform_index(host_count_ - hot_hosts_);
+            }
+            rank = permutation_(rank);
+            break;
+        default:
+            rank = uniform_index(host_count_);
+            break;
+    }
+    return base_ + static_cast<uint32_t>(rank);
+}
+
+// AddressPool
+
+AddressPool::AddressPool(const std::vector<std::string>& subnets,
+                         const std::vector<double>& weights,
+                         const std::vector<std::string>& popularity) {
+    if (subnets.empty()) {
+        throw std::runtime_error("Address pool requires at least one subnet");
+    }
+    if (!weights.empty() && weights.size() != subnets.size()) {
+        throw std::runtime_error("Subnet weights size must match subnets size");
+    }
+    if (popularity.size() > 1 && popularity.size() != subnets.size()) {
+        throw std::runtime_error("Host popularity must have one entry or one per subnet");
+    }
+
+    subnets_.reserve(subnets.size());
+    for (size_t i = 0; i < subnets.size(); ++i) {
+        std::string spec;
+        if (!popularity.empty()) {
+            spec = popularity.size() == 1 ? popularity[0] : popularity[i];
+        }
+        subnets_.emplace_back(subnets[i], spec);
+    }
+
+    selector_.build(weights.empty() ? std::vector<double>(subnets.size(), 1.0) : weights);
+}
+
+uint32_t AddressPool::sample() const {
+    return subnets_[sample_subnet()].sample();
+}
+
+Ipv6Pool::Ipv6Pool(const std::vector<std::string>& prefixes, const std::vector<double>& weights) {
+    if (prefixes.empty()) {
+        throw std::runtime_error("IPv6 pool requires at least one prefix");
+    }
+    if (!weights.empty() && weights.size() != prefixes.size()) {
+        throw std::runtime_error("Prefix weights size must match prefixes size");
+    }
+
+    prefixes_.reserve(prefixes.size());
+    for (const auto& text : prefixes) {
+        Prefix prefix;
+        unsigned length;
+        parse_ipv6_prefix(text, prefix.base, length);
+        prefix.host_mask.hi = length >= 64 ? 0 : (length == 0 ? ~0ULL : ~0ULL >> length);
+        prefix.host_mask.lo = length <= 64 ? ~0ULL : (length == 128 ? 0 : ~0ULL >> (length - 64));
+        prefixes_.push_back(prefix);
+        key_ = utils::mix64(key_ ^ prefix.base.hi ^ (prefix.base.lo + length));
+    }
+
+    selector_.build(weights.empty() ? std::vector<double>(prefixes.size(), 1.0) : weights);
+}
+
+IpAddress Ipv6Pool::sample() const {
+    auto& rng = utils::Random::instance();
+    const Prefix& prefix = prefixes_[prefixes_.size() == 1 ? 0 : selector_.sample()];
+    uint64_t hi_bits = (static_cast<uint64_t>(rng.rand32()) << 32) | rng.rand32();
+    uint64_t lo_bits = (static_cast<uint64_t>(rng.rand32()) << 32) | rng.rand32();
+    return host(prefix, hi_bits, lo_bits);
+}
+
+IpAddress Ipv6Pool::map(uint32_t surrogate) const {
+    uint64_t h = utils::mix64(key_ ^ surrogate);
+    size_t index = 0;
+    if (prefixes_.size() > 1) {
+        index = selector_.sample(static_cast<double>(h >> 11) * 0x1.0p-53);
+    }
+    // Low 32 bits keep the surrogate so distinct IPv4 hosts stay distinct in /96s and wider
+    uint64_t lo_bits = (utils::mix64(h) & 0xFFFFFFFF00000000ULL) | surrogate;
+    return host(prefixes_[index], utils::mix64(h ^ 0x9E3779B97F4A7C15ULL), lo_bits);
+}
+
+} // namespace flowgen
@@ -0,0 +1,672 @@
+#include "flowgen/aggregators.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+inline uint64_t metric_value(const GroupCounters& c, AggregateMetric metric) {
+    switch (metric) {
+    case AggregateMetric::PACKETS:
+        return c.packet_count;
+    case AggregateMetric::BYTES:
+        return c.byte_count;
+    case AggregateMetric::FLOWS:
+    default:
+        return c.flow_count;
+    }
+}
+
+inline uint64_t metric_weight(const FlowStats& stats, AggregateMetric metric) {
+    switch (metric) {
+    case AggregateMetric::PACKETS:
+        return stats.packet_count;
+    case AggregateMetric::BYTES:
+        return stats.byte_count;
+    case AggregateMetric::FLOWS:
+    default:
+        return 1;
+    }
+}
+
+inline uint64_t address_item(const IpAddress& ip) {
+    return utils::mix64(ip.hi ^ utils::mix64(ip.lo));
+}
+
+// Maximally skewed 1-stable variates (alpha = 1, beta = -1, scale pi/2)
+// by the Chambers-Mallows-Stuck method: with U, W independent uniform and
+// exponential, X = g(U) + ln(W) where
+//   g(u) = (pi/2 - V) tan V + ln(cos V / (pi/2 - V)),  V = pi (u - 1/2).
+// The heavy left tail of g is -1/u and is computed exactly; the bounded
+// rest of g and the light-tailed ln(W) come from tables of bucket means.
+// Tabulating the tail itself would make sums over many distinct items
+// collapse to the table mean.
+constexpr size_t STABLE_TABLE_BITS = 12;
+
+struct StableTables {
+    std::vector<double> smooth;  // Mean of g(u) + 1/u over each u bucket
+    std::vector<double> log_exp; // ln(W) quantiles, mean exactly -gamma
+};
+
+const StableTables& stable_tables() {
+    static const StableTables tables = [] {
+        const size_t n = size_t(1) << STABLE_TABLE_BITS;
+        const double half_pi = std::acos(0.0);
+        StableTables t;
+        t.smooth.resize(n);
+        t.log_exp.resize(n);
+        const int steps = 256;
+        double mean = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            double sum = 0.0;
+            for (int i = 0; i < steps; ++i) {
+                double u = (static_cast<double>(k) + (i + 0.5) / steps) / static_cast<double>(n);
+                double v = 2.0 * half_pi * (u - 0.5);
+                sum += (half_pi - v) * std::tan(v) + std::log(std::cos(v) / (half_pi - v)) + 1.0 / u;
+            }
+            t.smooth[k] = sum / steps;
+            t.log_exp[k] = std::log(-std::log(1.0 - (static_cast<double>(k) + 0.5) / static_cast<double>(n)));
+            mean += t.log_exp[k];
+        }
+        const double euler_gamma = 0.5772156649015329;
+        mean /= static_cast<double>(n);
+        for (double& value : t.log_exp) {
+            value += -euler_gamma - mean;
+        }
+        return t;
+    }();
+    return tables;
+}
+
+std::string to_lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+} // namespace
+
+// ========== FlowAggregator ==========
+
+void FlowAggregator::add_columns(const FlowColumns& columns) {
+    if (columns.count > 0 &&
+        (!columns.timestamp || !columns.source_ip || !columns.destination_ip ||
+         !columns.source_port || !columns.destination_port || !columns.protocol)) {
+        throw std::runtime_error("FlowColumns is missing a required column");
+    }
+
+    FlowRecord flow;
+    FlowStats stats;
+    for (size_t i = 0; i < columns.count; ++i) {
+        flow.timestamp = columns.timestamp[i];
+        flow.source_ip = columns.source_ip[i];
+        flow.destination_ip = columns.destination_ip[i];
+        flow.source_port = columns.source_port[i];
+        flow.destination_port = columns.destination_port[i];
+        flow.protocol = columns.protocol[i];
+        flow.packet_length = columns.packet_length ? columns.packet_length[i] : 0;
+
+        stats.packet_count = columns.packet_count ? columns.packet_count[i] : 1;
+        stats.byte_count = columns.byte_count ? columns.byte_count[i] : flow.packet_length;
+        stats.duration_ns = columns.duration_ns ? columns.duration_ns[i] : 0;
+
+        add(flow, stats);
+    }
+}
+
+// ========== PortTable ==========
+
+PortTable::PortTable(const PortTable& other) {
+    *this = other;
+}
+
+PortTable& PortTable::operator=(const PortTable& other) {
+    if (this != &other) {
+        for (size_t page = 0; page < PAGE_COUNT; ++page) {
+            if (other.pages_[page]) {
+                pages_[page] = std::make_unique<Page>(*other.pages_[page]);
+            } else {
+                pages_[page].reset();
+            }
+        }
+    }
+    return *this;
+}
+
+PortCounters& PortTable::at(uint16_t port) {
+    auto& page = pages_[port / PAGE_SIZE];
+    if (!page) {
+        page = std::make_unique<Page>();
+    }
+    return (*page)[port % PAGE_SIZE];
+}
+
+void PortTable::add(const FlowRecord& flow, const FlowStats& stats) {
+    // Source port (tx)
+    PortCounters& src = at(flow.source_port);
+    src.flow_count++;
+    src.tx_bytes += stats.byte_count;
+    src.tx_packets += stats.packet_count;
+
+    // Destination port (rx) - count the flow once if src == dst
+    PortCounters& dst = at(flow.destination_port);
+    if (flow.source_port != flow.destination_port) {
+        dst.flow_count++;
+    }
+    dst.rx_bytes += stats.byte_count;
+    dst.rx_packets += stats.packet_count;
+}
+
+void PortTable::merge(const PortTable& other) {
+    for (size_t page = 0; page < PAGE_COUNT; ++page) {
+        if (!other.pages_[page]) continue;
+        if (!pages_[page]) {
+            pages_[page] = std::make_unique<Page>(*other.pages_[page]);
+            continue;
+        }
+        Page& dst = *pages_[page];
+        const Page& src = *other.pages_[page];
+        for (size_t i = 0; i < PAGE_SIZE; ++i) {
+            dst[i].flow_count += src[i].flow_count;
+            dst[i].tx_bytes += src[i].tx_bytes;
+            dst[i].rx_bytes += src[i].rx_bytes;
+            dst[i].tx_packets += src[i].tx_packets;
+            dst[i].rx_packets += src[i].rx_packets;
+        }
+    }
+}
+
+const PortCounters* PortTable::find(uint16_t port) const {
+    const auto& page = pages_[port / PAGE_SIZE];
+    if (!page) {
+        return nullptr;
+    }
+    const PortCounters& c = (*page)[port % PAGE_SIZE];
+    return c.flow_count > 0 ? &c : nullptr;
+}
+
+size_t PortTable::size() const {
+    size_t n = 0;
+    for_each([&n](uint16_t, const PortCounters&) { n++; });
+    return n;
+}
+
+void PortTable::clear() {
+    for (auto& page : pages_) {
+        page.reset();
+    }
+}
+
+// ========== GroupBy ==========
+
+uint32_t parse_group_fields(const std::string& spec) {
+    uint32_t fields = 0;
+    std::stringstream ss(spec);
+    std::string token;
+
+    while (std::getline(ss, token, ',')) {
+        token.erase(0, token.find_first_not_of(" \t"));
+        token.erase(token.find_last_not_of(" \t") + 1);
+        std::string name = to_lower(token);
+
+        if (name.empty()) {
+            continue;
+        } else if (name == "src_ip" || name == "source_ip") {
+            fields |= GROUP_SRC_IP;
+        } else if (name == "dst_ip" || name == "destination_ip") {
+            fields |= GROUP_DST_IP;
+        } else if (name == "src_port" || name == "source_port") {
+            fields |= GROUP_SRC_PORT;
+        } else if (name == "dst_port" || name == "destination_port") {
+            fields |= GROUP_DST_PORT;
+        } else if (name == "protocol" || name == "proto") {
+            fields |= GROUP_PROTOCOL;
+        } else {
+            throw std::runtime_error("Invalid group field: " + token +
+                                     " (valid: src_ip, dst_ip, src_port, dst_port, protocol)");
+        }
+    }
+
+    if (fields == 0) {
+        throw std::runtime_error("At least one group field is required");
+    }
+    return fields;
+}
+
+GroupKey GroupKey::from_flow(const FlowRecord& flow, uint32_t fields) {
+    GroupKey key;
+    if (fields & GROUP_SRC_IP) key.source_ip = IpAddress::from_ipv4(flow.source_ip);
+    if (fields & GROUP_DST_IP) key.destination_ip = IpAddress::from_ipv4(flow.destination_ip);
+    if (fields & GROUP_SRC_PORT) key.source_port = flow.source_port;
+    if (fields & GROUP_DST_PORT) key.destination_port = flow.destination_port;
+    if (fields & GROUP_PROTOCOL) key.protocol = flow.protocol;
+    return key;
+}
+
+GroupKey GroupKey::from_flow(const DualStackFlowRecord& flow, uint32_t fields) {
+    GroupKey key;
+    if (fields & GROUP_SRC_IP) key.source_ip = flow.source_ip;
+    if (fields & GROUP_DST_IP) key.destination_ip = flow.destination_ip;
+    if (fields & GROUP_SRC_PORT) key.source_port = flow.source_port;
+    if (fields & GROUP_DST_PORT) key.destination_port = flow.destination_port;
+    if (fields & GROUP_PROTOCOL) key.protocol = flow.protocol;
+    return key;
+}
+
+AggregateMetric parse_aggregate_metric(const std::string& metric_str) {
+    std::string metric = to_lower(metric_str);
+
+    if (metric == "flows" || metric == "flow_count") {
+        return AggregateMetric::FLOWS;
+    } else if (metric == "packets" || metric == "packet_count") {
+        return AggregateMetric::PACKETS;
+    } else if (metric == "bytes" || metric == "byte_count") {
+        return AggregateMetric::BYTES;
+    } else {
+        throw std::runtime_error("Invalid metric: " + metric_str + " (valid: flows, packets, bytes)");
+    }
+}
+
+GroupBy::GroupBy(uint32_t fields)
+    : fields_(fields) {
+    if (fields_ == 0) {
+        throw std::runtime_error("GroupBy requires at least one field");
+    }
+}
+
+void GroupBy::add(const FlowRecord& flow, const FlowStats& stats) {
+    GroupCounters& c = groups_[GroupKey::from_flow(flow, fields_)];
+    c.flow_count++;
+    c.packet_count += stats.packet_count;
+    c.byte_count += stats.byte_count;
+}
+
+void GroupBy::add(const DualStackFlowRecord& flow, const FlowStats& stats) {
+    GroupCounters& c = groups_[GroupKey::from_flow(flow, fields_)];
+    c.flow_count++;
+    c.packet_count += stats.packet_count;
+    c.byte_count += stats.byte_count;
+}
+
+void GroupBy::merge(const GroupBy& other) {
+    if (other.fields_ != fields_) {
+        throw std::runtime_error("Cannot merge GroupBy aggregators with different fields");
+    }
+    for (const auto& [key, src] : other.groups_) {
+        GroupCounters& c = groups_[key];
+        c.flow_count += src.flow_count;
+        c.packet_count += src.packet_count;
+        c.byte_count += src.byte_count;
+    }
+}
+
+std::vector<std::pair<GroupKey, GroupCounters>> GroupBy::top(size_t n, AggregateMetric metric) const {
+    std::vector<std::pair<GroupKey, GroupCounters>> result(groups_.begin(), groups_.end());
+    auto cmp = [metric](const auto& a, const auto& b) {
+        return metric_value(a.second, metric) > metric_value(b.second, metric);
+    };
+
+    if (n > 0 && n < result.size()) {
+        std::partial_sort(result.begin(), result.begin() + n, result.end(), cmp);
+        result.resize(n);
+    } else {
+        std::sort(result.begin(), result.end(), cmp);
+    }
+    return result;
+}
+
+// ========== HeavyHitters ==========
+
+HeavyHitters::HeavyHitters(size_t capacity, uint32_t fields, AggregateMetric metric)
+    : capacity_(capacity), fields_(fields), metric_(metric) {
+    if (capacity_ == 0) {
+        throw std::runtime_error("HeavyHitters capacity must be greater than 0");
+    }
+    if (fields_ == 0) {
+        throw std::runtime_error("HeavyHitters requires at least one key field");
+    }
+    heap_.reserve(capacity_);
+    index_.reserve(capacity_);
+}
+
+void HeavyHitters::add(const FlowRecord& flow, const FlowStats& stats) {
+    update(GroupKey::from_flow(flow, fields_), metric_weight(stats, metric_));
+}
+
+void HeavyHitters::add(const DualStackFlowRecord& flow, const FlowStats& stats) {
+    update(GroupKey::from_flow(flow, fields_), metric_weight(stats, metric_));
+}
+
+void HeavyHitters::swap_entries(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    index_[heap_[a].key] = a;
+    index_[heap_[b].key] = b;
+}
+
+void HeavyHitters::sift_down(size_t pos) {
+    size_t size = heap_.size();
+    while (true) {
+        size_t smallest = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < size && heap_[left].count < heap_[smallest].count) smallest = left;
+        if (right < size && heap_[right].count < heap_[smallest].count) smallest = right;
+        if (smallest == pos) break;
+        swap_entries(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void HeavyHitters::update(const GroupKey& key, uint64_t weight) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // Counts only grow, so the entry can only move down the min-heap
+        heap_[it->second].count += weight;
+        sift_down(it->second);
+        return;
+    }
+
+    if (heap_.size() < capacity_) {
+        // Append and sift up
+        size_t pos = heap_.size();
+        heap_.push_back({key, weight, 0});
+        index_[key] = pos;
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (heap_[parent].count <= heap_[pos].count) break;
+            swap_entries(pos, parent);
+            pos = parent;
+        }
+        return;
+    }
+
+    // Replace the minimum entry, inheriting its count as error
+    Entry& min = heap_[0];
+    index_.erase(min.key);
+    min.error = min.count;
+    min.count += weight;
+    min.key = key;
+    index_[key] = 0;
+    sift_down(0);
+}
+
+void HeavyHitters::merge(const HeavyHitters& other) {
+    if (other.fields_ != fields_ || other.metric_ != metric_) {
+        throw std::runtime_error("Cannot merge HeavyHitters with different key fields or metric");
+    }
+    for (const Entry& e : other.heap_) {
+        update(e.key, e.count);
+        // Carry the other sketch's overestimate
+        heap_[index_[e.key]].error += e.error;
+    }
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::top(size_t n) const {
+    std::vector<Entry> result = heap_;
+    std::sort(result.begin(), result.end(),
+              [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    if (n > 0 && result.size() > n) {
+        result.resize(n);
+    }
+    return result;
+}
+
+// ========== TimeSeries ==========
+
+TimeSeries::TimeSeries(uint64_t bucket_ns)
+    : bucket_ns_(bucket_ns), first_bucket_(0) {
+    if (bucket_ns_ == 0) {
+        throw std::runtime_error("TimeSeries bucket width must be greater than 0");
+    }
+}
+
+GroupCounters& TimeSeries::bucket_for(uint64_t bucket_index) {
+    if (buckets_.empty()) {
+        first_bucket_ = bucket_index;
+        buckets_.resize(1);
+    } else if (bucket_index < first_bucket_) {
+        buckets_.insert(buckets_.begin(), first_bucket_ - bucket_index, GroupCounters{});
+        first_bucket_ = bucket_index;
+    } else if (bucket_index - first_bucket_ >= buckets_.size()) {
+        buckets_.resize(bucket_index - first_bucket_ + 1);
+    }
+    return buckets_[bucket_index - first_bucket_];
+}
+
+void TimeSeries::add(const FlowRecord& flow, const FlowStats& stats) {
+    GroupCounters& c = bucket_for(flow.timestamp / bucket_ns_);
+    c.flow_count++;
+    c.packet_count += stats.packet_count;
+    c.byte_count += stats.byte_count;
+}
+
+void TimeSeries::merge(const TimeSeries& other) {
+    if (other.bucket_ns_ != bucket_ns_) {
+        throw std::runtime_error("Cannot merge TimeSeries with different bucket widths");
+    }
+    for (size_t i = 0; i < other.buckets_.size(); ++i) {
+        const GroupCounters& src = other.buckets_[i];
+        if (src.flow_count == 0) continue;
+        GroupCounters& c = bucket_for(other.first_bucket_ + i);
+        c.flow_count += src.flow_count;
+        c.packet_count += src.packet_count;
+        c.byte_count += src.byte_count;
+    }
+}
+
+// ========== EntropySketch ==========
+
+EntropySketch::EntropySketch(size_t registers)
+    : registers_(registers, 0.0), total_(0) {
+    if (registers == 0) {
+        throw std::runtime_error("EntropySketch needs at least one register");
+    }
+}
+
+void EntropySketch::update(uint64_t item, uint64_t weight) {
+    // Each (item, register) pair hashes to its own stable variate
+    const StableTables& tables = stable_tables();
+    const double* smooth = tables.smooth.data();
+    const double* log_exp = tables.log_exp.data();
+    const uint64_t mask = (uint64_t(1) << STABLE_TABLE_BITS) - 1;
+    uint64_t h = utils::mix64(item);
+    double w = static_cast<double>(weight);
+    for (double& reg : registers_) {
+        uint64_t x = utils::mix64(h);
+        double u = (static_cast<double>(x >> 32) + 0.5) * (1.0 / 4294967296.0);
+        reg += w * (smooth[x >> (64 - STABLE_TABLE_BITS)] - 1.0 / u + log_exp[x & mask]);
+        h += 0x9E3779B97F4A7C15ULL;
+    }
+    total_ += weight;
+}
+
+void EntropySketch::merge(const EntropySketch& other) {
+    if (other.registers_.size() != registers_.size()) {
+        throw std::runtime_error("Cannot merge EntropySketch with different register counts");
+    }
+    for (size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] += other.registers_[i];
+    }
+    total_ += other.total_;
+}
+
+double EntropySketch::entropy() const {
+    if (total_ == 0) {
+        return 0.0;
+    }
+    // -ln(mean(exp(y / total))), evaluated as a log-sum-exp
+    double m = static_cast<double>(total_);
+    double peak = -INFINITY;
+    for (double reg : registers_) {
+        peak = std::max(peak, reg / m);
+    }
+    double sum = 0.0;
+    for (double reg : registers_) {
+        sum += std::exp(reg / m - peak);
+    }
+    double nats = -(peak + std::log(sum / static_cast<double>(registers_.size())));
+    return std::max(0.0, nats) / std::log(2.0);
+}
+
+// ========== EntropyTimeSeries ==========
+
+EntropyTimeSeries::EntropyTimeSeries(uint64_t window_ns, size_t registers, AggregateMetric metric)
+    : window_ns_(window_ns), registers_(registers), metric_(metric), first_window_(0),
+      pending_(3 * PENDING_SLOTS), pending_window_(0), has_pending_(false) {
+    if (window_ns_ == 0) {
+        throw std::runtime_error("EntropyTimeSeries window width must be greater than 0");
+    }
+    EntropySketch check(registers);  // Validates the register count
+}
+
+EntropyTimeSeries::Window& EntropyTimeSeries::window_for(uint64_t window_index) {
+    if (!windows_.empty() && window_index >= first_window_ &&
+        window_index - first_window_ < windows_.size()) {
+        return windows_[window_index - first_window_];
+    }
+    Window empty{0, EntropySketch(registers_), EntropySketch(registers_), EntropySketch(registers_)};
+    if (windows_.empty()) {
+        first_window_ = window_index;
+        windows_.push_back(empty);
+    } else if (window_index < first_window_) {
+        windows_.insert(windows_.begin(), first_window_ - window_index, empty);
+        first_window_ = window_index;
+    } else if (window_index - first_window_ >= windows_.size()) {
+        windows_.resize(window_index - first_window_ + 1, empty);
+    }
+    return windows_[window_index - first_window_];
+}
+
+void EntropyTimeSeries::add(const FlowRecord& flow, const FlowStats& stats) {
+    add_items(flow.timestamp, address_item(IpAddress::from_ipv4(flow.source_ip)),
+              address_item(IpAddress::from_ipv4(flow.destination_ip)),
+              flow.destination_port, stats);
+}
+
+void EntropyTimeSeries::add(const DualStackFlowRecord& flow, const FlowStats& stats) {
+    add_items(flow.timestamp, address_item(flow.source_ip), address_item(flow.destination_ip),
+              flow.destination_port, stats);
+}
+
+void EntropyTimeSeries::add_items(uint64_t timestamp, uint64_t src_item, uint64_t dst_item,
+                                  uint16_t dst_port, const FlowStats& stats) {
+    uint64_t window_index = timestamp / window_ns_;
+    window_for(window_index).flow_count++;
+    uint64_t weight = metric_weight(stats, metric_);
+    if (weight == 0) {
+        return;
+    }
+    if (has_pending_ && window_index != pending_window_) {
+        flush();
+    }
+    pending_window_ = window_index;
+    has_pending_ = true;
+
+    const uint64_t items[3] = {src_item, dst_item, dst_port};
+    for (size_t dim = 0; dim < 3; ++dim) {
+        uint64_t item = items[dim];
+        Pending& slot = pending_[dim * PENDING_SLOTS +
+                                 ((item * 0x9E3779B97F4A7C15ULL) >> 56) % PENDING_SLOTS];
+        if (slot.weight != 0 && slot.item != item) {
+            Window& w = windows_[pending_window_ - first_window_];
+            EntropySketch& sketch = dim == 0 ? w.src_ip : dim == 1 ? w.dst_ip : w.dst_port;
+            sketch.update(slot.item, slot.weight);
+            slot.weight = 0;
+        }
+        slot.item = item;
+        slot.weight += weight;
+    }
+}
+
+void EntropyTimeSeries::flush() const {
+    if (!has_pending_) {
+        return;
+    }
+    Window& w = windows_[pending_window_ - first_window_];
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        Pending& slot = pending_[i];
+        if (slot.weight == 0) {
+            continue;
+        }
+        size_t dim = i / PENDING_SLOTS;
+        EntropySketch& sketch = dim == 0 ? w.src_ip : dim == 1 ? w.dst_ip : w.dst_port;
+        sketch.update(slot.item, slot.weight);
+        slot.weight = 0;
+    }
+    has_pending_ = false;
+}
+
+const std::vector<EntropyTimeSeries::Window>& EntropyTimeSeries::windows() const {
+    flush();
+    return windows_;
+}
+
+void EntropyTimeSeries::merge(const EntropyTimeSeries& other) {
+    if (other.window_ns_ != window_ns_ || other.registers_ != registers_ ||
+        other.metric_ != metric_) {
+        throw std::runtime_error("Cannot merge EntropyTimeSeries with different windows, "
+                                 "register counts or metric");
+    }
+    flush();
+    const std::vector<Window>& source = other.windows();
+    for (size_t i = 0; i < source.size(); ++i) {
+        if (source[i].flow_count == 0) continue;
+        Window& w = window_for(other.first_window_ + i);
+        w.flow_count += source[i].flow_count;
+        w.src_ip.merge(source[i].src_ip);
+        w.dst_ip.merge(source[i].dst_ip);
+        w.dst_port.merge(source[i].dst_port);
+    }
+}
+
+// ========== Driver ==========
+
+uint64_t aggregate_flows(FlowGenerator& generator, uint64_t count,
+                         const std::vector<FlowAggregator*>& aggregators,
+                         size_t batch_size) {
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+
+    size_t capacity = static_cast<size_t>(std::min<uint64_t>(batch_size, count));
+    std::vector<FlowStats> stats(capacity);
+    uint64_t processed = 0;
+
+    if (generator.dual_stack()) {
+        std::vector<DualStackFlowRecord> batch(capacity);
+        while (processed < count) {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(capacity, count - processed));
+            generator.next_batch(batch.data(), stats.data(), n);
+
+            for (FlowAggregator* agg : aggregators) {
+                for (size_t i = 0; i < n; ++i) {
+                    agg->add(batch[i], stats[i]);
+                }
+            }
+            processed += n;
+        }
+        return processed;
+    }
+
+    std::vector<FlowRecord> batch(capacity);
+
+    while (processed < count) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(capacity, count - processed));
+        generator.next_batch(batch.data(), stats.data(), n);
+
+        for (FlowAggregator* agg : aggregators) {
+            for (size_t i = 0; i < n; ++i) {
+                agg->add(batch[i], stats[i]);
+            }
+        }
+        processed += n;
+    }
+
+    return processed;
+}
+
+} // namespace flowgen
@@ -0,0 +1,79 @@
+#include "flowgen/alias_table.hpp"
+#include "flowgen/utils.hpp"
+#include <stdexcept>
+
+namespace flowgen {
+
+AliasTable::AliasTable(const std::vector<double>& weights) {
+    build(weights);
+}
+
+void AliasTable::build(const std::vector<double>& weights) {
+    prob_.assign(weights.size(), 0.0);
+    alias_.assign(weights.size(), 0);
+    build_into(weights.data(), weights.size(), prob_.data(), alias_.data());
+}
+
+void AliasTable::build_into(const double* weights, size_t n, double* prob, uint32_t* alias) {
+    if (n == 0) {
+        throw std::runtime_error("Alias table requires at least one weight");
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (weights[i] < 0.0) {
+            throw std::runtime_error("Alias table weights must be non-negative");
+        }
+        total += weights[i];
+    }
+    if (total <= 0.0) {
+        throw std::runtime_error("Alias table weights must not all be zero");
+    }
+
+    // Vose's method: scale to mean 1 and pair small with large entries
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    small.reserve(n);
+    large.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * static_cast<double>(n) / total;
+        if (scaled[i] < 1.0) {
+            small.push_back(static_cast<uint32_t>(i));
+        } else {
+            large.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+
+        prob[s] = scaled[s];
+        alias[s] = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Remaining entries are 1 up to rounding error
+    for (uint32_t i : large) {
+        prob[i] = 1.0;
+        alias[i] = i;
+    }
+    for (uint32_t i : small) {
+        prob[i] = 1.0;
+        alias[i] = i;
+    }
+}
+
+size_t AliasTable::sample() const {
+    return sample(utils::Random::instance().uniform());
+}
+
+} // namespace flowgen
@@ -0,0 +1,276 @@
+#include "flowgen/anomalies.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+constexpr uint8_t PROTO_TCP = 6;
+constexpr uint8_t PROTO_UDP = 17;
+
+// Parse "250ms", "2s", "1500000ns" (bare numbers are seconds)
+uint64_t parse_duration_ns(const std::string& value) {
+    size_t pos = 0;
+    double number;
+    try {
+        number = std::stod(value, &pos);
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("Invalid duration '" + value + "'");
+    }
+    std::string unit = value.substr(pos);
+
+    double scale;
+    if (unit.empty() || unit == "s") scale = 1e9;
+    else if (unit == "ms") scale = 1e6;
+    else if (unit == "us") scale = 1e3;
+    else if (unit == "ns") scale = 1.0;
+    else if (unit == "m") scale = 60e9;
+    else throw std::runtime_error("Invalid duration unit in '" + value + "' (use ns, us, ms, s or m)");
+
+    if (number < 0.0) {
+        throw std::runtime_error("Duration must be non-negative: " + value);
+    }
+    return static_cast<uint64_t>(number * scale);
+}
+
+} // namespace
+
+AnomalySpec AnomalySpec::parse(const std::string& spec) {
+    std::string normalized = spec;
+    std::replace(normalized.begin(), normalized.end(), ',', ' ');
+
+    std::vector<std::string> tokens;
+    size_t start = 0;
+    while (start < normalized.size()) {
+        size_t end = normalized.find_first_of(" \t", start);
+        if (end == std::string::npos) end = normalized.size();
+        if (end > start) tokens.push_back(normalized.substr(start, end - start));
+        start = end + 1;
+    }
+    if (tokens.empty()) {
+        throw std::runtime_error("Empty overlay spec");
+    }
+
+    AnomalySpec result;
+    result.name = tokens[0];
+    std::transform(result.name.begin(), result.name.end(), result.name.begin(), ::tolower);
+
+    if (result.name == "syn_flood") {
+        result.kind = Kind::SYN_FLOOD;
+        result.port = 80;
+    } else if (result.name == "udp_amplification" || result.name == "udp_reflection") {
+        result.kind = Kind::UDP_AMPLIFICATION;
+        result.port = 53;
+        result.sources = 1000;
+    } else if (result.name == "horizontal_scan") {
+        result.kind = Kind::HORIZONTAL_SCAN;
+        result.port = 22;
+        result.sources = 1;
+    } else if (result.name == "vertical_scan") {
+        result.kind = Kind::VERTICAL_SCAN;
+        result.sources = 1;
+    } else if (result.name == "flash_crowd") {
+        result.kind = Kind::FLASH_CROWD;
+        result.port = 443;
+        result.sources = 10000;
+    } else {
+        throw std::runtime_error("Unknown overlay type '" + tokens[0] +
+                                 "' (valid: syn_flood, udp_amplification, horizontal_scan, vertical_scan, flash_crowd)");
+    }
+
+    bool has_target = false;
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        size_t eq = tokens[i].find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error("Expected key=value in overlay spec: " + tokens[i]);
+        }
+        std::string key = tokens[i].substr(0, eq);
+        std::string value = tokens[i].substr(eq + 1);
+
+        try {
+            if (key == "target") {
+                std::string address = value;
+                size_t colon = value.find(':');
+                if (colon != std::string::npos) {
+                    address = value.substr(0, colon);
+                    int port = std::stoi(value.substr(colon + 1));
+                    if (port < 1 || port > 65535) throw std::out_of_range(value);
+                    result.port = static_cast<uint16_t>(port);
+                }
+                auto [base, count] = utils::parse_subnet(address);
+                if (count > 2) {
+                    result.target_base = base + 1;
+                    result.target_count = count - 2;
+                } else {
+                    result.target_base = (address.find('/') == std::string::npos) ? base : base + 1;
+                    result.target_count = 1;
+                }
+                has_target = true;
+            } else if (key == "port") {
+                int port = std::stoi(value);
+                if (port < 1 || port > 65535) throw std::out_of_range(value);
+                result.port = static_cast<uint16_t>(port);
+            } else if (key == "rate") {
+                result.rate = std::stod(value);
+                if (result.rate <= 0.0) throw std::out_of_range(value);
+            } else if (key == "sources") {
+                result.sources = static_cast<size_t>(std::stoull(value));
+            } else if (key == "source_subnet") {
+                utils::parse_subnet(value);
+                result.source_subnet = value;
+            } else if (key == "start") {
+                result.start_ns = parse_duration_ns(value);
+            } else if (key == "duration") {
+                result.duration_ns = parse_duration_ns(value);
+            } else {
+                throw std::runtime_error("Unknown overlay key '" + key + "'");
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Invalid value for " + key + " in overlay spec: " + value);
+        }
+    }
+
+    if (!has_target) {
+        throw std::runtime_error("Overlay '" + result.name + "' needs target=<ip|ip:port|cidr>");
+    }
+    return result;
+}
+
+AnomalyPattern::AnomalyPattern(const AnomalySpec& spec)
+    : spec_(spec), cursor_(0) {
+    if (!spec_.source_subnet.empty()) {
+        spec_source_pool_ = AddressPool({spec_.source_subnet});
+    }
+
+    sources_.reserve(spec_.sources);
+    for (size_t i = 0; i < spec_.sources; ++i) {
+        sources_.push_back(spec_source_pool_.empty() ? utils::random_ipv4_uint32()
+                                                     : spec_source_pool_.sample());
+    }
+}
+
+bool AnomalyPattern::reset() {
+    cursor_ = 0;
+    return PatternGenerator::reset();
+}
+
+uint32_t AnomalyPattern::pick_source() {
+    if (!sources_.empty()) {
+        if (sources_.size() == 1) {
+            return sources_[0];
+        }
+        return sources_[utils::Random::instance().randint(0, static_cast<int>(sources_.size() - 1))];
+    }
+    // Spoofed: fresh source every flow
+    return spec_source_pool_.empty() ? utils::random_ipv4_uint32() : spec_source_pool_.sample();
+}
+
+uint32_t AnomalyPattern::pick_target() {
+    if (spec_.target_count <= 1) {
+        return spec_.target_base;
+    }
+    return spec_.target_base +
+           static_cast<uint32_t>(utils::Random::instance().uniform() * spec_.target_count) %
+               spec_.target_count;
+}
+
+FlowRecord AnomalyPattern::generate(
+    uint64_t timestamp_ns,
+    const std::vector<std::string>& /*src_subnets*/,
+    const std::vector<std::string>& /*dst_subnets*/,
+    const std::vector<double>& /*src_weights*/,
+    uint32_t min_pkt_size,
+    uint32_t max_pkt_size) {
+
+    uint32_t src_ip = pick_source();
+    uint32_t dst_ip;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t proto = PROTO_TCP;
+    uint32_t pkt_len;
+
+    switch (spec_.kind) {
+        case AnomalySpec::Kind::SYN_FLOOD:
+            dst_ip = pick_target();
+            src_port = utils::random_port(1024, 65535);
+            dst_port = spec_.port;
+            pkt_len = min_pkt_size;
+            break;
+
+        case AnomalySpec::Kind::UDP_AMPLIFICATION:
+            // Reflectors answer the spoofed victim from the service port
+            dst_ip = pick_target();
+            src_port = spec_.port;
+            dst_port = utils::random_port(1024, 65535);
+            proto = PROTO_UDP;
+            pkt_len = max_pkt_size;
+            break;
+
+        case AnomalySpec::Kind::HORIZONTAL_SCAN:
+            // Walk the target range on one port
+            dst_ip = spec_.target_base + static_cast<uint32_t>(cursor_ % spec_.target_count);
+            ++cursor_;
+            src_port = utils::random_port(1024, 65535);
+            dst_port = spec_.port;
+            pkt_len = min_pkt_size;
+            break;
+
+        case AnomalySpec::Kind::VERTICAL_SCAN:
+            // Walk ports 1-65535 on the target, host by host
+            dst_ip = spec_.target_base + static_cast<uint32_t>((cursor_ / 65535) % spec_.target_count);
+            dst_port = static_cast<uint16_t>(1 + cursor_ % 65535);
+            ++cursor_;
+            src_port = utils::random_port(1024, 65535);
+            pkt_len = min_pkt_size;
+            break;
+
+        default:  // FLASH_CROWD
+            dst_ip = pick_target();
+            src_port = utils::random_port(49152, 65535);
+            dst_port = spec_.port;
+            pkt_len = utils::random_packet_size(std::min<uint32_t>(500, max_pkt_size), max_pkt_size);
+            break;
+    }
+
+    return FlowRecord(src_ip, dst_ip, src_port, dst_port, proto, timestamp_ns, pkt_len);
+}
+
+bool AnomalyPattern::generate_stats(const FlowRecord& flow, FlowStats& stats) {
+    auto& rng = utils::Random::instance();
+
+    switch (spec_.kind) {
+        case AnomalySpec::Kind::SYN_FLOOD:
+        case AnomalySpec::Kind::HORIZONTAL_SCAN:
+        case AnomalySpec::Kind::VERTICAL_SCAN:
+            // Unanswered SYN, occasionally one retransmission
+            stats.packet_count = rng.uniform() < 0.9 ? 1 : 2;
+            stats.byte_count = static_cast<uint64_t>(stats.packet_count) * flow.packet_length;
+            stats.duration_ns = stats.packet_count == 1 ? 0 : 1000000000ULL;
+            return true;
+
+        case AnomalySpec::Kind::UDP_AMPLIFICATION:
+            stats.packet_count = static_cast<uint32_t>(rng.randint(1, 8));
+            stats.byte_count = static_cast<uint64_t>(stats.packet_count) * flow.packet_length;
+            stats.duration_ns = static_cast<uint64_t>(rng.uniform() * 1e6) * (stats.packet_count - 1);
+            return true;
+
+        default:
+            return false;  // Flash crowds look like ordinary web flows
+    }
+}
+
+uint8_t AnomalyPattern::tcp_flags(const FlowRecord& flow) const {
+    switch (spec_.kind) {
+        case AnomalySpec::Kind::SYN_FLOOD:
+        case AnomalySpec::Kind::HORIZONTAL_SCAN:
+        case AnomalySpec::Kind::VERTICAL_SCAN:
+            return 0x02;  // SYN only
+        default:
+            return PatternGenerator::tcp_flags(flow);
+    }
+}
+
+} // namespace flowgen
@@ -0,0 +1,257 @@
+#include "flowgen/biflow.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+void append_number(std::string& out, uint64_t value) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        out.push_back(digits[--n]);
+    }
+}
+
+void append_ip(std::string& out, const IpAddress& ip) {
+    char text[IP_ADDRESS_STRLEN];
+    out.append(text, format_ip(text, ip));
+}
+
+void append_csv(std::string& out, const BiflowRecord& b) {
+    append_number(out, b.timestamp);
+    out.push_back(',');
+    append_ip(out, b.source_ip);
+    out.push_back(',');
+    append_ip(out, b.destination_ip);
+    out.push_back(',');
+    append_number(out, b.source_port);
+    out.push_back(',');
+    append_number(out, b.destination_port);
+    out.push_back(',');
+    append_number(out, b.protocol);
+    out.push_back(',');
+    append_number(out, b.forward.packet_count);
+    out.push_back(',');
+    append_number(out, b.forward.byte_count);
+    out.push_back(',');
+    append_number(out, b.forward.duration_ns);
+    out.push_back(',');
+    append_number(out, b.reverse_timestamp);
+    out.push_back(',');
+    append_number(out, b.reverse.packet_count);
+    out.push_back(',');
+    append_number(out, b.reverse.byte_count);
+    out.push_back(',');
+    append_number(out, b.reverse.duration_ns);
+    out.push_back('\n');
+}
+
+} // namespace
+
+// ========== BiflowRecord ==========
+
+std::string BiflowRecord::csv_header() {
+    return "timestamp,src_ip,dst_ip,src_port,dst_port,protocol,packets,bytes,duration_ns,"
+           "reverse_timestamp,reverse_packets,reverse_bytes,reverse_duration_ns";
+}
+
+std::string BiflowRecord::to_csv() const {
+    std::string line;
+    append_csv(line, *this);
+    line.pop_back();
+    return line;
+}
+
+// ========== BiflowStitcher ==========
+
+BiflowStitcher::BiflowStitcher(const BiflowOptions& options, Output output)
+    : options_(options),
+      output_(std::move(output)),
+      partitions_(std::max<size_t>(options.partitions, 1)),
+      partition_limit_(options.max_pending > 0
+                           ? std::max<size_t>(options.max_pending / partitions_.size(), 1)
+                           : 0) {
+    if (!output_) {
+        throw std::runtime_error("BiflowStitcher needs an output");
+    }
+}
+
+size_t BiflowStitcher::pending() const {
+    size_t count = 0;
+    for (const Partition& partition : partitions_) {
+        count += partition.table.size();
+    }
+    return count;
+}
+
+void BiflowStitcher::consume(const FlowBatch& batch, const FlowStats* stats) {
+    bool ipv6 = batch.schema.has(FlowField::IPV6);
+    size_t n = batch.size();
+    flows_in_ += n;
+
+    for (size_t i = 0; i < n; ++i) {
+        const FlowRecord& flow = batch.flows[i];
+        IpAddress source = ipv6 ? batch.source_ip6[i] : IpAddress::from_ipv4(flow.source_ip);
+        IpAddress destination = ipv6 ? batch.destination_ip6[i]
+                                     : IpAddress::from_ipv4(flow.destination_ip);
+        latest_ = std::max(latest_, flow.timestamp);
+
+        // Canonical key: lower endpoint first, so both directions agree
+        bool source_low = source < destination ||
+                          (source == destination && flow.source_port <= flow.destination_port);
+        Key key;
+        key.low_ip = source_low ? source : destination;
+        key.high_ip = source_low ? destination : source;
+        key.low_port = source_low ? flow.source_port : flow.destination_port;
+        key.high_port = source_low ? flow.destination_port : flow.source_port;
+        key.protocol = flow.protocol;
+        key.hash = utils::canonical_flow_hash(key.low_ip, key.low_port, key.high_ip, key.high_port,
+                                              key.protocol);
+
+        Partition& partition = partitions_[(key.hash >> 32) % partitions_.size()];
+        auto it = partition.table.find(key);
+        if (it != partition.table.end()) {
+            BiflowRecord& record = it->second.record;
+            bool reverse = record.source_ip == destination && record.source_port == flow.destination_port &&
+                           record.destination_ip == source && record.destination_port == flow.source_port;
+            uint64_t gap = flow.timestamp > record.timestamp ? flow.timestamp - record.timestamp
+                                                             : record.timestamp - flow.timestamp;
+            if (reverse && gap <= options_.tolerance_ns) {
+                BiflowRecord biflow = record;
+                biflow.matched = true;
+                if (flow.timestamp < record.timestamp) {
+                    // The reverse flow started first, so it is the initiator
+                    biflow.reverse_timestamp = record.timestamp;
+                    biflow.reverse = record.forward;
+                    biflow.timestamp = flow.timestamp;
+                    biflow.source_ip = source;
+                    biflow.destination_ip = destination;
+                    biflow.source_port = flow.source_port;
+                    biflow.destination_port = flow.destination_port;
+                    biflow.forward = stats[i];
+                } else {
+                    biflow.reverse_timestamp = flow.timestamp;
+                    biflow.reverse = stats[i];
+                }
+                completed_.push_back(biflow);
+                ++matched_;
+                partition.table.erase(it);
+                continue;
+            }
+
+            // Same direction again, or too far apart: the pending flow is done
+            emit_unmatched(record);
+            partition.table.erase(it);
+        }
+
+        Pending entry;
+        entry.record.timestamp = flow.timestamp;
+        entry.record.source_ip = source;
+        entry.record.destination_ip = destination;
+        entry.record.source_port = flow.source_port;
+        entry.record.destination_port = flow.destination_port;
+        entry.record.protocol = flow.protocol;
+        entry.record.forward = stats[i];
+        entry.sequence = ++sequence_;
+        partition.table.emplace(key, entry);
+        partition.expiry.push_back({flow.timestamp, entry.sequence, key});
+    }
+
+    uint64_t watermark = latest_ > options_.tolerance_ns ? latest_ - options_.tolerance_ns : 0;
+    for (Partition& partition : partitions_) {
+        expire(partition, watermark, partition_limit_);
+    }
+    flush_output();
+}
+
+void BiflowStitcher::finish() {
+    for (Partition& partition : partitions_) {
+        expire(partition, UINT64_MAX, 0);
+    }
+    flush_output();
+}
+
+void BiflowStitcher::emit_unmatched(const BiflowRecord& record) {
+    completed_.push_back(record);
+    ++unmatched_;
+}
+
+void BiflowStitcher::expire(Partition& partition, uint64_t watermark, size_t limit) {
+    while (!partition.expiry.empty()) {
+        const Expiry& front = partition.expiry.front();
+        bool over_limit = limit > 0 && partition.table.size() > limit;
+        if (front.timestamp >= watermark && !over_limit) {
+            break;
+        }
+        // Entries already joined or replaced are skipped
+        auto it = partition.table.find(front.key);
+        if (it != partition.table.end() && it->second.sequence == front.sequence) {
+            emit_unmatched(it->second.record);
+            partition.table.erase(it);
+        }
+        partition.expiry.pop_front();
+    }
+}
+
+void BiflowStitcher::flush_output() {
+    if (!completed_.empty()) {
+        output_(completed_.data(), completed_.size());
+        completed_.clear();
+    }
+}
+
+// ========== BiflowCsvWriter ==========
+
+BiflowCsvWriter::BiflowCsvWriter(const std::string& path)
+    : fp_(std::fopen(path.c_str(), "wb")) {
+    if (!fp_) {
+        throw std::runtime_error("Failed to open output file: " + path);
+    }
+    buffer_ = BiflowRecord::csv_header() + "\n";
+}
+
+BiflowCsvWriter::~BiflowCsvWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+    }
+}
+
+void BiflowCsvWriter::write(const BiflowRecord* biflows, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        append_csv(buffer_, biflows[i]);
+        if (buffer_.size() >= (1 << 20)) {
+            flush();
+        }
+    }
+    written_ += count;
+}
+
+void BiflowCsvWriter::close() {
+    if (!fp_) {
+        return;
+    }
+    bool ok = buffer_.empty() || std::fwrite(buffer_.data(), 1, buffer_.size(), fp_) == buffer_.size();
+    buffer_.clear();
+    ok = std::fclose(fp_) == 0 && ok;
+    fp_ = nullptr;
+    if (!ok) {
+        throw std::runtime_error("Failed to write output file");
+    }
+}
+
+void BiflowCsvWriter::flush() {
+    if (!buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), fp_) != buffer_.size()) {
+        throw std::runtime_error("Failed to write output file");
+    }
+    buffer_.clear();
+}
+
+} // namespace flowgen
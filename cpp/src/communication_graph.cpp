@@ -0,0 +1,157 @@
+#include "flowgen/communication_graph.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace flowgen {
+
+bool CommunicationGraphOptions::validate(std::string* error) const {
+    if (!enabled()) {
+        return true;
+    }
+    if (servers == 0) {
+        if (error) *error = "communication_graph.servers must be greater than 0";
+        return false;
+    }
+    if (clients > std::numeric_limits<uint32_t>::max() || servers > std::numeric_limits<uint32_t>::max()) {
+        if (error) *error = "communication_graph is too large";
+        return false;
+    }
+    if (degree_exponent <= 1.0) {
+        if (error) *error = "communication_graph.degree_exponent must be greater than 1";
+        return false;
+    }
+    if (max_degree == 0) {
+        if (error) *error = "communication_graph.max_degree must be greater than 0";
+        return false;
+    }
+    if (server_skew < 0.0) {
+        if (error) *error = "communication_graph.server_skew must be >= 0";
+        return false;
+    }
+    if (locality < 0.0 || locality > 1.0) {
+        if (error) *error = "communication_graph.locality must be between 0.0 and 1.0";
+        return false;
+    }
+    return true;
+}
+
+CommunicationGraph::CommunicationGraph(const CommunicationGraphOptions& options,
+                                       const AddressPool& client_pool,
+                                       const AddressPool& server_pool) {
+    std::string error;
+    if (!options.validate(&error)) {
+        throw std::runtime_error(error);
+    }
+    if (!options.enabled()) {
+        throw std::runtime_error("communication_graph.clients must be greater than 0");
+    }
+
+    auto& rng = utils::Random::instance();
+    auto random_index = [&rng](size_t n) {
+        size_t i = static_cast<size_t>(rng.uniform() * static_cast<double>(n));
+        return i < n ? i : n - 1;
+    };
+
+    // Servers, remembering which destination subnet each came from
+    size_t subnet_count = server_pool.subnets().size();
+    std::vector<std::vector<uint32_t>> servers_by_subnet(subnet_count);
+    server_addresses_.resize(options.servers);
+    for (size_t i = 0; i < options.servers; ++i) {
+        size_t subnet = server_pool.sample_subnet();
+        server_addresses_[i] = server_pool.subnets()[subnet].sample();
+        servers_by_subnet[subnet].push_back(static_cast<uint32_t>(i));
+    }
+
+    // Popularity: Zipf over list position (lists are in random order)
+    bool skewed = options.server_skew > 0.0;
+    ZipfSampler global_rank;
+    std::vector<ZipfSampler> subnet_rank(subnet_count);
+    if (skewed) {
+        global_rank = ZipfSampler(options.servers, options.server_skew);
+        for (size_t s = 0; s < subnet_count; ++s) {
+            if (!servers_by_subnet[s].empty()) {
+                subnet_rank[s] = ZipfSampler(servers_by_subnet[s].size(), options.server_skew);
+            }
+        }
+    }
+
+    auto pick_global = [&]() -> uint32_t {
+        return static_cast<uint32_t>(skewed ? global_rank.sample() : random_index(options.servers));
+    };
+    auto pick_in_subnet = [&](size_t subnet) -> uint32_t {
+        const auto& list = servers_by_subnet[subnet];
+        if (list.empty()) {
+            return pick_global();
+        }
+        return list[skewed ? subnet_rank[subnet].sample() : random_index(list.size())];
+    };
+
+    // Clients and their edges
+    size_t degree_cap = std::min(options.max_degree, options.servers);
+    double tail = -1.0 / (options.degree_exponent - 1.0);
+
+    client_addresses_.resize(options.clients);
+    row_offsets_.reserve(options.clients + 1);
+    row_offsets_.push_back(0);
+
+    std::vector<double> client_weights(options.clients);
+    std::vector<uint32_t> row;
+    std::vector<double> row_weights;
+
+    for (size_t c = 0; c < options.clients; ++c) {
+        size_t subnet = client_pool.sample_subnet();
+        client_addresses_[c] = client_pool.subnets()[subnet].sample();
+
+        // Discrete power-law degree: P(degree >= k) ~ k^(1 - exponent)
+        double raw = std::floor(std::pow(1.0 - rng.uniform(), tail));
+        size_t degree = static_cast<size_t>(std::min(std::max(raw, 1.0), static_cast<double>(degree_cap)));
+
+        row.clear();
+        for (size_t attempt = 0; row.size() < degree && attempt < 4 * degree; ++attempt) {
+            bool local = options.locality > 0.0 && rng.uniform() < options.locality;
+            uint32_t target = local ? pick_in_subnet(subnet % subnet_count) : pick_global();
+            if (std::find(row.begin(), row.end(), target) == row.end()) {
+                row.push_back(target);
+            }
+        }
+
+        // Conversation intensity per edge
+        row_weights.resize(row.size());
+        double total = 0.0;
+        for (double& w : row_weights) {
+            w = -std::log1p(-rng.uniform()) + 1e-9;
+            total += w;
+        }
+        client_weights[c] = total;
+
+        size_t begin = edge_targets_.size();
+        if (begin + row.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("communication_graph has too many edges");
+        }
+        edge_targets_.insert(edge_targets_.end(), row.begin(), row.end());
+        edge_prob_.resize(begin + row.size());
+        edge_alias_.resize(begin + row.size());
+        AliasTable::build_into(row_weights.data(), row.size(), &edge_prob_[begin], &edge_alias_[begin]);
+        row_offsets_.push_back(static_cast<uint32_t>(edge_targets_.size()));
+    }
+
+    client_selector_.build(client_weights);
+}
+
+void CommunicationGraph::sample(uint32_t& client_ip, uint32_t& server_ip) const {
+    auto& rng = utils::Random::instance();
+
+    size_t client = client_selector_.sample();
+    size_t begin = row_offsets_[client];
+    size_t count = row_offsets_[client + 1] - begin;
+    size_t edge = begin + AliasTable::sample_from(&edge_prob_[begin], &edge_alias_[begin], count,
+                                                  rng.uniform());
+
+    client_ip = client_addresses_[client];
+    server_ip = server_addresses_[edge_targets_[edge]];
+}
+
+} // namespace flowgen
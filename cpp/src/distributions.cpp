@@ -0,0 +1,314 @@
+#include "flowgen/distributions.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace flowgen {
+
+InverseCdfTable::InverseCdfTable(std::vector<double> points)
+    : points_(std::move(points)) {
+    if (points_.empty()) {
+        throw std::runtime_error("Inverse-CDF table requires at least one point");
+    }
+    if (!std::is_sorted(points_.begin(), points_.end())) {
+        throw std::runtime_error("Inverse-CDF table points must be sorted ascending");
+    }
+}
+
+InverseCdfTable InverseCdfTable::from_samples(std::vector<double> samples, size_t resolution) {
+    if (samples.empty()) {
+        throw std::runtime_error("Cannot build a distribution from zero samples");
+    }
+    if (resolution < 2) {
+        resolution = 2;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    std::vector<double> points(resolution);
+    double last = static_cast<double>(samples.size() - 1);
+    for (size_t i = 0; i < resolution; ++i) {
+        double pos = last * static_cast<double>(i) / static_cast<double>(resolution - 1);
+        size_t lo = static_cast<size_t>(pos);
+        size_t hi = std::min(lo + 1, samples.size() - 1);
+        points[i] = samples[lo] + (pos - static_cast<double>(lo)) * (samples[hi] - samples[lo]);
+    }
+
+    return InverseCdfTable(std::move(points));
+}
+
+double InverseCdfTable::sample() const {
+    return sample(utils::Random::instance().uniform());
+}
+
+double InverseCdfTable::sample_tail(double u) const {
+    size_t last = points_.size() - 1;
+    double value = std::min(tail_(std::min(u, TAIL_LAST_QUANTILE)), max_value_);
+    return std::max(value, points_[last - 1]);
+}
+
+double InverseCdfTable::mean() const {
+    if (points_.size() == 1) {
+        return points_[0];
+    }
+    // Trapezoid rule over the piecewise-linear quantile function
+    size_t segments = points_.size() - 1;
+    double sum = 0.0;
+    for (size_t i = 0; i < segments; ++i) {
+        sum += tail_ && i + 1 == segments ? tail_mean_ : (points_[i] + points_[i + 1]) * 0.5;
+    }
+    return sum / static_cast<double>(segments);
+}
+
+InverseCdfTable InverseCdfTable::from_quantile_function(const std::function<double(double)>& quantile,
+                                                        size_t resolution, double max_value) {
+    if (resolution < 2) {
+        resolution = 2;
+    }
+
+    constexpr double LAST_QUANTILE = 1.0 - 1e-6;
+    std::vector<double> points(resolution);
+    for (size_t i = 0; i < resolution; ++i) {
+        double u = static_cast<double>(i) / static_cast<double>(resolution - 1);
+        points[i] = std::min(quantile(std::min(u, LAST_QUANTILE)), max_value);
+    }
+
+    // Guard against rounding making the table non-monotonic
+    for (size_t i = 1; i < resolution; ++i) {
+        points[i] = std::max(points[i], points[i - 1]);
+    }
+
+    InverseCdfTable table(std::move(points));
+    table.tail_ = quantile;
+    table.max_value_ = max_value;
+
+    // Mean of the last segment: integrate q over t = 1 - u on a
+    // geometric grid from the segment width down to the smallest gap a
+    // double uniform leaves below 1
+    constexpr size_t TAIL_STEPS = 512;
+    double width = 1.0 / static_cast<double>(resolution - 1);
+    double log_hi = std::log(width);
+    double log_lo = std::log(1.0 - TAIL_LAST_QUANTILE);
+    double step = (log_hi - log_lo) / static_cast<double>(TAIL_STEPS);
+    double integral = 0.0;
+    double prev_t = std::exp(log_lo);
+    double prev_q = table.sample_tail(1.0 - prev_t);
+    integral += prev_t * prev_q;  // Draws above the grid clamp to its top value
+    for (size_t k = 1; k <= TAIL_STEPS; ++k) {
+        double t = std::exp(log_lo + step * static_cast<double>(k));
+        double q = table.sample_tail(1.0 - t);
+        integral += (t - prev_t) * (q + prev_q) * 0.5;
+        prev_t = t;
+        prev_q = q;
+    }
+    table.tail_mean_ = integral / width;
+    return table;
+}
+
+InverseCdfTable InverseCdfTable::constant(double value) {
+    return InverseCdfTable(std::vector<double>{value});
+}
+
+InverseCdfTable InverseCdfTable::uniform(double min, double max) {
+    if (max < min) {
+        throw std::runtime_error("uniform: max must be >= min");
+    }
+    return InverseCdfTable(std::vector<double>{min, max});
+}
+
+InverseCdfTable InverseCdfTable::bimodal(double min1, double max1, double min2, double max2,
+                                         double first_fraction) {
+    if (max1 < min1 || max2 < min2 || max1 > min2) {
+        throw std::runtime_error("bimodal: expected min1 <= max1 <= min2 <= max2");
+    }
+    if (first_fraction <= 0.0 || first_fraction >= 1.0) {
+        throw std::runtime_error("bimodal: first_fraction must be between 0 and 1");
+    }
+    return from_quantile_function([=](double u) {
+        if (u < first_fraction) {
+            return min1 + (u / first_fraction) * (max1 - min1);
+        }
+        return min2 + ((u - first_fraction) / (1.0 - first_fraction)) * (max2 - min2);
+    });
+}
+
+InverseCdfTable InverseCdfTable::exponential(double mean, double max_value) {
+    if (mean <= 0.0) {
+        throw std::runtime_error("exponential: mean must be > 0");
+    }
+    return from_quantile_function([=](double u) {
+        return -mean * std::log1p(-u);
+    }, PARAMETRIC_RESOLUTION, max_value);
+}
+
+InverseCdfTable InverseCdfTable::pareto(double alpha, double scale, double max_value) {
+    if (alpha <= 0.0 || scale <= 0.0) {
+        throw std::runtime_error("pareto: alpha and scale must be > 0");
+    }
+    return from_quantile_function([=](double u) {
+        return scale / std::pow(1.0 - u, 1.0 / alpha);
+    }, PARAMETRIC_RESOLUTION, max_value);
+}
+
+namespace {
+
+// Inverse standard normal CDF (Acklam's rational approximation, |err| < 1.2e-9)
+double normal_quantile(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                               -2.759285104469687e+02, 1.383577518672690e+02,
+                               -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                               -1.556989798598866e+02, 6.680131188771972e+01,
+                               -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                               -2.400758277161838e+00, -2.549732539343734e+00,
+                               4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                               2.445134137142996e+00, 3.754408661907416e+00};
+
+    constexpr double P_LOW = 0.02425;
+    if (p <= 0.0) return -1e300;
+    if (p < P_LOW) {
+        double q = std::sqrt(-2.0 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p <= 1.0 - P_LOW) {
+        double q = p - 0.5;
+        double r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+               (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+    double q = std::sqrt(-2.0 * std::log1p(-p));
+    return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+}
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+double parse_number(const std::string& token, const std::string& spec) {
+    std::string t = trim(token);
+    char* end = nullptr;
+    double value = std::strtod(t.c_str(), &end);
+    if (t.empty() || end != t.c_str() + t.size()) {
+        throw std::runtime_error("Invalid number '" + t + "' in distribution: " + spec);
+    }
+    return value;
+}
+
+} // namespace
+
+InverseCdfTable InverseCdfTable::lognormal(double mu, double sigma, double max_value) {
+    if (sigma <= 0.0) {
+        throw std::runtime_error("lognormal: sigma must be > 0");
+    }
+    return from_quantile_function([=](double u) {
+        return std::exp(mu + sigma * normal_quantile(u));
+    }, PARAMETRIC_RESOLUTION, max_value);
+}
+
+InverseCdfTable InverseCdfTable::weibull(double shape, double scale, double max_value) {
+    if (shape <= 0.0 || scale <= 0.0) {
+        throw std::runtime_error("weibull: shape and scale must be > 0");
+    }
+    return from_quantile_function([=](double u) {
+        return scale * std::pow(-std::log1p(-u), 1.0 / shape);
+    }, PARAMETRIC_RESOLUTION, max_value);
+}
+
+DistributionSpec parse_distribution_spec(const std::string& spec) {
+    DistributionSpec result;
+    std::string s = trim(spec);
+    if (s.empty()) {
+        throw std::runtime_error("Empty distribution spec");
+    }
+
+    size_t open = s.find('(');
+    if (open == std::string::npos) {
+        char* end = nullptr;
+        double value = std::strtod(s.c_str(), &end);
+        if (end == s.c_str() + s.size()) {
+            result.name = "constant";
+            result.args.push_back(value);
+        } else {
+            result.name = s;
+            std::transform(result.name.begin(), result.name.end(), result.name.begin(), ::tolower);
+        }
+        return result;
+    }
+    if (s.back() != ')') {
+        throw std::runtime_error("Missing ')' in distribution: " + spec);
+    }
+
+    result.name = trim(s.substr(0, open));
+    std::transform(result.name.begin(), result.name.end(), result.name.begin(), ::tolower);
+
+    std::string body = s.substr(open + 1, s.size() - open - 2);
+    if (!trim(body).empty()) {
+        size_t start = 0;
+        while (true) {
+            size_t comma = body.find(',', start);
+            size_t end = comma == std::string::npos ? body.size() : comma;
+            result.args.push_back(parse_number(body.substr(start, end - start), spec));
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+    }
+    return result;
+}
+
+void DistributionSpec::expect_args(size_t min_args, size_t max_args) const {
+    if (args.size() < min_args || args.size() > max_args) {
+        throw std::runtime_error("Wrong number of arguments for " + name);
+    }
+}
+
+InverseCdfTable parse_distribution(const std::string& spec) {
+    DistributionSpec parsed = parse_distribution_spec(spec);
+    const std::string& name = parsed.name;
+    std::vector<double>& args = parsed.args;
+
+    auto expect = [&](size_t min_args, size_t max_args) { parsed.expect_args(min_args, max_args); };
+    auto cap = [&](size_t index) { return args.size() > index ? args[index] : 1e300; };
+
+    if (name == "constant" || name == "fixed") {
+        expect(1, 1);
+        return InverseCdfTable::constant(args[0]);
+    } else if (name == "uniform") {
+        expect(2, 2);
+        return InverseCdfTable::uniform(args[0], args[1]);
+    } else if (name == "bimodal") {
+        expect(5, 5);
+        return InverseCdfTable::bimodal(args[0], args[1], args[2], args[3], args[4]);
+    } else if (name == "exponential") {
+        expect(1, 2);
+        return InverseCdfTable::exponential(args[0], cap(1));
+    } else if (name == "pareto") {
+        expect(2, 3);
+        return InverseCdfTable::pareto(args[0], args[1], cap(2));
+    } else if (name == "lognormal") {
+        expect(2, 3);
+        return InverseCdfTable::lognormal(args[0], args[1], cap(2));
+    } else if (name == "weibull") {
+        expect(2, 3);
+        return InverseCdfTable::weibull(args[0], args[1], cap(2));
+    } else if (name == "empirical") {
+        // Values are used as-is, one table point each
+        expect(1, args.size());
+        std::sort(args.begin(), args.end());
+        return InverseCdfTable(std::move(args));
+    } else {
+        throw std::runtime_error("Unknown distribution '" + name +
+                                 "' (valid: constant, uniform, bimodal, exponential, pareto, lognormal, weibull, empirical)");
+    }
+}
+
+} // namespace flowgen
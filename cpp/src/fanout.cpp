@@ -0,0 +1,202 @@
+#include "flowgen/fanout.hpp"
+#include "flowgen/pipeline.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+uint64_t parse_number(const std::string& key, const std::string& value, uint64_t max_value) {
+    try {
+        size_t pos = 0;
+        unsigned long long number = std::stoull(value, &pos, 0);
+        if (pos != value.size() || number > max_value) {
+            throw std::out_of_range(value);
+        }
+        return number;
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("Invalid filter value " + key + "=" + value);
+    }
+}
+
+int parse_protocol(const std::string& value) {
+    std::string name = value;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name == "tcp") return 6;
+    if (name == "udp") return 17;
+    if (name == "icmp") return 1;
+    return static_cast<int>(parse_number("protocol", value, 255));
+}
+
+// Mask with the top length bits of a 128-bit address set
+IpAddress prefix_mask(unsigned length) {
+    IpAddress mask;
+    if (length >= 64) {
+        mask.hi = ~0ULL;
+        mask.lo = length == 64 ? 0 : ~0ULL << (128 - length);
+    } else {
+        mask.hi = length == 0 ? 0 : ~0ULL << (64 - length);
+    }
+    return mask;
+}
+
+IpAddress source_address(const FlowBatch& batch, size_t index) {
+    return batch.schema.has(FlowField::IPV6) ? batch.source_ip6[index]
+                                             : IpAddress::from_ipv4(batch.flows[index].source_ip);
+}
+
+IpAddress destination_address(const FlowBatch& batch, size_t index) {
+    return batch.schema.has(FlowField::IPV6)
+        ? batch.destination_ip6[index]
+        : IpAddress::from_ipv4(batch.flows[index].destination_ip);
+}
+
+} // namespace
+
+// Consumers
+
+void AggregatorConsumer::consume(const FlowBatch& batch, const FlowStats* stats) {
+    size_t n = batch.size();
+    if (batch.schema.has(FlowField::IPV6)) {
+        for (size_t i = 0; i < n; ++i) {
+            DualStackFlowRecord flow(batch.flows[i]);
+            flow.source_ip = batch.source_ip6[i];
+            flow.destination_ip = batch.destination_ip6[i];
+            aggregator_.add(flow, stats[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        aggregator_.add(batch.flows[i], stats[i]);
+    }
+}
+
+void SinkConsumer::consume(const FlowBatch& batch, const FlowStats* /*stats*/) {
+    sink_.write(batch);
+}
+
+void FilterConsumer::consume(const FlowBatch& batch, const FlowStats* stats) {
+    if (selected_.schema.fields != batch.schema.fields) {
+        selected_ = FlowBatch(batch.schema);
+    }
+    selected_.resize(0);
+    selected_stats_.clear();
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (filter_.matches(batch, i, stats[i])) {
+            selected_.append(batch, i);
+            selected_stats_.push_back(stats[i]);
+        }
+    }
+    if (selected_.size() > 0) {
+        downstream_.consume(selected_, selected_stats_.data());
+    }
+}
+
+// FlowFilter
+
+FlowFilter FlowFilter::parse(const std::string& spec) {
+    FlowFilter filter;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string term = trim(spec.substr(start, comma == std::string::npos ? std::string::npos
+                                                                               : comma - start));
+        start = comma == std::string::npos ? spec.size() + 1 : comma + 1;
+        if (term.empty()) {
+            continue;
+        }
+
+        size_t eq = term.find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error("Invalid filter term (expected key=value): " + term);
+        }
+        std::string key = trim(term.substr(0, eq));
+        std::string value = trim(term.substr(eq + 1));
+
+        if (key == "protocol" || key == "proto") {
+            filter.protocol_ = parse_protocol(value);
+        } else if (key == "src_port") {
+            filter.source_port_ = static_cast<int>(parse_number(key, value, 65535));
+        } else if (key == "dst_port") {
+            filter.destination_port_ = static_cast<int>(parse_number(key, value, 65535));
+        } else if (key == "port") {
+            filter.port_ = static_cast<int>(parse_number(key, value, 65535));
+        } else if (key == "src_net" || key == "dst_net" || key == "net") {
+            Prefix prefix;
+            unsigned length = 0;
+            if (is_ipv6_subnet(value)) {
+                parse_ipv6_prefix(value, prefix.base, length);
+            } else {
+                size_t slash = value.find('/');
+                prefix.base = parse_ip_address(value.substr(0, slash));
+                length = 32;
+                if (slash != std::string::npos) {
+                    length = static_cast<unsigned>(parse_number(key, value.substr(slash + 1), 32));
+                }
+                length += 96;  // IPv4-mapped
+            }
+            prefix.mask = prefix_mask(length);
+            prefix.base.hi &= prefix.mask.hi;
+            prefix.base.lo &= prefix.mask.lo;
+            Side side = key == "src_net" ? Side::SOURCE
+                      : key == "dst_net" ? Side::DESTINATION : Side::EITHER;
+            filter.prefixes_.emplace_back(side, prefix);
+        } else if (key == "min_bytes") {
+            filter.min_bytes_ = parse_number(key, value, UINT64_MAX);
+        } else if (key == "min_packets") {
+            filter.min_packets_ = parse_number(key, value, UINT32_MAX);
+        } else {
+            throw std::runtime_error("Unknown filter key: " + key);
+        }
+    }
+    return filter;
+}
+
+bool FlowFilter::matches(const FlowBatch& batch, size_t index, const FlowStats& stats) const {
+    const FlowRecord& flow = batch.flows[index];
+    if (protocol_ >= 0 && flow.protocol != protocol_) return false;
+    if (source_port_ >= 0 && flow.source_port != source_port_) return false;
+    if (destination_port_ >= 0 && flow.destination_port != destination_port_) return false;
+    if (port_ >= 0 && flow.source_port != port_ && flow.destination_port != port_) return false;
+    if (stats.byte_count < min_bytes_ || stats.packet_count < min_packets_) return false;
+
+    for (const auto& entry : prefixes_) {
+        const Prefix& prefix = entry.second;
+        bool source = entry.first != Side::DESTINATION &&
+                      prefix.contains(source_address(batch, index));
+        bool destination = entry.first != Side::SOURCE &&
+                           prefix.contains(destination_address(batch, index));
+        if (!source && !destination) return false;
+    }
+    return true;
+}
+
+// Driver
+
+uint64_t fanout_flows(FlowGenerator& generator, uint64_t count,
+                      const std::vector<FlowConsumer*>& consumers,
+                      const FanoutOptions& options) {
+    GeneratorSource source(generator, count);
+    Pipeline pipeline(source);
+    for (FlowConsumer* consumer : consumers) {
+        pipeline.add_sink(*consumer);
+    }
+
+    PipelineOptions pipeline_options;
+    pipeline_options.batch_size = static_cast<size_t>(
+        std::min<uint64_t>(std::max<size_t>(options.batch_size, 1), std::max<uint64_t>(count, 1)));
+    pipeline_options.threaded = options.threaded && consumers.size() >= 2;
+    pipeline_options.queue_depth = options.queue_depth;
+    return pipeline.run(pipeline_options).flows_in;
+}
+
+} // namespace flowgen
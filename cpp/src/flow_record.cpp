@@ -41,4 +41,16 @@ std::string FlowRecord::csv_header() {
     return "timestamp,src_ip,dst_ip,src_port,dst_port,protocol,length";
 }
 
+std::string DualStackFlowRecord::to_csv() const {
+    std::ostringstream oss;
+    oss << timestamp << ","
+        << source_ip.to_string() << ","
+        << destination_ip.to_string() << ","
+        << source_port << ","
+        << destination_port << ","
+        << static_cast<int>(protocol) << ","
+        << packet_length;
+    return oss.str();
+}
+
 } // namespace flowgen
@@ -1,11 +1,87 @@
 #include "flowgen/generator.hpp"
+#include "flowgen/plugins.hpp"
 #include "flowgen/utils.hpp"
 #include <chrono>
 #include <algorithm>
 #include <cmath>
+#include <iomanip>
+#include <sstream>
 
 namespace flowgen {
 
+namespace {
+
+// Replace modelled statistics with configured distributions, if any
+void apply_stats_overrides(const PatternDistributions& dists, const FlowRecord& flow,
+                           FlowStats& stats) {
+    if (!dists.packet_count.empty()) {
+        double packets = std::max(1.0, std::round(dists.packet_count.sample()));
+        stats.packet_count = static_cast<uint32_t>(std::min(packets, 4294967295.0));
+        stats.byte_count = static_cast<uint64_t>(stats.packet_count) * flow.packet_length;
+    }
+    if (!dists.duration_ms.empty()) {
+        double duration_ns = std::max(dists.duration_ms.sample() * 1e6, 0.0);
+        stats.duration_ns = static_cast<uint64_t>(std::min(duration_ns, 1.8e19));
+    }
+}
+
+// Identifies the network a shared model is built for (see model_seed)
+std::string network_key(const GeneratorConfig& config) {
+    std::ostringstream key;
+    key << std::setprecision(17);
+    auto list = [&key](const char* name, const auto& values) {
+        key << name << '=';
+        for (const auto& value : values) {
+            key << value << ',';
+        }
+        key << ';';
+    };
+    list("src", config.source_subnets);
+    list("src_weights", config.source_weights);
+    list("src_popularity", config.source_popularity);
+    list("dst", config.destination_subnets);
+    list("dst_popularity", config.destination_popularity);
+    return key.str();
+}
+
+uint32_t sample_or_zero(const FieldValues& values) {
+    return values.empty() ? 0 : values.sample();
+}
+
+// One address family's share of a subnet list
+struct FamilySubnets {
+    std::vector<std::string> subnets;
+    std::vector<double> weights;      // Empty when the list is unweighted
+    std::vector<std::string> popularity;
+    double weight = 0.0;              // Total weight (subnet count when unweighted)
+};
+
+// Split subnets into IPv4 subnets and IPv6 prefixes. IPv6 flows draw
+// IPv4 surrogates from the IPv4 side, which falls back to the whole
+// IPv4 space when only IPv6 prefixes are configured.
+void split_families(const std::vector<std::string>& subnets, const std::vector<double>& weights,
+                    const std::vector<std::string>& popularity,
+                    FamilySubnets& v4, FamilySubnets& v6) {
+    for (size_t i = 0; i < subnets.size(); ++i) {
+        FamilySubnets& family = is_ipv6_subnet(subnets[i]) ? v6 : v4;
+        double weight = weights.empty() ? 1.0 : weights[i];
+        family.subnets.push_back(subnets[i]);
+        if (!weights.empty()) family.weights.push_back(weight);
+        if (popularity.size() > 1 && i < popularity.size()) family.popularity.push_back(popularity[i]);
+        family.weight += weight;
+    }
+    if (popularity.size() == 1) {
+        v4.popularity = popularity;
+    }
+    if (v4.subnets.empty()) {
+        v4.subnets = {"0.0.0.0/0"};
+        v4.weights.clear();
+        if (popularity.size() > 1) v4.popularity.clear();
+    }
+}
+
+} // namespace
+
 // GeneratorConfig validation
 bool GeneratorConfig::validate(std::string* error) const {
     // Check bandwidth configuration
@@ -33,6 +109,23 @@ bool GeneratorConfig::validate(std::string* error) const {
         return false;
     }
 
+    // Check the rate/mix schedule
+    if (!schedule.validate(traffic_patterns.size(), error)) {
+        return false;
+    }
+
+    // Check pattern distribution specs
+    for (const auto& pattern : traffic_patterns) {
+        try {
+            PatternDistributions::parse(pattern.config);
+            FieldDistributions::parse(pattern.config);
+            SessionOptions::parse(pattern.config);
+        } catch (const std::exception& e) {
+            if (error) *error = "Traffic pattern '" + pattern.type + "': " + e.what();
+            return false;
+        }
+    }
+
     // Check network configuration
     if (source_subnets.empty()) {
         if (error) *error = "source_subnets cannot be empty";
@@ -61,6 +154,51 @@ bool GeneratorConfig::validate(std::string* error) const {
         }
     }
 
+    // Check subnets and host popularity
+    if ((source_popularity.size() > 1 && source_popularity.size() != source_subnets.size()) ||
+        (destination_popularity.size() > 1 && destination_popularity.size() != destination_subnets.size())) {
+        if (error) *error = "Host popularity must have one entry or one per subnet";
+        return false;
+    }
+
+    FamilySubnets src4, src6, dst4, dst6;
+    split_families(source_subnets, source_weights, source_popularity, src4, src6);
+    split_families(destination_subnets, {}, destination_popularity, dst4, dst6);
+    if ((src4.weight > 0.0) != (dst4.weight > 0.0) || src6.subnets.empty() != dst6.subnets.empty()) {
+        if (error) *error = "source_subnets and destination_subnets must cover the same address families";
+        return false;
+    }
+
+    try {
+        AddressPool(src4.subnets, src4.weights, src4.popularity);
+        AddressPool(dst4.subnets, {}, dst4.popularity);
+        if (!src6.subnets.empty()) {
+            Ipv6Pool(src6.subnets, src6.weights);
+            Ipv6Pool(dst6.subnets);
+        }
+    } catch (const std::exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+
+    if (!communication_graph.validate(error)) {
+        return false;
+    }
+
+    for (const auto& overlay : overlays) {
+        try {
+            AnomalySpec::parse(overlay);
+        } catch (const std::exception& e) {
+            if (error) *error = "Overlay '" + overlay + "': " + e.what();
+            return false;
+        }
+    }
+
+    if (pacing != "flows" && pacing != "bytes") {
+        if (error) *error = "pacing must be 'flows' or 'bytes'";
+        return false;
+    }
+
     // Check packet configuration
     if (min_packet_size > max_packet_size) {
         if (error) *error = "min_packet_size cannot exceed max_packet_size";
@@ -85,9 +223,19 @@ bool GeneratorConfig::validate(std::string* error) const {
 // FlowGenerator implementation
 FlowGenerator::FlowGenerator()
     : initialized_(false),
+      ipv6_fraction_(0.0),
       inter_arrival_time_ns_(0),
       start_timestamp_ns_(0),
-      current_timestamp_ns_(0) {
+      current_timestamp_ns_(0),
+      byte_pacing_(false),
+      flows_generated_(0),
+      bytes_generated_(0),
+      target_bytes_(0.0),
+      base_flows_(0),
+      base_bytes_(0),
+      last_pattern_(nullptr),
+      last_swapped_(false),
+      last_overlay_(false) {
 }
 
 FlowGenerator::~FlowGenerator() = default;
@@ -101,6 +249,12 @@ bool FlowGenerator::initialize(const GeneratorConfig& config) {
     }
 
     config_ = config;
+    std::string network = network_key(config_);
+    if (config_.seed != 0) {
+        rng_.seed(config_.seed);
+    }
+    // Pools, graphs and patterns may draw while being built
+    utils::Random::Scope scope(rng());
 
     // Calculate inter-arrival time based on bandwidth
     double flows_per_second = utils::calculate_flows_per_second(
@@ -122,14 +276,105 @@ bool FlowGenerator::initialize(const GeneratorConfig& config) {
 
     current_timestamp_ns_ = start_timestamp_ns_;
 
+    // Byte pacing lets one MTU of credit build up while the link is underused
+    byte_pacing_ = config_.pacing == "bytes";
+    pacer_ = BytePacer(config_.max_packet_size);
+    flows_generated_ = 0;
+    bytes_generated_ = 0;
+    target_bytes_ = 0.0;
+    base_flows_ = 0;
+    base_bytes_ = 0;
+
+    // Patterns only see IPv4 subnets; IPv6 flows are mapped from them
+    FamilySubnets src4, src6, dst4, dst6;
+    split_families(config_.source_subnets, config_.source_weights, config_.source_popularity, src4, src6);
+    split_families(config_.destination_subnets, {}, config_.destination_popularity, dst4, dst6);
+    config_.source_subnets = src4.subnets;
+    config_.source_weights = src4.weights;
+    config_.source_popularity = src4.popularity;
+    config_.destination_subnets = dst4.subnets;
+    config_.destination_popularity = dst4.popularity;
+
+    ipv6_fraction_ = src6.weight / (src4.weight + src6.weight);
+    source_pool6_ = src6.subnets.empty() ? Ipv6Pool() : Ipv6Pool(src6.subnets, src6.weights);
+    destination_pool6_ = dst6.subnets.empty() ? Ipv6Pool() : Ipv6Pool(dst6.subnets);
+
+    // Build address pools once rather than parsing subnets per flow
+    source_pool_ = AddressPool(config_.source_subnets, config_.source_weights,
+                               config_.source_popularity);
+    destination_pool_ = AddressPool(config_.destination_subnets, {},
+                                    config_.destination_popularity);
+    graph_.reset();
+    if (config_.communication_graph.enabled()) {
+        const CommunicationGraphOptions& options = config_.communication_graph;
+        std::function<std::shared_ptr<const CommunicationGraph>()> build = [&] {
+            return std::make_shared<const CommunicationGraph>(options, source_pool_, destination_pool_);
+        };
+        if (config_.model_seed != 0) {
+            std::ostringstream scope;
+            scope << std::setprecision(17) << network << "graph:" << options.clients << ','
+                  << options.servers << ',' << options.degree_exponent << ','
+                  << options.max_degree << ',' << options.server_skew << ',' << options.locality;
+            graph_ = utils::shared_seeded(scope.str(), config_.model_seed, build);
+        } else {
+            graph_ = build();
+        }
+    }
+
     // Initialize pattern generators
+    if (!config_.plugin_dir.empty()) {
+        PluginRegistry::instance().load_directory(config_.plugin_dir);
+    }
     pattern_generators_.clear();
-    pattern_weights_.clear();
+    std::vector<double> pattern_weights;
 
     for (const auto& pattern_config : config_.traffic_patterns) {
         auto generator = create_pattern_generator(pattern_config.type);
+        generator->set_address_pools(&source_pool_, &destination_pool_);
+        if (config_.model_seed != 0) {
+            // Scoped by position too, so two identical patterns stay distinct
+            std::string scope = network + "pattern" + std::to_string(pattern_generators_.size()) +
+                                ':' + pattern_config.type + ';';
+            for (const auto& [key, value] : pattern_config.config) {
+                scope += key + '=' + value + ';';
+            }
+            generator->set_shared_model(config_.model_seed, scope);
+        }
+        if (graph_) {
+            generator->set_communication_graph(graph_.get());
+        }
+        try {
+            generator->configure(pattern_config.config);
+        } catch (const std::exception&) {
+            // Pattern-specific settings (e.g. an infeasible key space)
+            initialized_ = false;
+            return false;
+        }
         pattern_generators_.push_back(std::move(generator));
-        pattern_weights_.push_back(pattern_config.percentage);
+        pattern_weights.push_back(pattern_config.percentage);
+    }
+
+    // Compile the schedule (a single segment when none is configured)
+    schedule_ = RateSchedule(config_.schedule, config_.bandwidth_gbps, pattern_weights,
+                             config_.average_packet_size);
+    schedule_.rewind(start_timestamp_ns_);
+
+    overlays_.clear();
+    for (const auto& spec_string : config_.overlays) {
+        AnomalySpec spec = AnomalySpec::parse(spec_string);
+        Overlay overlay;
+        overlay.pattern = std::make_unique<AnomalyPattern>(spec);
+        overlay.start_ns = start_timestamp_ns_ + spec.start_ns;
+        overlay.end_ns = spec.duration_ns == 0 ? UINT64_MAX : overlay.start_ns + spec.duration_ns;
+        overlay.rate = spec.rate;
+        overlay.next_ns = overlay.start_ns;
+        overlays_.push_back(std::move(overlay));
+    }
+
+    // Generation restarts its stream here, so reset() replays it
+    // without rebuilding the pools
+    if (config_.seed != 0) {
+        rng_.seed(utils::mix64(config_.seed));
     }
 
     initialized_ = true;
@@ -137,18 +382,75 @@ bool FlowGenerator::initialize(const GeneratorConfig& config) {
 }
 
 void FlowGenerator::next(FlowRecord& flow) {
-    // Select pattern based on weights
-    PatternGenerator* pattern = select_pattern();
+    utils::Random::Scope scope(rng());
+    generate(flow, nullptr);
+}
 
-    // Generate flow record
-    flow = pattern->generate(
-        current_timestamp_ns_,
-        config_.source_subnets,
-        config_.destination_subnets,
-        config_.source_weights,
-        config_.min_packet_size,
-        config_.max_packet_size
-    );
+void FlowGenerator::next(FlowRecord& flow, FlowStats& stats) {
+    utils::Random::Scope scope(rng());
+    generate(flow, &stats);
+}
+
+void FlowGenerator::generate(FlowRecord& flow, FlowStats* stats) {
+    // Byte pacing needs each flow's volume even if the caller doesn't
+    FlowStats local_stats;
+    if (!stats && byte_pacing_) {
+        stats = &local_stats;
+    }
+
+    last_swapped_ = false;
+    last_overlay_ = false;
+
+    // An overlay flow that is due before the next base flow goes first
+    if (!overlays_.empty()) {
+        Overlay* overlay = due_overlay();
+        if (overlay) {
+            generate_overlay(*overlay, flow, stats);
+            return;
+        }
+    }
+
+    // Select pattern from the current schedule segment's mix
+    const ScheduleSegment& segment = schedule_.segment_at(current_timestamp_ns_);
+    PatternGenerator* pattern = pattern_generators_[
+        schedule_.sample_pattern(segment, utils::Random::instance().uniform())].get();
+    last_pattern_ = pattern;
+
+    // Continue an active session, or generate a fresh flow
+    SessionTable* sessions = pattern->sessions();
+    const PatternDistributions& dists = pattern->distributions();
+    bool continued = sessions && sessions->continue_session(current_timestamp_ns_, flow);
+    if (!continued) {
+        flow = pattern->generate(
+            current_timestamp_ns_,
+            config_.source_subnets,
+            config_.destination_subnets,
+            config_.source_weights,
+            config_.min_packet_size,
+            config_.max_packet_size
+        );
+
+        if (!dists.packet_size.empty()) {
+            double size = std::round(dists.packet_size.sample());
+            size = std::max(size, static_cast<double>(config_.min_packet_size));
+            size = std::min(size, static_cast<double>(config_.max_packet_size));
+            flow.packet_length = static_cast<uint32_t>(size);
+        }
+
+        if (sessions) {
+            sessions->open(flow, current_timestamp_ns_);
+        }
+    }
+
+    // Statistics are derived before any direction swap (service = dst port)
+    if (stats) {
+        bool modelled = continued ? pattern->session_stats(flow, *stats)
+                                  : pattern->generate_stats(flow, *stats);
+        if (!modelled) {
+            *stats = generate_flow_stats(flow.packet_length, flow.protocol, flow.destination_port);
+        }
+        apply_stats_overrides(dists, flow, *stats);
+    }
 
     // Apply bidirectional mode - randomly swap source and destination
     if (config_.bidirectional_mode == "random") {
@@ -157,38 +459,228 @@ void FlowGenerator::next(FlowRecord& flow) {
             // Swap source and destination IPs and ports
             std::swap(flow.source_ip, flow.destination_ip);
             std::swap(flow.source_port, flow.destination_port);
+            last_swapped_ = true;
         }
     }
 
+    ++flows_generated_;
+    bytes_generated_ += stats ? stats->byte_count : flow.packet_length;
+    ++base_flows_;
+    base_bytes_ += stats ? stats->byte_count : flow.packet_length;
+
     // Update timestamp for next flow
-    current_timestamp_ns_ += inter_arrival_time_ns_;
+    uint64_t next_ns = byte_pacing_
+        ? pacer_.admit(current_timestamp_ns_, flow.packet_length, stats->byte_count,
+                       stats->duration_ns, segment.bandwidth_gbps / 8.0)
+        : current_timestamp_ns_ + segment.inter_arrival_ns;
+    target_bytes_ += segment.bandwidth_gbps / 8.0 * static_cast<double>(next_ns - current_timestamp_ns_);
+    current_timestamp_ns_ = next_ns;
 }
 
-void FlowGenerator::reset() {
-    if (initialized_) {
-        current_timestamp_ns_ = start_timestamp_ns_;
+FlowGenerator::Overlay* FlowGenerator::due_overlay() {
+    Overlay* earliest = nullptr;
+    for (auto& overlay : overlays_) {
+        if (overlay.next_ns >= overlay.end_ns || overlay.next_ns > current_timestamp_ns_) {
+            continue;
+        }
+        if (!earliest || overlay.next_ns < earliest->next_ns) {
+            earliest = &overlay;
+        }
+    }
+    return earliest;
+}
+
+void FlowGenerator::generate_overlay(Overlay& overlay, FlowRecord& flow, FlowStats* stats) {
+    last_pattern_ = overlay.pattern.get();
+    last_overlay_ = true;
+    flow = overlay.pattern->generate(
+        overlay.next_ns,
+        config_.source_subnets,
+        config_.destination_subnets,
+        config_.source_weights,
+        config_.min_packet_size,
+        config_.max_packet_size
+    );
+
+    if (stats && !overlay.pattern->generate_stats(flow, *stats)) {
+        *stats = generate_flow_stats(flow.packet_length, flow.protocol, flow.destination_port);
+    }
+
+    ++flows_generated_;
+    bytes_generated_ += stats ? stats->byte_count : flow.packet_length;
+
+    // Base spacing of the active segment: under byte pacing, the mean
+    // base flow's bytes at the link rate. The overlay's bytes are charged
+    // to the same link, so base flows make room for them.
+    const ScheduleSegment& segment = schedule_.segment_at(current_timestamp_ns_);
+    double base_interval_ns = static_cast<double>(segment.inter_arrival_ns);
+    if (byte_pacing_) {
+        double bytes_per_ns = segment.bandwidth_gbps / 8.0;
+        pacer_.admit(flow.timestamp, flow.packet_length, stats->byte_count, stats->duration_ns,
+                     bytes_per_ns);
+        if (base_flows_ > 0) {
+            base_interval_ns = static_cast<double>(base_bytes_) /
+                               static_cast<double>(base_flows_) / bytes_per_ns;
+        }
+    }
+
+    // Attack direction is meaningful, so no bidirectional swap here
+    overlay.next_ns += std::max<uint64_t>(1, static_cast<uint64_t>(base_interval_ns / overlay.rate));
+}
+
+void FlowGenerator::next_batch(FlowRecord* flows, size_t count) {
+    utils::Random::Scope scope(rng());
+    for (size_t i = 0; i < count; ++i) {
+        generate(flows[i], nullptr);
+    }
+}
+
+void FlowGenerator::next_batch(FlowRecord* flows, FlowStats* stats, size_t count) {
+    utils::Random::Scope scope(rng());
+    for (size_t i = 0; i < count; ++i) {
+        generate(flows[i], &stats[i]);
+    }
+}
+
+void FlowGenerator::next_batch(FlowBatch& batch, size_t count) {
+    next_batch(batch, nullptr, count);
+}
+
+void FlowGenerator::next_batch(FlowBatch& batch, FlowStats* stats, size_t count) {
+    utils::Random::Scope scope(rng());
+    batch.resize(count);
+    if (batch.schema.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            generate(batch.flows[i], stats ? &stats[i] : nullptr);
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        generate(batch.flows[i], stats ? &stats[i] : nullptr);
+        fill_fields(batch, i);
     }
 }
 
-PatternGenerator* FlowGenerator::select_pattern() {
-    if (pattern_generators_.empty()) {
-        return nullptr;
+void FlowGenerator::fill_fields(FlowBatch& batch, size_t index) const {
+    const FlowSchema& schema = batch.schema;
+    const FieldDistributions& fields = last_pattern_->fields();
+    const FlowRecord& flow = batch.flows[index];
+
+    if (schema.has(FlowField::TCP_FLAGS)) {
+        // Configured flags only apply to TCP flows
+        batch.tcp_flags[index] = fields.tcp_flags.empty() || flow.protocol != 6
+            ? last_pattern_->tcp_flags(flow)
+            : static_cast<uint8_t>(fields.tcp_flags.sample());
+    }
+    if (schema.has(FlowField::TOS)) {
+        batch.tos[index] = static_cast<uint8_t>(sample_or_zero(fields.tos));
+    }
+    if (schema.has(FlowField::VLAN)) {
+        batch.vlan[index] = static_cast<uint16_t>(sample_or_zero(fields.vlan));
     }
+    if (schema.has(FlowField::INPUT_IF)) {
+        batch.input_if[index] = sample_or_zero(fields.input_if);
+    }
+    if (schema.has(FlowField::OUTPUT_IF)) {
+        batch.output_if[index] = sample_or_zero(fields.output_if);
+    }
+    if (schema.has(FlowField::SRC_AS)) {
+        batch.src_as[index] = sample_or_zero(fields.src_as);
+    }
+    if (schema.has(FlowField::DST_AS)) {
+        batch.dst_as[index] = sample_or_zero(fields.dst_as);
+    }
+    if (schema.has(FlowField::NEXT_HOP)) {
+        batch.next_hop[index] = fields.next_hop.empty() ? 0 : fields.next_hop.sample();
+    }
+    if (schema.has(FlowField::IPV6)) {
+        map_addresses(flow, batch.source_ip6[index], batch.destination_ip6[index]);
+    }
+}
 
-    // Use weighted choice from utils
-    size_t idx = 0;
-    double r = utils::Random::instance().uniform(0.0, 100.0);
-    double cumsum = 0.0;
+void FlowGenerator::map_addresses(const FlowRecord& flow, IpAddress& source,
+                                  IpAddress& destination) const {
+    source = IpAddress::from_ipv4(flow.source_ip);
+    destination = IpAddress::from_ipv4(flow.destination_ip);
+    if (ipv6_fraction_ <= 0.0 || last_overlay_) {
+        return;
+    }
 
-    for (size_t i = 0; i < pattern_weights_.size(); ++i) {
-        cumsum += pattern_weights_[i];
-        if (r <= cumsum) {
-            idx = i;
-            break;
+    // The family is a property of the client/server pair, so sessions
+    // and swapped flows stay on the same family and addresses
+    uint32_t client = last_swapped_ ? flow.destination_ip : flow.source_ip;
+    uint32_t server = last_swapped_ ? flow.source_ip : flow.destination_ip;
+    uint64_t h = utils::mix64((static_cast<uint64_t>(client) << 32) | server);
+    if (static_cast<double>(h >> 11) * 0x1.0p-53 >= ipv6_fraction_) {
+        return;
+    }
+
+    IpAddress client6 = source_pool6_.map(client);
+    IpAddress server6 = destination_pool6_.map(server);
+    source = last_swapped_ ? server6 : client6;
+    destination = last_swapped_ ? client6 : server6;
+}
+
+void FlowGenerator::next(DualStackFlowRecord& flow) {
+    next_batch(&flow, nullptr, 1);
+}
+
+void FlowGenerator::next(DualStackFlowRecord& flow, FlowStats& stats) {
+    next_batch(&flow, &stats, 1);
+}
+
+void FlowGenerator::next_batch(DualStackFlowRecord* flows, FlowStats* stats, size_t count) {
+    utils::Random::Scope scope(rng());
+    FlowRecord flow;
+    for (size_t i = 0; i < count; ++i) {
+        generate(flow, stats ? &stats[i] : nullptr);
+        flows[i] = DualStackFlowRecord(flow);
+        map_addresses(flow, flows[i].source_ip, flows[i].destination_ip);
+    }
+}
+
+bool FlowGenerator::reset() {
+    bool rewound = true;
+    if (initialized_) {
+        if (config_.seed != 0) {
+            rng_.seed(utils::mix64(config_.seed));
+        }
+        current_timestamp_ns_ = start_timestamp_ns_;
+        schedule_.rewind(start_timestamp_ns_);
+        pacer_.clear();
+        flows_generated_ = 0;
+        bytes_generated_ = 0;
+        target_bytes_ = 0.0;
+        base_flows_ = 0;
+        base_bytes_ = 0;
+        for (auto& pattern : pattern_generators_) {
+            rewound = pattern->reset() && rewound;
+        }
+        for (auto& overlay : overlays_) {
+            rewound = overlay.pattern->reset() && rewound;
+            overlay.next_ns = overlay.start_ns;
         }
     }
+    return rewound;
+}
 
-    return pattern_generators_[idx].get();
+PacingReport FlowGenerator::pacing_report() const {
+    PacingReport report;
+    report.flows = flows_generated_;
+    report.bytes = bytes_generated_;
+    report.elapsed_ns = current_timestamp_ns_ - start_timestamp_ns_;
+    if (report.elapsed_ns > 0) {
+        double elapsed = static_cast<double>(report.elapsed_ns);
+        report.target_gbps = target_bytes_ * 8.0 / elapsed;
+        // Bytes of in-flight flows count as they are spread over their durations
+        double delivered = static_cast<double>(bytes_generated_);
+        if (byte_pacing_) {
+            delivered = std::max(0.0, delivered - pacer_.pending_bytes());
+        }
+        report.achieved_gbps = delivered * 8.0 / elapsed;
+        report.utilization = report.target_gbps > 0.0 ? report.achieved_gbps / report.target_gbps : 0.0;
+    }
+    return report;
 }
 
 } // namespace flowgen
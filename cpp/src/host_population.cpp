@@ -0,0 +1,333 @@
+#include "flowgen/host_population.hpp"
+#include "flowgen/distributions.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+// Built-in service mix, roughly matching the default pattern weights
+const std::vector<ServiceSpec>& default_services() {
+    static const std::vector<ServiceSpec> services = {
+        {6, 443, 40.0}, {6, 80, 15.0}, {17, 53, 20.0}, {6, 22, 5.0},
+        {6, 3306, 4.0}, {6, 5432, 4.0}, {6, 6379, 4.0}, {6, 25, 4.0}, {6, 21, 4.0},
+    };
+    return services;
+}
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+size_t parse_count(const std::map<std::string, std::string>& config, const char* key,
+                   size_t default_value) {
+    auto it = config.find(key);
+    if (it == config.end()) {
+        return default_value;
+    }
+    try {
+        size_t pos = 0;
+        unsigned long long value = std::stoull(it->second, &pos);
+        if (pos != it->second.size()) {
+            throw std::invalid_argument(it->second);
+        }
+        return static_cast<size_t>(value);
+    } catch (const std::logic_error&) {
+        throw std::runtime_error(std::string(key) + ": invalid count '" + it->second + "'");
+    }
+}
+
+size_t random_index(size_t n) {
+    return static_cast<size_t>(utils::Random::instance().randint(0, static_cast<int>(n - 1)));
+}
+
+} // namespace
+
+std::vector<ServiceSpec> parse_service_list(const std::string& spec) {
+    std::vector<ServiceSpec> services;
+
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string entry = trim(spec.substr(start, comma == std::string::npos ? std::string::npos
+                                                                                 : comma - start));
+        start = comma == std::string::npos ? spec.size() + 1 : comma + 1;
+        if (entry.empty()) {
+            continue;
+        }
+
+        size_t slash = entry.find('/');
+        if (slash == std::string::npos) {
+            throw std::runtime_error("Invalid service '" + entry + "' (expected proto/port[:weight])");
+        }
+
+        ServiceSpec service;
+        std::string proto = trim(entry.substr(0, slash));
+        std::transform(proto.begin(), proto.end(), proto.begin(), ::tolower);
+        std::string rest = entry.substr(slash + 1);
+        size_t colon = rest.find(':');
+
+        try {
+            if (proto == "tcp") {
+                service.protocol = 6;
+            } else if (proto == "udp") {
+                service.protocol = 17;
+            } else {
+                int value = std::stoi(proto);
+                if (value < 0 || value > 255) throw std::out_of_range(proto);
+                service.protocol = static_cast<uint8_t>(value);
+            }
+
+            int port = std::stoi(rest.substr(0, colon));
+            if (port < 0 || port > 65535) throw std::out_of_range(rest);
+            service.port = static_cast<uint16_t>(port);
+
+            if (colon != std::string::npos) {
+                service.weight = std::stod(rest.substr(colon + 1));
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Invalid service '" + entry + "' (expected proto/port[:weight])");
+        }
+
+        if (service.weight <= 0.0) {
+            throw std::runtime_error("Service weight must be > 0: " + entry);
+        }
+        services.push_back(service);
+    }
+
+    if (services.empty()) {
+        throw std::runtime_error("Service list is empty");
+    }
+    return services;
+}
+
+// HostPopulation
+
+HostPopulation::HostPopulation(const HostPopulationOptions& options,
+                               const AddressPool& client_pool,
+                               const AddressPool& server_pool)
+    : services_(options.services.empty() ? default_services() : options.services) {
+    if (options.clients == 0 || options.servers == 0) {
+        throw std::runtime_error("Host population needs at least one client and one server");
+    }
+    if (options.clients > static_cast<size_t>(INT32_MAX) || options.servers > static_cast<size_t>(INT32_MAX)) {
+        throw std::runtime_error("Host population is too large");
+    }
+    if (services_.size() > HostPopulationOptions::MAX_SERVICES) {
+        throw std::runtime_error("Host population supports at most " +
+                                 std::to_string(HostPopulationOptions::MAX_SERVICES) + " services");
+    }
+    if (options.server_skew < 0.0) {
+        throw std::runtime_error("server_skew must be >= 0");
+    }
+
+    std::vector<double> service_weights;
+    for (const auto& service : services_) {
+        service_weights.push_back(service.weight);
+    }
+    AliasTable service_selector(service_weights);
+
+    // Clients: draw activity, then bucket into power-of-two classes
+    InverseCdfTable activity = parse_distribution(options.activity);
+    std::vector<float> activities(options.clients);
+    double min_activity = 0.0;
+    for (size_t i = 0; i < options.clients; ++i) {
+        activities[i] = static_cast<float>(std::max(activity.sample(), 1e-9));
+        min_activity = (i == 0) ? activities[i] : std::min(min_activity, static_cast<double>(activities[i]));
+    }
+
+    auto class_of = [&](float a) {
+        double c = std::floor(std::log2(static_cast<double>(a) / min_activity));
+        return static_cast<size_t>(std::min(std::max(c, 0.0), static_cast<double>(ACTIVITY_CLASSES - 1)));
+    };
+
+    class_begin_.assign(ACTIVITY_CLASSES + 1, 0);
+    std::vector<double> class_weight(ACTIVITY_CLASSES, 0.0);
+    for (float a : activities) {
+        size_t c = class_of(a);
+        class_begin_[c + 1]++;
+        class_weight[c] += a;
+    }
+    for (size_t c = 0; c < ACTIVITY_CLASSES; ++c) {
+        class_begin_[c + 1] += class_begin_[c];
+    }
+
+    client_addresses_.resize(options.clients);
+    client_port_cursors_.resize(options.clients);
+    client_services_.resize(options.clients);
+
+    size_t per_client = std::max<size_t>(1, options.services_per_client);
+    std::vector<size_t> fill(class_begin_.begin(), class_begin_.end() - 1);
+    for (float a : activities) {
+        size_t slot = fill[class_of(a)]++;
+        client_addresses_[slot] = client_pool.sample();
+        client_port_cursors_[slot] = static_cast<uint16_t>(EPHEMERAL_FIRST + random_index(EPHEMERAL_PORTS));
+
+        uint16_t mask = 0;
+        size_t wanted = 1 + random_index(per_client);
+        for (size_t k = 0; k < wanted; ++k) {
+            mask |= static_cast<uint16_t>(1u << service_selector.sample());
+        }
+        client_services_[slot] = mask;
+    }
+
+    std::vector<double> active_weights;
+    for (size_t c = 0; c < ACTIVITY_CLASSES; ++c) {
+        if (class_begin_[c + 1] > class_begin_[c]) {
+            active_classes_.push_back(static_cast<uint8_t>(c));
+            active_weights.push_back(class_weight[c]);
+        }
+    }
+    class_selector_.build(active_weights);
+
+    // Servers: split by service weight, at least one per service
+    double total_weight = 0.0;
+    for (double w : service_weights) {
+        total_weight += w;
+    }
+
+    service_begin_.push_back(0);
+    for (size_t s = 0; s < services_.size(); ++s) {
+        double share = static_cast<double>(options.servers) * service_weights[s] / total_weight;
+        size_t count = std::max<size_t>(1, static_cast<size_t>(std::llround(share)));
+        for (size_t i = 0; i < count; ++i) {
+            server_addresses_.push_back(server_pool.sample());
+        }
+        service_begin_.push_back(server_addresses_.size());
+        if (options.server_skew > 0.0) {
+            server_rank_.emplace_back(count, options.server_skew);
+        }
+    }
+}
+
+std::vector<uint16_t> HostPopulation::port_cursors(size_t offset) const {
+    std::vector<uint16_t> cursors(client_port_cursors_);
+    offset %= EPHEMERAL_PORTS;
+    if (offset != 0) {
+        for (uint16_t& cursor : cursors) {
+            cursor = static_cast<uint16_t>(EPHEMERAL_FIRST + (cursor - EPHEMERAL_FIRST + offset) % EPHEMERAL_PORTS);
+        }
+    }
+    return cursors;
+}
+
+HostPopulation::Flow HostPopulation::next(std::vector<uint16_t>& port_cursors) const {
+    // Active client: class by total activity, then uniform within class
+    size_t c = active_classes_[class_selector_.sample()];
+    size_t client = class_begin_[c] + random_index(class_begin_[c + 1] - class_begin_[c]);
+
+    // One of the client's preferred services
+    uint16_t mask = client_services_[client];
+    size_t bits = 0;
+    for (uint16_t m = mask; m; m &= static_cast<uint16_t>(m - 1)) {
+        ++bits;
+    }
+    size_t pick = random_index(bits);
+    size_t service = 0;
+    for (; service + 1 < services_.size(); ++service) {
+        if ((mask & (1u << service)) && pick-- == 0) {
+            break;
+        }
+    }
+
+    // Server for that service, popular servers first
+    size_t begin = service_begin_[service];
+    size_t count = service_begin_[service + 1] - begin;
+    size_t server = begin + (server_rank_.empty() ? random_index(count)
+                                                  : static_cast<size_t>(server_rank_[service].sample()));
+
+    // Sequential ephemeral ports per client, wrapping within the range
+    uint16_t& cursor = port_cursors[client];
+    uint16_t source_port = cursor;
+    cursor = (cursor == 65535) ? EPHEMERAL_FIRST : static_cast<uint16_t>(cursor + 1);
+
+    const ServiceSpec& spec = services_[service];
+    return Flow{client_addresses_[client], server_addresses_[server], source_port, spec.port, spec.protocol};
+}
+
+// HostPopulationPattern
+
+void HostPopulationPattern::configure(const std::map<std::string, std::string>& config) {
+    PatternGenerator::configure(config);
+
+    HostPopulationOptions options;
+    options.clients = parse_count(config, "clients", options.clients);
+    options.servers = parse_count(config, "servers", options.servers);
+    options.services_per_client = parse_count(config, "services_per_client", options.services_per_client);
+
+    auto it = config.find("activity");
+    if (it != config.end()) {
+        parse_distribution(it->second);  // Validate now rather than on first flow
+        options.activity = it->second;
+    }
+
+    it = config.find("server_skew");
+    if (it != config.end()) {
+        try {
+            options.server_skew = std::stod(it->second);
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("server_skew: invalid number '" + it->second + "'");
+        }
+    }
+
+    it = config.find("services");
+    if (it != config.end()) {
+        options.services = parse_service_list(it->second);
+    }
+
+    options_ = options;
+    population_.reset();
+    port_cursors_.clear();
+    if (source_pool_ && destination_pool_) {
+        build(*source_pool_, *destination_pool_);
+    }
+}
+
+bool HostPopulationPattern::reset() {
+    if (population_) {
+        port_cursors_ = population_->port_cursors(port_offset_);
+    }
+    return PatternGenerator::reset();
+}
+
+void HostPopulationPattern::build(const AddressPool& client_pool, const AddressPool& server_pool) {
+    std::function<std::shared_ptr<const HostPopulation>()> make = [&] {
+        return std::make_shared<const HostPopulation>(options_, client_pool, server_pool);
+    };
+    if (model_seed_ != 0) {
+        population_ = utils::shared_seeded(model_scope_, model_seed_, make);
+        port_offset_ = random_index(65536);
+    } else {
+        population_ = make();
+        port_offset_ = 0;
+    }
+    port_cursors_ = population_->port_cursors(port_offset_);
+}
+
+FlowRecord HostPopulationPattern::generate(
+    uint64_t timestamp_ns,
+    const std::vector<std::string>& src_subnets,
+    const std::vector<std::string>& dst_subnets,
+    const std::vector<double>& src_weights,
+    uint32_t min_pkt_size,
+    uint32_t max_pkt_size) {
+
+    if (!population_) {
+        build(AddressPool(src_subnets, src_weights), AddressPool(dst_subnets));
+    }
+
+    HostPopulation::Flow f = population_->next(port_cursors_);
+    uint32_t pkt_len = utils::random_packet_size(min_pkt_size, max_pkt_size);
+
+    return FlowRecord(f.source_ip, f.destination_ip, f.source_port, f.destination_port,
+                      f.protocol, timestamp_ns, pkt_len);
+}
+
+} // namespace flowgen
@@ -0,0 +1,233 @@
+#include "flowgen/ip_address.hpp"
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+char* format_octet(char* p, uint32_t octet) {
+    if (octet >= 100) {
+        *p++ = static_cast<char>('0' + octet / 100);
+        octet %= 100;
+        *p++ = static_cast<char>('0' + octet / 10);
+    } else if (octet >= 10) {
+        *p++ = static_cast<char>('0' + octet / 10);
+    }
+    *p++ = static_cast<char>('0' + octet % 10);
+    return p;
+}
+
+char* format_dotted(char* p, uint32_t ip) {
+    p = format_octet(p, (ip >> 24) & 0xFF);
+    *p++ = '.';
+    p = format_octet(p, (ip >> 16) & 0xFF);
+    *p++ = '.';
+    p = format_octet(p, (ip >> 8) & 0xFF);
+    *p++ = '.';
+    return format_octet(p, ip & 0xFF);
+}
+
+char* format_group(char* p, uint32_t group) {
+    int shift = 12;
+    while (shift > 0 && ((group >> shift) & 0xF) == 0) {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4) {
+        *p++ = HEX_DIGITS[(group >> shift) & 0xF];
+    }
+    return p;
+}
+
+bool parse_ipv4(const std::string& text, size_t begin, size_t end, uint32_t& ip) {
+    ip = 0;
+    int octets = 0;
+    size_t pos = begin;
+    while (pos < end) {
+        uint32_t value = 0;
+        size_t digits = 0;
+        while (pos < end && text[pos] >= '0' && text[pos] <= '9') {
+            value = value * 10 + static_cast<uint32_t>(text[pos] - '0');
+            ++pos;
+            if (++digits > 3) return false;
+        }
+        if (digits == 0 || value > 255 || ++octets > 4) return false;
+        ip = (ip << 8) | value;
+        if (pos < end) {
+            if (text[pos] != '.' || pos + 1 == end) return false;
+            ++pos;
+        }
+    }
+    return octets == 4;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Parse colon-separated groups in [begin, end); a trailing dotted quad counts as two
+bool parse_groups(const std::string& text, size_t begin, size_t end,
+                  uint16_t* groups, size_t& count, bool allow_ipv4) {
+    count = 0;
+    size_t pos = begin;
+    while (pos < end) {
+        size_t colon = text.find(':', pos);
+        if (colon == std::string::npos || colon > end) colon = end;
+
+        if (colon == end && allow_ipv4 && text.find('.', pos) < end) {
+            uint32_t ip;
+            if (count > 6 || !parse_ipv4(text, pos, end, ip)) return false;
+            groups[count++] = static_cast<uint16_t>(ip >> 16);
+            groups[count++] = static_cast<uint16_t>(ip);
+            return true;
+        }
+
+        size_t digits = colon - pos;
+        if (digits == 0 || digits > 4 || count >= 8) return false;
+        uint32_t value = 0;
+        for (size_t i = pos; i < colon; ++i) {
+            int v = hex_value(text[i]);
+            if (v < 0) return false;
+            value = (value << 4) | static_cast<uint32_t>(v);
+        }
+        groups[count++] = static_cast<uint16_t>(value);
+
+        if (colon == end) break;
+        pos = colon + 1;
+        if (pos == end) return false;  // Trailing ':'
+    }
+    return true;
+}
+
+[[noreturn]] void invalid_address(const std::string& text) {
+    throw std::runtime_error("Invalid IP address: " + text);
+}
+
+} // namespace
+
+std::string IpAddress::to_string() const {
+    char buf[IP_ADDRESS_STRLEN];
+    return std::string(buf, format_ip(buf, *this));
+}
+
+char* format_ipv6(char* out, const IpAddress& ip) {
+    char* p = out;
+    if (ip.hi == 0 && (ip.lo >> 32) == 0xFFFF) {
+        const char prefix[] = "::ffff:";
+        for (const char* c = prefix; *c; ++c) *p++ = *c;
+        return format_dotted(p, ip.ipv4());
+    }
+
+    uint32_t groups[8];
+    for (int i = 0; i < 4; ++i) {
+        groups[i] = static_cast<uint32_t>((ip.hi >> (48 - 16 * i)) & 0xFFFF);
+        groups[4 + i] = static_cast<uint32_t>((ip.lo >> (48 - 16 * i)) & 0xFFFF);
+    }
+
+    // Longest run of zero groups (first one on a tie)
+    int best_start = -1;
+    int best_length = 1;
+    for (int i = 0; i < 8;) {
+        if (groups[i] != 0) {
+            ++i;
+            continue;
+        }
+        int j = i;
+        while (j < 8 && groups[j] == 0) ++j;
+        if (j - i > best_length) {
+            best_start = i;
+            best_length = j - i;
+        }
+        i = j;
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        if (i == best_start) {
+            *p++ = ':';
+            *p++ = ':';
+            i += best_length - 1;
+            continue;
+        }
+        if (i > 0 && i != best_start + best_length) {
+            *p++ = ':';
+        }
+        p = format_group(p, groups[i]);
+    }
+    return p;
+}
+
+char* format_ip(char* out, const IpAddress& ip) {
+    return ip.is_ipv4() ? format_dotted(out, ip.ipv4()) : format_ipv6(out, ip);
+}
+
+IpAddress parse_ip_address(const std::string& text) {
+    if (!is_ipv6_subnet(text)) {
+        uint32_t ip;
+        if (!parse_ipv4(text, 0, text.size(), ip)) invalid_address(text);
+        return IpAddress::from_ipv4(ip);
+    }
+
+    uint16_t head[8];
+    uint16_t tail[8];
+    size_t head_count = 0;
+    size_t tail_count = 0;
+
+    size_t gap = text.find("::");
+    if (gap == std::string::npos) {
+        if (!parse_groups(text, 0, text.size(), head, head_count, true) || head_count != 8) {
+            invalid_address(text);
+        }
+    } else {
+        if (text.find("::", gap + 1) != std::string::npos ||
+            !parse_groups(text, 0, gap, head, head_count, false) ||
+            !parse_groups(text, gap + 2, text.size(), tail, tail_count, true) ||
+            head_count + tail_count > 7) {
+            invalid_address(text);
+        }
+    }
+
+    uint16_t groups[8] = {};
+    for (size_t i = 0; i < head_count; ++i) groups[i] = head[i];
+    for (size_t i = 0; i < tail_count; ++i) groups[8 - tail_count + i] = tail[i];
+
+    IpAddress ip;
+    for (int i = 0; i < 4; ++i) {
+        ip.hi = (ip.hi << 16) | groups[i];
+        ip.lo = (ip.lo << 16) | groups[4 + i];
+    }
+    return ip;
+}
+
+void parse_ipv6_prefix(const std::string& prefix, IpAddress& base, unsigned& length) {
+    size_t slash = prefix.find('/');
+    base = parse_ip_address(prefix.substr(0, slash));
+    length = 128;
+    if (slash != std::string::npos) {
+        try {
+            size_t pos = 0;
+            std::string bits = prefix.substr(slash + 1);
+            unsigned long value = std::stoul(bits, &pos);
+            if (pos != bits.size() || value > 128) throw std::out_of_range(bits);
+            length = static_cast<unsigned>(value);
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Invalid IPv6 prefix length: " + prefix);
+        }
+    }
+    if (!is_ipv6_subnet(prefix)) {
+        throw std::runtime_error("Not an IPv6 prefix: " + prefix);
+    }
+
+    // Clear host bits
+    if (length < 64) {
+        base.hi &= length == 0 ? 0 : ~0ULL << (64 - length);
+        base.lo = 0;
+    } else if (length < 128) {
+        base.lo &= ~0ULL << (128 - length);
+    }
+}
+
+} // namespace flowgen
@@ -0,0 +1,435 @@
+#include "flowgen/keyspace.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace flowgen {
+
+namespace {
+
+// Common default RSS key (as shipped by most NIC drivers)
+constexpr uint8_t TOEPLITZ_KEY[40] = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67,
+    0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb,
+    0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30,
+    0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+// 5-tuple in network byte order: src ip, dst ip, src port, dst port, proto
+std::array<uint8_t, 13> serialize(const FlowRecord& flow) {
+    return {
+        static_cast<uint8_t>(flow.source_ip >> 24), static_cast<uint8_t>(flow.source_ip >> 16),
+        static_cast<uint8_t>(flow.source_ip >> 8), static_cast<uint8_t>(flow.source_ip),
+        static_cast<uint8_t>(flow.destination_ip >> 24), static_cast<uint8_t>(flow.destination_ip >> 16),
+        static_cast<uint8_t>(flow.destination_ip >> 8), static_cast<uint8_t>(flow.destination_ip),
+        static_cast<uint8_t>(flow.source_port >> 8), static_cast<uint8_t>(flow.source_port),
+        static_cast<uint8_t>(flow.destination_port >> 8), static_cast<uint8_t>(flow.destination_port),
+        flow.protocol,
+    };
+}
+
+uint32_t toeplitz(const uint8_t* data, size_t len) {
+    uint32_t result = 0;
+    uint32_t window = (static_cast<uint32_t>(TOEPLITZ_KEY[0]) << 24) |
+                      (static_cast<uint32_t>(TOEPLITZ_KEY[1]) << 16) |
+                      (static_cast<uint32_t>(TOEPLITZ_KEY[2]) << 8) |
+                      TOEPLITZ_KEY[3];
+    for (size_t i = 0; i < len; ++i) {
+        for (int bit = 7; bit >= 0; --bit) {
+            if (data[i] & (1u << bit)) {
+                result ^= window;
+            }
+            // Shift the next key bit into the 32-bit window
+            size_t next_bit = i * 8 + (7 - bit) + 32;
+            uint32_t key_bit = (TOEPLITZ_KEY[next_bit / 8] >> (7 - next_bit % 8)) & 1u;
+            window = (window << 1) | key_bit;
+        }
+    }
+    return result;
+}
+
+uint32_t crc32(const uint8_t* data, size_t len) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+// xxHash32, short-input path (len < 16), seed 0
+uint32_t xxhash32(const uint8_t* data, size_t len) {
+    constexpr uint32_t P1 = 2654435761u;
+    constexpr uint32_t P2 = 2246822519u;
+    constexpr uint32_t P3 = 3266489917u;
+    constexpr uint32_t P4 = 668265263u;
+    constexpr uint32_t P5 = 374761393u;
+
+    uint32_t h = P5 + static_cast<uint32_t>(len);
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t word = static_cast<uint32_t>(data[i]) |
+                        (static_cast<uint32_t>(data[i + 1]) << 8) |
+                        (static_cast<uint32_t>(data[i + 2]) << 16) |
+                        (static_cast<uint32_t>(data[i + 3]) << 24);
+        h = rotl32(h + word * P3, 17) * P4;
+    }
+    for (; i < len; ++i) {
+        h = rotl32(h + data[i] * P5, 11) * P1;
+    }
+
+    h ^= h >> 15;
+    h *= P2;
+    h ^= h >> 13;
+    h *= P3;
+    h ^= h >> 16;
+    return h;
+}
+
+// Candidate tuples: 64512 client ports times 10 service ports per address pair
+constexpr double CANDIDATE_PORTS = 64512.0 * 10.0;
+
+// Largest candidate search accepted before building (about a minute)
+constexpr double MAX_CANDIDATE_DRAWS = 1073741824.0;  // 2^30
+
+// Expected uniform draws from n values until k of them are distinct
+double distinct_draws(double k, double n) {
+    return n * std::log((n + 0.5) / (n - k + 0.5));
+}
+
+struct TupleHash {
+    size_t operator()(const std::pair<uint64_t, uint64_t>& k) const {
+        return std::hash<uint64_t>()(k.first * 0x9E3779B97F4A7C15ULL ^ k.second);
+    }
+};
+
+std::pair<uint64_t, uint64_t> tuple_key(const FlowRecord& f) {
+    return {(static_cast<uint64_t>(f.source_ip) << 32) | f.destination_ip,
+            (static_cast<uint64_t>(f.source_port) << 24) |
+            (static_cast<uint64_t>(f.destination_port) << 8) | f.protocol};
+}
+
+bool parse_double(const std::map<std::string, std::string>& config, const char* key, double& out) {
+    auto it = config.find(key);
+    if (it == config.end()) {
+        return false;
+    }
+    try {
+        out = std::stod(it->second);
+    } catch (const std::logic_error&) {
+        throw std::runtime_error(std::string(key) + ": invalid number '" + it->second + "'");
+    }
+    return true;
+}
+
+bool parse_size(const std::map<std::string, std::string>& config, const char* key, size_t& out) {
+    auto it = config.find(key);
+    if (it == config.end()) {
+        return false;
+    }
+    try {
+        out = static_cast<size_t>(std::stoull(it->second));
+    } catch (const std::logic_error&) {
+        throw std::runtime_error(std::string(key) + ": invalid count '" + it->second + "'");
+    }
+    return true;
+}
+
+} // namespace
+
+KeyHash parse_key_hash(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower.empty() || lower == "none") return KeyHash::NONE;
+    if (lower == "toeplitz") return KeyHash::TOEPLITZ;
+    if (lower == "crc32") return KeyHash::CRC32;
+    if (lower == "xxhash32" || lower == "xxhash") return KeyHash::XXHASH32;
+
+    throw std::runtime_error("Unknown hash '" + name + "' (valid: toeplitz, crc32, xxhash32, none)");
+}
+
+uint32_t hash_five_tuple(KeyHash hash, const FlowRecord& flow) {
+    auto bytes = serialize(flow);
+    switch (hash) {
+        case KeyHash::TOEPLITZ:
+            return toeplitz(bytes.data(), 12);  // RSS hashes IPs and ports only
+        case KeyHash::CRC32:
+            return crc32(bytes.data(), bytes.size());
+        case KeyHash::XXHASH32:
+            return xxhash32(bytes.data(), bytes.size());
+        default:
+            return 0;
+    }
+}
+
+KeySpaceOptions KeySpaceOptions::parse(const std::map<std::string, std::string>& config) {
+    KeySpaceOptions options;
+
+    parse_size(config, "keys", options.keys);
+    parse_double(config, "collision_fraction", options.collision_fraction);
+    parse_size(config, "collision_buckets", options.collision_buckets);
+    parse_double(config, "hit_rate", options.hit_rate);
+    parse_size(config, "reuse_distance", options.reuse_distance);
+
+    size_t buckets = options.buckets;
+    if (parse_size(config, "buckets", buckets)) {
+        if (buckets == 0 || buckets > 0x80000000ULL || (buckets & (buckets - 1)) != 0) {
+            throw std::runtime_error("buckets must be a power of two up to 2^31");
+        }
+        options.buckets = static_cast<uint32_t>(buckets);
+    }
+
+    auto it = config.find("hash");
+    if (it != config.end()) {
+        options.hash = parse_key_hash(it->second);
+    }
+
+    it = config.find("order");
+    if (it != config.end()) {
+        options.order = it->second;
+        std::transform(options.order.begin(), options.order.end(), options.order.begin(), ::tolower);
+    }
+
+    if (options.keys == 0) {
+        throw std::runtime_error("keys must be greater than 0");
+    }
+    if (options.collision_fraction < 0.0 || options.collision_fraction > 1.0) {
+        throw std::runtime_error("collision_fraction must be between 0 and 1");
+    }
+    if (options.collision_fraction > 0.0 && options.hash == KeyHash::NONE) {
+        throw std::runtime_error("collision_fraction requires a hash");
+    }
+    if (options.collision_buckets == 0 || options.collision_buckets > options.buckets) {
+        throw std::runtime_error("collision_buckets must be between 1 and buckets");
+    }
+    if (options.order != "random" && options.order != "sorted" && options.order != "bucket") {
+        throw std::runtime_error("order must be random, sorted or bucket");
+    }
+    if (options.order == "bucket" && options.hash == KeyHash::NONE) {
+        throw std::runtime_error("order 'bucket' requires a hash");
+    }
+    if (options.hit_rate < 0.0 || options.hit_rate >= 1.0) {
+        throw std::runtime_error("hit_rate must be in [0, 1)");
+    }
+    if (options.hit_rate > 0.0 && options.reuse_distance == 0) {
+        throw std::runtime_error("reuse_distance must be greater than 0");
+    }
+    return options;
+}
+
+// KeySpace
+
+KeySpace::KeySpace(const KeySpaceOptions& options,
+                   const AddressPool& source_pool,
+                   const AddressPool& destination_pool)
+    : hit_rate_(options.hit_rate),
+      reuse_distance_(options.hit_rate > 0.0 ? options.reuse_distance : 0) {
+    static const uint16_t SERVICE_PORTS[] = {80, 443, 53, 22, 25, 3306, 5432, 6379, 8080, 123};
+    auto& rng = utils::Random::instance();
+
+    auto candidate = [&]() {
+        FlowRecord f;
+        f.source_ip = source_pool.sample();
+        f.destination_ip = destination_pool.sample();
+        f.source_port = utils::random_port(1024, 65535);
+        f.destination_port = SERVICE_PORTS[rng.randint(0, 9)];
+        f.protocol = (f.destination_port == 53 || f.destination_port == 123) ? 17 : 6;
+        f.timestamp = 0;
+        f.packet_length = 0;
+        return f;
+    };
+
+    uint32_t mask = options.buckets - 1;
+    std::unordered_set<uint32_t> targets;
+    while (targets.size() < options.collision_buckets) {
+        targets.insert(rng.rand32() & mask);
+    }
+
+    size_t colliding = static_cast<size_t>(static_cast<double>(options.keys) * options.collision_fraction);
+
+    // Check the request against the reachable tuple space before searching;
+    // the hash spreads candidates evenly over the buckets
+    double space = static_cast<double>(source_pool.host_count()) *
+                   static_cast<double>(destination_pool.host_count()) * CANDIDATE_PORTS;
+    double target_share = static_cast<double>(options.collision_buckets) /
+                          static_cast<double>(options.buckets);
+    double keys = static_cast<double>(options.keys);
+    if (keys > space) {
+        throw std::runtime_error("keys: " + std::to_string(options.keys) + " exceeds the " +
+                                 std::to_string(static_cast<uint64_t>(space)) +
+                                 " distinct 5-tuples the subnets can produce");
+    }
+    double draws = distinct_draws(keys, space);
+    if (colliding > 0) {
+        double target_space = space * target_share;
+        if (static_cast<double>(colliding) > target_space) {
+            throw std::runtime_error("collision_fraction: " + std::to_string(colliding) +
+                                     " colliding keys exceed the about " +
+                                     std::to_string(static_cast<uint64_t>(target_space)) +
+                                     " 5-tuples that hash into the collision buckets");
+        }
+        draws += distinct_draws(static_cast<double>(colliding), target_space) / target_share;
+    }
+    if (draws > MAX_CANDIDATE_DRAWS) {
+        throw std::runtime_error("Building " + std::to_string(options.keys) +
+                                 " keys needs about " + std::to_string(static_cast<uint64_t>(draws)) +
+                                 " candidates (use fewer keys or more collision buckets)");
+    }
+
+    std::unordered_set<std::pair<uint64_t, uint64_t>, TupleHash> seen;
+    seen.reserve(options.keys);
+    keys_.reserve(options.keys);
+
+    // Skewed host popularity can still make the search slower than
+    // expected, so it stays bounded
+    uint64_t attempts = 0;
+    const uint64_t max_attempts = (uint64_t(1) << 20) + static_cast<uint64_t>(8.0 * draws);
+
+    while (keys_.size() < options.keys) {
+        if (++attempts > max_attempts) {
+            throw std::runtime_error("Could not build " + std::to_string(options.keys) +
+                                     " distinct keys (host popularity too skewed)");
+        }
+        FlowRecord f = candidate();
+        if (keys_.size() < colliding &&
+            targets.count(hash_five_tuple(options.hash, f) & mask) == 0) {
+            continue;
+        }
+        if (seen.insert(tuple_key(f)).second) {
+            keys_.push_back(f);
+        }
+    }
+
+    if (options.order == "sorted") {
+        std::sort(keys_.begin(), keys_.end(), [](const FlowRecord& a, const FlowRecord& b) {
+            return tuple_key(a) < tuple_key(b);
+        });
+    } else if (options.order == "bucket") {
+        std::vector<std::pair<uint32_t, size_t>> order(keys_.size());
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            order[i] = {hash_five_tuple(options.hash, keys_[i]) & mask, i};
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<FlowRecord> sorted;
+        sorted.reserve(keys_.size());
+        for (const auto& entry : order) {
+            sorted.push_back(keys_[entry.second]);
+        }
+        keys_.swap(sorted);
+    } else {
+        for (size_t i = keys_.size() - 1; i > 0; --i) {
+            size_t j = static_cast<size_t>(rng.uniform() * static_cast<double>(i + 1));
+            std::swap(keys_[i], keys_[std::min(j, i)]);
+        }
+    }
+}
+
+KeySpace::Cursor KeySpace::cursor(size_t start) const {
+    Cursor cursor;
+    cursor.position = start % keys_.size();
+    cursor.recent.resize(reuse_distance_);
+    return cursor;
+}
+
+void KeySpace::next(Cursor& cursor, FlowRecord& flow) const {
+    auto& rng = utils::Random::instance();
+    std::vector<uint32_t>& recent = cursor.recent;
+
+    size_t index;
+    if (cursor.recent_count > 0 && rng.uniform() < hit_rate_) {
+        size_t back = static_cast<size_t>(rng.uniform() * static_cast<double>(cursor.recent_count));
+        back = std::min(back, cursor.recent_count - 1);
+        index = recent[(cursor.recent_head + recent.size() - 1 - back) % recent.size()];
+    } else {
+        index = cursor.position;
+        cursor.position = (cursor.position + 1 == keys_.size()) ? 0 : cursor.position + 1;
+    }
+
+    if (!recent.empty()) {
+        recent[cursor.recent_head] = static_cast<uint32_t>(index);
+        cursor.recent_head = (cursor.recent_head + 1) % recent.size();
+        cursor.recent_count = std::min(cursor.recent_count + 1, recent.size());
+    }
+
+    const FlowRecord& key = keys_[index];
+    flow.source_ip = key.source_ip;
+    flow.destination_ip = key.destination_ip;
+    flow.source_port = key.source_port;
+    flow.destination_port = key.destination_port;
+    flow.protocol = key.protocol;
+}
+
+// KeySpacePattern
+
+void KeySpacePattern::configure(const std::map<std::string, std::string>& config) {
+    PatternGenerator::configure(config);
+    options_ = KeySpaceOptions::parse(config);
+    keyspace_.reset();
+    if (source_pool_ && destination_pool_) {
+        build(*source_pool_, *destination_pool_);
+    }
+}
+
+bool KeySpacePattern::reset() {
+    if (keyspace_) {
+        cursor_ = keyspace_->cursor(start_);
+    }
+    return PatternGenerator::reset();
+}
+
+void KeySpacePattern::build(const AddressPool& source_pool, const AddressPool& destination_pool) {
+    std::function<std::shared_ptr<const KeySpace>()> make = [&] {
+        return std::make_shared<const KeySpace>(options_, source_pool, destination_pool);
+    };
+    if (model_seed_ != 0) {
+        // One shared key set; each user starts at its own key
+        keyspace_ = utils::shared_seeded(model_scope_, model_seed_, make);
+        start_ = static_cast<size_t>(utils::Random::instance().uniform() *
+                                     static_cast<double>(keyspace_->size()));
+    } else {
+        keyspace_ = make();
+        start_ = 0;
+    }
+    cursor_ = keyspace_->cursor(start_);
+}
+
+FlowRecord KeySpacePattern::generate(
+    uint64_t timestamp_ns,
+    const std::vector<std::string>& src_subnets,
+    const std::vector<std::string>& dst_subnets,
+    const std::vector<double>& src_weights,
+    uint32_t min_pkt_size,
+    uint32_t max_pkt_size) {
+
+    if (!keyspace_) {
+        build(AddressPool(src_subnets, src_weights), AddressPool(dst_subnets));
+    }
+
+    FlowRecord flow;
+    keyspace_->next(cursor_, flow);
+    flow.timestamp = timestamp_ns;
+    flow.packet_length = utils::random_packet_size(min_pkt_size, max_pkt_size);
+    return flow;
+}
+
+} // namespace flowgen
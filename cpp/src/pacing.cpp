@@ -0,0 +1,97 @@
+#include "flowgen/pacing.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace flowgen {
+
+BytePacer::BytePacer(uint64_t burst_bytes)
+    : burst_bytes_(static_cast<double>(burst_bytes)),
+      balance_(0.0),
+      spread_rate_(0.0),
+      now_ns_(0) {
+}
+
+uint64_t BytePacer::admit(uint64_t start_ns, uint64_t first_bytes, uint64_t bytes,
+                          uint64_t duration_ns, double bytes_per_ns) {
+    if (now_ns_ == 0) {
+        now_ns_ = start_ns;  // First flow: start with an empty bucket
+    }
+    start_ns = std::max(start_ns, now_ns_);  // Late flows queue behind the debt
+    advance(start_ns, bytes_per_ns);
+
+    // First packet now, the rest spread over the flow's lifetime
+    if (duration_ns == 0 || bytes <= first_bytes) {
+        balance_ -= static_cast<double>(bytes);
+    } else {
+        balance_ -= static_cast<double>(first_bytes);
+        double rate = static_cast<double>(bytes - first_bytes) / static_cast<double>(duration_ns);
+        heap_.push_back(Charge{start_ns + duration_ns, rate});
+        std::push_heap(heap_.begin(), heap_.end(), later_end);
+        spread_rate_ += rate;
+    }
+
+    // Earliest time the bucket is out of debt
+    while (balance_ < 0.0) {
+        double slope = bytes_per_ns - spread_rate_;
+        if (slope > 0.0) {
+            uint64_t wait = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(-balance_ / slope)));
+            if (heap_.empty() || now_ns_ + wait <= heap_.front().end_ns) {
+                advance(now_ns_ + wait, bytes_per_ns);
+                continue;
+            }
+        }
+        // Link saturated or a charge ends first: move to the next end
+        advance(heap_.front().end_ns, bytes_per_ns);
+    }
+
+    if (now_ns_ == start_ns) {
+        advance(start_ns + 1, bytes_per_ns);  // Keep flow timestamps distinct
+    }
+    return now_ns_;
+}
+
+void BytePacer::clear() {
+    heap_.clear();
+    balance_ = 0.0;
+    spread_rate_ = 0.0;
+    now_ns_ = 0;
+}
+
+double BytePacer::pending_bytes() const {
+    double pending = 0.0;
+    for (const Charge& charge : heap_) {
+        pending += charge.bytes_per_ns * static_cast<double>(charge.end_ns - now_ns_);
+    }
+    return pending;
+}
+
+void BytePacer::advance(uint64_t to_ns, double bytes_per_ns) {
+    while (now_ns_ < to_ns) {
+        uint64_t step_end = to_ns;
+        if (!heap_.empty() && heap_.front().end_ns < step_end) {
+            step_end = heap_.front().end_ns;
+        }
+        balance_ += (bytes_per_ns - spread_rate_) * static_cast<double>(step_end - now_ns_);
+        balance_ = std::min(balance_, burst_bytes_);
+        now_ns_ = step_end;
+
+        while (!heap_.empty() && heap_.front().end_ns <= now_ns_) {
+            pop();
+        }
+    }
+}
+
+bool BytePacer::later_end(const Charge& a, const Charge& b) {
+    return a.end_ns > b.end_ns;
+}
+
+void BytePacer::pop() {
+    std::pop_heap(heap_.begin(), heap_.end(), later_end);
+    spread_rate_ -= heap_.back().bytes_per_ns;
+    heap_.pop_back();
+    if (heap_.empty()) {
+        spread_rate_ = 0.0;  // Drop accumulated rounding
+    }
+}
+
+} // namespace flowgen
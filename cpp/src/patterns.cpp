@@ -1,4 +1,8 @@
 #include "flowgen/patterns.hpp"
+#include "flowgen/host_population.hpp"
+#include "flowgen/keyspace.hpp"
+#include "flowgen/plugins.hpp"
+#include "flowgen/profile.hpp"
 #include "flowgen/utils.hpp"
 #include <stdexcept>
 #include <algorithm>
@@ -10,6 +14,53 @@ constexpr uint8_t PROTO_ICMP = 1;
 constexpr uint8_t PROTO_TCP = 6;
 constexpr uint8_t PROTO_UDP = 17;
 
+// Pattern distribution overrides
+PatternDistributions PatternDistributions::parse(const std::map<std::string, std::string>& config) {
+    PatternDistributions result;
+
+    auto parse_entry = [&config](const char* key, InverseCdfTable& table) {
+        auto it = config.find(key);
+        if (it == config.end()) {
+            return;
+        }
+        try {
+            table = parse_distribution(it->second);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string(key) + ": " + e.what());
+        }
+        if (table.points().front() < 0.0) {
+            throw std::runtime_error(std::string(key) + ": distribution must be non-negative");
+        }
+    };
+
+    parse_entry("packet_size", result.packet_size);
+    parse_entry("packet_count", result.packet_count);
+    parse_entry("duration_ms", result.duration_ms);
+    return result;
+}
+
+void PatternGenerator::configure(const std::map<std::string, std::string>& config) {
+    distributions_ = PatternDistributions::parse(config);
+    fields_ = FieldDistributions::parse(config);
+
+    SessionOptions session_options = SessionOptions::parse(config);
+    sessions_ = session_options.enabled() ? std::make_unique<SessionTable>(session_options) : nullptr;
+}
+
+void PatternGenerator::select_endpoints(const std::vector<std::string>& src_subnets,
+                                        const std::vector<std::string>& dst_subnets,
+                                        const std::vector<double>& src_weights,
+                                        uint32_t& src_ip, uint32_t& dst_ip) const {
+    if (graph_) {
+        graph_->sample(src_ip, dst_ip);
+        return;
+    }
+    src_ip = source_pool_ ? source_pool_->sample()
+                          : utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
+    dst_ip = destination_pool_ ? destination_pool_->sample()
+                               : utils::random_ip_from_subnets_uint32(dst_subnets);
+}
+
 // Random pattern
 FlowRecord RandomPattern::generate(
     uint64_t timestamp_ns,
@@ -19,8 +70,8 @@ FlowRecord RandomPattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     uint8_t proto = (utils::Random::instance().uniform() < 0.7) ? PROTO_TCP : PROTO_UDP;
     uint16_t src_port = utils::random_port(49152, 65535);
@@ -39,8 +90,8 @@ FlowRecord WebPattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     // 70% HTTPS, 30% HTTP
     uint16_t dst_port = (utils::Random::instance().uniform() < 0.7) ? 443 : 80;
@@ -67,8 +118,8 @@ FlowRecord DnsPattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     uint16_t dst_port = 53;
     uint16_t src_port = utils::random_port(49152, 65535);
@@ -89,8 +140,8 @@ FlowRecord SshPattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     uint16_t dst_port = 22;
     uint16_t src_port = utils::random_port(49152, 65535);
@@ -111,8 +162,8 @@ FlowRecord DatabasePattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     // Random database port
     const uint16_t db_ports[] = {3306, 5432, 27017, 6379};
@@ -142,8 +193,8 @@ FlowRecord SmtpPattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     const uint16_t smtp_ports[] = {25, 587, 465};
     int idx = utils::Random::instance().randint(0, 2);
@@ -166,8 +217,8 @@ FlowRecord FtpPattern::generate(
     uint32_t min_pkt_size,
     uint32_t max_pkt_size) {
 
-    uint32_t src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
-    uint32_t dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    uint32_t src_ip, dst_ip;
+    select_endpoints(src_subnets, dst_subnets, src_weights, src_ip, dst_ip);
 
     uint16_t dst_port = (utils::Random::instance().uniform() < 0.5) ? 20 : 21;
     uint16_t src_port = utils::random_port(49152, 65535);
@@ -203,6 +254,14 @@ std::unique_ptr<PatternGenerator> create_pattern_generator(const std::string& pa
         return std::make_unique<SmtpPattern>();
     } else if (type_lower == "ftp_traffic") {
         return std::make_unique<FtpPattern>();
+    } else if (type_lower == "host_population" || type_lower == "population") {
+        return std::make_unique<HostPopulationPattern>();
+    } else if (type_lower == "keyspace") {
+        return std::make_unique<KeySpacePattern>();
+    } else if (type_lower.rfind("profile:", 0) == 0) {
+        return std::make_unique<ProfilePattern>(load_shared_profile(pattern_type.substr(8)));
+    } else if (const flowgen_pattern_type* plugin_type = PluginRegistry::instance().find(type_lower)) {
+        return std::make_unique<PluginPattern>(type_lower, plugin_type);
     } else {
         throw std::runtime_error("Unknown pattern type: " + pattern_type);
     }
@@ -0,0 +1,396 @@
+#include "flowgen/pipeline.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace flowgen {
+
+namespace {
+
+template<typename T>
+inline T read_le(const unsigned char* p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return static_cast<T>(v);
+}
+
+inline IpAddress read_be(const unsigned char* p) {
+    IpAddress ip;
+    for (size_t i = 0; i < 8; ++i) {
+        ip.hi = (ip.hi << 8) | p[i];
+        ip.lo = (ip.lo << 8) | p[8 + i];
+    }
+    return ip;
+}
+
+} // namespace
+
+// ========== Sources ==========
+
+FlowSchema GeneratorSource::open(const FlowSchema& requested) {
+    FlowSchema schema = requested;
+    if (generator_.dual_stack()) {
+        schema.enable(FlowField::IPV6);
+    }
+    return schema;
+}
+
+size_t GeneratorSource::next(FlowBatch& batch, FlowStats* stats, size_t max_count) {
+    size_t n = static_cast<size_t>(std::min<uint64_t>(max_count, count_ - generated_));
+    if (n == 0) {
+        batch.resize(0);
+        return 0;
+    }
+    generator_.next_batch(batch, stats, n);
+    generated_ += n;
+    return n;
+}
+
+BinaryFileSource::BinaryFileSource(const std::string& path)
+    : path_(path), fp_(std::fopen(path.c_str(), "rb")), record_size_(0) {
+    if (!fp_) {
+        throw std::runtime_error("Failed to open flow file: " + path);
+    }
+
+    unsigned char header[12];
+    if (std::fread(header, 1, 8, fp_) != 8 ||
+        read_le<uint32_t>(header) != BinaryFlowHeader::MAGIC) {
+        std::fclose(fp_);
+        throw std::runtime_error("Not a binary flow file: " + path);
+    }
+    uint16_t version = read_le<uint16_t>(header + 4);
+    record_size_ = read_le<uint16_t>(header + 6);
+
+    size_t needed = BinaryFlowHeader::RECORD_SIZE;
+    if (version == BinaryFlowHeader::VERSION_SCHEMA) {
+        if (std::fread(header + 8, 1, 4, fp_) != 4) {
+            std::fclose(fp_);
+            throw std::runtime_error("Truncated binary flow file header: " + path);
+        }
+        schema_.fields = read_le<uint32_t>(header + 8);
+        for (size_t i = 0; i < static_cast<size_t>(FlowField::IPV6); ++i) {
+            if (schema_.has(static_cast<FlowField>(i))) {
+                needed += field_width(static_cast<FlowField>(i));
+            }
+        }
+        if (schema_.has(FlowField::IPV6)) {
+            needed += 32;
+        }
+    } else if (version != BinaryFlowHeader::VERSION) {
+        std::fclose(fp_);
+        throw std::runtime_error("Unsupported binary flow file version " +
+                                 std::to_string(version) + ": " + path);
+    }
+    if (schema_.fields >> static_cast<unsigned>(FlowField::COUNT) || record_size_ < needed) {
+        std::fclose(fp_);
+        throw std::runtime_error("Invalid binary flow file header: " + path);
+    }
+}
+
+BinaryFileSource::~BinaryFileSource() {
+    std::fclose(fp_);
+}
+
+FlowSchema BinaryFileSource::open(const FlowSchema& requested) {
+    FlowSchema missing;
+    missing.fields = requested.fields & ~schema_.fields;
+    if (!missing.empty()) {
+        throw std::runtime_error("Flow file " + path_ + " lacks fields: " + missing.to_string());
+    }
+    return schema_;
+}
+
+size_t BinaryFileSource::next(FlowBatch& batch, FlowStats* stats, size_t max_count) {
+    buffer_.resize(max_count * record_size_);
+    size_t n = std::fread(buffer_.data(), record_size_, max_count, fp_);
+    if (n < max_count && std::ferror(fp_)) {
+        throw std::runtime_error("Failed to read flow file: " + path_);
+    }
+    batch.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned char* p = buffer_.data() + i * record_size_;
+        FlowRecord& flow = batch.flows[i];
+        flow.timestamp = read_le<uint64_t>(p);
+        flow.source_ip = read_le<uint32_t>(p + 8);
+        flow.destination_ip = read_le<uint32_t>(p + 12);
+        flow.source_port = read_le<uint16_t>(p + 16);
+        flow.destination_port = read_le<uint16_t>(p + 18);
+        flow.protocol = p[20];
+        flow.packet_length = read_le<uint32_t>(p + 24);
+        stats[i] = {1, flow.packet_length, 0};
+
+        // Optional fields follow in FlowField order
+        p += BinaryFlowHeader::RECORD_SIZE;
+        if (batch.schema.has(FlowField::TCP_FLAGS)) batch.tcp_flags[i] = *p++;
+        if (batch.schema.has(FlowField::TOS)) batch.tos[i] = *p++;
+        if (batch.schema.has(FlowField::VLAN)) { batch.vlan[i] = read_le<uint16_t>(p); p += 2; }
+        if (batch.schema.has(FlowField::INPUT_IF)) { batch.input_if[i] = read_le<uint32_t>(p); p += 4; }
+        if (batch.schema.has(FlowField::OUTPUT_IF)) { batch.output_if[i] = read_le<uint32_t>(p); p += 4; }
+        if (batch.schema.has(FlowField::SRC_AS)) { batch.src_as[i] = read_le<uint32_t>(p); p += 4; }
+        if (batch.schema.has(FlowField::DST_AS)) { batch.dst_as[i] = read_le<uint32_t>(p); p += 4; }
+        if (batch.schema.has(FlowField::NEXT_HOP)) { batch.next_hop[i] = read_le<uint32_t>(p); p += 4; }
+        if (batch.schema.has(FlowField::IPV6)) {
+            batch.source_ip6[i] = read_be(p);
+            batch.destination_ip6[i] = read_be(p + 16);
+        }
+    }
+    return n;
+}
+
+// ========== Transforms ==========
+
+size_t retain_rows(FlowBatch& batch, std::vector<FlowStats>& stats,
+                   const std::vector<uint8_t>& selected) {
+    size_t kept = 0;
+    for (size_t i = 0; i < stats.size(); ++i) {
+        stats[kept] = stats[i];
+        kept += selected[i] != 0;
+    }
+    stats.resize(kept);
+    return batch.retain(selected.data());
+}
+
+void FilterTransform::apply(FlowBatch& batch, std::vector<FlowStats>& stats) {
+    size_t n = batch.size();
+    selected_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        selected_[i] = filter_.matches(batch, i, stats[i]);
+    }
+    retain_rows(batch, stats, selected_);
+}
+
+// ========== PartitionConsumer ==========
+
+PartitionConsumer::PartitionConsumer(std::vector<FlowConsumer*> partitions, PartitionKey key)
+    : partitions_(std::move(partitions)), key_(key) {
+    if (partitions_.empty()) {
+        throw std::runtime_error("PartitionConsumer needs at least one partition");
+    }
+    for (const FlowConsumer* partition : partitions_) {
+        if (!partition) {
+            throw std::runtime_error("PartitionConsumer partition is null");
+        }
+    }
+    batches_.resize(partitions_.size());
+    stats_.resize(partitions_.size());
+}
+
+FlowSchema PartitionConsumer::schema() const {
+    FlowSchema schema;
+    for (const FlowConsumer* partition : partitions_) {
+        schema.fields |= partition->schema().fields;
+    }
+    return schema;
+}
+
+size_t PartitionConsumer::partition_of(const FlowBatch& batch, size_t index) const {
+    uint64_t hash;
+    switch (key_) {
+    case PartitionKey::SOURCE_IP:
+        hash = utils::endpoint_hash(batch.source_address(index), 0);
+        break;
+    case PartitionKey::DESTINATION_IP:
+        hash = utils::endpoint_hash(batch.destination_address(index), 0);
+        break;
+    default:
+        // Both directions of a conversation land in the same partition
+        hash = canonical_flow_hash(batch, index);
+        break;
+    }
+    return static_cast<size_t>(hash % partitions_.size());
+}
+
+void PartitionConsumer::consume(const FlowBatch& batch, const FlowStats* stats) {
+    for (size_t p = 0; p < partitions_.size(); ++p) {
+        if (batches_[p].schema.fields != batch.schema.fields) {
+            batches_[p] = FlowBatch(batch.schema);
+        }
+        batches_[p].resize(0);
+        stats_[p].clear();
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        size_t p = partition_of(batch, i);
+        batches_[p].append(batch, i);
+        stats_[p].push_back(stats[i]);
+    }
+
+    for (size_t p = 0; p < partitions_.size(); ++p) {
+        if (batches_[p].size() > 0) {
+            partitions_[p]->consume(batches_[p], stats_[p].data());
+        }
+    }
+}
+
+void PartitionConsumer::finish() {
+    for (FlowConsumer* partition : partitions_) {
+        partition->finish();
+    }
+}
+
+// ========== Pipeline ==========
+
+PipelineStats Pipeline::run(const PipelineOptions& options) {
+    FlowSchema requested;
+    for (const FlowTransform* transform : transforms_) {
+        requested.fields |= transform->schema().fields;
+    }
+    for (const FlowConsumer* sink : sinks_) {
+        requested.fields |= sink->schema().fields;
+    }
+    FlowSchema schema = source_.open(requested);
+    size_t capacity = std::max<size_t>(options.batch_size, 1);
+
+    PipelineStats result;
+    bool exhausted = false;
+    size_t flushing = 0;  // Transform being flushed once the source is exhausted
+
+    // Fill the next batch from the source, or from a transform's flush()
+    // once the source is exhausted, and run it through the transforms
+    // after that point. Returns false when nothing is left.
+    auto produce = [&](FlowBatch& batch, std::vector<FlowStats>& stats) {
+        size_t first = 0;
+        if (!exhausted) {
+            stats.resize(capacity);
+            size_t n = source_.next(batch, stats.data(), capacity);
+            stats.resize(n);
+            result.flows_in += n;
+            exhausted = n == 0;
+        }
+        if (exhausted) {
+            if (flushing == transforms_.size()) {
+                return false;
+            }
+            batch.resize(0);
+            stats.clear();
+            first = flushing + 1;
+            if (!transforms_[flushing]->flush(batch, stats)) {
+                ++flushing;
+            }
+        }
+        for (size_t t = first; t < transforms_.size(); ++t) {
+            transforms_[t]->apply(batch, stats);
+        }
+        if (stats.size() != batch.size()) {
+            throw std::runtime_error("Pipeline transform left batch and stats with different sizes");
+        }
+        return true;
+    };
+
+    if (!options.threaded || sinks_.empty()) {
+        FlowBatch batch(schema, capacity);
+        std::vector<FlowStats> stats;
+        while (produce(batch, stats)) {
+            if (batch.size() == 0) {
+                continue;
+            }
+            for (FlowConsumer* sink : sinks_) {
+                sink->consume(batch, stats.data());
+            }
+            result.flows_out += batch.size();
+            ++result.batches;
+        }
+        for (FlowConsumer* sink : sinks_) {
+            sink->finish();
+        }
+        return result;
+    }
+
+    // Ring of batches; slot b % depth is reused once every sink is past batch b
+    struct Slot {
+        FlowBatch batch;
+        std::vector<FlowStats> stats;
+    };
+    size_t depth = std::max<size_t>(options.queue_depth, 1);
+    std::vector<Slot> slots(depth);
+    for (Slot& slot : slots) {
+        slot.batch = FlowBatch(schema, capacity);
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    uint64_t produced = 0;
+    std::vector<uint64_t> consumed(sinks_.size(), 0);
+    bool done = false;
+    std::exception_ptr error;
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < sinks_.size(); ++c) {
+        threads.emplace_back([&, c]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                changed.wait(lock, [&]() { return consumed[c] < produced || done || error; });
+                if (error || consumed[c] == produced) {
+                    return;
+                }
+                const Slot& slot = slots[consumed[c] % depth];
+                lock.unlock();
+                try {
+                    sinks_[c]->consume(slot.batch, slot.stats.data());
+                } catch (...) {
+                    lock.lock();
+                    if (!error) error = std::current_exception();
+                    changed.notify_all();
+                    return;
+                }
+                lock.lock();
+                ++consumed[c];
+                changed.notify_all();
+            }
+        });
+    }
+
+    try {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() {
+                    return error ||
+                           produced - *std::min_element(consumed.begin(), consumed.end()) < depth;
+                });
+                if (error) break;
+            }
+            Slot& slot = slots[produced % depth];
+            if (!produce(slot.batch, slot.stats)) {
+                break;
+            }
+            if (slot.batch.size() == 0) {
+                continue;
+            }
+            result.flows_out += slot.batch.size();
+            ++result.batches;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ++produced;
+            changed.notify_all();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        changed.notify_all();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    for (FlowConsumer* sink : sinks_) {
+        sink->finish();
+    }
+    return result;
+}
+
+} // namespace flowgen
@@ -0,0 +1,351 @@
+#include "flowgen/plugins.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace flowgen {
+
+namespace {
+
+#ifdef __APPLE__
+const char PLUGIN_SUFFIX[] = ".dylib";
+#else
+const char PLUGIN_SUFFIX[] = ".so";
+#endif
+
+std::string to_lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+// Version 1 flowgen_pattern_type, which ended at destroy. Arrays from
+// version 1 plugins have this stride.
+struct PatternTypeV1 {
+    const char* name;
+    decltype(flowgen_pattern_type::create) create;
+    decltype(flowgen_pattern_type::generate) generate;
+    decltype(flowgen_pattern_type::destroy) destroy;
+};
+
+bool has_suffix(const std::string& name, const std::string& suffix) {
+    return name.size() > suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// RNG callbacks handed to plugins; they draw from the running
+// generator's stream (utils::Random::instance()), rng is only a handle
+void random_u32(void*, uint32_t* out, size_t n) {
+    auto& random = utils::Random::instance();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = random.rand32();
+    }
+}
+
+void random_unit(void*, double* out, size_t n) {
+    auto& random = utils::Random::instance();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = random.uniform();
+    }
+}
+
+} // namespace
+
+// PluginRegistry
+
+PluginRegistry& PluginRegistry::instance() {
+    static PluginRegistry registry;
+    return registry;
+}
+
+void PluginRegistry::load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::find(loaded_paths_.begin(), loaded_paths_.end(), path) != loaded_paths_.end()) {
+        return;
+    }
+
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        const char* message = dlerror();
+        throw std::runtime_error("Cannot load plugin " + path + ": " +
+                                 (message ? message : "unknown error"));
+    }
+
+    auto fail = [&](const std::string& message) {
+        dlclose(handle);
+        throw std::runtime_error("Plugin " + path + ": " + message);
+    };
+
+    auto init = reinterpret_cast<flowgen_plugin_init_fn>(dlsym(handle, FLOWGEN_PLUGIN_INIT_SYMBOL));
+    if (!init) {
+        fail(std::string("missing ") + FLOWGEN_PLUGIN_INIT_SYMBOL);
+    }
+    const flowgen_plugin* plugin = init(FLOWGEN_PLUGIN_ABI_VERSION);
+    if (!plugin) {
+        plugin = init(1);
+    }
+    if (!plugin || plugin->abi_version == 0 || plugin->abi_version > FLOWGEN_PLUGIN_ABI_VERSION) {
+        fail("unsupported ABI version (host is " + std::to_string(FLOWGEN_PLUGIN_ABI_VERSION) + ")");
+    }
+
+    // Version 1 types are copied into current-layout structs without a reset hook
+    std::vector<flowgen_pattern_type> legacy;
+    if (plugin->abi_version == 1) {
+        const auto* types = reinterpret_cast<const PatternTypeV1*>(plugin->types);
+        for (size_t i = 0; i < plugin->type_count; ++i) {
+            legacy.push_back({types[i].name, types[i].create, types[i].generate,
+                              types[i].destroy, nullptr});
+        }
+    }
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < plugin->type_count; ++i) {
+        const flowgen_pattern_type& type = legacy.empty() ? plugin->types[i] : legacy[i];
+        if (!type.name || !type.create || !type.generate || !type.destroy) {
+            fail("incomplete pattern type at index " + std::to_string(i));
+        }
+        std::string name = to_lower(type.name);
+        if (types_.count(name) ||
+            std::find(names.begin(), names.end(), name) != names.end()) {
+            fail("pattern type '" + name + "' is already registered");
+        }
+        names.push_back(name);
+    }
+
+    // Libraries are never closed: pattern instances may still reference them
+    for (size_t i = 0; i < plugin->type_count; ++i) {
+        if (legacy.empty()) {
+            types_[names[i]] = &plugin->types[i];
+        } else {
+            legacy_types_.push_back(legacy[i]);
+            types_[names[i]] = &legacy_types_.back();
+        }
+    }
+    loaded_paths_.push_back(path);
+}
+
+void PluginRegistry::load_directory(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        throw std::runtime_error("Cannot open plugin directory: " + directory);
+    }
+    std::vector<std::string> files;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (has_suffix(name, PLUGIN_SUFFIX)) {
+            files.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        load(directory + "/" + file);
+    }
+}
+
+void PluginRegistry::load_environment() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (environment_loaded_) {
+            return;
+        }
+        environment_loaded_ = true;
+    }
+
+    const char* path = std::getenv(PLUGIN_PATH_ENV);
+    if (!path) {
+        return;
+    }
+    std::string paths = path;
+    size_t start = 0;
+    while (start <= paths.size()) {
+        size_t colon = paths.find(':', start);
+        std::string directory = paths.substr(start, colon == std::string::npos ? std::string::npos
+                                                                                : colon - start);
+        start = colon == std::string::npos ? paths.size() + 1 : colon + 1;
+        struct stat info;
+        // Like $PATH, entries that do not exist are skipped
+        if (!directory.empty() && stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+            load_directory(directory);
+        }
+    }
+}
+
+const flowgen_pattern_type* PluginRegistry::find(const std::string& type) {
+    load_environment();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = types_.find(to_lower(type));
+    return it == types_.end() ? nullptr : it->second;
+}
+
+std::vector<std::string> PluginRegistry::pattern_types() {
+    load_environment();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto& entry : types_) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+// PluginPattern
+
+PluginPattern::PluginPattern(std::string name, const flowgen_pattern_type* plugin_type)
+    : name_(std::move(name)),
+      plugin_type_(plugin_type),
+      env_(),
+      source_ip_(BATCH_SIZE),
+      destination_ip_(BATCH_SIZE),
+      source_port_(BATCH_SIZE),
+      destination_port_(BATCH_SIZE),
+      protocol_(BATCH_SIZE),
+      packet_length_(BATCH_SIZE),
+      packet_count_(BATCH_SIZE),
+      byte_count_(BATCH_SIZE),
+      duration_ns_(BATCH_SIZE) {
+    env_.abi_version = FLOWGEN_PLUGIN_ABI_VERSION;
+    env_.rng = this;
+    env_.random_u32 = random_u32;
+    env_.random_unit = random_unit;
+    env_.endpoints = this;
+    env_.sample_endpoints = sample_endpoints;
+    env_.sample_sources = sample_sources;
+    env_.sample_destinations = sample_destinations;
+}
+
+PluginPattern::~PluginPattern() {
+    if (instance_) {
+        plugin_type_->destroy(instance_);
+    }
+}
+
+void PluginPattern::configure(const std::map<std::string, std::string>& config) {
+    PatternGenerator::configure(config);
+    if (!source_pool_ || !destination_pool_) {
+        throw std::runtime_error("Plugin pattern '" + name_ + "' requires address pools");
+    }
+
+    std::vector<const char*> keys;
+    std::vector<const char*> values;
+    for (const auto& entry : config) {
+        keys.push_back(entry.first.c_str());
+        values.push_back(entry.second.c_str());
+    }
+
+    if (instance_) {
+        plugin_type_->destroy(instance_);
+        instance_ = nullptr;
+    }
+    char error[256] = {};
+    instance_ = plugin_type_->create(&env_, keys.data(), values.data(), config.size(),
+                                     error, sizeof(error));
+    if (!instance_) {
+        throw std::runtime_error("Plugin pattern '" + name_ + "': " +
+                                 (error[0] ? error : "invalid configuration"));
+    }
+    position_ = count_ = 0;
+}
+
+bool PluginPattern::reset() {
+    bool rewound = PatternGenerator::reset();
+    position_ = count_ = 0;
+    if (!instance_) {
+        return rewound;
+    }
+    if (!plugin_type_->reset) {
+        return false;
+    }
+    plugin_type_->reset(instance_);
+    return rewound;
+}
+
+void PluginPattern::refill(uint64_t timestamp_ns) {
+    flowgen_pattern_batch batch;
+    batch.count = BATCH_SIZE;
+    batch.start_ns = timestamp_ns;
+    batch.source_ip = source_ip_.data();
+    batch.destination_ip = destination_ip_.data();
+    batch.source_port = source_port_.data();
+    batch.destination_port = destination_port_.data();
+    batch.protocol = protocol_.data();
+    batch.packet_length = packet_length_.data();
+    batch.packet_count = packet_count_.data();
+    batch.byte_count = byte_count_.data();
+    batch.duration_ns = duration_ns_.data();
+    batch.stats_filled = 0;
+
+    plugin_type_->generate(instance_, &batch);
+    stats_filled_ = batch.stats_filled != 0;
+    position_ = 0;
+    count_ = BATCH_SIZE;
+}
+
+FlowRecord PluginPattern::generate(
+    uint64_t timestamp_ns,
+    const std::vector<std::string>& /*src_subnets*/,
+    const std::vector<std::string>& /*dst_subnets*/,
+    const std::vector<double>& /*src_weights*/,
+    uint32_t min_pkt_size,
+    uint32_t max_pkt_size) {
+
+    if (!instance_) {
+        throw std::runtime_error("Plugin pattern '" + name_ + "' is not configured");
+    }
+    if (position_ == count_) {
+        env_.min_packet_size = min_pkt_size;
+        env_.max_packet_size = max_pkt_size;
+        refill(timestamp_ns);
+    }
+
+    size_t i = position_++;
+    return FlowRecord(source_ip_[i], destination_ip_[i], source_port_[i], destination_port_[i],
+                      protocol_[i], timestamp_ns, packet_length_[i]);
+}
+
+bool PluginPattern::generate_stats(const FlowRecord& /*flow*/, FlowStats& stats) {
+    if (!stats_filled_ || position_ == 0) {
+        return false;
+    }
+    size_t i = position_ - 1;
+    stats.packet_count = packet_count_[i];
+    stats.byte_count = byte_count_[i];
+    stats.duration_ns = duration_ns_[i];
+    return true;
+}
+
+void PluginPattern::sample_endpoints(void* self, uint32_t* source_ip, uint32_t* destination_ip,
+                                     size_t n) {
+    const auto& pattern = *static_cast<const PluginPattern*>(self);
+    if (pattern.graph_) {
+        for (size_t i = 0; i < n; ++i) {
+            pattern.graph_->sample(source_ip[i], destination_ip[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        source_ip[i] = pattern.source_pool_->sample();
+        destination_ip[i] = pattern.destination_pool_->sample();
+    }
+}
+
+void PluginPattern::sample_sources(void* self, uint32_t* out, size_t n) {
+    const auto& pattern = *static_cast<const PluginPattern*>(self);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = pattern.source_pool_->sample();
+    }
+}
+
+void PluginPattern::sample_destinations(void* self, uint32_t* out, size_t n) {
+    const auto& pattern = *static_cast<const PluginPattern*>(self);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = pattern.destination_pool_->sample();
+    }
+}
+
+} // namespace flowgen
@@ -0,0 +1,613 @@
+#include "flowgen/profile.hpp"
+#include "flowgen/sinks.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+constexpr int PROFILE_VERSION = 1;
+
+inline uint32_t service_key(uint8_t protocol, uint16_t port) {
+    return (static_cast<uint32_t>(protocol) << 16) | port;
+}
+
+inline uint32_t prefix_mask(uint8_t prefix_length) {
+    return prefix_length == 0 ? 0 : (0xFFFFFFFFu << (32 - prefix_length));
+}
+
+template<typename T>
+inline T clamp_round(double value, T lo, T hi) {
+    double r = std::round(value);
+    if (r < static_cast<double>(lo)) return lo;
+    if (r > static_cast<double>(hi)) return hi;
+    return static_cast<T>(r);
+}
+
+template<typename Map>
+std::vector<std::pair<typename Map::key_type, uint64_t>> top_counts(const Map& counts, size_t limit) {
+    std::vector<std::pair<typename Map::key_type, uint64_t>> sorted(counts.begin(), counts.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (limit > 0 && sorted.size() > limit) {
+        sorted.resize(limit);
+    }
+    return sorted;
+}
+
+std::vector<PrefixWeight> normalize_prefixes(const std::unordered_map<uint32_t, uint64_t>& counts,
+                                             size_t limit) {
+    auto top = top_counts(counts, limit);
+    uint64_t total = 0;
+    for (const auto& [prefix, count] : top) {
+        total += count;
+    }
+
+    std::vector<PrefixWeight> result;
+    result.reserve(top.size());
+    for (const auto& [prefix, count] : top) {
+        result.push_back({prefix, static_cast<double>(count) / static_cast<double>(total)});
+    }
+    return result;
+}
+
+void write_table(std::ostream& out, const char* name, const InverseCdfTable& table) {
+    if (table.empty()) {
+        return;
+    }
+    out << "  " << name;
+    for (double v : table.points()) {
+        out << ' ' << v;
+    }
+    out << '\n';
+}
+
+// ========== Flow file readers ==========
+
+/**
+ * Column positions in a CSV header (-1 = absent)
+ */
+struct CsvColumns {
+    int timestamp = -1;
+    int last_timestamp = -1;
+    int source_ip = -1;
+    int destination_ip = -1;
+    int source_port = -1;
+    int destination_port = -1;
+    int protocol = -1;
+    int packet_length = -1;
+    int packet_count = -1;
+    int byte_count = -1;
+    int duration_ns = -1;
+};
+
+CsvColumns map_csv_header(const std::vector<std::string>& names) {
+    CsvColumns cols;
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::string name = names[i];
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        int idx = static_cast<int>(i);
+
+        if (name == "timestamp" || name == "first_timestamp" || name == "ts") {
+            cols.timestamp = idx;
+        } else if (name == "last_timestamp") {
+            cols.last_timestamp = idx;
+        } else if (name == "src_ip" || name == "source_ip") {
+            cols.source_ip = idx;
+        } else if (name == "dst_ip" || name == "destination_ip") {
+            cols.destination_ip = idx;
+        } else if (name == "src_port" || name == "source_port") {
+            cols.source_port = idx;
+        } else if (name == "dst_port" || name == "destination_port") {
+            cols.destination_port = idx;
+        } else if (name == "protocol" || name == "proto") {
+            cols.protocol = idx;
+        } else if (name == "length" || name == "packet_length") {
+            cols.packet_length = idx;
+        } else if (name == "packet_count" || name == "packets") {
+            cols.packet_count = idx;
+        } else if (name == "byte_count" || name == "bytes") {
+            cols.byte_count = idx;
+        } else if (name == "duration_ns" || name == "duration") {
+            cols.duration_ns = idx;
+        }
+    }
+
+    if (cols.source_ip < 0 || cols.destination_ip < 0 || cols.source_port < 0 ||
+        cols.destination_port < 0 || cols.protocol < 0) {
+        throw std::runtime_error("CSV header must contain src_ip, dst_ip, src_port, dst_port and protocol");
+    }
+    if (cols.packet_length < 0 && (cols.byte_count < 0 || cols.packet_count < 0)) {
+        throw std::runtime_error("CSV header must contain length, or packet_count and byte_count");
+    }
+    return cols;
+}
+
+void split_csv(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t start = 0;
+    while (true) {
+        size_t comma = line.find(',', start);
+        size_t end = comma == std::string::npos ? line.size() : comma;
+        size_t e = end;
+        if (e > start && line[e - 1] == '\r') --e;
+        fields.emplace_back(line, start, e - start);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+}
+
+inline uint32_t parse_ip_field(const std::string& field) {
+    if (field.find('.') != std::string::npos) {
+        return utils::ip_str_to_uint32(field);
+    }
+    return static_cast<uint32_t>(std::stoul(field));
+}
+
+inline uint64_t parse_u64(const std::string& field) {
+    return field.empty() ? 0 : std::stoull(field);
+}
+
+void learn_csv(std::istream& in, ProfileLearner& learner) {
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error("Flow file is empty");
+    }
+
+    std::vector<std::string> fields;
+    split_csv(line, fields);
+    CsvColumns cols = map_csv_header(fields);
+    bool has_stats = cols.packet_count >= 0;
+
+    FlowRecord flow;
+    FlowStats stats;
+    uint64_t line_number = 1;
+
+    while (std::getline(in, line)) {
+        line_number++;
+        if (line.empty() || line == "\r") continue;
+        split_csv(line, fields);
+
+        try {
+            flow.timestamp = cols.timestamp >= 0 ? parse_u64(fields.at(cols.timestamp)) : 0;
+            flow.source_ip = parse_ip_field(fields.at(cols.source_ip));
+            flow.destination_ip = parse_ip_field(fields.at(cols.destination_ip));
+            flow.source_port = static_cast<uint16_t>(parse_u64(fields.at(cols.source_port)));
+            flow.destination_port = static_cast<uint16_t>(parse_u64(fields.at(cols.destination_port)));
+            flow.protocol = static_cast<uint8_t>(parse_u64(fields.at(cols.protocol)));
+
+            if (has_stats) {
+                stats.packet_count = static_cast<uint32_t>(parse_u64(fields.at(cols.packet_count)));
+                if (stats.packet_count == 0) stats.packet_count = 1;
+            }
+
+            if (has_stats && cols.byte_count >= 0) {
+                stats.byte_count = parse_u64(fields.at(cols.byte_count));
+                flow.packet_length = static_cast<uint32_t>(stats.byte_count / stats.packet_count);
+            } else {
+                flow.packet_length = static_cast<uint32_t>(parse_u64(fields.at(cols.packet_length)));
+                stats.byte_count = static_cast<uint64_t>(flow.packet_length) *
+                                   (has_stats ? stats.packet_count : 1);
+            }
+
+            if (cols.duration_ns >= 0) {
+                stats.duration_ns = parse_u64(fields.at(cols.duration_ns));
+            } else if (cols.last_timestamp >= 0 && cols.timestamp >= 0) {
+                uint64_t last = parse_u64(fields.at(cols.last_timestamp));
+                stats.duration_ns = last > flow.timestamp ? last - flow.timestamp : 0;
+            } else {
+                stats.duration_ns = 0;
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Invalid flow at line " + std::to_string(line_number) +
+                                     ": " + e.what());
+        }
+
+        learner.add(flow, has_stats ? &stats : nullptr);
+    }
+}
+
+template<typename T>
+inline T read_le(const unsigned char* p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return static_cast<T>(v);
+}
+
+void learn_binary(std::istream& in, ProfileLearner& learner) {
+    unsigned char header[8];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    uint16_t version = read_le<uint16_t>(header + 4);
+    uint16_t record_size = read_le<uint16_t>(header + 6);
+    if (version != BinaryFlowHeader::VERSION || record_size < BinaryFlowHeader::RECORD_SIZE) {
+        throw std::runtime_error("Unsupported binary flow file version");
+    }
+
+    std::vector<unsigned char> record(record_size);
+    FlowRecord flow;
+    while (in.read(reinterpret_cast<char*>(record.data()), record_size)) {
+        const unsigned char* p = record.data();
+        flow.timestamp = read_le<uint64_t>(p);
+        flow.source_ip = read_le<uint32_t>(p + 8);
+        flow.destination_ip = read_le<uint32_t>(p + 12);
+        flow.source_port = read_le<uint16_t>(p + 16);
+        flow.destination_port = read_le<uint16_t>(p + 18);
+        flow.protocol = p[20];
+        flow.packet_length = read_le<uint32_t>(p + 24);
+        learner.add(flow, nullptr);
+    }
+}
+
+} // namespace
+
+// ========== TrafficProfile ==========
+
+bool TrafficProfile::has_flow_stats() const {
+    return !services.empty() && !services.front().packet_count.empty();
+}
+
+void TrafficProfile::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open profile for writing: " + path);
+    }
+
+    out << std::setprecision(10);
+    out << "# flowgen traffic profile\n";
+    out << "version " << PROFILE_VERSION << '\n';
+    out << "flows " << flow_count << '\n';
+    out << "prefix_length " << static_cast<int>(prefix_length) << '\n';
+
+    for (const auto& p : source_prefixes) {
+        out << "src_prefix " << utils::uint32_to_ip_str(p.prefix) << ' ' << p.weight << '\n';
+    }
+    for (const auto& p : destination_prefixes) {
+        out << "dst_prefix " << utils::uint32_to_ip_str(p.prefix) << ' ' << p.weight << '\n';
+    }
+
+    for (const auto& s : services) {
+        out << "service " << static_cast<int>(s.protocol) << ' ' << s.port << ' ' << s.weight << '\n';
+        write_table(out, "src_port", s.source_port);
+        write_table(out, "packet_length", s.packet_length);
+        write_table(out, "packet_count", s.packet_count);
+        write_table(out, "duration_ns", s.duration_ns);
+    }
+
+    if (!out) {
+        throw std::runtime_error("Failed to write profile: " + path);
+    }
+}
+
+TrafficProfile TrafficProfile::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open profile: " + path);
+    }
+
+    TrafficProfile profile;
+    std::string line;
+    uint64_t line_number = 0;
+
+    auto read_points = [](std::istringstream& iss) {
+        std::vector<double> points;
+        double v;
+        while (iss >> v) {
+            points.push_back(v);
+        }
+        return InverseCdfTable(std::move(points));
+    };
+
+    while (std::getline(in, line)) {
+        line_number++;
+        std::istringstream iss(line);
+        std::string keyword;
+        if (!(iss >> keyword) || keyword[0] == '#') {
+            continue;
+        }
+
+        try {
+            if (keyword == "version") {
+                int version = 0;
+                iss >> version;
+                if (version != PROFILE_VERSION) {
+                    throw std::runtime_error("unsupported profile version " + std::to_string(version));
+                }
+            } else if (keyword == "flows") {
+                iss >> profile.flow_count;
+            } else if (keyword == "prefix_length") {
+                int len = 0;
+                iss >> len;
+                if (len < 0 || len > 32) {
+                    throw std::runtime_error("prefix_length must be 0-32");
+                }
+                profile.prefix_length = static_cast<uint8_t>(len);
+            } else if (keyword == "src_prefix" || keyword == "dst_prefix") {
+                std::string ip;
+                PrefixWeight p;
+                if (!(iss >> ip >> p.weight)) {
+                    throw std::runtime_error("expected '<prefix> <weight>'");
+                }
+                p.prefix = utils::ip_str_to_uint32(ip);
+                (keyword == "src_prefix" ? profile.source_prefixes : profile.destination_prefixes).push_back(p);
+            } else if (keyword == "service") {
+                int protocol = 0;
+                int port = 0;
+                ServiceProfile s;
+                if (!(iss >> protocol >> port >> s.weight)) {
+                    throw std::runtime_error("expected '<protocol> <port> <weight>'");
+                }
+                s.protocol = static_cast<uint8_t>(protocol);
+                s.port = static_cast<uint16_t>(port);
+                profile.services.push_back(std::move(s));
+            } else if (keyword == "src_port" || keyword == "packet_length" ||
+                       keyword == "packet_count" || keyword == "duration_ns") {
+                if (profile.services.empty()) {
+                    throw std::runtime_error(keyword + " before any service");
+                }
+                ServiceProfile& s = profile.services.back();
+                InverseCdfTable table = read_points(iss);
+                if (keyword == "src_port") s.source_port = std::move(table);
+                else if (keyword == "packet_length") s.packet_length = std::move(table);
+                else if (keyword == "packet_count") s.packet_count = std::move(table);
+                else s.duration_ns = std::move(table);
+            } else {
+                throw std::runtime_error("unknown keyword '" + keyword + "'");
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Invalid profile " + path + " at line " +
+                                     std::to_string(line_number) + ": " + e.what());
+        }
+    }
+
+    if (profile.services.empty()) {
+        throw std::runtime_error("Profile contains no services: " + path);
+    }
+    for (const auto& s : profile.services) {
+        if (s.source_port.empty() || s.packet_length.empty()) {
+            throw std::runtime_error("Profile service " + std::to_string(s.port) +
+                                     " is missing src_port or packet_length: " + path);
+        }
+        if (s.packet_count.empty() != s.duration_ns.empty()) {
+            throw std::runtime_error("Profile service " + std::to_string(s.port) +
+                                     " needs both packet_count and duration_ns or neither: " + path);
+        }
+    }
+
+    return profile;
+}
+
+// ========== ProfileLearner ==========
+
+ProfileLearner::ProfileLearner(const ProfileLearnOptions& options)
+    : options_(options),
+      prefix_mask_(prefix_mask(options.prefix_length)),
+      flow_count_(0),
+      has_stats_(false),
+      rng_(0x666C6F7770726F66ULL) {  // Fixed seed: same input, same profile
+    if (options_.prefix_length > 32) {
+        throw std::runtime_error("prefix_length must be 0-32");
+    }
+    if (options_.reservoir_size == 0) {
+        options_.reservoir_size = 1;
+    }
+}
+
+void ProfileLearner::add(const FlowRecord& flow, const FlowStats* stats) {
+    flow_count_++;
+    source_prefixes_[flow.source_ip & prefix_mask_]++;
+    destination_prefixes_[flow.destination_ip & prefix_mask_]++;
+
+    Sample sample;
+    sample.source_port = flow.source_port;
+    sample.packet_length = flow.packet_length;
+    sample.packet_count = stats ? static_cast<double>(stats->packet_count) : 0.0;
+    sample.duration_ns = stats ? static_cast<double>(stats->duration_ns) : 0.0;
+    if (stats) {
+        has_stats_ = true;
+    }
+
+    // Reservoir sampling keeps a uniform sample of each service's flows
+    ServiceState& state = services_[service_key(flow.protocol, flow.destination_port)];
+    state.count++;
+    if (state.reservoir.size() < options_.reservoir_size) {
+        state.reservoir.push_back(sample);
+    } else {
+        uint64_t j = rng_() % state.count;
+        if (j < options_.reservoir_size) {
+            state.reservoir[j] = sample;
+        }
+    }
+}
+
+TrafficProfile ProfileLearner::build() const {
+    if (flow_count_ == 0) {
+        throw std::runtime_error("Cannot build a profile from zero flows");
+    }
+
+    TrafficProfile profile;
+    profile.flow_count = flow_count_;
+    profile.prefix_length = options_.prefix_length;
+    profile.source_prefixes = normalize_prefixes(source_prefixes_, options_.max_prefixes);
+    profile.destination_prefixes = normalize_prefixes(destination_prefixes_, options_.max_prefixes);
+
+    std::unordered_map<uint32_t, uint64_t> service_counts;
+    for (const auto& [key, state] : services_) {
+        service_counts[key] = state.count;
+    }
+    auto top = top_counts(service_counts, options_.max_services);
+
+    uint64_t total = 0;
+    for (const auto& [key, count] : top) {
+        total += count;
+    }
+
+    std::vector<double> values;
+    for (const auto& [key, count] : top) {
+        const ServiceState& state = services_.at(key);
+
+        ServiceProfile s;
+        s.protocol = static_cast<uint8_t>(key >> 16);
+        s.port = static_cast<uint16_t>(key & 0xFFFF);
+        s.weight = static_cast<double>(count) / static_cast<double>(total);
+
+        auto column = [&](double Sample::*field) {
+            values.clear();
+            for (const Sample& sample : state.reservoir) {
+                values.push_back(sample.*field);
+            }
+            return InverseCdfTable::from_samples(values, options_.resolution);
+        };
+
+        s.source_port = column(&Sample::source_port);
+        s.packet_length = column(&Sample::packet_length);
+        if (has_stats_) {
+            s.packet_count = column(&Sample::packet_count);
+            s.duration_ns = column(&Sample::duration_ns);
+        }
+        profile.services.push_back(std::move(s));
+    }
+
+    return profile;
+}
+
+TrafficProfile learn_profile(const std::string& path, const ProfileLearnOptions& options) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open flow file: " + path);
+    }
+
+    ProfileLearner learner(options);
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    in.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    bool is_binary = in.gcount() == 4 && read_le<uint32_t>(magic) == BinaryFlowHeader::MAGIC;
+    in.clear();
+    in.seekg(0);
+
+    if (is_binary) {
+        learn_binary(in, learner);
+    } else {
+        learn_csv(in, learner);
+    }
+
+    return learner.build();
+}
+
+// ========== ProfilePattern ==========
+
+ProfilePattern::ProfilePattern(std::shared_ptr<const TrafficProfile> profile)
+    : profile_(std::move(profile)),
+      host_mask_(0),
+      last_service_(0) {
+    if (!profile_ || profile_->services.empty()) {
+        throw std::runtime_error("Profile pattern requires a profile with at least one service");
+    }
+
+    std::vector<double> weights;
+    for (size_t i = 0; i < profile_->services.size(); ++i) {
+        const ServiceProfile& s = profile_->services[i];
+        weights.push_back(s.weight);
+        service_index_.emplace(static_cast<uint32_t>(s.protocol) << 16 | s.port, i);
+    }
+    services_.build(weights);
+
+    if (!profile_->source_prefixes.empty()) {
+        weights.clear();
+        for (const auto& p : profile_->source_prefixes) weights.push_back(p.weight);
+        source_prefixes_.build(weights);
+    }
+    if (!profile_->destination_prefixes.empty()) {
+        weights.clear();
+        for (const auto& p : profile_->destination_prefixes) weights.push_back(p.weight);
+        destination_prefixes_.build(weights);
+    }
+
+    host_mask_ = ~prefix_mask(profile_->prefix_length);
+}
+
+FlowRecord ProfilePattern::generate(
+    uint64_t timestamp_ns,
+    const std::vector<std::string>& src_subnets,
+    const std::vector<std::string>& dst_subnets,
+    const std::vector<double>& src_weights,
+    uint32_t min_pkt_size,
+    uint32_t max_pkt_size) {
+
+    auto& rng = utils::Random::instance();
+
+    last_service_ = services_.sample(rng.uniform());
+    const ServiceProfile& s = profile_->services[last_service_];
+
+    // Learned prefix popularity, uniform host within the prefix
+    uint32_t src_ip;
+    if (!source_prefixes_.empty()) {
+        src_ip = profile_->source_prefixes[source_prefixes_.sample(rng.uniform())].prefix |
+                 (rng.rand32() & host_mask_);
+    } else {
+        src_ip = utils::random_ip_from_subnets_uint32(src_subnets, src_weights);
+    }
+
+    uint32_t dst_ip;
+    if (!destination_prefixes_.empty()) {
+        dst_ip = profile_->destination_prefixes[destination_prefixes_.sample(rng.uniform())].prefix |
+                 (rng.rand32() & host_mask_);
+    } else {
+        dst_ip = utils::random_ip_from_subnets_uint32(dst_subnets);
+    }
+
+    uint16_t src_port = clamp_round<uint16_t>(s.source_port.sample(rng.uniform()), 0, 65535);
+    uint32_t pkt_len = clamp_round<uint32_t>(s.packet_length.sample(rng.uniform()),
+                                             min_pkt_size, max_pkt_size);
+
+    return FlowRecord(src_ip, dst_ip, src_port, s.port, s.protocol, timestamp_ns, pkt_len);
+}
+
+bool ProfilePattern::generate_stats(const FlowRecord& flow, FlowStats& stats) {
+    return fill_stats(profile_->services[last_service_], flow, stats);
+}
+
+bool ProfilePattern::session_stats(const FlowRecord& flow, FlowStats& stats) {
+    auto it = service_index_.find(static_cast<uint32_t>(flow.protocol) << 16 | flow.destination_port);
+    return it != service_index_.end() && fill_stats(profile_->services[it->second], flow, stats);
+}
+
+bool ProfilePattern::fill_stats(const ServiceProfile& s, const FlowRecord& flow, FlowStats& stats) const {
+    if (s.packet_count.empty() || s.duration_ns.empty()) {
+        return false;
+    }
+
+    // One variate for both: longer flows have more packets (comonotonic)
+    double u = utils::Random::instance().uniform();
+    stats.packet_count = clamp_round<uint32_t>(s.packet_count.sample(u), 1, UINT32_MAX);
+    stats.duration_ns = stats.packet_count == 1 ? 0 :
+        clamp_round<uint64_t>(s.duration_ns.sample(u), 0, UINT64_MAX);
+    stats.byte_count = static_cast<uint64_t>(stats.packet_count) * flow.packet_length;
+    return true;
+}
+
+std::shared_ptr<const TrafficProfile> load_shared_profile(const std::string& path) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const TrafficProfile>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = cache[path];
+    if (auto profile = entry.lock()) {
+        return profile;
+    }
+
+    auto profile = std::make_shared<const TrafficProfile>(TrafficProfile::load(path));
+    entry = profile;
+    return profile;
+}
+
+} // namespace flowgen
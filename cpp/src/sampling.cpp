@@ -0,0 +1,172 @@
+#include "flowgen/sampling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+uint64_t parse_number(const std::string& key, const std::string& value, uint64_t max_value) {
+    try {
+        size_t pos = 0;
+        unsigned long long number = std::stoull(value, &pos, 0);
+        if (pos != value.size() || number > max_value) {
+            throw std::out_of_range(value);
+        }
+        return number;
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("Invalid sampling value " + key + "=" + value);
+    }
+}
+
+} // namespace
+
+SamplingOptions SamplingOptions::parse(const std::string& spec) {
+    SamplingOptions options;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string term = trim(spec.substr(start, comma == std::string::npos ? std::string::npos
+                                                                               : comma - start));
+        start = comma == std::string::npos ? spec.size() + 1 : comma + 1;
+        if (term.empty()) {
+            continue;
+        }
+
+        size_t eq = term.find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error("Invalid sampling term (expected key=value): " + term);
+        }
+        std::string key = trim(term.substr(0, eq));
+        std::string value = trim(term.substr(eq + 1));
+
+        if (key == "flows") {
+            options.flow_rate = static_cast<uint32_t>(parse_number(key, value, UINT32_MAX));
+        } else if (key == "packets") {
+            options.packet_rate = static_cast<uint32_t>(parse_number(key, value, UINT32_MAX));
+        } else if (key == "mode") {
+            if (value == "count") {
+                options.mode = FlowSamplingMode::COUNT;
+            } else if (value == "random") {
+                options.mode = FlowSamplingMode::RANDOM;
+            } else if (value == "hash") {
+                options.mode = FlowSamplingMode::HASH;
+            } else {
+                throw std::runtime_error("Unknown sampling mode: " + value +
+                                         " (valid: count, random, hash)");
+            }
+        } else if (key == "seed") {
+            options.seed = parse_number(key, value, UINT64_MAX);
+        } else if (key == "rescale") {
+            options.rescale = parse_number(key, value, 1) != 0;
+        } else {
+            throw std::runtime_error("Unknown sampling key: " + key);
+        }
+    }
+    if (options.flow_rate == 0 || options.packet_rate == 0) {
+        throw std::runtime_error("Sampling rates must be positive: " + spec);
+    }
+    return options;
+}
+
+SamplerTransform::SamplerTransform(const SamplingOptions& options)
+    : options_(options),
+      state_(utils::mix64(options.seed ^ 0x73616D706C6572ULL)),  // "sampler"
+      position_(options.flow_rate > 0 ? options.seed % options.flow_rate : 0),
+      hash_threshold_(options.flow_rate > 1 ? UINT64_MAX / options.flow_rate : UINT64_MAX),
+      log_skip_(options.packet_rate > 1 ? std::log1p(-1.0 / options.packet_rate) : 0.0) {
+    if (options_.flow_rate == 0 || options_.packet_rate == 0) {
+        throw std::runtime_error("Sampling rates must be positive");
+    }
+}
+
+uint32_t SamplerTransform::sample_packets(uint32_t packets) {
+    double p = 1.0 / options_.packet_rate;
+    double mean = packets * p;
+    if (mean > 64.0) {
+        // Normal approximation of the binomial
+        double u1 = next_uniform();
+        double u2 = next_uniform();
+        double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        double k = std::round(mean + z * std::sqrt(mean * (1.0 - p)));
+        return static_cast<uint32_t>(std::min<double>(std::max(k, 0.0), packets));
+    }
+
+    // Jump from one sampled packet to the next with geometric skips
+    uint32_t sampled = 0;
+    double position = -1.0;
+    while (true) {
+        position += 1.0 + std::floor(std::log(next_uniform()) / log_skip_);
+        if (position >= packets) {
+            return sampled;
+        }
+        ++sampled;
+    }
+}
+
+void SamplerTransform::apply(FlowBatch& batch, std::vector<FlowStats>& stats) {
+    size_t n = batch.size();
+    flows_seen_ += n;
+    if (options_.flow_rate == 1 && options_.packet_rate == 1) {
+        flows_kept_ += n;
+        return;
+    }
+    selected_.assign(n, 1);
+
+    uint32_t rate = options_.flow_rate;
+    if (rate > 1) {
+        switch (options_.mode) {
+        case FlowSamplingMode::COUNT: {
+            // Keep the flows at stream positions that are multiples of rate
+            uint64_t first = (rate - position_ % rate) % rate;
+            std::fill(selected_.begin(), selected_.end(), 0);
+            for (uint64_t i = first; i < n; i += rate) {
+                selected_[i] = 1;
+            }
+            position_ += n;
+            break;
+        }
+        case FlowSamplingMode::RANDOM:
+            for (size_t i = 0; i < n; ++i) {
+                selected_[i] = next_random() < hash_threshold_;
+            }
+            break;
+        case FlowSamplingMode::HASH:
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t hash = utils::mix64(canonical_flow_hash(batch, i) ^ options_.seed);
+                selected_[i] = hash < hash_threshold_;
+            }
+            break;
+        }
+    }
+
+    if (options_.packet_rate > 1) {
+        double scale = options_.rescale ? options_.packet_rate : 1.0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!selected_[i]) {
+                continue;
+            }
+            FlowStats& s = stats[i];
+            uint32_t sampled = sample_packets(s.packet_count);
+            if (sampled == 0) {
+                selected_[i] = 0;
+                continue;
+            }
+            double bytes_per_packet = static_cast<double>(s.byte_count) / s.packet_count;
+            s.packet_count = static_cast<uint32_t>(std::min<double>(sampled * scale, UINT32_MAX));
+            s.byte_count = static_cast<uint64_t>(std::llround(bytes_per_packet * sampled * scale));
+        }
+    }
+
+    flows_kept_ += retain_rows(batch, stats, selected_);
+}
+
+} // namespace flowgen
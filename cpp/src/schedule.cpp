@@ -0,0 +1,207 @@
+#include "flowgen/schedule.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+constexpr size_t MAX_SEGMENTS = 1 << 22;
+
+struct Knot {
+    double time_s;
+    double bandwidth_gbps;
+    const std::vector<double>* mix;
+};
+
+uint64_t seconds_to_ns(double seconds) {
+    return static_cast<uint64_t>(std::llround(seconds * 1e9));
+}
+
+uint64_t saturating_add(uint64_t a, uint64_t b) {
+    return b > UINT64_MAX - a ? UINT64_MAX : a + b;
+}
+
+} // namespace
+
+bool ScheduleOptions::validate(size_t pattern_count, std::string* error) const {
+    if (!enabled()) {
+        return true;
+    }
+    if (interpolation != "step" && interpolation != "linear") {
+        if (error) *error = "schedule.interpolation must be 'step' or 'linear'";
+        return false;
+    }
+    if (period_s < 0.0) {
+        if (error) *error = "schedule.period_s must be >= 0";
+        return false;
+    }
+    if (interpolation == "linear" && resolution_s <= 0.0) {
+        if (error) *error = "schedule.resolution_s must be greater than 0";
+        return false;
+    }
+
+    double previous = 0.0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const SchedulePoint& point = points[i];
+        std::string where = "schedule point " + std::to_string(i);
+        if (point.time_s < previous) {
+            if (error) *error = where + ": times must be non-negative and increasing";
+            return false;
+        }
+        previous = point.time_s;
+        if (point.rate <= 0.0) {
+            if (error) *error = where + ": rate must be greater than 0";
+            return false;
+        }
+        if (!point.mix.empty()) {
+            if (point.mix.size() != pattern_count) {
+                if (error) *error = where + ": mix needs one weight per traffic pattern";
+                return false;
+            }
+            double sum = 0.0;
+            for (double w : point.mix) {
+                if (w < 0.0) {
+                    if (error) *error = where + ": mix weights must be non-negative";
+                    return false;
+                }
+                sum += w;
+            }
+            if (sum <= 0.0) {
+                if (error) *error = where + ": mix weights must not all be zero";
+                return false;
+            }
+        }
+    }
+
+    if (period_s > 0.0 && points.back().time_s >= period_s) {
+        if (error) *error = "schedule point times must be less than period_s";
+        return false;
+    }
+    return true;
+}
+
+RateSchedule::RateSchedule(const ScheduleOptions& options,
+                           double base_bandwidth_gbps,
+                           const std::vector<double>& base_mix,
+                           uint32_t average_packet_size)
+    : pattern_count_(base_mix.size()) {
+    std::string error;
+    if (!options.validate(base_mix.size(), &error)) {
+        throw std::runtime_error(error);
+    }
+
+    if (!options.enabled()) {
+        add_segment(UINT64_MAX, base_bandwidth_gbps, base_mix, average_packet_size);
+        rewind(0);
+        return;
+    }
+
+    const auto& points = options.points;
+    auto knot_for = [&](const SchedulePoint& p, double time_s) {
+        return Knot{time_s, base_bandwidth_gbps * p.rate, p.mix.empty() ? &base_mix : &p.mix};
+    };
+
+    // Control points plus the values that apply around them
+    std::vector<Knot> knots;
+    double cover_end;
+    if (options.period_s > 0.0) {
+        knots.push_back(knot_for(points.back(), points.back().time_s - options.period_s));
+        for (const auto& p : points) knots.push_back(knot_for(p, p.time_s));
+        knots.push_back(knot_for(points.front(), points.front().time_s + options.period_s));
+        cover_end = options.period_s;
+        period_ns_ = seconds_to_ns(options.period_s);
+    } else {
+        if (points.front().time_s > 0.0) {
+            knots.push_back(Knot{0.0, base_bandwidth_gbps, &base_mix});
+        }
+        for (const auto& p : points) knots.push_back(knot_for(p, p.time_s));
+        cover_end = points.back().time_s;
+    }
+
+    bool linear = options.interpolation == "linear";
+    std::vector<double> mix(pattern_count_);
+
+    for (size_t k = 0; k + 1 < knots.size(); ++k) {
+        const Knot& a = knots[k];
+        const Knot& b = knots[k + 1];
+        double lo = std::max(a.time_s, 0.0);
+        double hi = std::min(b.time_s, cover_end);
+        if (hi <= lo) {
+            continue;
+        }
+
+        if (!linear) {
+            add_segment(seconds_to_ns(hi), a.bandwidth_gbps, *a.mix, average_packet_size);
+            continue;
+        }
+
+        // Subdivide and sample each piece at its midpoint
+        size_t pieces = static_cast<size_t>(std::ceil((hi - lo) / options.resolution_s));
+        if (segments_.size() + pieces > MAX_SEGMENTS) {
+            throw std::runtime_error("schedule needs too many segments; increase resolution_s");
+        }
+        for (size_t i = 0; i < pieces; ++i) {
+            double start = lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(pieces);
+            double end = lo + (hi - lo) * static_cast<double>(i + 1) / static_cast<double>(pieces);
+            double f = ((start + end) / 2.0 - a.time_s) / (b.time_s - a.time_s);
+            for (size_t j = 0; j < pattern_count_; ++j) {
+                mix[j] = (*a.mix)[j] + f * ((*b.mix)[j] - (*a.mix)[j]);
+            }
+            add_segment(seconds_to_ns(end),
+                        a.bandwidth_gbps + f * (b.bandwidth_gbps - a.bandwidth_gbps),
+                        mix, average_packet_size);
+        }
+    }
+
+    if (period_ns_ > 0) {
+        segments_.back().end_ns = period_ns_;
+    } else {
+        // Hold the last point for the rest of the run
+        const Knot& last = knots.back();
+        add_segment(UINT64_MAX, last.bandwidth_gbps, *last.mix, average_packet_size);
+    }
+
+    rewind(0);
+}
+
+void RateSchedule::add_segment(uint64_t end_ns, double bandwidth_gbps,
+                               const std::vector<double>& mix, uint32_t average_packet_size) {
+    if (!segments_.empty() && end_ns <= segments_.back().end_ns) {
+        return;  // Empty after rounding to nanoseconds
+    }
+
+    double flows_per_second = utils::calculate_flows_per_second(bandwidth_gbps, average_packet_size);
+    uint64_t inter_arrival_ns = std::max<uint64_t>(
+        1, static_cast<uint64_t>(1e9 / flows_per_second));
+
+    uint32_t offset = static_cast<uint32_t>(prob_.size());
+    prob_.resize(prob_.size() + pattern_count_);
+    alias_.resize(alias_.size() + pattern_count_);
+    AliasTable::build_into(mix.data(), pattern_count_, prob_.data() + offset, alias_.data() + offset);
+
+    segments_.push_back(ScheduleSegment{end_ns, inter_arrival_ns, bandwidth_gbps, offset});
+}
+
+void RateSchedule::rewind(uint64_t origin_ns) {
+    cursor_ = 0;
+    cycle_start_ns_ = origin_ns;
+    segment_end_ns_ = saturating_add(cycle_start_ns_, segments_[0].end_ns);
+}
+
+void RateSchedule::seek(uint64_t now_ns) {
+    uint64_t offset = now_ns - cycle_start_ns_;
+    if (period_ns_ > 0 && offset >= period_ns_) {
+        cycle_start_ns_ += (offset / period_ns_) * period_ns_;
+        offset = now_ns - cycle_start_ns_;
+        cursor_ = 0;
+    }
+    while (segments_[cursor_].end_ns <= offset) {
+        ++cursor_;
+    }
+    segment_end_ns_ = saturating_add(cycle_start_ns_, segments_[cursor_].end_ns);
+}
+
+} // namespace flowgen
@@ -0,0 +1,245 @@
+#include "flowgen/schema.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace flowgen {
+
+namespace {
+
+constexpr size_t FIELD_COUNT = static_cast<size_t>(FlowField::COUNT);
+
+const char* const FIELD_NAMES[FIELD_COUNT] = {
+    "tcp_flags", "tos", "vlan", "input_if", "output_if", "src_as", "dst_as", "next_hop", "ipv6",
+};
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+std::vector<std::string> split_list(const std::string& spec) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string item = trim(spec.substr(start, comma == std::string::npos ? std::string::npos
+                                                                               : comma - start));
+        start = comma == std::string::npos ? spec.size() + 1 : comma + 1;
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+template<typename T>
+void append_if(bool enabled, std::vector<T>& column, const std::vector<T>& source, size_t index) {
+    if (enabled) {
+        column.push_back(source[index]);
+    }
+}
+
+template<typename T>
+void retain_if(bool enabled, std::vector<T>& column, const uint8_t* selected) {
+    if (enabled) {
+        size_t kept = 0;
+        for (size_t i = 0; i < column.size(); ++i) {
+            column[kept] = column[i];
+            kept += selected[i] != 0;
+        }
+        column.resize(kept);
+    }
+}
+
+template<typename T>
+void resize_if(bool enabled, std::vector<T>& column, size_t count) {
+    if (enabled) {
+        column.resize(count);
+    } else {
+        column.clear();
+    }
+}
+
+} // namespace
+
+const char* flow_field_name(FlowField field) {
+    size_t index = static_cast<size_t>(field);
+    return index < FIELD_COUNT ? FIELD_NAMES[index] : "unknown";
+}
+
+size_t field_width(FlowField field) {
+    switch (field) {
+    case FlowField::TCP_FLAGS:
+    case FlowField::TOS:
+        return 1;
+    case FlowField::VLAN:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+size_t FlowSchema::size() const {
+    size_t count = 0;
+    for (uint32_t bits = fields; bits != 0; bits &= bits - 1) {
+        ++count;
+    }
+    return count;
+}
+
+FlowSchema FlowSchema::parse(const std::string& spec) {
+    FlowSchema schema;
+    for (const std::string& item : split_list(spec)) {
+        std::string name = item;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name == "all") {
+            schema.fields = (1u << FIELD_COUNT) - 1;
+            continue;
+        }
+        size_t index = 0;
+        while (index < FIELD_COUNT && name != FIELD_NAMES[index]) {
+            ++index;
+        }
+        if (index == FIELD_COUNT) {
+            throw std::runtime_error("Unknown flow field: " + item);
+        }
+        schema.enable(static_cast<FlowField>(index));
+    }
+    return schema;
+}
+
+std::string FlowSchema::to_string() const {
+    std::string result;
+    for (size_t i = 0; i < FIELD_COUNT; ++i) {
+        if (has(static_cast<FlowField>(i))) {
+            if (!result.empty()) result += ',';
+            result += FIELD_NAMES[i];
+        }
+    }
+    return result;
+}
+
+void FlowBatch::resize(size_t count) {
+    flows.resize(count);
+    resize_if(schema.has(FlowField::TCP_FLAGS), tcp_flags, count);
+    resize_if(schema.has(FlowField::TOS), tos, count);
+    resize_if(schema.has(FlowField::VLAN), vlan, count);
+    resize_if(schema.has(FlowField::INPUT_IF), input_if, count);
+    resize_if(schema.has(FlowField::OUTPUT_IF), output_if, count);
+    resize_if(schema.has(FlowField::SRC_AS), src_as, count);
+    resize_if(schema.has(FlowField::DST_AS), dst_as, count);
+    resize_if(schema.has(FlowField::NEXT_HOP), next_hop, count);
+    resize_if(schema.has(FlowField::IPV6), source_ip6, count);
+    resize_if(schema.has(FlowField::IPV6), destination_ip6, count);
+}
+
+void FlowBatch::append(const FlowBatch& source, size_t index) {
+    flows.push_back(source.flows[index]);
+    append_if(schema.has(FlowField::TCP_FLAGS), tcp_flags, source.tcp_flags, index);
+    append_if(schema.has(FlowField::TOS), tos, source.tos, index);
+    append_if(schema.has(FlowField::VLAN), vlan, source.vlan, index);
+    append_if(schema.has(FlowField::INPUT_IF), input_if, source.input_if, index);
+    append_if(schema.has(FlowField::OUTPUT_IF), output_if, source.output_if, index);
+    append_if(schema.has(FlowField::SRC_AS), src_as, source.src_as, index);
+    append_if(schema.has(FlowField::DST_AS), dst_as, source.dst_as, index);
+    append_if(schema.has(FlowField::NEXT_HOP), next_hop, source.next_hop, index);
+    append_if(schema.has(FlowField::IPV6), source_ip6, source.source_ip6, index);
+    append_if(schema.has(FlowField::IPV6), destination_ip6, source.destination_ip6, index);
+}
+
+size_t FlowBatch::retain(const uint8_t* selected) {
+    retain_if(true, flows, selected);
+    retain_if(schema.has(FlowField::TCP_FLAGS), tcp_flags, selected);
+    retain_if(schema.has(FlowField::TOS), tos, selected);
+    retain_if(schema.has(FlowField::VLAN), vlan, selected);
+    retain_if(schema.has(FlowField::INPUT_IF), input_if, selected);
+    retain_if(schema.has(FlowField::OUTPUT_IF), output_if, selected);
+    retain_if(schema.has(FlowField::SRC_AS), src_as, selected);
+    retain_if(schema.has(FlowField::DST_AS), dst_as, selected);
+    retain_if(schema.has(FlowField::NEXT_HOP), next_hop, selected);
+    retain_if(schema.has(FlowField::IPV6), source_ip6, selected);
+    retain_if(schema.has(FlowField::IPV6), destination_ip6, selected);
+    return flows.size();
+}
+
+FieldValues::FieldValues(const std::string& spec, uint32_t max_value)
+    : max_value_(max_value) {
+    if (spec.find('(') != std::string::npos) {
+        table_ = parse_distribution(spec);
+        if (table_.points().front() < 0.0) {
+            throw std::runtime_error("distribution must be non-negative");
+        }
+        return;
+    }
+
+    // Weighted value list: value[:weight], ...
+    std::vector<double> weights;
+    for (const std::string& item : split_list(spec)) {
+        size_t colon = item.find(':');
+        try {
+            size_t pos = 0;
+            std::string value_str = trim(item.substr(0, colon));
+            unsigned long long value = std::stoull(value_str, &pos, 0);
+            if (pos != value_str.size() || value > max_value) {
+                throw std::out_of_range(item);
+            }
+            values_.push_back(static_cast<uint32_t>(value));
+            weights.push_back(colon == std::string::npos ? 1.0 : std::stod(item.substr(colon + 1)));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("invalid value '" + item + "' (expected value[:weight], max " +
+                                     std::to_string(max_value) + ")");
+        }
+    }
+    if (values_.empty()) {
+        throw std::runtime_error("empty value list");
+    }
+    selector_.build(weights);
+}
+
+uint32_t FieldValues::sample() const {
+    if (!values_.empty()) {
+        return values_[selector_.sample()];
+    }
+    double value = std::round(table_.sample());
+    return static_cast<uint32_t>(std::min(value, static_cast<double>(max_value_)));
+}
+
+FieldDistributions FieldDistributions::parse(const std::map<std::string, std::string>& config) {
+    FieldDistributions result;
+
+    auto parse_entry = [&config](const char* key, FieldValues& values, uint32_t max_value) {
+        auto it = config.find(key);
+        if (it == config.end()) {
+            return;
+        }
+        try {
+            values = FieldValues(it->second, max_value);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string(key) + ": " + e.what());
+        }
+    };
+
+    parse_entry("tcp_flags", result.tcp_flags, 0xFF);
+    parse_entry("tos", result.tos, 0xFF);
+    parse_entry("vlan", result.vlan, 4095);
+    parse_entry("input_if", result.input_if, UINT32_MAX);
+    parse_entry("output_if", result.output_if, UINT32_MAX);
+    parse_entry("src_as", result.src_as, UINT32_MAX);
+    parse_entry("dst_as", result.dst_as, UINT32_MAX);
+
+    auto it = config.find("next_hop");
+    if (it != config.end()) {
+        try {
+            result.next_hop = AddressPool(split_list(it->second));
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string("next_hop: ") + e.what());
+        }
+    }
+    return result;
+}
+
+} // namespace flowgen
@@ -0,0 +1,175 @@
+#include "flowgen/session_table.hpp"
+#include "flowgen/utils.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace flowgen {
+
+SessionOptions SessionOptions::parse(const std::map<std::string, std::string>& config) {
+    SessionOptions options;
+
+    auto it = config.find("session_reuse");
+    if (it != config.end()) {
+        try {
+            options.reuse = std::stod(it->second);
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("session_reuse: invalid number '" + it->second + "'");
+        }
+        if (options.reuse < 0.0 || options.reuse >= 1.0) {
+            throw std::runtime_error("session_reuse must be in [0, 1)");
+        }
+    }
+
+    it = config.find("session_ms");
+    if (it != config.end()) {
+        try {
+            parse_distribution(it->second);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string("session_ms: ") + e.what());
+        }
+        options.lifetime_ms = it->second;
+    }
+
+    it = config.find("max_sessions");
+    if (it != config.end()) {
+        try {
+            options.max_sessions = static_cast<size_t>(std::stoull(it->second));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("max_sessions: invalid count '" + it->second + "'");
+        }
+        if (options.max_sessions == 0 || options.max_sessions >= 0xFFFFFFFFULL) {
+            throw std::runtime_error("max_sessions must be between 1 and 2^32 - 2");
+        }
+    }
+
+    return options;
+}
+
+SessionTable::SessionTable(const SessionOptions& options)
+    : reuse_(options.reuse),
+      capacity_(options.max_sessions),
+      lifetime_ms_(parse_distribution(options.lifetime_ms)),
+      wheel_(WHEEL_SLOTS),
+      current_tick_(0),
+      started_(false),
+      opened_(0),
+      continued_(0),
+      expired_(0),
+      evicted_(0) {
+    slab_.reserve(std::min<size_t>(capacity_, 1 << 16));
+}
+
+bool SessionTable::continue_session(uint64_t now_ns, FlowRecord& flow) {
+    advance(now_ns);
+
+    auto& rng = utils::Random::instance();
+    if (active_.empty() || rng.uniform() >= reuse_) {
+        return false;
+    }
+
+    size_t pick = static_cast<size_t>(rng.uniform() * static_cast<double>(active_.size()));
+    pick = std::min(pick, active_.size() - 1);
+
+    flow = slab_[active_[pick]].flow;
+    flow.timestamp = now_ns;
+    ++continued_;
+    return true;
+}
+
+void SessionTable::open(const FlowRecord& flow, uint64_t now_ns) {
+    advance(now_ns);
+
+    if (active_.size() >= capacity_) {
+        size_t victim = static_cast<size_t>(utils::Random::instance().uniform() *
+                                            static_cast<double>(active_.size()));
+        release(active_[std::min(victim, active_.size() - 1)]);
+        ++evicted_;
+    }
+
+    uint32_t id;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(slab_.size());
+        slab_.push_back(Session{flow, 0, 0, NONE});
+    }
+
+    Session& session = slab_[id];
+    // Heavy tails are capped at about 30 years so the expiry cannot overflow
+    double lifetime_ms = std::min(std::max(lifetime_ms_.sample(), 0.0), 1e12);
+    session.flow = flow;
+    session.expiry_ns = now_ns + static_cast<uint64_t>(lifetime_ms * 1e6);
+    session.position = static_cast<uint32_t>(active_.size());
+    active_.push_back(id);
+
+    uint64_t tick = std::max(session.expiry_ns / TICK_NS, current_tick_ + 1);
+    wheel_[tick % WHEEL_SLOTS].push_back(WheelEntry{id, session.generation});
+    ++opened_;
+}
+
+void SessionTable::clear() {
+    slab_.clear();
+    free_.clear();
+    active_.clear();
+    for (auto& slot : wheel_) {
+        slot.clear();
+    }
+    started_ = false;
+    opened_ = 0;
+    continued_ = 0;
+    expired_ = 0;
+    evicted_ = 0;
+}
+
+void SessionTable::advance(uint64_t now_ns) {
+    uint64_t now_tick = now_ns / TICK_NS;
+    if (!started_) {
+        current_tick_ = now_tick;
+        started_ = true;
+        return;
+    }
+    if (now_tick <= current_tick_) {
+        return;
+    }
+
+    // After a full rotation every slot has been visited once
+    uint64_t first = current_tick_ + 1;
+    uint64_t last = std::min(now_tick, current_tick_ + WHEEL_SLOTS);
+    for (uint64_t tick = first; tick <= last; ++tick) {
+        auto& slot = wheel_[tick % WHEEL_SLOTS];
+        size_t kept = 0;
+        for (const WheelEntry& entry : slot) {
+            Session& session = slab_[entry.session];
+            if (session.generation != entry.generation || session.position == NONE) {
+                continue;  // Evicted or reused since scheduling
+            }
+            // Expire by tick: a session due later in the current tick
+            // would otherwise wait a full rotation for its slot again
+            if (session.expiry_ns / TICK_NS <= now_tick) {
+                release(entry.session);
+                ++expired_;
+            } else {
+                slot[kept++] = entry;  // Due in a later rotation
+            }
+        }
+        slot.resize(kept);
+    }
+    current_tick_ = now_tick;
+}
+
+void SessionTable::release(uint32_t id) {
+    Session& session = slab_[id];
+
+    // Swap-remove from the dense active list
+    uint32_t last = active_.back();
+    active_[session.position] = last;
+    slab_[last].position = session.position;
+    active_.pop_back();
+
+    session.position = NONE;
+    ++session.generation;
+    free_.push_back(id);
+}
+
+} // namespace flowgen
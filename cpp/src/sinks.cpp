@@ -0,0 +1,999 @@
+#include "flowgen/sinks.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef FLOWGEN_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace flowgen {
+
+namespace {
+
+// Fast formatting helpers (no locale, no allocation beyond the buffer)
+inline void append_uint(std::string& out, uint64_t value) {
+    char buf[20];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+inline char* format_octet(char* p, uint32_t octet) {
+    if (octet >= 100) {
+        *p++ = static_cast<char>('0' + octet / 100);
+        octet %= 100;
+        *p++ = static_cast<char>('0' + octet / 10);
+    } else if (octet >= 10) {
+        *p++ = static_cast<char>('0' + octet / 10);
+    }
+    *p++ = static_cast<char>('0' + octet % 10);
+    return p;
+}
+
+inline void append_ipv4(std::string& out, uint32_t ip) {
+    char buf[16];
+    char* p = format_octet(buf, (ip >> 24) & 0xFF);
+    *p++ = '.';
+    p = format_octet(p, (ip >> 16) & 0xFF);
+    *p++ = '.';
+    p = format_octet(p, (ip >> 8) & 0xFF);
+    *p++ = '.';
+    p = format_octet(p, ip & 0xFF);
+    out.append(buf, p);
+}
+
+template<typename T>
+inline void append_le(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bytes[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+    out.append(bytes, sizeof(T));
+}
+
+inline void append_ip(std::string& out, const IpAddress& ip) {
+    char buf[IP_ADDRESS_STRLEN];
+    out.append(buf, format_ip(buf, ip));
+}
+
+inline void append_be(std::string& out, const IpAddress& ip) {
+    char bytes[16];
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((ip.hi >> (56 - 8 * i)) & 0xFF);
+        bytes[8 + i] = static_cast<char>((ip.lo >> (56 - 8 * i)) & 0xFF);
+    }
+    out.append(bytes, sizeof(bytes));
+}
+
+template<typename T>
+inline void append_be_uint(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bytes[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * (sizeof(T) - 1 - i))) & 0xFF);
+    }
+    out.append(bytes, sizeof(T));
+}
+
+// ClickHouse LEB128 length prefix
+inline void append_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+// ClickHouse String: varint length + bytes
+inline void append_ch_string(std::string& out, const std::string& value) {
+    append_varint(out, value.size());
+    out += value;
+}
+
+// Batch carries dual-stack address columns
+inline bool has_ipv6(const FlowBatch* batch) {
+    return batch && batch->schema.has(FlowField::IPV6);
+}
+
+// Enabled optional field columns, in column order (IPV6 is not a column)
+std::vector<FlowField> schema_fields(const FlowSchema& schema) {
+    std::vector<FlowField> fields;
+    for (size_t i = 0; i < static_cast<size_t>(FlowField::IPV6); ++i) {
+        if (schema.has(static_cast<FlowField>(i))) {
+            fields.push_back(static_cast<FlowField>(i));
+        }
+    }
+    return fields;
+}
+
+// Value of an optional field (0 for flows written without a batch)
+uint32_t field_value(const FlowBatch* batch, FlowField field, size_t index) {
+    if (!batch) {
+        return 0;
+    }
+    switch (field) {
+    case FlowField::TCP_FLAGS: return batch->tcp_flags[index];
+    case FlowField::TOS: return batch->tos[index];
+    case FlowField::VLAN: return batch->vlan[index];
+    case FlowField::INPUT_IF: return batch->input_if[index];
+    case FlowField::OUTPUT_IF: return batch->output_if[index];
+    case FlowField::SRC_AS: return batch->src_as[index];
+    case FlowField::DST_AS: return batch->dst_as[index];
+    case FlowField::NEXT_HOP: return batch->next_hop[index];
+    default: return 0;
+    }
+}
+
+// ========== Output backends ==========
+
+class OutputFile {
+public:
+    virtual ~OutputFile() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void close() = 0;
+};
+
+class PlainFile : public OutputFile {
+public:
+    explicit PlainFile(const std::string& path)
+        : fp_(std::fopen(path.c_str(), "wb")) {
+        if (!fp_) {
+            throw std::runtime_error("Failed to open output file: " + path);
+        }
+    }
+
+    ~PlainFile() override { close(); }
+
+    void write(const char* data, size_t size) override {
+        if (std::fwrite(data, 1, size, fp_) != size) {
+            throw std::runtime_error("Failed to write output file");
+        }
+    }
+
+    void close() override {
+        if (fp_) {
+            std::fclose(fp_);
+            fp_ = nullptr;
+        }
+    }
+
+private:
+    FILE* fp_;
+};
+
+#ifdef FLOWGEN_HAVE_ZLIB
+class GzipFile : public OutputFile {
+public:
+    explicit GzipFile(const std::string& path)
+        : gz_(gzopen(path.c_str(), "wb6")) {
+        if (!gz_) {
+            throw std::runtime_error("Failed to open output file: " + path);
+        }
+        gzbuffer(gz_, 1 << 18);
+    }
+
+    ~GzipFile() override { close(); }
+
+    void write(const char* data, size_t size) override {
+        if (size > 0 && gzwrite(gz_, data, static_cast<unsigned>(size)) == 0) {
+            throw std::runtime_error("Failed to write compressed output file");
+        }
+    }
+
+    void close() override {
+        if (gz_) {
+            gzclose(gz_);
+            gz_ = nullptr;
+        }
+    }
+
+private:
+    gzFile gz_;
+};
+#endif
+
+// ========== Serializers ==========
+
+// Records come from a FlowBatch (batch + index) or, without optional
+// field values, from a plain FlowRecord array (batch == nullptr)
+class Serializer {
+public:
+    explicit Serializer(const FlowSchema& schema) : fields_(schema_fields(schema)) {}
+    virtual ~Serializer() = default;
+    virtual void begin(std::string& out) = 0;
+    virtual void append(std::string& out, const FlowRecord& flow,
+                        const FlowBatch* batch, size_t index) = 0;
+    virtual void end(std::string& out) = 0;
+
+protected:
+    std::vector<FlowField> fields_;
+};
+
+class CsvSerializer : public Serializer {
+public:
+    CsvSerializer(const FlowSchema& schema, bool include_header)
+        : Serializer(schema), include_header_(include_header) {}
+
+    void begin(std::string& out) override {
+        if (include_header_) {
+            out += FlowRecord::csv_header();
+            for (FlowField field : fields_) {
+                out += ',';
+                out += flow_field_name(field);
+            }
+            out += '\n';
+        }
+    }
+
+    void append(std::string& out, const FlowRecord& flow,
+                const FlowBatch* batch, size_t index) override {
+        append_uint(out, flow.timestamp);
+        out += ',';
+        if (has_ipv6(batch)) {
+            append_ip(out, batch->source_ip6[index]);
+            out += ',';
+            append_ip(out, batch->destination_ip6[index]);
+        } else {
+            append_ipv4(out, flow.source_ip);
+            out += ',';
+            append_ipv4(out, flow.destination_ip);
+        }
+        out += ',';
+        append_uint(out, flow.source_port);
+        out += ',';
+        append_uint(out, flow.destination_port);
+        out += ',';
+        append_uint(out, flow.protocol);
+        out += ',';
+        append_uint(out, flow.packet_length);
+        for (FlowField field : fields_) {
+            out += ',';
+            uint32_t value = field_value(batch, field, index);
+            if (field == FlowField::NEXT_HOP) {
+                append_ipv4(out, value);
+            } else {
+                append_uint(out, value);
+            }
+        }
+        out += '\n';
+    }
+
+    void end(std::string&) override {}
+
+private:
+    bool include_header_;
+};
+
+class JsonSerializer : public Serializer {
+public:
+    JsonSerializer(const FlowSchema& schema, bool array, bool pretty)
+        : Serializer(schema), array_(array), pretty_(pretty), first_(true) {}
+
+    void begin(std::string& out) override {
+        first_ = true;
+        if (array_) {
+            out += pretty_ ? "[\n" : "[";
+        }
+    }
+
+    void append(std::string& out, const FlowRecord& flow,
+                const FlowBatch* batch, size_t index) override {
+        if (array_ && !first_) {
+            out += pretty_ ? ",\n" : ",";
+        }
+        first_ = false;
+
+        const char* sep = pretty_ ? ",\n    " : ",";
+        out += pretty_ ? "  {\n    " : "{";
+        bool ipv6 = has_ipv6(batch);
+        out += "\"src_ip\": \"";
+        if (ipv6) {
+            append_ip(out, batch->source_ip6[index]);
+        } else {
+            append_ipv4(out, flow.source_ip);
+        }
+        out += '"';
+        out += sep;
+        out += "\"dst_ip\": \"";
+        if (ipv6) {
+            append_ip(out, batch->destination_ip6[index]);
+        } else {
+            append_ipv4(out, flow.destination_ip);
+        }
+        out += '"';
+        out += sep;
+        out += "\"src_port\": ";
+        append_uint(out, flow.source_port);
+        out += sep;
+        out += "\"dst_port\": ";
+        append_uint(out, flow.destination_port);
+        out += sep;
+        out += "\"protocol\": ";
+        append_uint(out, flow.protocol);
+        out += sep;
+        out += "\"timestamp\": ";
+        append_uint(out, flow.timestamp);
+        out += sep;
+        out += "\"length\": ";
+        append_uint(out, flow.packet_length);
+        for (FlowField field : fields_) {
+            out += sep;
+            out += '"';
+            out += flow_field_name(field);
+            out += "\": ";
+            uint32_t value = field_value(batch, field, index);
+            if (field == FlowField::NEXT_HOP) {
+                out += '"';
+                append_ipv4(out, value);
+                out += '"';
+            } else {
+                append_uint(out, value);
+            }
+        }
+        out += pretty_ ? "\n  }" : "}";
+
+        if (!array_) {
+            out += '\n';
+        }
+    }
+
+    void end(std::string& out) override {
+        if (array_) {
+            out += pretty_ ? "\n]\n" : "]";
+        }
+    }
+
+private:
+    bool array_;
+    bool pretty_;
+    bool first_;
+};
+
+class BinarySerializer : public Serializer {
+public:
+    explicit BinarySerializer(const FlowSchema& schema)
+        : Serializer(schema),
+          header_(BinaryFlowHeader::for_schema(schema)),
+          ipv6_(schema.has(FlowField::IPV6)) {}
+
+    void begin(std::string& out) override {
+        append_le(out, header_.magic);
+        append_le(out, header_.version);
+        append_le(out, header_.record_size);
+        if (header_.version >= BinaryFlowHeader::VERSION_SCHEMA) {
+            append_le(out, header_.fields);
+        }
+    }
+
+    void append(std::string& out, const FlowRecord& flow,
+                const FlowBatch* batch, size_t index) override {
+        append_le(out, flow.timestamp);
+        append_le(out, flow.source_ip);
+        append_le(out, flow.destination_ip);
+        append_le(out, flow.source_port);
+        append_le(out, flow.destination_port);
+        append_le(out, flow.protocol);
+        out.append(3, '\0');
+        append_le(out, flow.packet_length);
+        out.append(4, '\0');
+
+        if (header_.record_size > BinaryFlowHeader::RECORD_SIZE) {
+            size_t written = 0;
+            for (FlowField field : fields_) {
+                uint32_t value = field_value(batch, field, index);
+                switch (field_width(field)) {
+                case 1: append_le(out, static_cast<uint8_t>(value)); break;
+                case 2: append_le(out, static_cast<uint16_t>(value)); break;
+                default: append_le(out, value); break;
+                }
+                written += field_width(field);
+            }
+            if (ipv6_) {
+                bool columns = has_ipv6(batch);
+                append_be(out, columns ? batch->source_ip6[index] : IpAddress::from_ipv4(flow.source_ip));
+                append_be(out, columns ? batch->destination_ip6[index]
+                                       : IpAddress::from_ipv4(flow.destination_ip));
+                written += 32;
+            }
+            out.append(header_.record_size - BinaryFlowHeader::RECORD_SIZE - written, '\0');
+        } else if (has_ipv6(batch) && !batch->source_ip6[index].is_ipv4()) {
+            throw std::runtime_error("IPv6 flow written to a binary sink without 'ipv6' in its schema");
+        }
+    }
+
+    void end(std::string&) override {}
+
+private:
+    BinaryFlowHeader header_;
+    bool ipv6_;
+};
+
+// ========== Database bulk-load serializers ==========
+
+// Typed table columns shared by the ClickHouse and PostgreSQL formats.
+// Addresses are IPv4 columns unless the schema has FlowField::IPV6, in
+// which case src_ip/dst_ip hold IPv6 (IPv4-mapped for IPv4 flows).
+enum class ColumnType { TIMESTAMP, ADDRESS, IPV4, UINT8, UINT16, UINT32 };
+
+enum class ColumnSource { TIMESTAMP, SRC_IP, DST_IP, SRC_PORT, DST_PORT, PROTOCOL, LENGTH, FIELD };
+
+struct TableColumn {
+    std::string name;
+    ColumnType type;
+    ColumnSource source;
+    FlowField field;  // ColumnSource::FIELD only
+};
+
+std::vector<TableColumn> table_columns(const FlowSchema& schema) {
+    ColumnType address = schema.has(FlowField::IPV6) ? ColumnType::ADDRESS : ColumnType::IPV4;
+    std::vector<TableColumn> columns = {
+        {"timestamp", ColumnType::TIMESTAMP, ColumnSource::TIMESTAMP, FlowField::IPV6},
+        {"src_ip", address, ColumnSource::SRC_IP, FlowField::IPV6},
+        {"dst_ip", address, ColumnSource::DST_IP, FlowField::IPV6},
+        {"src_port", ColumnType::UINT16, ColumnSource::SRC_PORT, FlowField::IPV6},
+        {"dst_port", ColumnType::UINT16, ColumnSource::DST_PORT, FlowField::IPV6},
+        {"protocol", ColumnType::UINT8, ColumnSource::PROTOCOL, FlowField::IPV6},
+        {"length", ColumnType::UINT32, ColumnSource::LENGTH, FlowField::IPV6},
+    };
+    for (FlowField field : schema_fields(schema)) {
+        ColumnType type = field == FlowField::NEXT_HOP ? ColumnType::IPV4
+                        : field_width(field) == 1 ? ColumnType::UINT8
+                        : field_width(field) == 2 ? ColumnType::UINT16
+                        : ColumnType::UINT32;
+        columns.push_back({flow_field_name(field), type, ColumnSource::FIELD, field});
+    }
+    return columns;
+}
+
+const char* clickhouse_type(ColumnType type) {
+    switch (type) {
+    case ColumnType::TIMESTAMP: return "DateTime64(9, 'UTC')";
+    case ColumnType::ADDRESS: return "IPv6";
+    case ColumnType::IPV4: return "IPv4";
+    case ColumnType::UINT8: return "UInt8";
+    case ColumnType::UINT16: return "UInt16";
+    default: return "UInt32";
+    }
+}
+
+// PostgreSQL has no unsigned types, so each width gets the next signed one
+const char* postgres_type(ColumnType type) {
+    switch (type) {
+    case ColumnType::TIMESTAMP: return "timestamptz";
+    case ColumnType::ADDRESS:
+    case ColumnType::IPV4: return "inet";
+    case ColumnType::UINT8: return "smallint";
+    case ColumnType::UINT16: return "integer";
+    default: return "bigint";
+    }
+}
+
+uint64_t column_value(const TableColumn& column, const FlowRecord& flow,
+                      const FlowBatch* batch, size_t index) {
+    switch (column.source) {
+    case ColumnSource::TIMESTAMP: return flow.timestamp;
+    case ColumnSource::SRC_IP: return flow.source_ip;
+    case ColumnSource::DST_IP: return flow.destination_ip;
+    case ColumnSource::SRC_PORT: return flow.source_port;
+    case ColumnSource::DST_PORT: return flow.destination_port;
+    case ColumnSource::PROTOCOL: return flow.protocol;
+    case ColumnSource::LENGTH: return flow.packet_length;
+    default: return field_value(batch, column.field, index);
+    }
+}
+
+// Source or destination address of a flow (ADDRESS columns)
+IpAddress column_address(const TableColumn& column, const FlowRecord& flow,
+                         const FlowBatch* batch, size_t index) {
+    bool src = column.source == ColumnSource::SRC_IP;
+    if (has_ipv6(batch)) {
+        return src ? batch->source_ip6[index] : batch->destination_ip6[index];
+    }
+    return IpAddress::from_ipv4(src ? flow.source_ip : flow.destination_ip);
+}
+
+// IPv6 flows cannot be written to IPv4 address columns
+void check_ipv4_columns(const FlowBatch* batch, size_t index, const char* format) {
+    if (has_ipv6(batch) && !batch->source_ip6[index].is_ipv4()) {
+        throw std::runtime_error(std::string("IPv6 flow written to a ") + format +
+                                 " sink without 'ipv6' in its schema");
+    }
+}
+
+// One ClickHouse value, as laid out by both RowBinary and Native
+void append_clickhouse_value(std::string& out, const TableColumn& column, const FlowRecord& flow,
+                             const FlowBatch* batch, size_t index) {
+    switch (column.type) {
+    case ColumnType::TIMESTAMP:
+        append_le(out, flow.timestamp);
+        break;
+    case ColumnType::ADDRESS:
+        append_be(out, column_address(column, flow, batch, index));
+        break;
+    case ColumnType::IPV4:
+    case ColumnType::UINT32:
+        append_le(out, static_cast<uint32_t>(column_value(column, flow, batch, index)));
+        break;
+    case ColumnType::UINT16:
+        append_le(out, static_cast<uint16_t>(column_value(column, flow, batch, index)));
+        break;
+    case ColumnType::UINT8:
+        append_le(out, static_cast<uint8_t>(column_value(column, flow, batch, index)));
+        break;
+    }
+}
+
+// ClickHouse RowBinary; the header makes it RowBinaryWithNamesAndTypes
+class RowBinarySerializer : public Serializer {
+public:
+    RowBinarySerializer(const FlowSchema& schema, bool include_header)
+        : Serializer(schema), columns_(table_columns(schema)),
+          ipv6_(schema.has(FlowField::IPV6)), include_header_(include_header) {}
+
+    void begin(std::string& out) override {
+        if (include_header_) {
+            append_varint(out, columns_.size());
+            for (const auto& column : columns_) {
+                append_ch_string(out, column.name);
+            }
+            for (const auto& column : columns_) {
+                append_ch_string(out, clickhouse_type(column.type));
+            }
+        }
+    }
+
+    void append(std::string& out, const FlowRecord& flow,
+                const FlowBatch* batch, size_t index) override {
+        if (!ipv6_) {
+            check_ipv4_columns(batch, index, "RowBinary");
+        }
+        for (const auto& column : columns_) {
+            append_clickhouse_value(out, column, flow, batch, index);
+        }
+    }
+
+    void end(std::string&) override {}
+
+private:
+    std::vector<TableColumn> columns_;
+    bool ipv6_;
+    bool include_header_;
+};
+
+// ClickHouse Native: column-major blocks of up to BLOCK_ROWS rows, each
+// column prefixed with its name and type
+class NativeSerializer : public Serializer {
+public:
+    static constexpr size_t BLOCK_ROWS = 65536;
+
+    explicit NativeSerializer(const FlowSchema& schema)
+        : Serializer(schema), columns_(table_columns(schema)), data_(columns_.size()),
+          ipv6_(schema.has(FlowField::IPV6)), rows_(0) {}
+
+    void begin(std::string&) override {
+        rows_ = 0;
+        for (auto& column : data_) {
+            column.clear();
+        }
+    }
+
+    void append(std::string& out, const FlowRecord& flow,
+                const FlowBatch* batch, size_t index) override {
+        if (!ipv6_) {
+            check_ipv4_columns(batch, index, "Native");
+        }
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            append_clickhouse_value(data_[i], columns_[i], flow, batch, index);
+        }
+        if (++rows_ == BLOCK_ROWS) {
+            write_block(out);
+        }
+    }
+
+    void end(std::string& out) override {
+        if (rows_ > 0) {
+            write_block(out);
+        }
+    }
+
+private:
+    void write_block(std::string& out) {
+        append_varint(out, columns_.size());
+        append_varint(out, rows_);
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            append_ch_string(out, columns_[i].name);
+            append_ch_string(out, clickhouse_type(columns_[i].type));
+            out += data_[i];
+            data_[i].clear();
+        }
+        rows_ = 0;
+    }
+
+    std::vector<TableColumn> columns_;
+    std::vector<std::string> data_;
+    bool ipv6_;
+    size_t rows_;
+};
+
+// PostgreSQL COPY ... WITH (FORMAT binary): big-endian tuples of
+// length-prefixed fields between a fixed signature and a -1 trailer
+class PostgresCopySerializer : public Serializer {
+public:
+    // Microseconds from the Unix epoch to the PostgreSQL epoch (2000-01-01)
+    static constexpr int64_t POSTGRES_EPOCH_US = 946684800000000LL;
+
+    explicit PostgresCopySerializer(const FlowSchema& schema)
+        : Serializer(schema), columns_(table_columns(schema)) {}
+
+    void begin(std::string& out) override {
+        out.append("PGCOPY\n\377\r\n\0", 11);
+        append_be_uint(out, uint32_t(0));  // Flags
+        append_be_uint(out, uint32_t(0));  // Header extension length
+    }
+
+    void append(std::string& out, const FlowRecord& flow,
+                const FlowBatch* batch, size_t index) override {
+        append_be_uint(out, static_cast<uint16_t>(columns_.size()));
+        for (const auto& column : columns_) {
+            switch (column.type) {
+            case ColumnType::TIMESTAMP:
+                append_be_uint(out, uint32_t(8));
+                append_be_uint(out, static_cast<uint64_t>(
+                    static_cast<int64_t>(flow.timestamp / 1000) - POSTGRES_EPOCH_US));
+                break;
+            case ColumnType::ADDRESS:
+                append_inet(out, column_address(column, flow, batch, index));
+                break;
+            case ColumnType::IPV4:
+                if (column.source != ColumnSource::FIELD) {
+                    check_ipv4_columns(batch, index, "PostgreSQL COPY");
+                }
+                append_inet(out, IpAddress::from_ipv4(
+                    static_cast<uint32_t>(column_value(column, flow, batch, index))));
+                break;
+            case ColumnType::UINT8:
+                append_be_uint(out, uint32_t(2));
+                append_be_uint(out, static_cast<uint16_t>(column_value(column, flow, batch, index)));
+                break;
+            case ColumnType::UINT16:
+                append_be_uint(out, uint32_t(4));
+                append_be_uint(out, static_cast<uint32_t>(column_value(column, flow, batch, index)));
+                break;
+            case ColumnType::UINT32:
+                append_be_uint(out, uint32_t(8));
+                append_be_uint(out, column_value(column, flow, batch, index));
+                break;
+            }
+        }
+    }
+
+    void end(std::string& out) override {
+        append_be_uint(out, uint16_t(0xFFFF));
+    }
+
+private:
+    // inet: family, prefix bits, is_cidr, address length, address
+    static void append_inet(std::string& out, const IpAddress& ip) {
+        if (ip.is_ipv4()) {
+            append_be_uint(out, uint32_t(8));
+            out += static_cast<char>(2);  // PGSQL_AF_INET
+            out += static_cast<char>(32);
+            out += '\0';
+            out += static_cast<char>(4);
+            append_be_uint(out, ip.ipv4());
+        } else {
+            append_be_uint(out, uint32_t(20));
+            out += static_cast<char>(3);  // PGSQL_AF_INET6
+            out += static_cast<char>(static_cast<unsigned char>(128));
+            out += '\0';
+            out += static_cast<char>(16);
+            append_be(out, ip);
+        }
+    }
+
+    std::vector<TableColumn> columns_;
+};
+
+std::unique_ptr<Serializer> create_serializer(const SinkOptions& options) {
+    switch (options.format) {
+    case SinkFormat::CSV:
+        return std::make_unique<CsvSerializer>(options.schema, options.include_header);
+    case SinkFormat::JSON:
+        return std::make_unique<JsonSerializer>(options.schema, true, options.pretty);
+    case SinkFormat::JSON_LINES:
+        return std::make_unique<JsonSerializer>(options.schema, false, false);
+    case SinkFormat::BINARY:
+        return std::make_unique<BinarySerializer>(options.schema);
+    case SinkFormat::CLICKHOUSE_ROWBINARY:
+        return std::make_unique<RowBinarySerializer>(options.schema, options.include_header);
+    case SinkFormat::CLICKHOUSE_NATIVE:
+        return std::make_unique<NativeSerializer>(options.schema);
+    case SinkFormat::POSTGRES_BINARY:
+        return std::make_unique<PostgresCopySerializer>(options.schema);
+    default:
+        throw std::runtime_error("Unknown sink format");
+    }
+}
+
+// ========== File sink ==========
+
+class FileSink : public FlowSink {
+public:
+    FileSink(const std::string& path, const SinkOptions& options)
+        : options_(options),
+          serializer_(create_serializer(options)),
+          file_index_(0),
+          flows_in_file_(0) {
+#ifndef FLOWGEN_HAVE_ZLIB
+        if (options_.compress) {
+            throw std::runtime_error("Compressed output requested but flowgen was built without zlib");
+        }
+#endif
+        // Split path into stem and extension for rotated file names
+        size_t slash = path.find_last_of('/');
+        size_t dot = path.find_last_of('.');
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+            stem_ = path.substr(0, dot);
+            extension_ = path.substr(dot);
+        } else {
+            stem_ = path;
+        }
+        if (options_.compress && extension_ == ".gz") {
+            // Caller already named the file .gz - keep the inner extension
+            size_t inner = stem_.find_last_of('.');
+            if (inner != std::string::npos && (slash == std::string::npos || inner > slash)) {
+                extension_ = stem_.substr(inner);
+                stem_ = stem_.substr(0, inner);
+            } else {
+                extension_.clear();
+            }
+        }
+
+        buffer_.reserve(options_.buffer_size + 1024);
+        open_file();
+    }
+
+    ~FileSink() override {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw
+        }
+    }
+
+    void write(const FlowRecord* flows, size_t count) override {
+        write_records(flows, nullptr, count);
+    }
+
+    void write(const FlowBatch& batch) override {
+        // IPv4-only batches can still go to an IPv6 sink (written IPv4-mapped)
+        FlowSchema required = options_.schema;
+        required.fields &= ~(1u << static_cast<unsigned>(FlowField::IPV6));
+        if ((required.fields & ~batch.schema.fields) != 0) {
+            throw std::runtime_error("Flow batch is missing sink fields (sink: " +
+                                     options_.schema.to_string() + ", batch: " +
+                                     batch.schema.to_string() + ")");
+        }
+        write_records(batch.flows.data(), &batch, batch.size());
+    }
+
+    FlowSchema schema() const override { return options_.schema; }
+
+    void close() override {
+        if (output_) {
+            finish_file();
+        }
+    }
+
+private:
+    void write_records(const FlowRecord* flows, const FlowBatch* batch, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (options_.rotate_flows > 0 && flows_in_file_ >= options_.rotate_flows) {
+                finish_file();
+                open_file();
+            }
+
+            serializer_->append(buffer_, flows[i], batch, i);
+            flows_in_file_++;
+
+            if (buffer_.size() >= options_.buffer_size) {
+                flush_buffer();
+            }
+        }
+        flows_written_ += count;
+    }
+
+    std::string next_path() {
+        std::string path = stem_;
+        if (options_.rotate_flows > 0) {
+            char index[16];
+            std::snprintf(index, sizeof(index), "_%06zu", file_index_);
+            path += index;
+        }
+        path += extension_;
+        if (options_.compress) {
+            path += ".gz";
+        }
+        file_index_++;
+        return path;
+    }
+
+    void open_file() {
+        std::string path = next_path();
+#ifdef FLOWGEN_HAVE_ZLIB
+        if (options_.compress) {
+            output_ = std::make_unique<GzipFile>(path);
+        } else {
+            output_ = std::make_unique<PlainFile>(path);
+        }
+#else
+        output_ = std::make_unique<PlainFile>(path);
+#endif
+        flows_in_file_ = 0;
+        serializer_->begin(buffer_);
+    }
+
+    void finish_file() {
+        serializer_->end(buffer_);
+        flush_buffer();
+        output_->close();
+        output_.reset();
+    }
+
+    void flush_buffer() {
+        if (!buffer_.empty()) {
+            output_->write(buffer_.data(), buffer_.size());
+            buffer_.clear();
+        }
+    }
+
+    SinkOptions options_;
+    std::unique_ptr<Serializer> serializer_;
+    std::unique_ptr<OutputFile> output_;
+    std::string buffer_;
+    std::string stem_;
+    std::string extension_;
+    size_t file_index_;
+    uint64_t flows_in_file_;
+};
+
+// Flows of a batch that start before end_ns (the batch is in time order)
+size_t flows_before(const FlowRecord* flows, size_t count, uint64_t end_ns) {
+    if (end_ns == UINT64_MAX) {
+        return count;
+    }
+    size_t i = 0;
+    while (i < count && flows[i].timestamp < end_ns) {
+        ++i;
+    }
+    return i;
+}
+
+} // namespace
+
+BinaryFlowHeader BinaryFlowHeader::for_schema(const FlowSchema& schema) {
+    BinaryFlowHeader header;
+    if (schema.empty()) {
+        return header;
+    }
+    size_t size = RECORD_SIZE;
+    for (FlowField field : schema_fields(schema)) {
+        size += field_width(field);
+    }
+    if (schema.has(FlowField::IPV6)) {
+        size += 32;
+    }
+    header.version = VERSION_SCHEMA;
+    header.record_size = static_cast<uint16_t>((size + 7) & ~size_t(7));
+    header.fields = schema.fields;
+    return header;
+}
+
+std::unique_ptr<FlowSink> create_file_sink(const std::string& path,
+                                           const SinkOptions& options) {
+    return std::make_unique<FileSink>(path, options);
+}
+
+SinkFormat parse_sink_format(const std::string& format_str) {
+    std::string lower = format_str;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "csv") {
+        return SinkFormat::CSV;
+    } else if (lower == "json") {
+        return SinkFormat::JSON;
+    } else if (lower == "jsonl" || lower == "jsonlines" || lower == "json_lines") {
+        return SinkFormat::JSON_LINES;
+    } else if (lower == "binary" || lower == "bin") {
+        return SinkFormat::BINARY;
+    } else if (lower == "rowbinary" || lower == "clickhouse") {
+        return SinkFormat::CLICKHOUSE_ROWBINARY;
+    } else if (lower == "native") {
+        return SinkFormat::CLICKHOUSE_NATIVE;
+    } else if (lower == "pgcopy" || lower == "postgres" || lower == "postgresql") {
+        return SinkFormat::POSTGRES_BINARY;
+    } else {
+        throw std::runtime_error("Unknown sink format: " + format_str);
+    }
+}
+
+std::string sink_table_ddl(SinkFormat format, const FlowSchema& schema,
+                           const std::string& table) {
+    bool clickhouse = format == SinkFormat::CLICKHOUSE_ROWBINARY ||
+                      format == SinkFormat::CLICKHOUSE_NATIVE;
+    if (!clickhouse && format != SinkFormat::POSTGRES_BINARY) {
+        throw std::runtime_error("Sink format has no table definition");
+    }
+
+    std::string ddl = "CREATE TABLE " + table + " (\n";
+    std::vector<TableColumn> columns = table_columns(schema);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        ddl += "    " + columns[i].name + ' ';
+        ddl += clickhouse ? clickhouse_type(columns[i].type) : postgres_type(columns[i].type);
+        ddl += i + 1 < columns.size() ? ",\n" : "\n";
+    }
+    ddl += clickhouse ? ") ENGINE = MergeTree ORDER BY timestamp;\n" : ");\n";
+    return ddl;
+}
+
+bool sink_compression_available() {
+#ifdef FLOWGEN_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t export_flows(FlowGenerator& generator, FlowSink& sink,
+                      uint64_t count, size_t batch_size, uint64_t end_timestamp_ns) {
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+
+    size_t capacity = static_cast<size_t>(std::min<uint64_t>(batch_size, count));
+    FlowSchema schema = sink.schema();
+    if (generator.dual_stack()) {
+        schema.enable(FlowField::IPV6);
+    }
+    uint64_t written = 0;
+
+    if (!schema.empty()) {
+        FlowBatch batch(schema, capacity);
+        while (written < count) {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(capacity, count - written));
+            generator.next_batch(batch, n);
+            size_t kept = flows_before(batch.flows.data(), n, end_timestamp_ns);
+            if (kept < n) {
+                batch.resize(kept);
+            }
+            if (kept > 0) {
+                sink.write(batch);
+            }
+            written += kept;
+            if (kept < n) {
+                break;
+            }
+        }
+        return written;
+    }
+
+    std::vector<FlowRecord> batch(capacity);
+    while (written < count) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(batch.size(), count - written));
+        generator.next_batch(batch.data(), n);
+        size_t kept = flows_before(batch.data(), n, end_timestamp_ns);
+        if (kept > 0) {
+            sink.write(batch.data(), kept);
+        }
+        written += kept;
+        if (kept < n) {
+            break;
+        }
+    }
+
+    return written;
+}
+
+} // namespace flowgen
@@ -1,22 +1,48 @@
 #include "flowgen/utils.hpp"
+#include "flowgen/address_pool.hpp"
 #include <stdexcept>
 #include <chrono>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace flowgen {
 namespace utils {
 
-// Random singleton implementation
+// Random implementation
+namespace {
+thread_local Random* current_random = nullptr;
+}
+
 Random& Random::instance() {
-    static Random inst;
+    if (current_random) {
+        return *current_random;
+    }
+    thread_local Random inst;
     return inst;
 }
 
 Random::Random() {
     auto seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    gen_.seed(seed);
+    // Threads starting together still get distinct streams
+    gen_.seed(static_cast<uint64_t>(seed) ^
+              std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ULL);
+}
+
+Random::Random(uint64_t seed_value) {
+    gen_.seed(seed_value);
+}
+
+Random::Scope::Scope(Random& rng) : previous_(current_random) {
+    current_random = &rng;
+}
+
+Random::Scope::~Scope() {
+    current_random = previous_;
 }
 
 void Random::seed(uint64_t seed_value) {
@@ -37,6 +63,24 @@ uint32_t Random::rand32() {
     return static_cast<uint32_t>(gen_());
 }
 
+std::shared_ptr<const void> shared_seeded(const std::string& key, uint64_t seed,
+                                          const std::function<std::shared_ptr<const void>()>& build) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const void>> cache;
+
+    // Builds are rare and short next to generation, so one lock serves all keys
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = cache[key + '#' + std::to_string(seed)];
+    if (auto object = entry.lock()) {
+        return object;
+    }
+    Random rng(seed);
+    Random::Scope scope(rng);
+    auto object = build();
+    entry = object;
+    return object;
+}
+
 // Convert IPv4 string to uint32_t (host byte order)
 uint32_t ip_str_to_uint32(const std::string& ip_str) {
     std::istringstream iss(ip_str);
@@ -182,16 +226,7 @@ std::string random_ipv4(const std::string& subnet) {
 }
 
 std::string random_ipv6(const std::string& subnet) {
-    (void)subnet;  // TODO: Implement subnet support for IPv6
-    auto& rng = Random::instance();
-
-    // Simplified IPv6 generation
-    std::ostringstream oss;
-    for (int i = 0; i < 8; ++i) {
-        if (i > 0) oss << ":";
-        oss << std::hex << rng.randint(0, 65535);
-    }
-    return oss.str();
+    return Ipv6Pool({subnet.empty() ? std::string("::/0") : subnet}).sample().to_string();
 }
 
 uint32_t random_ip_from_subnets_uint32(const std::vector<std::string>& subnets,
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <flowgen/flow_stats.hpp>
 
 namespace flowdump {
 
@@ -24,6 +25,14 @@ struct EnhancedFlowRecord {
 
     EnhancedFlowRecord() = default;
 
+    /**
+     * Marker a worker queues after the last flow of a stream; its
+     * timestamp (UINT64_MAX) is past any flow the stream can still send
+     */
+    static EnhancedFlowRecord end_of_stream(uint32_t stream_id);
+
+    bool is_end_of_stream() const { return timestamp == UINT64_MAX; }
+
     /**
      * Convert IP uint32_t to string
      */
@@ -65,21 +74,9 @@ struct EnhancedFlowRecord {
     static std::string plain_text_header();
 };
 
-/**
- * Flow statistics for realistic packet/byte count generation
- */
-struct FlowStats {
-    uint32_t packet_count;
-    uint64_t byte_count;
-    uint64_t duration_ns;  // Flow duration in nanoseconds
-};
-
-/**
- * Generate realistic flow statistics based on protocol and port
- */
-FlowStats generate_flow_stats(uint32_t avg_packet_size,
-                               uint8_t protocol,
-                               uint16_t dst_port);
+// Flow enrichment is provided by libflowgen (shared with flowstats)
+using flowgen::FlowStats;
+using flowgen::generate_flow_stats;
 
 } // namespace flowdump
 
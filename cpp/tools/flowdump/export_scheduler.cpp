@@ -0,0 +1,93 @@
+#include "export_scheduler.hpp"
+#include <algorithm>
+
+namespace flowdump {
+
+namespace {
+
+// Share of total accumulated by `at` when spread evenly over [first, last]
+uint64_t share_until(uint64_t total, const EnhancedFlowRecord& flow, uint64_t at) {
+    if (at >= flow.last_timestamp) {
+        return total;
+    }
+    long double fraction = static_cast<long double>(at - flow.first_timestamp) /
+                           static_cast<long double>(flow.last_timestamp - flow.first_timestamp);
+    return static_cast<uint64_t>(static_cast<long double>(total) * fraction);
+}
+
+} // namespace
+
+ExportScheduler::ExportScheduler(uint64_t active_timeout_ns)
+    : active_timeout_ns_(active_timeout_ns) {
+}
+
+void ExportScheduler::add(const EnhancedFlowRecord& flow) {
+    push(flow, flow.first_timestamp, added_++);
+}
+
+void ExportScheduler::release(uint64_t watermark_ns, std::vector<EnhancedFlowRecord>& out) {
+    while (!heap_.empty() && heap_.front().export_ns <= watermark_ns) {
+        emit_top(out);
+    }
+}
+
+void ExportScheduler::flush(std::vector<EnhancedFlowRecord>& out) {
+    while (!heap_.empty()) {
+        emit_top(out);
+    }
+}
+
+void ExportScheduler::push(const EnhancedFlowRecord& flow, uint64_t segment_start_ns,
+                           uint64_t sequence) {
+    heap_.push_back(Pending{segment_end(flow, segment_start_ns), segment_start_ns, sequence, flow});
+    std::push_heap(heap_.begin(), heap_.end(), later_export);
+}
+
+void ExportScheduler::emit_top(std::vector<EnhancedFlowRecord>& out) {
+    std::pop_heap(heap_.begin(), heap_.end(), later_export);
+    Pending pending = std::move(heap_.back());
+    heap_.pop_back();
+
+    const EnhancedFlowRecord& flow = pending.flow;
+    if (pending.segment_start_ns == flow.first_timestamp && pending.export_ns == flow.last_timestamp) {
+        out.push_back(flow);  // Exported whole at flow end
+        return;
+    }
+
+    // One active-timeout segment with its share of packets and bytes
+    uint64_t start = pending.segment_start_ns;
+    uint64_t end = pending.export_ns;
+    EnhancedFlowRecord record = flow;
+    record.timestamp = start;
+    record.first_timestamp = start;
+    record.last_timestamp = end;
+    record.packet_count = static_cast<uint32_t>(
+        share_until(flow.packet_count, flow, end) - share_until(flow.packet_count, flow, start));
+    record.byte_count = share_until(flow.byte_count, flow, end) - share_until(flow.byte_count, flow, start);
+
+    if (end < flow.last_timestamp) {
+        push(flow, end, pending.sequence);
+    }
+    if (record.packet_count > 0) {
+        out.push_back(record);  // Idle segments produce no record
+    }
+}
+
+uint64_t ExportScheduler::segment_end(const EnhancedFlowRecord& flow, uint64_t segment_start_ns) const {
+    if (active_timeout_ns_ == 0 || flow.last_timestamp - segment_start_ns <= active_timeout_ns_) {
+        return flow.last_timestamp;
+    }
+    return segment_start_ns + active_timeout_ns_;
+}
+
+bool ExportScheduler::later_export(const Pending& a, const Pending& b) {
+    // Ties break on start and then add() order, so the order does not
+    // depend on how flows were batched into release calls
+    if (a.export_ns != b.export_ns)
+        return a.export_ns > b.export_ns;
+    if (a.segment_start_ns != b.segment_start_ns)
+        return a.segment_start_ns > b.segment_start_ns;
+    return a.sequence > b.sequence;
+}
+
+} // namespace flowdump
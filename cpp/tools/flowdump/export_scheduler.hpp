@@ -0,0 +1,78 @@
+#ifndef FLOWDUMP_EXPORT_SCHEDULER_HPP
+#define FLOWDUMP_EXPORT_SCHEDULER_HPP
+
+#include "enhanced_flow.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flowdump {
+
+/**
+ * Output record order
+ */
+enum class ExportOrder {
+    START,   // First packet time (default)
+    EXPIRY   // Export time, like a real exporter
+};
+
+/**
+ * Exporter-order emulation
+ *
+ * Flows go in ordered by start time and come out ordered by export
+ * time. A flow is exported when it ends (last_timestamp). With an
+ * active timeout, a longer flow is also exported every timeout
+ * interval, as one record per interval with its share of packets and
+ * bytes.
+ *
+ * Pending exports sit in a min-heap keyed on export time. Once a start
+ * time W has been seen, no later flow can be exported before W, so
+ * everything due by then can be released. Memory is therefore bounded
+ * by the flows started within one maximum flow duration (or active
+ * timeout) of the newest start.
+ */
+class ExportScheduler {
+public:
+    /**
+     * @param active_timeout_ns Active timeout (0 = export only at flow end)
+     */
+    explicit ExportScheduler(uint64_t active_timeout_ns = 0);
+
+    /**
+     * Queue a flow (flows must arrive in non-decreasing start order)
+     */
+    void add(const EnhancedFlowRecord& flow);
+
+    /**
+     * Move records due by watermark_ns into out, in export order
+     */
+    void release(uint64_t watermark_ns, std::vector<EnhancedFlowRecord>& out);
+
+    /**
+     * Move all pending records into out, in export order
+     */
+    void flush(std::vector<EnhancedFlowRecord>& out);
+
+    size_t pending() const { return heap_.size(); }
+
+private:
+    struct Pending {
+        uint64_t export_ns;        // When the current record is exported
+        uint64_t segment_start_ns; // Start of the current active-timeout segment
+        uint64_t sequence;         // Order of add(), the final tie-break
+        EnhancedFlowRecord flow;
+    };
+
+    std::vector<Pending> heap_;    // Min-heap on export_ns
+    uint64_t active_timeout_ns_;
+    uint64_t added_ = 0;
+
+    void push(const EnhancedFlowRecord& flow, uint64_t segment_start_ns, uint64_t sequence);
+    void emit_top(std::vector<EnhancedFlowRecord>& out);
+    uint64_t segment_end(const EnhancedFlowRecord& flow, uint64_t segment_start_ns) const;
+    static bool later_export(const Pending& a, const Pending& b);
+};
+
+} // namespace flowdump
+
+#endif // FLOWDUMP_EXPORT_SCHEDULER_HPP
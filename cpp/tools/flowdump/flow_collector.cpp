@@ -1,16 +1,32 @@
 #include "flow_collector.hpp"
+#include <algorithm>
 #include <iostream>
 
 namespace flowdump {
 
+namespace {
+
+// Adaptive window: a quarter of the skew, but at least enough time for
+// MIN_WINDOW_FLOWS flows so sorts stay batched
+constexpr double SKEW_PER_WINDOW = 4.0;
+constexpr double MIN_WINDOW_FLOWS = 256.0;
+constexpr uint64_t MIN_ADAPTIVE_WINDOW_NS = 10000;        // 10 us
+constexpr uint64_t MAX_ADAPTIVE_WINDOW_NS = 1000000000;   // 1 s
+constexpr uint64_t ADAPT_INTERVAL_FLOWS = 1024;
+
+} // namespace
+
 FlowCollector::FlowCollector(ThreadSafeQueue<EnhancedFlowRecord>& input_queue,
                              uint64_t chunk_duration_ns,
                              FlowFormatter& formatter,
                              std::ostream& output,
                              size_t num_generators,
-                             bool suppress_header)
+                             bool suppress_header,
+                             ExportOrder export_order,
+                             uint64_t active_timeout_ns,
+                             size_t num_streams)
     : input_queue_(input_queue),
-      chunker_(chunk_duration_ns),
+      chunker_(chunk_duration_ns > 0 ? chunk_duration_ns : MIN_ADAPTIVE_WINDOW_NS),
       formatter_(formatter),
       output_(output),
       num_generators_(num_generators),
@@ -18,7 +34,29 @@ FlowCollector::FlowCollector(ThreadSafeQueue<EnhancedFlowRecord>& input_queue,
       flows_collected_(0),
       suppress_header_(suppress_header),
       header_printed_(false),
-      first_flow_(true) {
+      first_flow_(true),
+      export_order_(export_order),
+      exporter_(active_timeout_ns),
+      stream_latest_(num_streams > 0 ? num_streams : num_generators, 0),
+      watermark_(0),
+      adaptive_(chunk_duration_ns == 0),
+      gate_(nullptr),
+      first_timestamp_(UINT64_MAX),
+      newest_(0),
+      skew_ewma_(0.0),
+      skew_samples_(0),
+      skew_sum_(0.0),
+      window_sum_(0.0) {
+    metrics_.adaptive = adaptive_;
+}
+
+void FlowCollector::set_release_targets(const ReleaseTargets& targets, LeadGate* gate) {
+    targets_ = targets;
+    gate_ = gate;
+    if (gate_) {
+        gate_->set_held_limit(targets_.max_buffered);
+    }
+    adapt();
 }
 
 void FlowCollector::run() {
@@ -37,9 +75,36 @@ void FlowCollector::run() {
         auto flow_opt = input_queue_.try_pop(std::chrono::milliseconds(10));
 
         if (flow_opt.has_value()) {
+            if (flow_opt->is_end_of_stream()) {
+                advance_stream(flow_opt->stream_id, UINT64_MAX);
+                process_complete_chunks();
+                continue;
+            }
+
             // Add flow to chunker
+            uint64_t timestamp = flow_opt->timestamp;
             chunker_.add_flow(*flow_opt);
             flows_collected_++;
+            metrics_.peak_buffered = std::max(metrics_.peak_buffered, chunker_.flow_count());
+            first_timestamp_ = std::min(first_timestamp_, timestamp);
+            if (timestamp > newest_) {
+                newest_ = timestamp;
+            } else {
+                metrics_.max_arrival_lag_ns = std::max(metrics_.max_arrival_lag_ns, newest_ - timestamp);
+            }
+            advance_stream(flow_opt->stream_id, timestamp);
+
+            // Skew once every stream has reported
+            if (watermark_ > 0 && watermark_ != UINT64_MAX) {
+                uint64_t skew = newest_ > watermark_ ? newest_ - watermark_ : 0;
+                metrics_.max_skew_ns = std::max(metrics_.max_skew_ns, skew);
+                skew_sum_ += static_cast<double>(skew);
+                ++skew_samples_;
+                skew_ewma_ += (static_cast<double>(skew) - skew_ewma_) / 256.0;
+            }
+            if (flows_collected_ % ADAPT_INTERVAL_FLOWS == 0) {
+                adapt();
+            }
 
             // Process complete chunks
             process_complete_chunks();
@@ -66,11 +131,107 @@ void FlowCollector::generator_done() {
     generators_done_++;
 }
 
+CollectorMetrics FlowCollector::metrics() const {
+    CollectorMetrics metrics = metrics_;
+    if (metrics.windows > 0) {
+        metrics.mean_window_ns = window_sum_ / static_cast<double>(metrics.windows);
+    }
+    if (skew_samples_ > 0) {
+        metrics.mean_skew_ns = skew_sum_ / static_cast<double>(skew_samples_);
+    }
+    if (gate_) {
+        metrics.lead_limit_ns = gate_->lead_limit();
+        metrics.stalls = gate_->stalls();
+    }
+    return metrics;
+}
+
+void FlowCollector::adapt() {
+    // Flow time per collected flow, once there is a span to measure
+    double ns_per_flow = 0.0;
+    if (flows_collected_ > 0 && newest_ > first_timestamp_) {
+        ns_per_flow = static_cast<double>(newest_ - first_timestamp_) /
+                      static_cast<double>(flows_collected_);
+    }
+
+    // Ordering comes from the watermark, so a window only adds delay on
+    // top of the skew; keep it a fraction of the skew, enough to batch,
+    // and within its share of the delay target
+    double max_window = static_cast<double>(chunker_.chunk_duration());
+    if (adaptive_) {
+        max_window = static_cast<double>(MAX_ADAPTIVE_WINDOW_NS);
+        if (targets_.max_delay_ns > 0) {
+            max_window = std::min(max_window, static_cast<double>(targets_.max_delay_ns) / SKEW_PER_WINDOW);
+        }
+        // A small buffer cap takes priority over batching
+        double window_flows = MIN_WINDOW_FLOWS;
+        if (targets_.max_buffered > 0) {
+            window_flows = std::min(window_flows, static_cast<double>(targets_.max_buffered) / 2.0);
+        }
+        double window = std::max(skew_ewma_ / SKEW_PER_WINDOW, window_flows * ns_per_flow);
+        window = std::max(std::min(window, max_window), static_cast<double>(MIN_ADAPTIVE_WINDOW_NS));
+        chunker_.set_chunk_duration(static_cast<uint64_t>(window));
+    }
+
+    if (!gate_ || (targets_.max_delay_ns == 0 && targets_.max_buffered == 0)) {
+        return;
+    }
+
+    // Output lags the newest flow by up to skew + window, so the skew
+    // producers may build up is what remains of each target (the delay
+    // budget against the largest window, so the sum holds as it adapts)
+    double window = static_cast<double>(chunker_.chunk_duration());
+    double lead = static_cast<double>(UINT64_MAX);
+    if (targets_.max_delay_ns > 0) {
+        lead = static_cast<double>(targets_.max_delay_ns) - max_window;
+    }
+    if (targets_.max_buffered > 0 && ns_per_flow == 0.0) {
+        lead = 0.0;  // No flow rate yet: hold producers in step until there is
+    } else if (targets_.max_buffered > 0) {
+        double span = static_cast<double>(targets_.max_buffered) * ns_per_flow;
+        size_t buffered = chunker_.flow_count();
+        if (buffered > targets_.max_buffered) {
+            // Over the cap: tighten in proportion until it drains
+            span *= static_cast<double>(targets_.max_buffered) / static_cast<double>(buffered);
+        }
+        lead = std::min(lead, span - window);
+    }
+    lead = std::max(lead, 0.0);
+    gate_->set_lead_limit(lead >= static_cast<double>(UINT64_MAX) ? UINT64_MAX
+                                                                   : static_cast<uint64_t>(lead));
+}
+
+void FlowCollector::advance_stream(uint32_t stream_id, uint64_t timestamp_ns) {
+    if (stream_id == 0 || stream_id > stream_latest_.size()) {
+        return;
+    }
+    uint64_t& latest = stream_latest_[stream_id - 1];
+    bool was_lowest = latest == watermark_;
+    latest = std::max(latest, timestamp_ns);
+    if (was_lowest) {
+        watermark_ = *std::min_element(stream_latest_.begin(), stream_latest_.end());
+    }
+}
+
 void FlowCollector::process_complete_chunks() {
-    while (chunker_.has_complete_chunk()) {
-        auto chunk = chunker_.get_complete_chunk();
-        if (!chunk.empty()) {
-            output_chunk(chunk);
+    while (chunker_.has_chunk_before(watermark_)) {
+        auto chunk = chunker_.get_chunk_before(watermark_);
+        uint64_t window = chunk.end_ns - chunk.start_ns;
+        metrics_.min_window_ns = metrics_.windows == 0 ? window
+                                                       : std::min(metrics_.min_window_ns, window);
+        metrics_.max_window_ns = std::max(metrics_.max_window_ns, window);
+        window_sum_ += static_cast<double>(window);
+        ++metrics_.windows;
+        if (newest_ > chunk.start_ns) {
+            metrics_.max_output_delay_ns = std::max(metrics_.max_output_delay_ns,
+                                                    newest_ - chunk.start_ns);
+        }
+        if (!chunk.flows.empty()) {
+            size_t released = chunk.flows.size();
+            output_chunk(chunk.flows);
+            if (gate_ && targets_.max_buffered > 0) {
+                gate_->release(released);
+            }
         }
     }
 }
@@ -82,18 +243,40 @@ void FlowCollector::flush_remaining_chunks() {
             output_chunk(chunk);
         }
     }
+
+    if (export_order_ == ExportOrder::EXPIRY) {
+        exported_.clear();
+        exporter_.flush(exported_);
+        write_flows(exported_, true);
+    }
 }
 
 void FlowCollector::output_chunk(std::vector<EnhancedFlowRecord>& flows) {
+    // Canonical order first, so ties sort the same whatever the arrival order
+    std::stable_sort(flows.begin(), flows.end(), [](const auto& a, const auto& b) {
+        if (a.timestamp != b.timestamp)
+            return a.timestamp < b.timestamp;
+        return a.stream_id < b.stream_id;
+    });
+
+    if (export_order_ == ExportOrder::EXPIRY) {
+        // Queue by start time; everything due by the newest start can go out
+        for (const auto& flow : flows) {
+            exporter_.add(flow);
+        }
+        exported_.clear();
+        exporter_.release(flows.back().timestamp, exported_);
+        write_flows(exported_, false);
+        return;
+    }
+
     // Sort flows according to configured field
     formatter_.sort_flows(flows);
 
     // Output each flow
+    bool final_chunk = watermark_ == UINT64_MAX && chunker_.chunk_count() == 0;
     for (size_t i = 0; i < flows.size(); ++i) {
-        bool is_last = (i == flows.size() - 1) &&
-                       (generators_done_ >= num_generators_) &&
-                       (input_queue_.empty()) &&
-                       (chunker_.chunk_count() == 0);
+        bool is_last = (i == flows.size() - 1) && final_chunk;
 
         std::string formatted = formatter_.format_flow(flows[i], is_last);
         output_ << formatted << "\n";
@@ -101,4 +284,12 @@ void FlowCollector::output_chunk(std::vector<EnhancedFlowRecord>& flows) {
     }
 }
 
+void FlowCollector::write_flows(const std::vector<EnhancedFlowRecord>& flows, bool final_batch) {
+    for (size_t i = 0; i < flows.size(); ++i) {
+        bool is_last = final_batch && i == flows.size() - 1;
+        output_ << formatter_.format_flow(flows[i], is_last) << "\n";
+        first_flow_ = false;
+    }
+}
+
 } // namespace flowdump
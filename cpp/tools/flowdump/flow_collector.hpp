@@ -2,6 +2,8 @@
 #define FLOWDUMP_FLOW_COLLECTOR_HPP
 
 #include "enhanced_flow.hpp"
+#include "export_scheduler.hpp"
+#include "lead_gate.hpp"
 #include "thread_safe_queue.hpp"
 #include "timestamp_chunker.hpp"
 #include "flow_formatter.hpp"
@@ -11,9 +13,59 @@
 
 namespace flowdump {
 
+/**
+ * Bounds for the collector's release horizon (0 = unbounded)
+ */
+struct ReleaseTargets {
+    uint64_t max_delay_ns = 0;  // Output lag behind the newest flow, in flow time
+    size_t max_buffered = 0;    // Flows queued and held for ordering (approximate)
+};
+
+/**
+ * Ordering and release statistics (timestamps are flow time)
+ */
+struct CollectorMetrics {
+    bool adaptive = false;             // Window chosen by the collector
+    uint64_t windows = 0;              // Windows released
+    uint64_t min_window_ns = 0;
+    uint64_t max_window_ns = 0;
+    double mean_window_ns = 0.0;
+    double mean_skew_ns = 0.0;         // Newest flow minus slowest stream
+    uint64_t max_skew_ns = 0;
+    uint64_t max_arrival_lag_ns = 0;   // Newest flow minus a flow arriving after it
+    uint64_t max_output_delay_ns = 0;  // Newest flow minus a window's start at release
+    size_t peak_buffered = 0;          // Most flows held at once
+    uint64_t lead_limit_ns = UINT64_MAX;  // Final producer lead limit (UINT64_MAX = none)
+    uint64_t stalls = 0;               // Times a producer waited at the lead limit
+};
+
 /**
  * Flow collector thread
  * Consumes flows from queue, chunks by timestamp, sorts, and outputs
+ *
+ * Streams have ids 1..num_streams (0 = one per generator). A window is
+ * only released once every stream has sent a flow past its end (or its
+ * end-of-stream marker), so output is in order however far streams
+ * drift apart, and windows are ordered by (timestamp, stream_id,
+ * arrival within the stream) before sorting. Output then depends only
+ * on each stream's flows, not on how worker threads interleave them.
+ *
+ * Ordering therefore needs no window: output lags the newest flow by
+ * the observed skew between streams (newest flow minus slowest stream)
+ * plus at most one window. With chunk_duration_ns 0 the window adapts
+ * to a quarter of the skew, but at least 256 flows' worth of time (10
+ * us to 1 s), so windows shrink when streams are in step and grow only
+ * when they drift apart.
+ *
+ * Release targets bound the skew itself. The collector sets the
+ * LeadGate lead limit so that skew plus window stays under
+ * max_delay_ns, and so that the buffered time span times the observed
+ * flow rate stays under max_buffered (no lead until a rate has been
+ * observed). max_buffered is also the gate's held limit, so producers
+ * wait directly on the flows queued and buffered. Producers that run
+ * ahead are held back rather than anything being released out of
+ * order. Targets are approximate: the slowest producer is never held,
+ * and a stream's own gap between consecutive flows can add to them.
  */
 class FlowCollector {
 public:
@@ -22,7 +74,15 @@ public:
                   FlowFormatter& formatter,
                   std::ostream& output,
                   size_t num_generators,
-                  bool suppress_header = false);
+                  bool suppress_header = false,
+                  ExportOrder export_order = ExportOrder::START,
+                  uint64_t active_timeout_ns = 0,
+                  size_t num_streams = 0);
+
+    /**
+     * Bound the release horizon through the producers' gate (call before run())
+     */
+    void set_release_targets(const ReleaseTargets& targets, LeadGate* gate);
 
     /**
      * Run the collector (call in thread)
@@ -39,7 +99,22 @@ public:
      */
     uint64_t flows_collected() const { return flows_collected_; }
 
+    /**
+     * Ordering and release statistics (after run())
+     */
+    CollectorMetrics metrics() const;
+
 private:
+    /**
+     * Record that a stream has reached timestamp_ns
+     */
+    void advance_stream(uint32_t stream_id, uint64_t timestamp_ns);
+
+    /**
+     * Retune the adaptive window and the producers' lead limit
+     */
+    void adapt();
+
     /**
      * Process and output complete chunks
      */
@@ -55,6 +130,11 @@ private:
      */
     void output_chunk(std::vector<EnhancedFlowRecord>& flows);
 
+    /**
+     * Write flows in their current order
+     */
+    void write_flows(const std::vector<EnhancedFlowRecord>& flows, bool final_batch);
+
     ThreadSafeQueue<EnhancedFlowRecord>& input_queue_;
     TimestampChunker chunker_;
     FlowFormatter& formatter_;
@@ -65,6 +145,25 @@ private:
     bool suppress_header_;
     bool header_printed_;
     bool first_flow_;
+    ExportOrder export_order_;
+    ExportScheduler exporter_;
+    std::vector<EnhancedFlowRecord> exported_;  // Reused release buffer
+    std::vector<uint64_t> stream_latest_;        // Latest timestamp per stream
+    uint64_t watermark_;                         // Minimum of stream_latest_
+
+    // Adaptive release
+    bool adaptive_;
+    ReleaseTargets targets_;
+    LeadGate* gate_;
+    uint64_t first_timestamp_;
+    uint64_t newest_;
+    double skew_ewma_;
+
+    // Metrics
+    uint64_t skew_samples_;
+    double skew_sum_;
+    double window_sum_;
+    CollectorMetrics metrics_;
 };
 
 } // namespace flowdump
@@ -11,14 +11,14 @@ FlowFormatter::FlowFormatter(OutputFormat format, SortField sort_field, bool pre
 void FlowFormatter::sort_flows(std::vector<EnhancedFlowRecord>& flows) const {
     switch (sort_field_) {
     case SortField::TIMESTAMP:
-        std::sort(flows.begin(), flows.end(),
+        std::stable_sort(flows.begin(), flows.end(),
                   [](const auto& a, const auto& b) {
                       return a.timestamp < b.timestamp;
                   });
         break;
 
     case SortField::STREAM_ID:
-        std::sort(flows.begin(), flows.end(),
+        std::stable_sort(flows.begin(), flows.end(),
                   [](const auto& a, const auto& b) {
                       if (a.stream_id != b.stream_id)
                           return a.stream_id < b.stream_id;
@@ -27,7 +27,7 @@ void FlowFormatter::sort_flows(std::vector<EnhancedFlowRecord>& flows) const {
         break;
 
     case SortField::SOURCE_IP:
-        std::sort(flows.begin(), flows.end(),
+        std::stable_sort(flows.begin(), flows.end(),
                   [](const auto& a, const auto& b) {
                       if (a.source_ip != b.source_ip)
                           return a.source_ip < b.source_ip;
@@ -36,7 +36,7 @@ void FlowFormatter::sort_flows(std::vector<EnhancedFlowRecord>& flows) const {
         break;
 
     case SortField::DESTINATION_IP:
-        std::sort(flows.begin(), flows.end(),
+        std::stable_sort(flows.begin(), flows.end(),
                   [](const auto& a, const auto& b) {
                       if (a.destination_ip != b.destination_ip)
                           return a.destination_ip < b.destination_ip;
@@ -45,7 +45,7 @@ void FlowFormatter::sort_flows(std::vector<EnhancedFlowRecord>& flows) const {
         break;
 
     case SortField::BYTE_COUNT:
-        std::sort(flows.begin(), flows.end(),
+        std::stable_sort(flows.begin(), flows.end(),
                   [](const auto& a, const auto& b) {
                       if (a.byte_count != b.byte_count)
                           return a.byte_count > b.byte_count;  // Descending
@@ -54,7 +54,7 @@ void FlowFormatter::sort_flows(std::vector<EnhancedFlowRecord>& flows) const {
         break;
 
     case SortField::PACKET_COUNT:
-        std::sort(flows.begin(), flows.end(),
+        std::stable_sort(flows.begin(), flows.end(),
                   [](const auto& a, const auto& b) {
                       if (a.packet_count != b.packet_count)
                           return a.packet_count > b.packet_count;  // Descending
@@ -30,7 +30,7 @@ public:
     FlowFormatter(OutputFormat format, SortField sort_field, bool pretty = false);
 
     /**
-     * Sort flows according to configured field
+     * Sort flows according to configured field (stable, so ties keep their order)
      */
     void sort_flows(std::vector<EnhancedFlowRecord>& flows) const;
 
@@ -6,41 +6,86 @@ namespace flowdump {
 GeneratorWorker::GeneratorWorker(uint32_t stream_id,
                                  const flowgen::GeneratorConfig& config,
                                  ThreadSafeQueue<EnhancedFlowRecord>& output_queue,
-                                 uint64_t flows_to_generate)
-    : stream_id_(stream_id),
-      config_(config),
+                                 uint64_t flows_to_generate,
+                                 uint64_t end_timestamp_ns)
+    : GeneratorWorker(std::vector<StreamSpec>{{stream_id, config, flows_to_generate}},
+                      output_queue, end_timestamp_ns) {
+}
+
+GeneratorWorker::GeneratorWorker(std::vector<StreamSpec> streams,
+                                 ThreadSafeQueue<EnhancedFlowRecord>& output_queue,
+                                 uint64_t end_timestamp_ns)
+    : streams_(std::move(streams)),
       output_queue_(output_queue),
-      flows_to_generate_(flows_to_generate),
+      end_timestamp_ns_(end_timestamp_ns),
       flows_generated_(0) {
 }
 
 void GeneratorWorker::run() {
-    // Create generator for this thread
-    flowgen::FlowGenerator generator;
-
-    // Modify config to generate exact number of flows for this worker
-    flowgen::GeneratorConfig worker_config = config_;
-    worker_config.max_flows = flows_to_generate_;
-
-    if (!generator.initialize(worker_config)) {
-        std::cerr << "Failed to initialize generator for stream "
-                  << std::hex << stream_id_ << std::dec << std::endl;
-        return;
+    // Create a generator per stream
+    size_t n = streams_.size();
+    std::vector<std::unique_ptr<flowgen::FlowGenerator>> generators;
+    std::vector<uint64_t> generated(n, 0);
+    std::vector<bool> active(n, true);
+    for (size_t i = 0; i < n; ++i) {
+        generators.push_back(std::make_unique<flowgen::FlowGenerator>());
+        if (!generators[i]->initialize(streams_[i].config)) {
+            std::cerr << "Failed to initialize generator for stream "
+                      << std::hex << streams_[i].stream_id << std::dec << std::endl;
+            output_queue_.push(EnhancedFlowRecord::end_of_stream(streams_[i].stream_id));
+            active[i] = false;
+        }
     }
 
-    // Generate flows
+    // Generate flows until each stream reaches its count or the end timestamp
     flowgen::FlowRecord basic_flow;
-    while (generator.next(basic_flow)) {
-        EnhancedFlowRecord enhanced = enhance_flow(basic_flow);
-        output_queue_.push(std::move(enhanced));
+    FlowStats stats;
+    while (true) {
+        size_t next = n;
+        for (size_t i = 0; i < n; ++i) {
+            if (active[i] && (next == n || generators[i]->current_timestamp_ns() <
+                                               generators[next]->current_timestamp_ns())) {
+                next = i;
+            }
+        }
+        if (next == n) {
+            break;
+        }
+
+        bool done = generated[next] >= streams_[next].flows_to_generate;
+        if (!done) {
+            generators[next]->next(basic_flow, stats);
+            done = end_timestamp_ns_ > 0 && basic_flow.timestamp >= end_timestamp_ns_;
+        }
+        if (done) {
+            output_queue_.push(EnhancedFlowRecord::end_of_stream(streams_[next].stream_id));
+            active[next] = false;
+            continue;
+        }
+        if (gate_) {
+            gate_->wait(gate_index_, basic_flow.timestamp);
+        }
+        output_queue_.push(enhance_flow(streams_[next].stream_id, basic_flow, stats));
+        generated[next]++;
         flows_generated_++;
     }
+
+    if (gate_) {
+        gate_->finish(gate_index_);
+    }
+
+    pacing_.clear();
+    for (size_t i = 0; i < n; ++i) {
+        pacing_.push_back(generators[i]->pacing_report());
+    }
 }
 
-EnhancedFlowRecord GeneratorWorker::enhance_flow(const flowgen::FlowRecord& basic_flow) {
+EnhancedFlowRecord GeneratorWorker::enhance_flow(uint32_t stream_id,
+                                                 const flowgen::FlowRecord& basic_flow,
+                                                 const FlowStats& stats) {
     EnhancedFlowRecord enhanced;
 
-    enhanced.stream_id = stream_id_;
+    enhanced.stream_id = stream_id;
     enhanced.timestamp = basic_flow.timestamp;  // Keep for chunking (first packet time)
     enhanced.source_ip = basic_flow.source_ip;
     enhanced.destination_ip = basic_flow.destination_ip;
@@ -48,13 +93,6 @@ EnhancedFlowRecord GeneratorWorker::enhance_flow(const flowgen::FlowRecord& basi
     enhanced.destination_port = basic_flow.destination_port;
     enhanced.protocol = basic_flow.protocol;
 
-    // Generate realistic packet count, byte count, and flow duration
-    FlowStats stats = generate_flow_stats(
-        basic_flow.packet_length,
-        basic_flow.protocol,
-        basic_flow.destination_port
-    );
-
     enhanced.packet_count = stats.packet_count;
     enhanced.byte_count = stats.byte_count;
 
@@ -2,23 +2,51 @@
 #define FLOWDUMP_GENERATOR_WORKER_HPP
 
 #include "enhanced_flow.hpp"
+#include "lead_gate.hpp"
 #include "thread_safe_queue.hpp"
 #include <flowgen/generator.hpp>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace flowdump {
 
+/**
+ * One logical flow stream: a generator configuration and its flow budget
+ */
+struct StreamSpec {
+    uint32_t stream_id;
+    flowgen::GeneratorConfig config;
+    uint64_t flows_to_generate;
+};
+
 /**
  * Generator worker thread
- * Each worker generates flows independently and pushes to shared queue
+ * Each worker generates its streams independently and pushes to shared queue
+ *
+ * A worker may own several streams; it always advances the one with the
+ * earliest next timestamp, so its streams progress together. Each
+ * stream ends with an EnhancedFlowRecord::end_of_stream() marker.
  */
 class GeneratorWorker {
 public:
     GeneratorWorker(uint32_t stream_id,
                     const flowgen::GeneratorConfig& config,
                     ThreadSafeQueue<EnhancedFlowRecord>& output_queue,
-                    uint64_t flows_to_generate);
+                    uint64_t flows_to_generate,
+                    uint64_t end_timestamp_ns = 0);
+
+    GeneratorWorker(std::vector<StreamSpec> streams,
+                    ThreadSafeQueue<EnhancedFlowRecord>& output_queue,
+                    uint64_t end_timestamp_ns = 0);
+
+    /**
+     * Wait at gate (as producer index) before sending each flow
+     */
+    void set_lead_gate(LeadGate* gate, size_t index) {
+        gate_ = gate;
+        gate_index_ = index;
+    }
 
     /**
      * Run the worker (call in thread)
@@ -30,17 +58,26 @@ public:
      */
     uint64_t flows_generated() const { return flows_generated_; }
 
+    /**
+     * Achieved versus target utilization of each stream (after run())
+     */
+    const std::vector<flowgen::PacingReport>& pacing_reports() const { return pacing_; }
+
 private:
     /**
-     * Convert basic FlowRecord to EnhancedFlowRecord
+     * Convert basic FlowRecord and its statistics to EnhancedFlowRecord
      */
-    EnhancedFlowRecord enhance_flow(const flowgen::FlowRecord& basic_flow);
+    EnhancedFlowRecord enhance_flow(uint32_t stream_id,
+                                    const flowgen::FlowRecord& basic_flow,
+                                    const FlowStats& stats);
 
-    uint32_t stream_id_;
-    flowgen::GeneratorConfig config_;
+    std::vector<StreamSpec> streams_;
     ThreadSafeQueue<EnhancedFlowRecord>& output_queue_;
-    uint64_t flows_to_generate_;
+    uint64_t end_timestamp_ns_;  // 0 = stop on flow count only
     uint64_t flows_generated_;
+    std::vector<flowgen::PacingReport> pacing_;
+    LeadGate* gate_ = nullptr;
+    size_t gate_index_ = 0;
 };
 
 } // namespace flowdump
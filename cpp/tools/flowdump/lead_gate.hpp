@@ -0,0 +1,133 @@
+#ifndef FLOWDUMP_LEAD_GATE_HPP
+#define FLOWDUMP_LEAD_GATE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace flowdump {
+
+/**
+ * Backpressure between generator workers
+ *
+ * Each producer reports the timestamp of the flow it is about to send
+ * and blocks while that is more than the lead limit ahead of the
+ * slowest producer. Progress counts flows already sent (the previous
+ * wait()), which is what the consumer has seen, so a slow producer's
+ * gap before its next flow does not widen the lead. With a held
+ * limit, producers also block while that many flows are in flight to
+ * the consumer (sent but not yet released through release()). The
+ * slowest producer never blocks, so the group always makes progress.
+ * With the default unlimited lead and no held limit, wait() is a single
+ * atomic load.
+ */
+class LeadGate {
+public:
+    explicit LeadGate(size_t producers)
+        : progress_(producers, 0), pending_(producers, 0), slowest_(0), held_(0), held_limit_(0),
+          lead_limit_(UINT64_MAX), stalls_(0) {}
+
+    /**
+     * Producer `index` is about to send timestamp_ns
+     */
+    void wait(size_t index, uint64_t timestamp_ns) {
+        if (lead_limit_.load(std::memory_order_relaxed) == UINT64_MAX && held_limit_ == 0) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        advance(index, pending_[index]);
+        if (!allowed(index, timestamp_ns)) {
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+            cond_.wait(lock, [&] { return allowed(index, timestamp_ns); });
+        }
+        pending_[index] = timestamp_ns;
+        ++held_;
+    }
+
+    /**
+     * Producer `index` has sent its last flow
+     */
+    void finish(size_t index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        advance(index, UINT64_MAX);
+    }
+
+    /**
+     * Largest lead over the slowest producer (UINT64_MAX = unlimited)
+     */
+    void set_lead_limit(uint64_t lead_ns) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lead_limit_.store(lead_ns, std::memory_order_relaxed);
+        }
+        cond_.notify_all();
+    }
+
+    uint64_t lead_limit() const { return lead_limit_.load(std::memory_order_relaxed); }
+
+    /**
+     * Largest number of flows sent but not yet released (0 = unlimited;
+     * call before any producer starts)
+     */
+    void set_held_limit(size_t flows) { held_limit_ = flows; }
+
+    /**
+     * The consumer is done with `flows` flows
+     */
+    void release(size_t flows) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            held_ -= std::min<uint64_t>(held_, flows);
+        }
+        cond_.notify_all();
+    }
+
+    /**
+     * Times a producer had to wait
+     */
+    uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+private:
+    // Called with mutex_ held
+    void advance(size_t index, uint64_t timestamp_ns) {
+        uint64_t& progress = progress_[index];
+        bool was_slowest = progress == slowest_;
+        progress = std::max(progress, timestamp_ns);
+        if (was_slowest) {
+            uint64_t slowest = *std::min_element(progress_.begin(), progress_.end());
+            if (slowest != slowest_) {
+                slowest_ = slowest;
+                cond_.notify_all();
+            }
+        }
+    }
+
+    bool allowed(size_t index, uint64_t timestamp_ns) const {
+        if (progress_[index] == slowest_) {
+            return true;
+        }
+        if (held_limit_ > 0 && held_ >= held_limit_) {
+            return false;
+        }
+        uint64_t limit = lead_limit_.load(std::memory_order_relaxed);
+        return limit == UINT64_MAX || timestamp_ns <= slowest_ || timestamp_ns - slowest_ <= limit;
+    }
+
+    std::vector<uint64_t> progress_;  // Latest timestamp sent per producer
+    std::vector<uint64_t> pending_;   // Timestamp each producer is sending
+    uint64_t slowest_;                // Minimum of progress_
+    uint64_t held_;                   // Flows sent and not yet released
+    size_t held_limit_;
+    std::atomic<uint64_t> lead_limit_;
+    std::atomic<uint64_t> stalls_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+};
+
+} // namespace flowdump
+
+#endif // FLOWDUMP_LEAD_GATE_HPP
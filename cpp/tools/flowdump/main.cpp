@@ -6,7 +6,11 @@
 #include "flow_collector.hpp"
 #include "arg_parser.hpp"
 #include <flowgen/generator.hpp>
+#include <flowgen/profile.hpp>
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <random>
 #include <thread>
 #include <vector>
 #include <string>
@@ -16,22 +20,46 @@
 
 using namespace flowdump;
 
+// Logical streams of a seeded run unless --streams says otherwise
+constexpr size_t DEFAULT_SEEDED_STREAMS = 10;
+
+// Sort window of a seeded run sorted by a field other than timestamp
+constexpr uint64_t DEFAULT_SEEDED_WINDOW_MS = 10;
+
 struct ProgramOptions {
     std::string config_file;
     size_t num_threads = 10;
-    uint64_t flows_per_thread = 0;
+    size_t num_streams = 0;  // 0 = one per thread (DEFAULT_SEEDED_STREAMS with --seed)
+    uint64_t seed = 0;       // 0 = unseeded, output varies run to run
+    uint64_t flows_per_thread = 0;  // Per stream
     uint64_t total_flows = 0;
     std::string output_format_str = "text";
     std::string sort_field_str = "timestamp";
     OutputFormat output_format = OutputFormat::PLAIN_TEXT;
     SortField sort_field = SortField::TIMESTAMP;
-    uint64_t time_window_ms = 10;
+    uint64_t time_window_ms = 0;    // 0 = adaptive
+    uint64_t max_delay_ms = 0;      // Release horizon targets (0 = unbounded)
+    uint64_t max_buffer = 0;
     bool pretty = false;
     bool no_header = false;
     uint64_t start_timestamp_ns = 1704067200000000000ULL;  // 2024-01-01 00:00:00
     uint64_t end_timestamp_ns = 0;  // 0 means use duration-based calculation
+    std::string profile_file;  // Learned traffic profile (replaces built-in patterns)
+    std::string pacing = "bytes";  // bytes (enriched volume) or flows (one packet per flow)
+    std::string export_order_str = "start";
+    ExportOrder export_order = ExportOrder::START;
+    uint64_t active_timeout_ms = 0;  // 0 = export only at flow end
 };
 
+// Seed of logical stream `index`: a splitmix64 step from the base seed
+uint64_t stream_seed(uint64_t seed, size_t index) {
+    uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z != 0 ? z : 1;
+}
+
 bool file_exists(const std::string& path) {
     struct stat buffer;
     return (stat(path.c_str(), &buffer) == 0);
@@ -63,6 +91,16 @@ SortField parse_sort_field(const std::string& field) {
                            " (valid: timestamp, stream_id, src_ip, dst_ip, bytes, packets)");
 }
 
+ExportOrder parse_export_order(const std::string& order) {
+    std::string ord = order;
+    std::transform(ord.begin(), ord.end(), ord.begin(), ::tolower);
+
+    if (ord == "start") return ExportOrder::START;
+    if (ord == "expiry") return ExportOrder::EXPIRY;
+
+    throw std::runtime_error("Invalid export order: " + order + " (valid: start, expiry)");
+}
+
 int main(int argc, char** argv) {
     ProgramOptions opts;
 
@@ -76,8 +114,14 @@ int main(int argc, char** argv) {
     parser.add_option("-n", "num-threads", opts.num_threads,
                      "Number of generator threads", static_cast<size_t>(10));
 
+    parser.add_option("", "streams", opts.num_streams,
+                     "Number of logical flow streams (0 = one per thread, 10 with --seed)", static_cast<size_t>(0));
+
+    parser.add_option("", "seed", opts.seed,
+                     "Random seed: same output for any thread count (0 = unseeded)", static_cast<uint64_t>(0));
+
     parser.add_option("-f", "flows-per-thread", opts.flows_per_thread,
-                     "Number of flows per thread", static_cast<uint64_t>(0));
+                     "Number of flows per stream", static_cast<uint64_t>(0));
 
     parser.add_option("-t", "total-flows", opts.total_flows,
                      "Total flows to generate (overrides --flows-per-thread)", static_cast<uint64_t>(0));
@@ -89,7 +133,14 @@ int main(int argc, char** argv) {
                      "Sort by: timestamp, stream_id, src_ip, dst_ip, bytes, packets", false, "timestamp");
 
     parser.add_option("-w", "time-window", opts.time_window_ms,
-                     "Time window for chunking in milliseconds", static_cast<uint64_t>(10));
+                     "Time window for chunking in milliseconds (0 = adaptive)", static_cast<uint64_t>(0));
+
+    parser.add_option("", "max-delay", opts.max_delay_ms,
+                     "Largest output lag behind the newest flow in ms of flow time (0 = unbounded)",
+                     static_cast<uint64_t>(0));
+
+    parser.add_option("", "max-buffer", opts.max_buffer,
+                     "Approximate cap on flows queued and held for ordering (0 = unbounded)", static_cast<uint64_t>(0));
 
     parser.add_option("", "start-timestamp", opts.start_timestamp_ns,
                      "Start timestamp in nanoseconds (Unix epoch)", static_cast<uint64_t>(1704067200000000000ULL));
@@ -97,6 +148,18 @@ int main(int argc, char** argv) {
     parser.add_option("", "end-timestamp", opts.end_timestamp_ns,
                      "End timestamp in nanoseconds (Unix epoch, 0=auto-calculate)", static_cast<uint64_t>(0));
 
+    parser.add_option("-p", "profile", opts.profile_file,
+                     "Traffic profile from 'flowstats learn' (replaces built-in patterns)");
+
+    parser.add_option("", "pacing", opts.pacing,
+                     "Flow spacing: bytes (enriched byte volume) or flows (one packet per flow)", false, "bytes");
+
+    parser.add_option("", "export-order", opts.export_order_str,
+                     "Record order: start (first packet) or expiry (flow end / active timeout)", false, "start");
+
+    parser.add_option("", "active-timeout", opts.active_timeout_ms,
+                     "Active timeout in ms for --export-order expiry (0=export at flow end)", static_cast<uint64_t>(0));
+
     parser.add_flag("no-header", opts.no_header,
                    "Suppress header in CSV/text output");
 
@@ -137,23 +200,47 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    // Parse export order
+    try {
+        opts.export_order = parse_export_order(opts.export_order_str);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
     // Validation
     if (opts.num_threads == 0) {
         std::cerr << "Error: Number of threads must be > 0\n";
         return 1;
     }
 
-    if (opts.time_window_ms == 0) {
-        std::cerr << "Error: Time window must be > 0\n";
+    if (opts.time_window_ms == 0 && opts.seed != 0 && opts.sort_field != SortField::TIMESTAMP) {
+        // Sorting by other fields is per window, so reproducible output needs fixed windows
+        opts.time_window_ms = DEFAULT_SEEDED_WINDOW_MS;
+    }
+
+    if (opts.pacing != "bytes" && opts.pacing != "flows") {
+        std::cerr << "Error: Invalid pacing: " << opts.pacing << " (valid: bytes, flows)\n";
         return 1;
     }
+    bool byte_pacing = opts.pacing == "bytes";
+
+    // The logical streams define the output; threads only produce them
+    if (opts.num_streams == 0) {
+        opts.num_streams = opts.seed != 0 ? DEFAULT_SEEDED_STREAMS : opts.num_threads;
+    }
+    size_t num_workers = std::min(opts.num_threads, opts.num_streams);
 
     // Load configuration
     // TODO: Load from YAML file when config parser is available
     // For now, create a basic config
     flowgen::GeneratorConfig base_config;
 
-    base_config.bandwidth_gbps = 10.0;
+    // With byte pacing the streams share one 10 Gbps link
+    const double link_bandwidth_gbps = 10.0;
+    base_config.bandwidth_gbps = byte_pacing ? link_bandwidth_gbps / opts.num_streams
+                                             : link_bandwidth_gbps;
+    base_config.pacing = opts.pacing;
     base_config.source_subnets = {"192.168.1.0/24", "192.168.2.0/24"};
     base_config.destination_subnets = {"10.0.0.0/8", "172.16.0.0/12"};
     base_config.source_weights = {70.0, 30.0};
@@ -164,11 +251,21 @@ int main(int argc, char** argv) {
     // Set start timestamp
     base_config.start_timestamp_ns = opts.start_timestamp_ns;
 
-    // Calculate flows_per_second based on bandwidth
-    double flows_per_second = (base_config.bandwidth_gbps * 1e9 / 8.0) /
+    // The streams model one network, so shared state (host populations,
+    // communication graphs) comes from a seed of the run, not the stream
+    if (opts.seed != 0) {
+        base_config.model_seed = stream_seed(opts.seed, SIZE_MAX);  // Not a stream index
+    } else {
+        std::random_device device;
+        base_config.model_seed = (static_cast<uint64_t>(device()) << 32 | device()) | 1;
+    }
+
+    // Calculate flows_per_second based on bandwidth (one packet per flow)
+    double flows_per_second = (link_bandwidth_gbps * 1e9 / 8.0) /
                                base_config.average_packet_size;
 
     // Determine flow count and end timestamp
+    bool end_given = opts.end_timestamp_ns > 0;
     if (opts.end_timestamp_ns > 0) {
         // User specified end timestamp - calculate flow count from time range
         if (opts.end_timestamp_ns <= opts.start_timestamp_ns) {
@@ -176,50 +273,61 @@ int main(int argc, char** argv) {
             return 1;
         }
 
-        uint64_t duration_ns = opts.end_timestamp_ns - opts.start_timestamp_ns;
-        double duration_seconds = static_cast<double>(duration_ns) / 1e9;
-        uint64_t calculated_total_flows = static_cast<uint64_t>(duration_seconds * flows_per_second);
-
-        // If user also specified flow count, warn about override
-        if (opts.total_flows > 0 || opts.flows_per_thread > 0) {
-            std::cerr << "Warning: --end-timestamp overrides flow count options. "
-                      << "Generating " << calculated_total_flows << " flows to fit time range.\n";
-        }
+        if (byte_pacing) {
+            // Flow sizes vary, so workers run until they reach the end timestamp
+            if (opts.total_flows > 0 || opts.flows_per_thread > 0) {
+                std::cerr << "Warning: --end-timestamp overrides flow count options.\n";
+            }
+            opts.total_flows = 0;
+        } else {
+            uint64_t duration_ns = opts.end_timestamp_ns - opts.start_timestamp_ns;
+            double duration_seconds = static_cast<double>(duration_ns) / 1e9;
+            uint64_t calculated_total_flows = static_cast<uint64_t>(duration_seconds * flows_per_second);
+
+            // If user also specified flow count, warn about override
+            if (opts.total_flows > 0 || opts.flows_per_thread > 0) {
+                std::cerr << "Warning: --end-timestamp overrides flow count options. "
+                          << "Generating " << calculated_total_flows << " flows to fit time range.\n";
+            }
 
-        opts.total_flows = calculated_total_flows;
-        opts.flows_per_thread = opts.total_flows / opts.num_threads;
-        if (opts.total_flows % opts.num_threads != 0) {
-            opts.flows_per_thread++;  // Round up
+            opts.total_flows = calculated_total_flows;
         }
     } else {
         // No end timestamp - use flow count to calculate duration
-        if (opts.total_flows > 0) {
-            opts.flows_per_thread = opts.total_flows / opts.num_threads;
-            if (opts.total_flows % opts.num_threads != 0) {
-                opts.flows_per_thread++;  // Round up
+        if (opts.total_flows == 0) {
+            if (opts.flows_per_thread == 0) {
+                opts.flows_per_thread = 10000;  // Default
             }
-        } else if (opts.flows_per_thread == 0) {
-            opts.flows_per_thread = 10000;  // Default
+            opts.total_flows = opts.num_streams * opts.flows_per_thread;
         }
 
-        // Calculate end timestamp based on flow count
-        uint64_t total_flows = opts.num_threads * opts.flows_per_thread;
-        double duration_seconds = static_cast<double>(total_flows) / flows_per_second;
+        // Calculate end timestamp based on flow count (replaced by the
+        // actual range after generation under byte pacing)
+        double duration_seconds = static_cast<double>(opts.total_flows) / flows_per_second;
         uint64_t duration_ns = static_cast<uint64_t>(duration_seconds * 1e9);
         opts.end_timestamp_ns = opts.start_timestamp_ns + duration_ns;
     }
 
-    // Set max flows in config
-    base_config.max_flows = opts.flows_per_thread;
-
     // Add traffic patterns
-    base_config.traffic_patterns = {
-        {"web_traffic", 40.0},
-        {"dns_traffic", 20.0},
-        {"database_traffic", 15.0},
-        {"ssh_traffic", 10.0},
-        {"random", 15.0}
-    };
+    std::shared_ptr<const flowgen::TrafficProfile> profile;
+    if (!opts.profile_file.empty()) {
+        // Load once up front: reports errors early and workers share this copy
+        try {
+            profile = flowgen::load_shared_profile(opts.profile_file);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        base_config.traffic_patterns = {{"profile:" + opts.profile_file, 100.0, {}}};
+    } else {
+        base_config.traffic_patterns = {
+            {"web_traffic", 40.0, {}},
+            {"dns_traffic", 20.0, {}},
+            {"database_traffic", 15.0, {}},
+            {"ssh_traffic", 10.0, {}},
+            {"random", 15.0, {}}
+        };
+    }
 
     // Create shared queue
     ThreadSafeQueue<EnhancedFlowRecord> flow_queue;
@@ -227,10 +335,18 @@ int main(int argc, char** argv) {
     // Create formatter
     FlowFormatter formatter(opts.output_format, opts.sort_field, opts.pretty);
 
-    // Create collector
+    // Create collector; workers that run ahead wait at the gate when
+    // the release horizon is bounded
+    LeadGate gate(num_workers);
     uint64_t chunk_duration_ns = opts.time_window_ms * 1000000ULL;  // ms to ns
     FlowCollector collector(flow_queue, chunk_duration_ns, formatter,
-                           std::cout, opts.num_threads, opts.no_header);
+                           std::cout, num_workers, opts.no_header,
+                           opts.export_order, opts.active_timeout_ms * 1000000ULL,
+                           opts.num_streams);
+    ReleaseTargets targets;
+    targets.max_delay_ns = opts.max_delay_ms * 1000000ULL;
+    targets.max_buffered = opts.max_buffer;
+    collector.set_release_targets(targets, &gate);
 
     // Launch collector thread
     std::thread collector_thread([&collector]() {
@@ -241,13 +357,27 @@ int main(int argc, char** argv) {
     std::vector<std::thread> generator_threads;
     std::vector<std::unique_ptr<GeneratorWorker>> workers;
 
-    for (size_t i = 0; i < opts.num_threads; ++i) {
-        uint32_t stream_id = i + 1;
-        auto worker = std::make_unique<GeneratorWorker>(
-            stream_id, base_config, flow_queue, opts.flows_per_thread
-        );
+    // Stream k gets stream_id k + 1, its share of the flows (the first
+    // total % streams streams take one extra) and goes to worker k % workers
+    std::vector<std::vector<StreamSpec>> assignments(num_workers);
+    for (size_t k = 0; k < opts.num_streams; ++k) {
+        StreamSpec spec{static_cast<uint32_t>(k + 1), base_config, UINT64_MAX};
+        if (opts.total_flows > 0) {
+            spec.flows_to_generate = opts.total_flows / opts.num_streams +
+                                     (k < opts.total_flows % opts.num_streams ? 1 : 0);
+        }
+        if (opts.seed != 0) {
+            spec.config.seed = stream_seed(opts.seed, k);
+        }
+        assignments[k % num_workers].push_back(std::move(spec));
+    }
 
-        workers.push_back(std::move(worker));
+    for (auto& streams : assignments) {
+        workers.push_back(std::make_unique<GeneratorWorker>(
+            std::move(streams), flow_queue,
+            byte_pacing && end_given ? opts.end_timestamp_ns : 0
+        ));
+        workers.back()->set_lead_gate(&gate, workers.size() - 1);
     }
 
     // Start all generator threads
@@ -271,16 +401,49 @@ int main(int argc, char** argv) {
 
     // Print summary to stderr so it doesn't interfere with output
     uint64_t total_generated = 0;
+    double target_gbps = 0.0;
+    double achieved_gbps = 0.0;
+    uint64_t last_timestamp_ns = opts.start_timestamp_ns;
     for (const auto& worker : workers) {
         total_generated += worker->flows_generated();
+        for (const flowgen::PacingReport& report : worker->pacing_reports()) {
+            target_gbps += report.target_gbps;
+            achieved_gbps += report.achieved_gbps;
+            last_timestamp_ns = std::max(last_timestamp_ns, opts.start_timestamp_ns + report.elapsed_ns);
+        }
+    }
+    if (byte_pacing && !end_given) {
+        opts.end_timestamp_ns = last_timestamp_ns;  // Flow-count estimate no longer applies
     }
 
     std::cerr << "\nSummary:\n"
-              << "  Threads: " << opts.num_threads << "\n"
+              << "  Threads: " << num_workers << "\n"
+              << "  Streams: " << opts.num_streams << "\n"
               << "  Flows generated: " << total_generated << "\n"
               << "  Flows collected: " << collector.flows_collected() << "\n"
               << "  Timestamp range: " << opts.start_timestamp_ns << " - "
               << opts.end_timestamp_ns << " ns\n";
+    if (target_gbps > 0.0) {
+        std::cerr << "  Link utilization: " << std::fixed << std::setprecision(2)
+                  << achieved_gbps << " of " << target_gbps << " Gbps ("
+                  << std::setprecision(1) << (100.0 * achieved_gbps / target_gbps) << "%)\n";
+    }
+
+    // Release horizon actually needed (flow time)
+    CollectorMetrics metrics = collector.metrics();
+    std::cerr << std::fixed << std::setprecision(3)
+              << "  Windows: " << metrics.windows << (metrics.adaptive ? " adaptive" : " fixed")
+              << ", " << metrics.min_window_ns / 1e6 << " - " << metrics.max_window_ns / 1e6
+              << " ms (mean " << metrics.mean_window_ns / 1e6 << " ms)\n"
+              << "  Stream skew: mean " << metrics.mean_skew_ns / 1e6 << " ms, max "
+              << metrics.max_skew_ns / 1e6 << " ms (max arrival lag "
+              << metrics.max_arrival_lag_ns / 1e6 << " ms)\n"
+              << "  Release horizon: max " << metrics.max_output_delay_ns / 1e6
+              << " ms behind newest flow, peak " << metrics.peak_buffered << " flows buffered\n";
+    if (metrics.lead_limit_ns != UINT64_MAX) {
+        std::cerr << "  Lead limit: " << metrics.lead_limit_ns / 1e6 << " ms ("
+                  << metrics.stalls << " producer waits)\n";
+    }
 
     return 0;
 }
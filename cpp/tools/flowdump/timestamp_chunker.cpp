@@ -4,47 +4,59 @@
 namespace flowdump {
 
 TimestampChunker::TimestampChunker(uint64_t chunk_duration_ns)
-    : chunk_duration_ns_(chunk_duration_ns),
-      oldest_chunk_id_(0),
-      has_oldest_(false) {
+    : chunk_duration_ns_(std::max<uint64_t>(chunk_duration_ns, 1)),
+      flow_count_(0) {
 }
 
-void TimestampChunker::add_flow(const EnhancedFlowRecord& flow) {
-    uint64_t chunk_id = flow.timestamp / chunk_duration_ns_;
-    chunks_[chunk_id].push_back(flow);
+void TimestampChunker::set_chunk_duration(uint64_t chunk_duration_ns) {
+    chunk_duration_ns_ = std::max<uint64_t>(chunk_duration_ns, 1);
+}
 
-    if (!has_oldest_) {
-        oldest_chunk_id_ = chunk_id;
-        has_oldest_ = true;
+void TimestampChunker::add_flow(const EnhancedFlowRecord& flow) {
+    ++flow_count_;
+
+    // The chunk starting at or before the flow, if the flow lies inside it
+    auto next = chunks_.upper_bound(flow.timestamp);
+    if (next != chunks_.begin()) {
+        Chunk& chunk = std::prev(next)->second;
+        if (flow.timestamp < chunk.end_ns) {
+            chunk.flows.push_back(flow);
+            return;
+        }
     }
-}
 
-bool TimestampChunker::has_complete_chunk() const {
-    if (!has_oldest_ || chunks_.empty()) {
-        return false;
+    // Open a chunk on the current grid, clipped to its neighbours
+    uint64_t start = flow.timestamp - flow.timestamp % chunk_duration_ns_;
+    uint64_t end = start + chunk_duration_ns_;
+    if (end < start) {
+        end = UINT64_MAX;  // Last grid cell
+    }
+    if (next != chunks_.begin()) {
+        start = std::max(start, std::prev(next)->second.end_ns);
+    }
+    if (next != chunks_.end()) {
+        end = std::min(end, next->first);
     }
 
-    // A chunk is complete when we have data from a later chunk
-    // This ensures all flows in the chunk have arrived
-    uint64_t latest_chunk = chunks_.rbegin()->first;
-    return (latest_chunk > oldest_chunk_id_);
+    Chunk& chunk = chunks_[start];
+    chunk.start_ns = start;
+    chunk.end_ns = end;
+    chunk.flows.push_back(flow);
 }
 
-std::vector<EnhancedFlowRecord> TimestampChunker::get_complete_chunk() {
-    if (!has_complete_chunk()) {
-        return {};
-    }
+bool TimestampChunker::has_chunk_before(uint64_t watermark_ns) const {
+    return !chunks_.empty() && chunks_.begin()->second.end_ns <= watermark_ns;
+}
 
-    auto it = chunks_.find(oldest_chunk_id_);
-    if (it == chunks_.end()) {
-        // No data for this chunk, move to next
-        oldest_chunk_id_++;
+TimestampChunker::Chunk TimestampChunker::get_chunk_before(uint64_t watermark_ns) {
+    if (!has_chunk_before(watermark_ns)) {
         return {};
     }
 
-    std::vector<EnhancedFlowRecord> result = std::move(it->second);
+    auto it = chunks_.begin();
+    Chunk result = std::move(it->second);
     chunks_.erase(it);
-    oldest_chunk_id_++;
+    flow_count_ -= result.flows.size();
 
     return result;
 }
@@ -53,24 +65,16 @@ std::vector<std::vector<EnhancedFlowRecord>> TimestampChunker::flush_all() {
     std::vector<std::vector<EnhancedFlowRecord>> result;
 
     // Get all remaining chunks in order
-    for (auto& [chunk_id, flows] : chunks_) {
-        if (!flows.empty()) {
-            result.push_back(std::move(flows));
+    for (auto& [start, chunk] : chunks_) {
+        if (!chunk.flows.empty()) {
+            result.push_back(std::move(chunk.flows));
         }
     }
 
     chunks_.clear();
-    has_oldest_ = false;
+    flow_count_ = 0;
 
     return result;
 }
 
-size_t TimestampChunker::flow_count() const {
-    size_t count = 0;
-    for (const auto& [chunk_id, flows] : chunks_) {
-        count += flows.size();
-    }
-    return count;
-}
-
 } // namespace flowdump
@@ -11,33 +11,52 @@ namespace flowdump {
 /**
  * Timestamp-based flow chunker for merging multi-threaded streams
  *
- * Groups flows into time-based chunks and outputs complete chunks
- * in order. A chunk is considered complete when we receive flows
- * from a later time window.
+ * Groups flows into time-based chunks and outputs complete chunks in
+ * order. The caller tracks how far every stream has progressed; a
+ * chunk is complete once that watermark passes the chunk's end.
+ *
+ * Chunks are contiguous, non-overlapping time ranges. A new chunk is
+ * aligned to the current chunk duration and clipped to its neighbours,
+ * so the duration can change between chunks (adaptive windows) and a
+ * fixed duration gives the plain [k * duration, (k + 1) * duration)
+ * grid.
  */
 class TimestampChunker {
 public:
+    struct Chunk {
+        uint64_t start_ns = 0;
+        uint64_t end_ns = 0;   // Exclusive
+        std::vector<EnhancedFlowRecord> flows;
+    };
+
     /**
      * Constructor
      * @param chunk_duration_ns Duration of each chunk in nanoseconds
      */
     explicit TimestampChunker(uint64_t chunk_duration_ns);
 
+    /**
+     * Duration of chunks opened from now on
+     */
+    void set_chunk_duration(uint64_t chunk_duration_ns);
+    uint64_t chunk_duration() const { return chunk_duration_ns_; }
+
     /**
      * Add a flow to the chunker
      */
     void add_flow(const EnhancedFlowRecord& flow);
 
     /**
-     * Check if there's a complete chunk ready to be retrieved
+     * Check if the oldest buffered chunk ends at or before watermark_ns
+     * (the earliest timestamp any stream can still send)
      */
-    bool has_complete_chunk() const;
+    bool has_chunk_before(uint64_t watermark_ns) const;
 
     /**
-     * Get the next complete chunk
-     * Returns empty vector if no complete chunk available
+     * Get the oldest buffered chunk if it ends at or before watermark_ns
+     * Returns an empty chunk otherwise
      */
-    std::vector<EnhancedFlowRecord> get_complete_chunk();
+    Chunk get_chunk_before(uint64_t watermark_ns);
 
     /**
      * Flush all remaining chunks (call at end of processing)
@@ -52,13 +71,12 @@ public:
     /**
      * Get total number of flows buffered
      */
-    size_t flow_count() const;
+    size_t flow_count() const { return flow_count_; }
 
 private:
     uint64_t chunk_duration_ns_;
-    std::map<uint64_t, std::vector<EnhancedFlowRecord>> chunks_;
-    uint64_t oldest_chunk_id_;
-    bool has_oldest_;
+    std::map<uint64_t, Chunk> chunks_;  // By start_ns
+    size_t flow_count_;
 };
 
 } // namespace flowdump
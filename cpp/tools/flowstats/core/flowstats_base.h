@@ -1,10 +1,12 @@
 #pragma once
 
 #include "progress_tracker.h"
+#include <flowgen/generator.hpp>
 #include <atomic>
 #include <thread>
 #include <vector>
 #include <memory>
+#include <iomanip>
 #include <iostream>
 #include <string>
 
@@ -16,12 +18,38 @@ struct TimestampRange {
     uint64_t end_ns;
 };
 
+// Simulated link shared by all worker streams
+constexpr double LINK_BANDWIDTH_GBPS = 10.0;
+
+// Default generator setup for the generating subcommands. Each of the
+// streams gets an equal share of the link and is paced by enriched bytes.
+inline flowgen::GeneratorConfig default_generator_config(uint64_t start_timestamp_ns,
+                                                         size_t streams = 1) {
+    flowgen::GeneratorConfig config;
+    config.start_timestamp_ns = start_timestamp_ns;
+    config.source_subnets = {"192.168.0.0/16", "10.10.0.0/16"};
+    config.destination_subnets = {"10.100.0.0/16", "172.16.0.0/12"};
+    config.min_packet_size = 64;
+    config.max_packet_size = 1500;
+    config.average_packet_size = 800;
+    config.traffic_patterns = {
+        {"web_traffic", 40.0, {}},
+        {"dns_traffic", 20.0, {}},
+        {"database_traffic", 20.0, {}},
+        {"random", 20.0, {}}
+    };
+    config.bandwidth_gbps = LINK_BANDWIDTH_GBPS / static_cast<double>(streams);
+    config.pacing = "bytes";
+    return config;
+}
+
 // Per-thread data structure (thread-local, no locking needed)
 struct PerThreadData {
     uint32_t m_thread_id;
     std::atomic<size_t> m_flows_generated;
     std::atomic<uint64_t> m_bytes_generated;
     std::atomic<bool> m_done;
+    flowgen::PacingReport m_pacing;  // Written by the worker before m_done
 
     PerThreadData()
         : m_thread_id(0)
@@ -190,11 +218,46 @@ protected:
         );
     }
 
+    flowgen::GeneratorConfig default_generator_config(uint64_t start_timestamp_ns) const {
+        return flowstats::default_generator_config(start_timestamp_ns, m_num_threads);
+    }
+
+    // Aggregate flow rate under byte pacing, measured on a short sample
+    double estimate_flows_per_second(uint64_t start_timestamp_ns) const {
+        flowgen::FlowGenerator gen;
+        if (!gen.initialize(default_generator_config(start_timestamp_ns))) {
+            return 0.0;
+        }
+        flowgen::FlowRecord flow;
+        for (int i = 0; i < 20000; ++i) {
+            gen.next(flow);
+        }
+        flowgen::PacingReport report = gen.pacing_report();
+        if (report.elapsed_ns == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(report.flows) * 1e9 / static_cast<double>(report.elapsed_ns) *
+               static_cast<double>(m_num_threads);
+    }
+
     void output_summary() {
         std::cerr << "\nSummary:\n";
         std::cerr << "  Threads: " << m_num_threads << "\n";
         std::cerr << "  Flows processed: " << m_total_flows.load() << "\n";
         std::cerr << "  Total bytes: " << m_total_bytes.load() << "\n";
+
+        // Streams share one link, so per-stream rates add up
+        double target_gbps = 0.0;
+        double achieved_gbps = 0.0;
+        for (const auto& data : m_thread_data) {
+            target_gbps += data->m_pacing.target_gbps;
+            achieved_gbps += data->m_pacing.achieved_gbps;
+        }
+        if (target_gbps > 0.0) {
+            std::cerr << "  Link utilization: " << std::fixed << std::setprecision(2)
+                      << achieved_gbps << " of " << target_gbps << " Gbps ("
+                      << std::setprecision(1) << (100.0 * achieved_gbps / target_gbps) << "%)\n";
+        }
     }
 
     // Check if shutdown requested
@@ -2,6 +2,7 @@
 
 #include "../utils/enhanced_flow.h"
 #include "../utils/port_stat.h"
+#include "../utils/entropy_stat.h"
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -213,6 +214,89 @@ private:
     bool m_pretty;
 };
 
+// ========== Entropy Formatters ==========
+
+// Text formatter for EntropyResult
+class EntropyTextFormatter : public OutputFormatter<EntropyResult> {
+public:
+    void format(const EntropyResult& results, std::ostream& out, bool no_header = false) override {
+        if (!no_header) {
+            out << std::left
+                << std::setw(22) << "WINDOW_START_NS"
+                << std::setw(12) << "FLOWS"
+                << std::setw(12) << "H_SRC_IP"
+                << std::setw(12) << "H_DST_IP"
+                << "H_DST_PORT"
+                << "\n";
+        }
+
+        for (const auto& point : results.m_windows) {
+            out << std::left << std::fixed << std::setprecision(3)
+                << std::setw(22) << point.m_window_start_ns
+                << std::setw(12) << point.m_flow_count
+                << std::setw(12) << point.m_src_ip_entropy
+                << std::setw(12) << point.m_dst_ip_entropy
+                << point.m_dst_port_entropy
+                << "\n";
+        }
+    }
+};
+
+// CSV formatter for EntropyResult
+class EntropyCSVFormatter : public OutputFormatter<EntropyResult> {
+public:
+    void format(const EntropyResult& results, std::ostream& out, bool no_header = false) override {
+        if (!no_header) {
+            out << "window_start_ns,flows,src_ip_entropy,dst_ip_entropy,dst_port_entropy\n";
+        }
+
+        for (const auto& point : results.m_windows) {
+            out << std::fixed << std::setprecision(4)
+                << point.m_window_start_ns << ","
+                << point.m_flow_count << ","
+                << point.m_src_ip_entropy << ","
+                << point.m_dst_ip_entropy << ","
+                << point.m_dst_port_entropy << "\n";
+        }
+    }
+};
+
+// JSON formatter for EntropyResult
+class EntropyJSONFormatter : public OutputFormatter<EntropyResult> {
+public:
+    explicit EntropyJSONFormatter(bool pretty = false)
+        : m_pretty(pretty)
+    {}
+
+    void format(const EntropyResult& results, std::ostream& out, bool /*no_header*/ = false) override {
+        const std::string indent1 = m_pretty ? "  " : "";
+        const std::string indent2 = m_pretty ? "    " : "";
+        const std::string nl = m_pretty ? "\n" : "";
+
+        out << "[" << nl;
+
+        size_t count = results.m_windows.size();
+        for (size_t i = 0; i < count; ++i) {
+            const EntropyPoint& point = results.m_windows[i];
+            bool last = (i == count - 1);
+
+            out << std::fixed << std::setprecision(4);
+            out << indent1 << "{" << nl;
+            out << indent2 << "\"window_start_ns\": " << point.m_window_start_ns << "," << nl;
+            out << indent2 << "\"flows\": " << point.m_flow_count << "," << nl;
+            out << indent2 << "\"src_ip_entropy\": " << point.m_src_ip_entropy << "," << nl;
+            out << indent2 << "\"dst_ip_entropy\": " << point.m_dst_ip_entropy << "," << nl;
+            out << indent2 << "\"dst_port_entropy\": " << point.m_dst_port_entropy << nl;
+            out << indent1 << "}" << (last ? "" : ",") << nl;
+        }
+
+        out << "]" << nl;
+    }
+
+private:
+    bool m_pretty;
+};
+
 // Factory function to create appropriate formatter - CollectResult specialization
 template<typename ResultType>
 std::unique_ptr<OutputFormatter<ResultType>> create_formatter(OutputFormat format);
@@ -250,4 +334,21 @@ inline std::unique_ptr<OutputFormatter<PortResult>> create_formatter<PortResult>
     }
 }
 
+// Factory function to create appropriate formatter - EntropyResult specialization
+template<>
+inline std::unique_ptr<OutputFormatter<EntropyResult>> create_formatter<EntropyResult>(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::TEXT:
+        return std::make_unique<EntropyTextFormatter>();
+    case OutputFormat::CSV:
+        return std::make_unique<EntropyCSVFormatter>();
+    case OutputFormat::JSON:
+        return std::make_unique<EntropyJSONFormatter>(false);
+    case OutputFormat::JSON_PRETTY:
+        return std::make_unique<EntropyJSONFormatter>(true);
+    default:
+        throw std::runtime_error("Unknown output format");
+    }
+}
+
 } // namespace flowstats
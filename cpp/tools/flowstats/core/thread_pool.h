@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flowstats {
+
+// Fixed set of worker threads fed from one FIFO task queue
+//
+// Workers live as long as the pool, so per-worker state (see the
+// worker index passed to each task) survives from one task to the next.
+class ThreadPool {
+public:
+    using Task = std::function<void(size_t worker)>;
+
+    explicit ThreadPool(size_t threads)
+        : m_stopping(false)
+    {
+        if (threads == 0) {
+            threads = 1;
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            m_workers.emplace_back(&ThreadPool::run_worker, this, i);
+        }
+    }
+
+    // Runs the remaining queued tasks, then joins the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_task_ready.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task; tasks must not throw
+    void submit(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_task_ready.notify_one();
+    }
+
+    size_t size() const { return m_workers.size(); }
+
+private:
+    void run_worker(size_t worker) {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_task_ready.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task(worker);
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::deque<Task> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_task_ready;
+    bool m_stopping;
+};
+
+} // namespace flowstats
@@ -1,5 +1,9 @@
 #include "subcommands/flows_command.h"
 #include "subcommands/port_command.h"
+#include "subcommands/learn_command.h"
+#include "subcommands/multi_command.h"
+#include "subcommands/batch_command.h"
+#include "subcommands/entropy_command.h"
 #include "utils/arg_parser.h"
 #include <iostream>
 #include <string>
@@ -14,6 +18,10 @@ void print_usage() {
     std::cout << "Subcommands:\n";
     std::cout << "  flows      Generate and collect flow records\n";
     std::cout << "  port       Aggregate port statistics from flows\n";
+    std::cout << "  learn      Learn a traffic profile from a flow file\n";
+    std::cout << "  multi      Feed several aggregations and sinks from one generation run\n";
+    std::cout << "  batch      Run the jobs of a job file inside one process\n";
+    std::cout << "  entropy    Per-window entropy of addresses and destination ports\n";
     std::cout << "  help       Show this help message\n\n";
     std::cout << "Run 'flowstats <subcommand> --help' for subcommand-specific options\n";
 }
@@ -203,6 +211,209 @@ int flowstats_port_main(int argc, char** argv) {
     return cmd.execute();
 }
 
+// Learn subcommand entry point
+int flowstats_learn_main(int argc, char** argv) {
+    LearnOptions opts;
+
+    // Parse arguments
+    ArgParser parser("flowstats learn - Learn a traffic profile from a flow CSV or binary file");
+
+    parser.add_option("i", "input", opts.m_input_file,
+                     "Input flow file (CSV with header, or binary sink file)", true);
+
+    parser.add_option("o", "output", opts.m_output_file,
+                     "Output profile file (use as pattern type profile:<file>)", true);
+
+    parser.add_option("", "prefix-length", opts.m_prefix_length,
+                     "Subnet prefix length for address popularity", static_cast<size_t>(24));
+
+    parser.add_option("", "max-prefixes", opts.m_max_prefixes,
+                     "Most popular prefixes kept per direction", static_cast<size_t>(4096));
+
+    parser.add_option("", "max-services", opts.m_max_services,
+                     "Most popular (protocol, port) services kept", static_cast<size_t>(1024));
+
+    parser.add_option("", "reservoir", opts.m_reservoir_size,
+                     "Flows sampled per service for distributions", static_cast<size_t>(4096));
+
+    parser.add_option("", "resolution", opts.m_resolution,
+                     "Quantile points per distribution", static_cast<size_t>(64));
+
+    parser.add_option("", "top", opts.m_top_n,
+                     "Number of top services to print", static_cast<size_t>(10));
+
+    if (!parser.parse(argc, argv)) {
+        if (parser.has_error()) {
+            std::cerr << "Error: " << parser.error() << "\n\n";
+            parser.print_help();
+        }
+        return parser.has_error() ? 1 : 0;
+    }
+
+    // Create and execute command
+    FlowStatsLearn cmd(opts);
+    return cmd.execute();
+}
+
+// Multi subcommand entry point
+int flowstats_multi_main(int argc, char** argv) {
+    MultiOptions opts;
+
+    // Parse arguments
+    ArgParser parser("flowstats multi - Feed several aggregations and sinks from one generation run");
+
+    parser.add_list_option("C", "consumer", opts.m_consumers,
+                          "Consumer: ports, groupby:<fields>, heavy:<fields>, timeseries:<ms>, entropy:<ms> or "
+                          "sink:<path> or biflow:[<ms>:]<path>, optionally followed by ' where <filter>'", true);
+
+    parser.add_option("i", "input", opts.m_input,
+                     "Read flows from a binary flow file instead of generating them",
+                     false, "");
+
+    parser.add_option("", "sample", opts.m_sample,
+                     "Sample flows before the consumers, e.g. 'mode=hash,flows=10,packets=100' "
+                     "(keys: flows, mode=count|random|hash, packets, seed, rescale)",
+                     false, "");
+
+    parser.add_option("t", "total-flows", opts.m_total_flows,
+                     "Total flows to generate", static_cast<uint64_t>(1000000));
+
+    parser.add_option("", "start-timestamp", opts.m_start_timestamp_ns,
+                     "Start timestamp in nanoseconds", static_cast<uint64_t>(1704067200000000000ULL));
+
+    parser.add_option("b", "batch-size", opts.m_batch_size,
+                     "Flows per shared batch", static_cast<size_t>(4096));
+
+    parser.add_option("", "top", opts.m_top_n,
+                     "Rows shown per aggregation (0 = all)", static_cast<size_t>(10));
+
+    parser.add_flag("threaded", opts.m_threaded,
+                   "Run each consumer on its own thread");
+
+    if (!parser.parse(argc, argv)) {
+        if (parser.has_error()) {
+            std::cerr << "Error: " << parser.error() << "\n\n";
+            parser.print_help();
+        }
+        return parser.has_error() ? 1 : 0;
+    }
+
+    // Create and execute command
+    FlowStatsMulti cmd(opts);
+    return cmd.execute();
+}
+
+// Batch subcommand entry point
+int flowstats_batch_main(int argc, char** argv) {
+    BatchOptions opts;
+
+    // The job file may also be given as the first argument
+    if (argc > 1 && argv[1][0] != '-') {
+        opts.m_job_file = argv[1];
+        argv[1] = argv[0];
+        --argc;
+        ++argv;
+    }
+
+    // Parse arguments
+    ArgParser parser("flowstats batch - Run the jobs of a job file inside one process");
+
+    parser.add_option("f", "job-file", opts.m_job_file,
+                     "Job file (YAML: optional threads and defaults, jobs list)",
+                     opts.m_job_file.empty(), opts.m_job_file);
+
+    parser.add_option("j", "jobs", opts.m_num_threads,
+                     "Jobs run concurrently (0 = job file 'threads' or CPU count)",
+                     static_cast<size_t>(0));
+
+    if (!parser.parse(argc, argv)) {
+        if (parser.has_error()) {
+            std::cerr << "Error: " << parser.error() << "\n\n";
+            parser.print_help();
+        }
+        return parser.has_error() ? 1 : 0;
+    }
+
+    // Create and execute command
+    FlowStatsBatch cmd(opts);
+    return cmd.execute();
+}
+
+// Entropy subcommand entry point
+int flowstats_entropy_main(int argc, char** argv) {
+    EntropyOptions opts;
+
+    // Temporary variables for parsing
+    std::string output_format_str = "text";
+    std::string progress_style_str = "bar";
+    bool no_progress = false;
+
+    // Parse arguments
+    ArgParser parser("flowstats entropy - Per-window entropy of addresses and destination ports");
+
+    parser.add_option("n", "num-threads", opts.m_num_threads,
+                     "Number of generator threads", static_cast<size_t>(10));
+
+    parser.add_option("f", "flows-per-thread", opts.m_flows_per_thread,
+                     "Number of flows per thread", static_cast<size_t>(10000));
+
+    parser.add_option("t", "total-flows", opts.m_total_flows,
+                     "Total flows to generate (overrides -f)", static_cast<uint64_t>(0));
+
+    parser.add_option("", "start-timestamp", opts.m_start_timestamp_ns,
+                     "Start timestamp in nanoseconds", static_cast<uint64_t>(1704067200000000000ULL));
+
+    parser.add_option("", "end-timestamp", opts.m_end_timestamp_ns,
+                     "End timestamp in nanoseconds (0 = use flow count)", static_cast<uint64_t>(0));
+
+    parser.add_option("w", "window-ms", opts.m_window_ms,
+                     "Window width in milliseconds", static_cast<uint64_t>(1000));
+
+    parser.add_option("", "registers", opts.m_registers,
+                     "Sketch registers per dimension (error ~ 2.8 / sqrt(registers) bits)",
+                     static_cast<size_t>(flowgen::EntropySketch::DEFAULT_REGISTERS));
+
+    parser.add_option("m", "metric", opts.m_metric,
+                     "Weight items by: flows, packets, bytes", false, "flows");
+
+    parser.add_list_option("", "overlay", opts.m_overlays,
+                          "Anomaly overlay spec, e.g. \"syn_flood target=10.0.0.5:80 rate=10 start=2s duration=1s\"");
+
+    parser.add_option("o", "output-format", output_format_str,
+                     "Output format: text, csv, json, json-pretty", false, "text");
+
+    parser.add_flag("no-header", opts.m_no_header,
+                   "Suppress header in output");
+
+    parser.add_flag("no-progress", no_progress,
+                   "Disable progress indicator");
+
+    parser.add_option("", "progress-style", progress_style_str,
+                     "Progress style: bar, simple, spinner, none", false, "bar");
+
+    if (!parser.parse(argc, argv)) {
+        if (parser.has_error()) {
+            std::cerr << "Error: " << parser.error() << "\n\n";
+            parser.print_help();
+        }
+        return parser.has_error() ? 1 : 0;
+    }
+
+    // Parse output format and progress style
+    try {
+        opts.m_output_format = parse_output_format(output_format_str);
+        opts.m_progress_style = parse_progress_style(progress_style_str);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    opts.m_show_progress = !no_progress;
+
+    // Create and execute command
+    FlowStatsEntropy cmd(opts);
+    return cmd.execute();
+}
+
 // Main entry point
 int main(int argc, char** argv) {
     if (argc < 2) {
@@ -228,6 +439,26 @@ int main(int argc, char** argv) {
         return flowstats_port_main(argc - 1, argv + 1);
     }
 
+    // Learn subcommand
+    if (subcommand == "learn") {
+        return flowstats_learn_main(argc - 1, argv + 1);
+    }
+
+    // Multi subcommand
+    if (subcommand == "multi") {
+        return flowstats_multi_main(argc - 1, argv + 1);
+    }
+
+    // Batch subcommand
+    if (subcommand == "batch") {
+        return flowstats_batch_main(argc - 1, argv + 1);
+    }
+
+    // Entropy subcommand
+    if (subcommand == "entropy") {
+        return flowstats_entropy_main(argc - 1, argv + 1);
+    }
+
     // Unknown subcommand
     std::cerr << "Error: Unknown subcommand: " << subcommand << "\n\n";
     print_usage();
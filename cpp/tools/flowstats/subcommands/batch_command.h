@@ -0,0 +1,350 @@
+#pragma once
+
+#include "../core/flowstats_base.h"
+#include "../core/thread_pool.h"
+#include "../utils/job_file.h"
+#include "multi_command.h"
+#include <flowgen/fanout.hpp>
+#include <flowgen/generator.hpp>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace flowstats {
+
+// Options for batch subcommand
+struct BatchOptions {
+    std::string m_job_file;
+    size_t m_num_threads;   // 0 = from the job file, else hardware concurrency
+
+    BatchOptions()
+        : m_num_threads(0)
+    {}
+};
+
+// One job of a batch file
+//
+// Job keys (all but consumers optional, "defaults" supplies fallbacks):
+//   name             Label in the report (default: job-<index>)
+//   flows            Flows to generate (default 100000)
+//   start_timestamp  Start timestamp in nanoseconds
+//   bandwidth_gbps   Simulated link speed (default 10)
+//   pacing           flows or bytes (default bytes)
+//   patterns         List of "type:percentage" (default: built-in mix)
+//   consumers        List of consumer specs, as for flowstats multi
+//   batch_size       Flows per shared batch (default 4096)
+//   top              Rows shown per aggregation (default 10)
+struct BatchJob {
+    std::string m_name;
+    uint64_t m_flows;
+    uint64_t m_start_timestamp_ns;
+    double m_bandwidth_gbps;
+    std::string m_pacing;
+    std::vector<std::string> m_patterns;
+    std::vector<std::string> m_consumers;
+    size_t m_batch_size;
+    size_t m_top_n;
+
+    BatchJob()
+        : m_flows(100000)
+        , m_start_timestamp_ns(1704067200000000000ULL)  // 2024-01-01
+        , m_bandwidth_gbps(LINK_BANDWIDTH_GBPS)
+        , m_pacing("bytes")
+        , m_batch_size(4096)
+        , m_top_n(10)
+    {}
+
+    // Apply the keys of a job (or defaults) mapping
+    void apply(const JobNode& node) {
+        for (const auto& entry : node.m_entries) {
+            const std::string& key = entry.first;
+            const JobNode& value = entry.second;
+            if (key == "patterns" || key == "consumers") {
+                std::vector<std::string>& list = key == "patterns" ? m_patterns : m_consumers;
+                list.clear();
+                if (value.is_scalar() && !value.m_value.empty()) {
+                    list.push_back(value.m_value);
+                }
+                for (const auto& item : value.m_items) {
+                    if (!item.is_scalar()) {
+                        throw std::runtime_error(key + " entries must be strings");
+                    }
+                    list.push_back(item.m_value);
+                }
+                continue;
+            }
+            if (!value.is_scalar()) {
+                throw std::runtime_error("'" + key + "' must be a scalar");
+            }
+            try {
+                if (key == "name") {
+                    m_name = value.m_value;
+                } else if (key == "flows") {
+                    m_flows = std::stoull(value.m_value);
+                } else if (key == "start_timestamp") {
+                    m_start_timestamp_ns = std::stoull(value.m_value);
+                } else if (key == "bandwidth_gbps") {
+                    m_bandwidth_gbps = std::stod(value.m_value);
+                } else if (key == "pacing") {
+                    m_pacing = value.m_value;
+                } else if (key == "batch_size") {
+                    m_batch_size = std::stoull(value.m_value);
+                } else if (key == "top") {
+                    m_top_n = std::stoull(value.m_value);
+                } else {
+                    throw std::runtime_error("Unknown job key: " + key);
+                }
+            } catch (const std::logic_error&) {
+                throw std::runtime_error("Invalid value for " + key + ": " + value.m_value);
+            }
+        }
+    }
+
+    flowgen::GeneratorConfig generator_config() const {
+        flowgen::GeneratorConfig config = default_generator_config(m_start_timestamp_ns);
+        config.bandwidth_gbps = m_bandwidth_gbps;
+        config.pacing = m_pacing;
+        if (!m_patterns.empty()) {
+            config.traffic_patterns.clear();
+            for (const auto& pattern : m_patterns) {
+                size_t colon = pattern.rfind(':');
+                if (colon == std::string::npos) {
+                    throw std::runtime_error("Invalid pattern (expected type:percentage): " + pattern);
+                }
+                try {
+                    config.traffic_patterns.push_back(
+                        {pattern.substr(0, colon), std::stod(pattern.substr(colon + 1)), {}});
+                } catch (const std::logic_error&) {
+                    throw std::runtime_error("Invalid pattern percentage: " + pattern);
+                }
+            }
+        }
+        return config;
+    }
+
+    // Identifies the compiled generator a job can reuse
+    std::string plan_key() const {
+        std::ostringstream key;
+        key << m_start_timestamp_ns << '|' << m_bandwidth_gbps << '|' << m_pacing;
+        for (const auto& pattern : m_patterns) {
+            key << '|' << pattern;
+        }
+        return key.str();
+    }
+};
+
+// Outcome of one job
+struct BatchJobResult {
+    bool m_ok = false;
+    std::string m_report;
+    std::string m_error;
+    uint64_t m_flows = 0;
+    double m_seconds = 0.0;
+    bool m_plan_reused = false;
+};
+
+// Batch subcommand - runs many jobs inside one process
+//
+// Jobs are queued on a persistent thread pool and run concurrently, one
+// job per worker. Each worker keeps the generators it has initialized
+// (address pools, alias tables, schedules, key spaces, loaded profiles)
+// keyed by the job's generator settings, and later jobs with the same
+// settings rewind and reuse them instead of rebuilding. Reports are
+// printed in job order as jobs finish.
+class FlowStatsBatch {
+private:
+    // Compiled generators kept per worker
+    static constexpr size_t MAX_PLANS_PER_WORKER = 16;
+
+    struct WorkerPlans {
+        std::map<std::string, std::unique_ptr<flowgen::FlowGenerator>> m_generators;
+        std::vector<std::string> m_order;  // Least recently used first, for eviction
+    };
+
+    BatchOptions m_options;
+    std::vector<BatchJob> m_jobs;
+    size_t m_file_threads;
+    std::vector<WorkerPlans> m_plans;
+
+public:
+    explicit FlowStatsBatch(const BatchOptions& opts)
+        : m_options(opts)
+        , m_file_threads(0)
+    {}
+
+    bool load_jobs() {
+        try {
+            JobNode root = JobFileParser::parse_file(m_options.m_job_file);
+            if (!root.is_map()) {
+                throw std::runtime_error("Job file must be a mapping with a 'jobs' list");
+            }
+
+            BatchJob defaults;
+            if (const JobNode* node = root.find("defaults")) {
+                defaults.apply(*node);
+            }
+            if (const JobNode* node = root.find("threads")) {
+                m_file_threads = std::stoull(node->m_value);
+            }
+
+            const JobNode* jobs = root.find("jobs");
+            if (!jobs || !jobs->is_list() || jobs->m_items.empty()) {
+                throw std::runtime_error("Job file has no jobs");
+            }
+
+            std::set<std::string> sink_paths;
+            for (size_t i = 0; i < jobs->m_items.size(); ++i) {
+                BatchJob job = defaults;
+                job.m_name = "job-" + std::to_string(i + 1);
+                try {
+                    job.apply(jobs->m_items[i]);
+                    if (job.m_consumers.empty()) {
+                        throw std::runtime_error("no consumers");
+                    }
+                    for (const auto& spec : job.m_consumers) {
+                        if (spec.compare(0, 5, "sink:") == 0) {
+                            std::string path = spec.substr(5, spec.find(" where ") - 5);
+                            if (!sink_paths.insert(path).second) {
+                                throw std::runtime_error("sink path used by two jobs: " + path);
+                            }
+                        }
+                    }
+                    job.generator_config();  // Check patterns early
+                } catch (const std::exception& e) {
+                    throw std::runtime_error("Job '" + job.m_name + "': " + e.what());
+                }
+                m_jobs.push_back(std::move(job));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    int execute() {
+        if (!load_jobs()) {
+            return 1;
+        }
+
+        size_t threads = m_options.m_num_threads > 0 ? m_options.m_num_threads
+                       : m_file_threads > 0 ? m_file_threads
+                       : std::max<size_t>(1, std::thread::hardware_concurrency());
+        threads = std::min(threads, m_jobs.size());
+        m_plans.resize(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::promise<BatchJobResult>> promises(m_jobs.size());
+        {
+            ThreadPool pool(threads);
+            for (size_t i = 0; i < m_jobs.size(); ++i) {
+                pool.submit([this, i, &promises](size_t worker) {
+                    promises[i].set_value(run_job(m_jobs[i], m_plans[worker]));
+                });
+            }
+
+            // Report in job order while later jobs are still running
+            size_t failed = 0;
+            size_t reused = 0;
+            uint64_t total_flows = 0;
+            for (size_t i = 0; i < m_jobs.size(); ++i) {
+                BatchJobResult result = promises[i].get_future().get();
+                std::cout << "### " << m_jobs[i].m_name;
+                if (result.m_ok) {
+                    std::cout << " (" << result.m_flows << " flows, " << std::fixed
+                              << std::setprecision(3) << result.m_seconds << " s)\n\n"
+                              << result.m_report;
+                } else {
+                    std::cout << " FAILED: " << result.m_error << "\n\n";
+                    ++failed;
+                }
+                std::cout.flush();
+                total_flows += result.m_flows;
+                reused += result.m_plan_reused ? 1 : 0;
+            }
+
+            double elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            std::cerr << "Summary:\n";
+            std::cerr << "  Jobs: " << m_jobs.size() << " (" << failed << " failed) on "
+                      << threads << " threads\n";
+            std::cerr << "  Generators reused: " << reused << " of " << m_jobs.size() << "\n";
+            std::cerr << "  Flows generated: " << total_flows << "\n";
+            std::cerr << "  Elapsed: " << std::fixed << std::setprecision(2) << elapsed << " s\n";
+            if (failed > 0) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+private:
+    static BatchJobResult run_job(const BatchJob& job, WorkerPlans& plans) {
+        BatchJobResult result;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            std::vector<std::unique_ptr<MultiConsumer>> outputs;
+            std::vector<flowgen::FlowConsumer*> consumers;
+            for (const auto& spec : job.m_consumers) {
+                outputs.push_back(std::make_unique<MultiConsumer>(spec));
+                consumers.push_back(outputs.back()->consumer());
+            }
+
+            flowgen::FlowGenerator& gen = plan_for(job, plans, result.m_plan_reused);
+
+            flowgen::FanoutOptions fanout;
+            fanout.batch_size = job.m_batch_size;
+            result.m_flows = flowgen::fanout_flows(gen, job.m_flows, consumers, fanout);
+
+            std::ostringstream report;
+            for (const auto& output : outputs) {
+                output->output(report, job.m_top_n);
+            }
+            result.m_report = report.str();
+            result.m_ok = true;
+        } catch (const std::exception& e) {
+            result.m_error = e.what();
+        }
+        result.m_seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // Rewound generator for the job's settings, initialized on first use
+    // and again when one of its patterns cannot rewind
+    static flowgen::FlowGenerator& plan_for(const BatchJob& job, WorkerPlans& plans, bool& reused) {
+        std::string key = job.plan_key();
+        auto it = plans.m_generators.find(key);
+        if (it != plans.m_generators.end()) {
+            plans.m_order.erase(std::find(plans.m_order.begin(), plans.m_order.end(), key));
+            if (it->second->reset()) {
+                plans.m_order.push_back(key);
+                reused = true;
+                return *it->second;
+            }
+            plans.m_generators.erase(it);
+        }
+
+        auto gen = std::make_unique<flowgen::FlowGenerator>();
+        if (!gen->initialize(job.generator_config())) {
+            throw std::runtime_error("Invalid generator settings");
+        }
+        if (plans.m_order.size() >= MAX_PLANS_PER_WORKER) {
+            plans.m_generators.erase(plans.m_order.front());
+            plans.m_order.erase(plans.m_order.begin());
+        }
+        plans.m_order.push_back(key);
+        reused = false;
+        return *(plans.m_generators[key] = std::move(gen));
+    }
+};
+
+} // namespace flowstats
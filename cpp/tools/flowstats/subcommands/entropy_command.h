@@ -0,0 +1,235 @@
+#pragma once
+
+#include "../core/flowstats_base.h"
+#include "../utils/entropy_stat.h"
+#include <flowgen/aggregators.hpp>
+#include <flowgen/generator.hpp>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace flowstats {
+
+// Options for entropy subcommand
+struct EntropyOptions {
+    size_t m_num_threads;
+    size_t m_flows_per_thread;
+    uint64_t m_total_flows;
+    uint64_t m_start_timestamp_ns;
+    uint64_t m_end_timestamp_ns;
+    uint64_t m_window_ms;
+    size_t m_registers;
+    std::string m_metric;
+    std::vector<std::string> m_overlays;
+    OutputFormat m_output_format;
+    bool m_no_header;
+    bool m_show_progress;
+    ProgressStyle m_progress_style;
+
+    EntropyOptions()
+        : m_num_threads(10)
+        , m_flows_per_thread(10000)
+        , m_total_flows(0)
+        , m_start_timestamp_ns(1704067200000000000ULL)  // 2024-01-01
+        , m_end_timestamp_ns(0)
+        , m_window_ms(1000)
+        , m_registers(flowgen::EntropySketch::DEFAULT_REGISTERS)
+        , m_metric("flows")
+        , m_output_format(OutputFormat::TEXT)
+        , m_no_header(false)
+        , m_show_progress(true)
+        , m_progress_style(ProgressStyle::BAR)
+    {}
+};
+
+// Entropy subcommand - per-window entropy of addresses and ports
+//
+// Every worker keeps its own flowgen::EntropyTimeSeries (fixed-size
+// sketches per window) and the sketches are merged after generation, so
+// no state is shared while generating. Anomaly overlays (--overlay) run
+// in every worker's stream, so floods and scans show up as entropy
+// shifts in their windows.
+class FlowStatsEntropy : public FlowStatsCommand<EntropyResult> {
+private:
+    EntropyOptions m_options;
+    flowgen::AggregateMetric m_metric;
+    std::vector<std::unique_ptr<flowgen::EntropyTimeSeries>> m_thread_series;
+
+public:
+    explicit FlowStatsEntropy(const EntropyOptions& opts)
+        : m_options(opts)
+        , m_metric(flowgen::AggregateMetric::FLOWS)
+    {
+        // Copy options to base class members
+        m_num_threads = opts.m_num_threads;
+        m_flows_per_thread = opts.m_flows_per_thread;
+        m_show_progress = opts.m_show_progress;
+        m_progress_style = opts.m_progress_style;
+    }
+
+    bool validate_options() override {
+        if (m_options.m_num_threads == 0 || m_options.m_num_threads > 100) {
+            std::cerr << "Error: Invalid thread count (must be 1-100)\n";
+            return false;
+        }
+
+        if (m_options.m_window_ms == 0) {
+            std::cerr << "Error: Window must be positive\n";
+            return false;
+        }
+
+        if (m_options.m_registers == 0) {
+            std::cerr << "Error: Register count must be positive\n";
+            return false;
+        }
+
+        if (m_options.m_end_timestamp_ns > 0 &&
+            m_options.m_end_timestamp_ns <= m_options.m_start_timestamp_ns) {
+            std::cerr << "Error: End timestamp must be greater than start timestamp\n";
+            return false;
+        }
+
+        try {
+            m_metric = flowgen::parse_aggregate_metric(m_options.m_metric);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    void initialize() override {
+        // Check the overlay specs once, before any worker starts
+        flowgen::GeneratorConfig config = generator_config();
+        std::string error;
+        if (!config.validate(&error)) {
+            throw std::runtime_error(error);
+        }
+
+        for (size_t i = 0; i < m_num_threads; ++i) {
+            m_thread_series.push_back(std::make_unique<flowgen::EntropyTimeSeries>(
+                m_options.m_window_ms * 1000000ULL, m_options.m_registers, m_metric));
+        }
+
+        if (m_options.m_end_timestamp_ns > 0) {
+            // Workers stop at the end timestamp
+            m_flows_per_thread = std::numeric_limits<size_t>::max();
+            std::cerr << "Generating flows for time range: "
+                      << m_options.m_start_timestamp_ns << " - "
+                      << m_options.m_end_timestamp_ns << " ns\n";
+        } else if (m_options.m_total_flows > 0) {
+            m_flows_per_thread = m_options.m_total_flows / m_num_threads;
+        }
+    }
+
+    void run_worker_thread(size_t thread_id) override {
+        try {
+            flowgen::FlowGenerator gen;
+            gen.initialize(generator_config());
+
+            auto& series = *m_thread_series[thread_id];
+            auto& thread_data = get_thread_data(thread_id);
+
+            flowgen::FlowRecord flow;
+            FlowStats stats;
+            for (size_t i = 0; i < m_flows_per_thread; ++i) {
+                if (is_shutdown_requested()) {
+                    break;
+                }
+
+                gen.next(flow, stats);
+                if (m_options.m_end_timestamp_ns > 0 && flow.timestamp >= m_options.m_end_timestamp_ns) {
+                    break;
+                }
+
+                series.add(flow, stats);
+
+                // Update statistics
+                thread_data.m_flows_generated.fetch_add(1, std::memory_order_relaxed);
+                thread_data.m_bytes_generated.fetch_add(stats.byte_count,
+                                                       std::memory_order_relaxed);
+
+                // Update progress (lock-free)
+                update_progress(thread_id, flow.timestamp, stats.byte_count);
+                increment_flow_count(1);
+                increment_byte_count(stats.byte_count);
+            }
+
+            // Signal completion
+            thread_data.m_pacing = gen.pacing_report();
+            thread_data.m_done.store(true, std::memory_order_release);
+
+        } catch (const std::exception& e) {
+            std::cerr << "Error in worker thread " << thread_id << ": " << e.what() << "\n";
+            auto& thread_data = get_thread_data(thread_id);
+            thread_data.m_done.store(true, std::memory_order_release);
+        }
+    }
+
+    EntropyResult collect_results() override {
+        EntropyResult result;
+
+        // Wait for all threads to complete
+        for (auto& data_ptr : m_thread_data) {
+            while (!data_ptr->m_done.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+
+        // Merge per-thread sketches window by window
+        flowgen::EntropyTimeSeries merged(m_options.m_window_ms * 1000000ULL,
+                                          m_options.m_registers, m_metric);
+        for (const auto& series : m_thread_series) {
+            merged.merge(*series);
+        }
+
+        const auto& windows = merged.windows();
+        for (size_t i = 0; i < windows.size(); ++i) {
+            EntropyPoint point;
+            point.m_window_start_ns = merged.start_ns() + i * merged.window_ns();
+            point.m_flow_count = windows[i].flow_count;
+            point.m_src_ip_entropy = windows[i].src_ip.entropy();
+            point.m_dst_ip_entropy = windows[i].dst_ip.entropy();
+            point.m_dst_port_entropy = windows[i].dst_port.entropy();
+            result.m_windows.push_back(point);
+        }
+
+        result.m_window_ns = merged.window_ns();
+        result.m_total_flows = m_total_flows.load();
+        result.m_total_bytes = m_total_bytes.load();
+
+        return result;
+    }
+
+    void output_results(const EntropyResult& results) override {
+        auto formatter = create_formatter<EntropyResult>(m_options.m_output_format);
+        formatter->format(results, std::cout, m_options.m_no_header);
+    }
+
+    TimestampRange get_timestamp_range() const override {
+        uint64_t end_ts = m_options.m_end_timestamp_ns;
+        if (end_ts == 0) {
+            // Estimate from the flow count and the byte-paced flow rate
+            double flows_per_second = estimate_flows_per_second(m_options.m_start_timestamp_ns);
+
+            uint64_t total_flows = m_options.m_total_flows > 0 ?
+                m_options.m_total_flows :
+                (m_flows_per_thread * m_num_threads);
+
+            double duration_sec = total_flows / flows_per_second;
+            end_ts = m_options.m_start_timestamp_ns + static_cast<uint64_t>(duration_sec * 1e9);
+        }
+
+        return {m_options.m_start_timestamp_ns, end_ts};
+    }
+
+private:
+    flowgen::GeneratorConfig generator_config() const {
+        flowgen::GeneratorConfig config = default_generator_config(m_options.m_start_timestamp_ns);
+        config.overlays = m_options.m_overlays;
+        return config;
+    }
+};
+
+} // namespace flowstats
@@ -5,6 +5,7 @@
 #include <flowgen/generator.hpp>
 #include <flowgen/utils.hpp>
 #include <algorithm>
+#include <limits>
 
 namespace flowstats {
 
@@ -91,18 +92,15 @@ public:
             uint64_t duration_ns = m_options.m_end_timestamp_ns - m_options.m_start_timestamp_ns;
             double duration_sec = duration_ns / 1e9;
 
-            // Assume 10 Gbps and 800 byte average packet size
-            double bandwidth_gbps = 10.0;
-            double avg_packet_size = 800.0;
-            double flows_per_second = (bandwidth_gbps * 1e9 / 8.0) / avg_packet_size;
-
+            // Workers stop at the end timestamp; the count is an estimate
+            double flows_per_second = estimate_flows_per_second(m_options.m_start_timestamp_ns);
             m_options.m_total_flows = static_cast<uint64_t>(duration_sec * flows_per_second);
-            m_flows_per_thread = m_options.m_total_flows / m_num_threads;
+            m_flows_per_thread = std::numeric_limits<size_t>::max();
 
             std::cerr << "Generating flows for time range: "
                       << m_options.m_start_timestamp_ns << " - "
                       << m_options.m_end_timestamp_ns << " ns\n";
-            std::cerr << "Calculated total flows: " << m_options.m_total_flows << "\n";
+            std::cerr << "Estimated total flows: " << m_options.m_total_flows << "\n";
         } else if (m_options.m_total_flows > 0) {
             // Total flows specified
             m_flows_per_thread = m_options.m_total_flows / m_num_threads;
@@ -113,42 +111,7 @@ public:
         try {
             // Create flow generator
             flowgen::FlowGenerator gen;
-            flowgen::GeneratorConfig config;
-
-            // Configure generator
-            config.max_flows = m_flows_per_thread;
-            config.start_timestamp_ns = m_options.m_start_timestamp_ns;
-
-            // Simple default configuration
-            config.source_subnets = {"192.168.0.0/16", "10.10.0.0/16"};
-            config.destination_subnets = {"10.100.0.0/16", "172.16.0.0/12"};
-            config.min_packet_size = 64;
-            config.max_packet_size = 1500;
-            config.average_packet_size = 800;
-
-            // Add default traffic patterns
-            flowgen::GeneratorConfig::TrafficPattern web_pattern;
-            web_pattern.type = "web_traffic";
-            web_pattern.percentage = 40;
-            config.traffic_patterns.push_back(web_pattern);
-
-            flowgen::GeneratorConfig::TrafficPattern dns_pattern;
-            dns_pattern.type = "dns_traffic";
-            dns_pattern.percentage = 20;
-            config.traffic_patterns.push_back(dns_pattern);
-
-            flowgen::GeneratorConfig::TrafficPattern db_pattern;
-            db_pattern.type = "database_traffic";
-            db_pattern.percentage = 20;
-            config.traffic_patterns.push_back(db_pattern);
-
-            flowgen::GeneratorConfig::TrafficPattern random_pattern;
-            random_pattern.type = "random";
-            random_pattern.percentage = 20;
-            config.traffic_patterns.push_back(random_pattern);
-
-            // Bandwidth-based rate (10 Gbps default)
-            config.bandwidth_gbps = 10.0;
+            flowgen::GeneratorConfig config = default_generator_config(m_options.m_start_timestamp_ns);
 
             gen.initialize(config);
 
@@ -157,13 +120,19 @@ public:
             auto& thread_data = get_thread_data(thread_id);
 
             flowgen::FlowRecord flow;
-            while (gen.next(flow)) {
+            FlowStats stats;
+            for (size_t i = 0; i < m_flows_per_thread; ++i) {
                 if (is_shutdown_requested()) {
                     break;
                 }
 
+                gen.next(flow, stats);
+                if (m_options.m_end_timestamp_ns > 0 && flow.timestamp >= m_options.m_end_timestamp_ns) {
+                    break;
+                }
+
                 // Enhance flow with statistics
-                EnhancedFlowRecord enhanced = enhance_flow(flow, thread_id);
+                EnhancedFlowRecord enhanced = enhance_flow(flow, stats, thread_id);
 
                 // Store in thread-local buffer
                 buffer.m_flows.push_back(enhanced);
@@ -180,6 +149,7 @@ public:
             }
 
             // Signal completion
+            thread_data.m_pacing = gen.pacing_report();
             thread_data.m_done.store(true, std::memory_order_release);
 
         } catch (const std::exception& e) {
@@ -237,10 +207,8 @@ public:
     TimestampRange get_timestamp_range() const override {
         uint64_t end_ts = m_options.m_end_timestamp_ns;
         if (end_ts == 0) {
-            // Calculate based on flow count and bandwidth
-            double bandwidth_gbps = 10.0;
-            double avg_packet_size = 800.0;
-            double flows_per_second = (bandwidth_gbps * 1e9 / 8.0) / avg_packet_size;
+            // Estimate from the flow count and the byte-paced flow rate
+            double flows_per_second = estimate_flows_per_second(m_options.m_start_timestamp_ns);
 
             uint64_t total_flows = m_options.m_total_flows > 0 ?
                 m_options.m_total_flows :
@@ -257,7 +225,8 @@ public:
 
 private:
     // Enhance basic flow record with statistics
-    EnhancedFlowRecord enhance_flow(const flowgen::FlowRecord& basic_flow, size_t thread_id) {
+    EnhancedFlowRecord enhance_flow(const flowgen::FlowRecord& basic_flow,
+                                    const FlowStats& stats, size_t thread_id) {
         EnhancedFlowRecord enhanced;
 
         enhanced.stream_id = thread_id + 1;  // 1-indexed
@@ -268,11 +237,6 @@ private:
         enhanced.destination_port = basic_flow.destination_port;
         enhanced.protocol = basic_flow.protocol;
 
-        // Generate realistic flow statistics
-        FlowStats stats = generate_flow_stats(basic_flow.packet_length,
-                                              basic_flow.protocol,
-                                              basic_flow.destination_port);
-
         enhanced.packet_count = stats.packet_count;
         enhanced.byte_count = stats.byte_count;
 
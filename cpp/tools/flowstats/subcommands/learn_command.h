@@ -0,0 +1,118 @@
+#pragma once
+
+#include <flowgen/profile.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace flowstats {
+
+// Options for learn subcommand
+struct LearnOptions {
+    std::string m_input_file;
+    std::string m_output_file;
+    size_t m_prefix_length;
+    size_t m_max_prefixes;
+    size_t m_max_services;
+    size_t m_reservoir_size;
+    size_t m_resolution;
+    size_t m_top_n;
+
+    LearnOptions()
+        : m_prefix_length(24)
+        , m_max_prefixes(4096)
+        , m_max_services(1024)
+        , m_reservoir_size(4096)
+        , m_resolution(64)
+        , m_top_n(10)
+    {}
+};
+
+// Learn subcommand - builds a traffic profile from a real flow file
+//
+// Unlike the generating subcommands this is a single sequential pass
+// over an input file, so it does not use FlowStatsCommand threading.
+class FlowStatsLearn {
+private:
+    LearnOptions m_options;
+
+public:
+    explicit FlowStatsLearn(const LearnOptions& opts)
+        : m_options(opts)
+    {}
+
+    bool validate_options() {
+        if (m_options.m_input_file.empty()) {
+            std::cerr << "Error: Input flow file required\n";
+            return false;
+        }
+
+        if (m_options.m_output_file.empty()) {
+            std::cerr << "Error: Output profile file required\n";
+            return false;
+        }
+
+        if (m_options.m_prefix_length > 32) {
+            std::cerr << "Error: Invalid prefix length (must be 0-32)\n";
+            return false;
+        }
+
+        if (m_options.m_resolution < 2) {
+            std::cerr << "Error: Resolution must be at least 2\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    int execute() {
+        if (!validate_options()) {
+            std::cerr << "Error: Invalid options\n";
+            return 1;
+        }
+
+        flowgen::ProfileLearnOptions learn_opts;
+        learn_opts.prefix_length = static_cast<uint8_t>(m_options.m_prefix_length);
+        learn_opts.max_prefixes = m_options.m_max_prefixes;
+        learn_opts.max_services = m_options.m_max_services;
+        learn_opts.reservoir_size = m_options.m_reservoir_size;
+        learn_opts.resolution = m_options.m_resolution;
+
+        flowgen::TrafficProfile profile;
+        try {
+            profile = flowgen::learn_profile(m_options.m_input_file, learn_opts);
+            profile.save(m_options.m_output_file);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+
+        output_summary(profile);
+        return 0;
+    }
+
+private:
+    void output_summary(const flowgen::TrafficProfile& profile) const {
+        std::cerr << "Learned profile from " << profile.flow_count << " flows\n";
+        std::cerr << "  Services: " << profile.services.size() << "\n";
+        std::cerr << "  Source prefixes (/" << static_cast<int>(profile.prefix_length) << "): "
+                  << profile.source_prefixes.size() << "\n";
+        std::cerr << "  Destination prefixes: " << profile.destination_prefixes.size() << "\n";
+        std::cerr << "  Flow statistics: "
+                  << (profile.has_flow_stats() ? "learned" : "not in input (built-in model)") << "\n";
+        std::cerr << "  Written to: " << m_options.m_output_file << "\n";
+
+        size_t shown = std::min(m_options.m_top_n, profile.services.size());
+        if (shown > 0) {
+            std::cerr << "\nTop services:\n";
+            for (size_t i = 0; i < shown; ++i) {
+                const auto& s = profile.services[i];
+                std::cerr << "  proto " << static_cast<int>(s.protocol)
+                          << " port " << s.port << ": "
+                          << (s.weight * 100.0) << "%\n";
+            }
+        }
+    }
+};
+
+} // namespace flowstats
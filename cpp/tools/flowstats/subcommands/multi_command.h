@@ -0,0 +1,416 @@
+#pragma once
+
+#include "../core/flowstats_base.h"
+#include <flowgen/aggregators.hpp>
+#include <flowgen/biflow.hpp>
+#include <flowgen/fanout.hpp>
+#include <flowgen/generator.hpp>
+#include <flowgen/pipeline.hpp>
+#include <flowgen/sampling.hpp>
+#include <flowgen/sinks.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flowstats {
+
+// Options for multi subcommand
+struct MultiOptions {
+    std::vector<std::string> m_consumers;
+    std::string m_input;
+    std::string m_sample;
+    uint64_t m_total_flows;
+    uint64_t m_start_timestamp_ns;
+    size_t m_batch_size;
+    size_t m_top_n;
+    bool m_threaded;
+
+    MultiOptions()
+        : m_total_flows(1000000)
+        , m_start_timestamp_ns(1704067200000000000ULL)  // 2024-01-01
+        , m_batch_size(4096)
+        , m_top_n(10)
+        , m_threaded(false)
+    {}
+};
+
+// Stitches flows into biflows and writes them as CSV; finish() closes the file
+class BiflowFileConsumer : public flowgen::FlowConsumer {
+public:
+    BiflowFileConsumer(const std::string& path, uint64_t tolerance_ns)
+        : m_writer(path)
+        , m_stitcher(stitcher_options(tolerance_ns),
+                     [this](const flowgen::BiflowRecord* biflows, size_t count) {
+                         m_writer.write(biflows, count);
+                     })
+    {}
+
+    void consume(const flowgen::FlowBatch& batch, const flowgen::FlowStats* stats) override {
+        m_stitcher.consume(batch, stats);
+    }
+
+    void finish() override {
+        m_stitcher.finish();
+        m_writer.close();
+    }
+
+    const flowgen::BiflowStitcher& stitcher() const { return m_stitcher; }
+
+private:
+    static flowgen::BiflowOptions stitcher_options(uint64_t tolerance_ns) {
+        flowgen::BiflowOptions options;
+        options.tolerance_ns = tolerance_ns;
+        return options;
+    }
+
+    flowgen::BiflowCsvWriter m_writer;
+    flowgen::BiflowStitcher m_stitcher;
+};
+
+// One output of a multi run, built from a consumer spec:
+//
+//   <kind>[:<arg>][ where <filter>]
+//
+//   ports               Port table
+//   groupby:<fields>    Exact group-by, e.g. groupby:src_ip,dst_port
+//   heavy:<fields>      Heavy hitters by bytes (Space-Saving)
+//   timeseries:<ms>     Flow/packet/byte counts per time bucket
+//   entropy:<ms>        Source/destination address and destination
+//                       port entropy per time window (bits)
+//   sink:<path>         Flow file; format from the extension (.csv,
+//                       .json, .jsonl, .bin, .rowbinary, .native,
+//                       .pgcopy), ".gz" compresses
+//   biflow:[<ms>:]<path> RFC 5103 biflows as CSV, joining reverse
+//                       flows that start within <ms> (default 1000)
+//
+// The optional filter is a flowgen::FlowFilter spec, e.g.
+// "sink:dns.csv where protocol=udp,dst_port=53".
+class MultiConsumer {
+public:
+    explicit MultiConsumer(const std::string& spec, size_t heavy_capacity = 1024)
+        : m_spec(spec)
+    {
+        std::string target = spec;
+        size_t where = spec.find(" where ");
+        if (where != std::string::npos) {
+            target = spec.substr(0, where);
+        }
+
+        size_t colon = target.find(':');
+        m_kind = target.substr(0, colon);
+        std::string arg = colon == std::string::npos ? "" : target.substr(colon + 1);
+
+        if (m_kind == "ports") {
+            m_port_table = std::make_unique<flowgen::PortTable>();
+            m_aggregator = m_port_table.get();
+        } else if (m_kind == "groupby") {
+            m_group_by = std::make_unique<flowgen::GroupBy>(flowgen::parse_group_fields(arg));
+            m_aggregator = m_group_by.get();
+        } else if (m_kind == "heavy") {
+            m_heavy = std::make_unique<flowgen::HeavyHitters>(
+                heavy_capacity, flowgen::parse_group_fields(arg), flowgen::AggregateMetric::BYTES);
+            m_aggregator = m_heavy.get();
+        } else if (m_kind == "timeseries") {
+            uint64_t bucket_ms = arg.empty() ? 1000 : std::stoull(arg);
+            if (bucket_ms == 0) {
+                throw std::runtime_error("timeseries bucket must be positive: " + spec);
+            }
+            m_time_series = std::make_unique<flowgen::TimeSeries>(bucket_ms * 1000000ULL);
+            m_aggregator = m_time_series.get();
+        } else if (m_kind == "entropy") {
+            uint64_t window_ms = arg.empty() ? 1000 : std::stoull(arg);
+            if (window_ms == 0) {
+                throw std::runtime_error("entropy window must be positive: " + spec);
+            }
+            m_entropy = std::make_unique<flowgen::EntropyTimeSeries>(window_ms * 1000000ULL);
+            m_aggregator = m_entropy.get();
+        } else if (m_kind == "sink") {
+            if (arg.empty()) {
+                throw std::runtime_error("sink needs a path: " + spec);
+            }
+            m_sink = flowgen::create_file_sink(arg, sink_options(arg));
+            m_sink_path = arg;
+        } else if (m_kind == "biflow") {
+            uint64_t tolerance_ms = 1000;
+            size_t split = arg.find(':');
+            if (split != std::string::npos && split > 0 &&
+                arg.find_first_not_of("0123456789") == split) {
+                tolerance_ms = std::stoull(arg.substr(0, split));
+                arg = arg.substr(split + 1);
+            }
+            if (arg.empty()) {
+                throw std::runtime_error("biflow needs a path: " + spec);
+            }
+            m_biflow = std::make_unique<BiflowFileConsumer>(arg, tolerance_ms * 1000000ULL);
+            m_sink_path = arg;
+        } else {
+            throw std::runtime_error("Unknown consumer: " + spec +
+                                     " (valid: ports, groupby, heavy, timeseries, entropy, sink, biflow)");
+        }
+
+        if (m_aggregator) {
+            m_consumer = std::make_unique<flowgen::AggregatorConsumer>(*m_aggregator);
+        } else if (m_sink) {
+            m_consumer = std::make_unique<flowgen::SinkConsumer>(*m_sink);
+        }
+        if (where != std::string::npos) {
+            m_filter = std::make_unique<flowgen::FilterConsumer>(
+                flowgen::FlowFilter::parse(spec.substr(where + 7)), *this->target());
+        }
+    }
+
+    // Consumer to attach to the fanout
+    flowgen::FlowConsumer* consumer() {
+        return m_filter ? static_cast<flowgen::FlowConsumer*>(m_filter.get()) : target();
+    }
+
+    const std::string& spec() const { return m_spec; }
+
+    void output(std::ostream& out, size_t top_n) const {
+        out << "== " << m_spec << " ==\n";
+        if (m_port_table) {
+            output_ports(out, top_n);
+        } else if (m_group_by) {
+            out << std::left << std::setw(48) << "KEY" << std::setw(12) << "FLOWS"
+                << std::setw(14) << "PACKETS" << "BYTES\n";
+            for (const auto& entry : m_group_by->top(top_n, flowgen::AggregateMetric::BYTES)) {
+                out << std::left << std::setw(48) << format_key(entry.first, m_group_by->fields())
+                    << std::setw(12) << entry.second.flow_count
+                    << std::setw(14) << entry.second.packet_count
+                    << entry.second.byte_count << "\n";
+            }
+        } else if (m_heavy) {
+            out << std::left << std::setw(48) << "KEY" << std::setw(16) << "BYTES" << "ERROR\n";
+            for (const auto& entry : m_heavy->top(top_n)) {
+                out << std::left << std::setw(48) << format_key(entry.key, m_heavy->fields())
+                    << std::setw(16) << entry.count << entry.error << "\n";
+            }
+        } else if (m_time_series) {
+            out << std::left << std::setw(22) << "BUCKET_START_NS" << std::setw(12) << "FLOWS"
+                << std::setw(14) << "PACKETS" << "BYTES\n";
+            const auto& buckets = m_time_series->buckets();
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                out << std::left
+                    << std::setw(22) << m_time_series->start_ns() + i * m_time_series->bucket_ns()
+                    << std::setw(12) << buckets[i].flow_count
+                    << std::setw(14) << buckets[i].packet_count
+                    << buckets[i].byte_count << "\n";
+            }
+        } else if (m_entropy) {
+            out << std::left << std::setw(22) << "WINDOW_START_NS" << std::setw(12) << "FLOWS"
+                << std::setw(12) << "H_SRC_IP" << std::setw(12) << "H_DST_IP" << "H_DST_PORT\n";
+            const auto& windows = m_entropy->windows();
+            for (size_t i = 0; i < windows.size(); ++i) {
+                out << std::left << std::fixed << std::setprecision(3)
+                    << std::setw(22) << m_entropy->start_ns() + i * m_entropy->window_ns()
+                    << std::setw(12) << windows[i].flow_count
+                    << std::setw(12) << windows[i].src_ip.entropy()
+                    << std::setw(12) << windows[i].dst_ip.entropy()
+                    << windows[i].dst_port.entropy() << "\n";
+            }
+        } else if (m_biflow) {
+            const flowgen::BiflowStitcher& stitcher = m_biflow->stitcher();
+            out << stitcher.biflows_matched() + stitcher.biflows_unmatched() << " biflows ("
+                << stitcher.biflows_matched() << " matched, " << stitcher.biflows_unmatched()
+                << " unidirectional) from " << stitcher.flows_in() << " flows written to "
+                << m_sink_path << "\n";
+        } else {
+            out << m_sink->flows_written() << " flows written to " << m_sink_path << "\n";
+        }
+        out << "\n";
+    }
+
+private:
+    // Innermost consumer, behind the optional filter
+    flowgen::FlowConsumer* target() const {
+        return m_biflow ? static_cast<flowgen::FlowConsumer*>(m_biflow.get()) : m_consumer.get();
+    }
+
+    static flowgen::SinkOptions sink_options(std::string path) {
+        flowgen::SinkOptions options;
+        if (path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0) {
+            options.compress = true;
+            path.resize(path.size() - 3);
+        }
+        size_t dot = path.find_last_of('.');
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+        if (extension == "json") {
+            options.format = flowgen::SinkFormat::JSON;
+        } else if (extension == "jsonl") {
+            options.format = flowgen::SinkFormat::JSON_LINES;
+        } else if (extension == "bin") {
+            options.format = flowgen::SinkFormat::BINARY;
+        } else if (extension == "rowbinary") {
+            options.format = flowgen::SinkFormat::CLICKHOUSE_ROWBINARY;
+        } else if (extension == "native") {
+            options.format = flowgen::SinkFormat::CLICKHOUSE_NATIVE;
+        } else if (extension == "pgcopy") {
+            options.format = flowgen::SinkFormat::POSTGRES_BINARY;
+        }
+        return options;
+    }
+
+    static std::string format_key(const flowgen::GroupKey& key, uint32_t fields) {
+        std::string text;
+        auto add = [&text](const std::string& part) {
+            if (!text.empty()) text += ' ';
+            text += part;
+        };
+        if (fields & flowgen::GROUP_SRC_IP) add(key.source_ip.to_string());
+        if (fields & flowgen::GROUP_DST_IP) add(key.destination_ip.to_string());
+        if (fields & flowgen::GROUP_SRC_PORT) add(std::to_string(key.source_port));
+        if (fields & flowgen::GROUP_DST_PORT) add(std::to_string(key.destination_port));
+        if (fields & flowgen::GROUP_PROTOCOL) add(std::to_string(key.protocol));
+        return text;
+    }
+
+    void output_ports(std::ostream& out, size_t top_n) const {
+        std::vector<std::pair<uint16_t, flowgen::PortCounters>> ports;
+        m_port_table->for_each([&ports](uint16_t port, const flowgen::PortCounters& counters) {
+            ports.emplace_back(port, counters);
+        });
+        std::sort(ports.begin(), ports.end(), [](const auto& a, const auto& b) {
+            return a.second.tx_bytes + a.second.rx_bytes > b.second.tx_bytes + b.second.rx_bytes;
+        });
+        if (top_n > 0 && ports.size() > top_n) {
+            ports.resize(top_n);
+        }
+
+        out << std::left << std::setw(8) << "PORT" << std::setw(12) << "FLOWS"
+            << std::setw(16) << "TOTAL_BYTES" << "TOTAL_PACKETS\n";
+        for (const auto& entry : ports) {
+            out << std::left << std::setw(8) << entry.first
+                << std::setw(12) << entry.second.flow_count
+                << std::setw(16) << entry.second.tx_bytes + entry.second.rx_bytes
+                << entry.second.tx_packets + entry.second.rx_packets << "\n";
+        }
+    }
+
+    std::string m_spec;
+    std::string m_kind;
+    std::string m_sink_path;
+    std::unique_ptr<flowgen::PortTable> m_port_table;
+    std::unique_ptr<flowgen::GroupBy> m_group_by;
+    std::unique_ptr<flowgen::HeavyHitters> m_heavy;
+    std::unique_ptr<flowgen::TimeSeries> m_time_series;
+    std::unique_ptr<flowgen::EntropyTimeSeries> m_entropy;
+    std::unique_ptr<flowgen::FlowSink> m_sink;
+    std::unique_ptr<BiflowFileConsumer> m_biflow;
+    flowgen::FlowAggregator* m_aggregator = nullptr;
+    std::unique_ptr<flowgen::FlowConsumer> m_consumer;
+    std::unique_ptr<flowgen::FilterConsumer> m_filter;
+};
+
+// Multi subcommand - one generation pass feeding several consumers
+//
+// A flowgen::Pipeline from a generator (or, with --input, a binary flow
+// file) to every consumer: each batch is produced once and handed by
+// reference to all consumers, so extra outputs cost only their own
+// processing. --sample puts a flowgen::SamplerTransform in front of all
+// consumers, so sinks only serialize the sampled flows. Runs a single
+// source, so it does not use FlowStatsCommand threading; --threaded
+// gives each consumer its own thread instead.
+class FlowStatsMulti {
+private:
+    MultiOptions m_options;
+
+public:
+    explicit FlowStatsMulti(const MultiOptions& opts)
+        : m_options(opts)
+    {}
+
+    bool validate_options() {
+        if (m_options.m_consumers.empty()) {
+            std::cerr << "Error: At least one --consumer required\n";
+            return false;
+        }
+
+        if (m_options.m_batch_size == 0) {
+            std::cerr << "Error: Batch size must be positive\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    int execute() {
+        if (!validate_options()) {
+            std::cerr << "Error: Invalid options\n";
+            return 1;
+        }
+
+        std::vector<std::unique_ptr<MultiConsumer>> outputs;
+        flowgen::FlowGenerator gen;
+        std::unique_ptr<flowgen::FlowSource> source;
+        std::unique_ptr<flowgen::SamplerTransform> sampler;
+        try {
+            if (!m_options.m_sample.empty()) {
+                sampler = std::make_unique<flowgen::SamplerTransform>(
+                    flowgen::SamplingOptions::parse(m_options.m_sample));
+            }
+            for (const auto& spec : m_options.m_consumers) {
+                outputs.push_back(std::make_unique<MultiConsumer>(spec));
+            }
+            if (!m_options.m_input.empty()) {
+                source = std::make_unique<flowgen::BinaryFileSource>(m_options.m_input);
+            } else {
+                if (!gen.initialize(default_generator_config(m_options.m_start_timestamp_ns))) {
+                    std::cerr << "Error: Failed to initialize generator\n";
+                    return 1;
+                }
+                source = std::make_unique<flowgen::GeneratorSource>(gen, m_options.m_total_flows);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error during initialization: " << e.what() << "\n";
+            return 1;
+        }
+
+        flowgen::Pipeline pipeline(*source);
+        if (sampler) {
+            pipeline.add_transform(*sampler);
+        }
+        for (const auto& output : outputs) {
+            pipeline.add_sink(*output->consumer());
+        }
+
+        flowgen::PipelineOptions pipeline_options;
+        pipeline_options.batch_size = m_options.m_batch_size;
+        pipeline_options.threaded = m_options.m_threaded;
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t flows = 0;
+        try {
+            flows = pipeline.run(pipeline_options).flows_in;
+        } catch (const std::exception& e) {
+            std::cerr << "Error during " << (m_options.m_input.empty() ? "generation" : "reading")
+                      << ": " << e.what() << "\n";
+            return 1;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (const auto& output : outputs) {
+            output->output(std::cout, m_options.m_top_n);
+        }
+
+        std::cerr << "Summary:\n";
+        std::cerr << "  Flows " << (m_options.m_input.empty() ? "generated" : "read") << ": "
+                  << flows << " (once for "
+                  << outputs.size() << " consumers)\n";
+        if (sampler) {
+            std::cerr << "  Flows sampled: " << sampler->flows_kept() << " of "
+                      << sampler->flows_seen() << " (" << m_options.m_sample << ")\n";
+        }
+        std::cerr << "  Elapsed: " << std::fixed << std::setprecision(2) << elapsed << " s";
+        if (elapsed > 0.0) {
+            std::cerr << " (" << std::setprecision(2) << (flows / elapsed / 1e6) << " Mflows/s)";
+        }
+        std::cerr << "\n";
+        return 0;
+    }
+};
+
+} // namespace flowstats
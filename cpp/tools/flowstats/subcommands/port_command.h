@@ -2,9 +2,11 @@
 
 #include "../core/flowstats_base.h"
 #include "../utils/port_stat.h"
+#include <flowgen/aggregators.hpp>
 #include <flowgen/generator.hpp>
 #include <flowgen/utils.hpp>
 #include <algorithm>
+#include <limits>
 #include <map>
 #include <mutex>
 
@@ -44,7 +46,7 @@ struct PortOptions {
 
 // Per-thread port statistics buffer
 struct ThreadPortBuffer {
-    std::map<uint16_t, PortStat> m_port_stats;
+    flowgen::PortTable m_port_table;
     uint64_t m_start_ts;
     uint64_t m_end_ts;
 
@@ -102,18 +104,15 @@ public:
             uint64_t duration_ns = m_options.m_end_timestamp_ns - m_options.m_start_timestamp_ns;
             double duration_sec = duration_ns / 1e9;
 
-            // Assume 10 Gbps and 800 byte average packet size
-            double bandwidth_gbps = 10.0;
-            double avg_packet_size = 800.0;
-            double flows_per_second = (bandwidth_gbps * 1e9 / 8.0) / avg_packet_size;
-
+            // Workers stop at the end timestamp; the count is an estimate
+            double flows_per_second = estimate_flows_per_second(m_options.m_start_timestamp_ns);
             m_options.m_total_flows = static_cast<uint64_t>(duration_sec * flows_per_second);
-            m_flows_per_thread = m_options.m_total_flows / m_num_threads;
+            m_flows_per_thread = std::numeric_limits<size_t>::max();
 
             std::cerr << "Generating flows for time range: "
                       << m_options.m_start_timestamp_ns << " - "
                       << m_options.m_end_timestamp_ns << " ns\n";
-            std::cerr << "Calculated total flows: " << m_options.m_total_flows << "\n";
+            std::cerr << "Estimated total flows: " << m_options.m_total_flows << "\n";
         } else if (m_options.m_total_flows > 0) {
             // Total flows specified
             m_flows_per_thread = m_options.m_total_flows / m_num_threads;
@@ -124,42 +123,7 @@ public:
         try {
             // Create flow generator
             flowgen::FlowGenerator gen;
-            flowgen::GeneratorConfig config;
-
-            // Configure generator
-            config.max_flows = m_flows_per_thread;
-            config.start_timestamp_ns = m_options.m_start_timestamp_ns;
-
-            // Simple default configuration
-            config.source_subnets = {"192.168.0.0/16", "10.10.0.0/16"};
-            config.destination_subnets = {"10.100.0.0/16", "172.16.0.0/12"};
-            config.min_packet_size = 64;
-            config.max_packet_size = 1500;
-            config.average_packet_size = 800;
-
-            // Add default traffic patterns
-            flowgen::GeneratorConfig::TrafficPattern web_pattern;
-            web_pattern.type = "web_traffic";
-            web_pattern.percentage = 40;
-            config.traffic_patterns.push_back(web_pattern);
-
-            flowgen::GeneratorConfig::TrafficPattern dns_pattern;
-            dns_pattern.type = "dns_traffic";
-            dns_pattern.percentage = 20;
-            config.traffic_patterns.push_back(dns_pattern);
-
-            flowgen::GeneratorConfig::TrafficPattern db_pattern;
-            db_pattern.type = "database_traffic";
-            db_pattern.percentage = 20;
-            config.traffic_patterns.push_back(db_pattern);
-
-            flowgen::GeneratorConfig::TrafficPattern random_pattern;
-            random_pattern.type = "random";
-            random_pattern.percentage = 20;
-            config.traffic_patterns.push_back(random_pattern);
-
-            // Bandwidth-based rate (10 Gbps default)
-            config.bandwidth_gbps = 10.0;
+            flowgen::GeneratorConfig config = default_generator_config(m_options.m_start_timestamp_ns);
 
             gen.initialize(config);
 
@@ -168,15 +132,17 @@ public:
             auto& thread_data = get_thread_data(thread_id);
 
             flowgen::FlowRecord flow;
-            while (gen.next(flow)) {
+            FlowStats stats;
+            for (size_t i = 0; i < m_flows_per_thread; ++i) {
                 if (is_shutdown_requested()) {
                     break;
                 }
 
-                // Generate flow statistics
-                FlowStats stats = generate_flow_stats(flow.packet_length,
-                                                      flow.protocol,
-                                                      flow.destination_port);
+                // Generate flow with statistics
+                gen.next(flow, stats);
+                if (m_options.m_end_timestamp_ns > 0 && flow.timestamp >= m_options.m_end_timestamp_ns) {
+                    break;
+                }
 
                 // Track timestamp range
                 if (flow.timestamp < buffer.m_start_ts) {
@@ -187,26 +153,8 @@ public:
                     buffer.m_end_ts = last_ts;
                 }
 
-                // Aggregate source port statistics (tx)
-                auto& src_stat = buffer.m_port_stats[flow.source_port];
-                if (src_stat.m_port == 0) {
-                    src_stat.m_port = flow.source_port;
-                }
-                src_stat.m_flow_count++;
-                src_stat.m_tx_bytes += stats.byte_count;
-                src_stat.m_tx_packets += stats.packet_count;
-
-                // Aggregate destination port statistics (rx)
-                auto& dst_stat = buffer.m_port_stats[flow.destination_port];
-                if (dst_stat.m_port == 0) {
-                    dst_stat.m_port = flow.destination_port;
-                }
-                // Note: Don't increment flow_count again if src==dst port (rare but possible)
-                if (flow.source_port != flow.destination_port) {
-                    dst_stat.m_flow_count++;
-                }
-                dst_stat.m_rx_bytes += stats.byte_count;
-                dst_stat.m_rx_packets += stats.packet_count;
+                // Aggregate source (tx) and destination (rx) port statistics
+                buffer.m_port_table.add(flow, stats);
 
                 // Update statistics
                 thread_data.m_flows_generated.fetch_add(1, std::memory_order_relaxed);
@@ -220,6 +168,7 @@ public:
             }
 
             // Signal completion
+            thread_data.m_pacing = gen.pacing_report();
             thread_data.m_done.store(true, std::memory_order_release);
 
         } catch (const std::exception& e) {
@@ -243,6 +192,7 @@ public:
         result.m_start_ts = UINT64_MAX;
         result.m_end_ts = 0;
 
+        flowgen::PortTable merged;
         for (auto& buffer : m_thread_buffers) {
             // Update timestamp range
             if (buffer.m_start_ts < result.m_start_ts) {
@@ -252,20 +202,20 @@ public:
                 result.m_end_ts = buffer.m_end_ts;
             }
 
-            // Merge port statistics
-            for (const auto& [port, stat] : buffer.m_port_stats) {
-                auto& merged_stat = result.m_port_stats[port];
-                if (merged_stat.m_port == 0) {
-                    merged_stat.m_port = port;
-                }
-                merged_stat.m_flow_count += stat.m_flow_count;
-                merged_stat.m_tx_bytes += stat.m_tx_bytes;
-                merged_stat.m_rx_bytes += stat.m_rx_bytes;
-                merged_stat.m_tx_packets += stat.m_tx_packets;
-                merged_stat.m_rx_packets += stat.m_rx_packets;
-            }
+            merged.merge(buffer.m_port_table);
         }
 
+        // Convert merged table to port statistics
+        merged.for_each([&result](uint16_t port, const flowgen::PortCounters& counters) {
+            PortStat& stat = result.m_port_stats[port];
+            stat.m_port = port;
+            stat.m_flow_count = counters.flow_count;
+            stat.m_tx_bytes = counters.tx_bytes;
+            stat.m_rx_bytes = counters.rx_bytes;
+            stat.m_tx_packets = counters.tx_packets;
+            stat.m_rx_packets = counters.rx_packets;
+        });
+
         // Calculate totals
         result.m_total_flows = m_total_flows.load();
         result.m_total_bytes = m_total_bytes.load();
@@ -296,10 +246,8 @@ public:
     TimestampRange get_timestamp_range() const override {
         uint64_t end_ts = m_options.m_end_timestamp_ns;
         if (end_ts == 0) {
-            // Calculate based on flow count and bandwidth
-            double bandwidth_gbps = 10.0;
-            double avg_packet_size = 800.0;
-            double flows_per_second = (bandwidth_gbps * 1e9 / 8.0) / avg_packet_size;
+            // Estimate from the flow count and the byte-paced flow rate
+            double flows_per_second = estimate_flows_per_second(m_options.m_start_timestamp_ns);
 
             uint64_t total_flows = m_options.m_total_flows > 0 ?
                 m_options.m_total_flows :
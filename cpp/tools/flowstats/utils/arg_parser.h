@@ -68,6 +68,24 @@ public:
         target = default_value;
     }
 
+    // Add repeatable string option; each occurrence appends a value
+    void add_list_option(const std::string& short_name,
+                         const std::string& long_name,
+                         std::vector<std::string>& target,
+                         const std::string& description,
+                         bool required = false) {
+        Option opt;
+        opt.short_name = short_name;
+        opt.long_name = long_name;
+        opt.description = description;
+        opt.required = required;
+        opt.is_flag = false;
+        opt.list_target = &target;
+
+        m_options.push_back(opt);
+        target.clear();
+    }
+
     // Add boolean flag
     void add_flag(const std::string& long_name,
                  bool& target,
@@ -123,6 +141,8 @@ public:
                         m_has_error = true;
                         return false;
                     }
+                } else if (opt->list_target) {
+                    opt->list_target->push_back(value);
                 } else {
                     *opt->string_target = value;
                 }
@@ -160,6 +180,9 @@ public:
             if (!opt.is_flag) {
                 std::cout << " <value>";
             }
+            if (opt.list_target) {
+                std::cout << " (repeatable)";
+            }
 
             std::cout << "\n      " << opt.description;
 
@@ -195,6 +218,7 @@ private:
         std::string* string_target = nullptr;
         uint64_t* uint64_target = nullptr;
         bool* bool_target = nullptr;
+        std::vector<std::string>* list_target = nullptr;
 
         // Default values
         std::string default_string;
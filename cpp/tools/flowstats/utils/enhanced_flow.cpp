@@ -126,78 +126,4 @@ std::string EnhancedFlowRecord::to_json(bool pretty, bool last) const {
     return oss.str();
 }
 
-FlowStats generate_flow_stats(uint32_t avg_packet_size,
-                              uint8_t protocol,
-                              uint16_t dst_port) {
-    FlowStats stats;
-    auto& rng = flowgen::utils::Random::instance();
-
-    // Generate realistic packet count based on protocol and port
-    if (protocol == 6) {  // TCP
-        if (dst_port == 80 || dst_port == 443) {  // HTTP/HTTPS
-            stats.packet_count = rng.randint(10, 50);
-        } else if (dst_port == 22) {  // SSH
-            stats.packet_count = rng.randint(100, 500);
-        } else if (dst_port == 3306 || dst_port == 5432 ||
-                   dst_port == 27017 || dst_port == 6379) {  // Databases
-            stats.packet_count = rng.randint(5, 100);
-        } else if (dst_port == 25 || dst_port == 587 || dst_port == 465) {  // SMTP
-            stats.packet_count = rng.randint(10, 50);
-        } else {
-            stats.packet_count = rng.randint(5, 100);
-        }
-    } else if (protocol == 17) {  // UDP
-        if (dst_port == 53) {  // DNS
-            stats.packet_count = 2;  // Query + response
-        } else {
-            stats.packet_count = rng.randint(1, 20);
-        }
-    } else {
-        stats.packet_count = rng.randint(1, 10);
-    }
-
-    // Calculate byte count with variance
-    stats.byte_count = 0;
-    for (uint32_t i = 0; i < stats.packet_count; ++i) {
-        uint32_t variance = avg_packet_size / 5;  // 20% variance
-        int32_t offset = rng.randint(static_cast<int32_t>(-variance),
-                                     static_cast<int32_t>(variance));
-        uint32_t pkt_size = avg_packet_size + offset;
-        pkt_size = std::max(64u, std::min(1500u, pkt_size));
-        stats.byte_count += pkt_size;
-    }
-
-    // Calculate flow duration based on protocol
-    if (stats.packet_count == 1) {
-        stats.duration_ns = 0;
-    } else if (protocol == 6) {  // TCP
-        if (dst_port == 80 || dst_port == 443) {  // HTTP/HTTPS
-            uint64_t inter_packet_time_us = rng.randint(10000, 100000);  // 10-100ms
-            stats.duration_ns = (stats.packet_count - 1) * inter_packet_time_us * 1000;
-        } else if (dst_port == 22) {  // SSH
-            uint64_t inter_packet_time_us = rng.randint(1000, 50000);  // 1-50ms
-            stats.duration_ns = (stats.packet_count - 1) * inter_packet_time_us * 1000;
-        } else if (dst_port == 3306 || dst_port == 5432 ||
-                   dst_port == 27017 || dst_port == 6379) {  // Databases
-            uint64_t inter_packet_time_us = rng.randint(1000, 20000);  // 1-20ms
-            stats.duration_ns = (stats.packet_count - 1) * inter_packet_time_us * 1000;
-        } else {
-            uint64_t inter_packet_time_us = rng.randint(5000, 50000);  // 5-50ms
-            stats.duration_ns = (stats.packet_count - 1) * inter_packet_time_us * 1000;
-        }
-    } else if (protocol == 17) {  // UDP
-        if (dst_port == 53) {  // DNS
-            stats.duration_ns = rng.randint(1000000, 50000000);  // 1-50ms total
-        } else {
-            uint64_t inter_packet_time_us = rng.randint(100, 10000);  // 0.1-10ms
-            stats.duration_ns = (stats.packet_count - 1) * inter_packet_time_us * 1000;
-        }
-    } else {
-        uint64_t inter_packet_time_us = rng.randint(1000, 10000);  // 1-10ms
-        stats.duration_ns = (stats.packet_count - 1) * inter_packet_time_us * 1000;
-    }
-
-    return stats;
-}
-
 } // namespace flowstats
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <flowgen/flow_stats.hpp>
 
 namespace flowstats {
 
@@ -64,20 +65,8 @@ struct EnhancedFlowRecord {
     static std::string plain_text_header();
 };
 
-/**
- * Flow statistics for realistic packet/byte count generation
- */
-struct FlowStats {
-    uint32_t packet_count;
-    uint64_t byte_count;
-    uint64_t duration_ns;  // Flow duration in nanoseconds
-};
-
-/**
- * Generate realistic flow statistics based on protocol and port
- */
-FlowStats generate_flow_stats(uint32_t avg_packet_size,
-                              uint8_t protocol,
-                              uint16_t dst_port);
+// Enrichment comes from libflowgen
+using flowgen::FlowStats;
+using flowgen::generate_flow_stats;
 
 } // namespace flowstats
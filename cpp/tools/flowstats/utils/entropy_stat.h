@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace flowstats {
+
+// Entropy of one time window (bits)
+struct EntropyPoint {
+    uint64_t m_window_start_ns;   // Window start timestamp
+    uint64_t m_flow_count;        // Flows starting in the window
+    double m_src_ip_entropy;      // Source address entropy
+    double m_dst_ip_entropy;      // Destination address entropy
+    double m_dst_port_entropy;    // Destination port entropy
+
+    EntropyPoint()
+        : m_window_start_ns(0)
+        , m_flow_count(0)
+        , m_src_ip_entropy(0.0)
+        , m_dst_ip_entropy(0.0)
+        , m_dst_port_entropy(0.0)
+    {}
+};
+
+// Entropy time series result
+struct EntropyResult {
+    std::vector<EntropyPoint> m_windows;
+    uint64_t m_window_ns;
+    uint64_t m_total_flows;
+    uint64_t m_total_bytes;
+
+    EntropyResult()
+        : m_window_ns(0)
+        , m_total_flows(0)
+        , m_total_bytes(0)
+    {}
+};
+
+} // namespace flowstats
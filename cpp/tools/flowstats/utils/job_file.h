@@ -0,0 +1,216 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flowstats {
+
+// Node of a parsed job file
+struct JobNode {
+    enum class Kind { SCALAR, MAP, LIST };
+
+    Kind m_kind = Kind::SCALAR;
+    std::string m_value;                                    // SCALAR
+    std::vector<std::pair<std::string, JobNode>> m_entries; // MAP, in file order
+    std::vector<JobNode> m_items;                           // LIST
+
+    bool is_scalar() const { return m_kind == Kind::SCALAR; }
+    bool is_map() const { return m_kind == Kind::MAP; }
+    bool is_list() const { return m_kind == Kind::LIST; }
+
+    // Map entry by key, or nullptr
+    const JobNode* find(const std::string& key) const {
+        for (const auto& entry : m_entries) {
+            if (entry.first == key) {
+                return &entry.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Parser for the YAML subset used by job files
+//
+// Supports block mappings ("key: value" / "key:" + nested block),
+// block sequences ("- item", including "- key: value" mappings),
+// single- or double-quoted scalars and '#' comments. Flow collections
+// ({...}, [...]), anchors and multi-line scalars are not supported.
+class JobFileParser {
+public:
+    static JobNode parse_file(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open job file: " + path);
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        return parse(buffer.str());
+    }
+
+    static JobNode parse(const std::string& text) {
+        JobFileParser parser(text);
+        if (parser.m_lines.empty()) {
+            return JobNode();
+        }
+        JobNode root = parser.parse_block(parser.m_lines.front().m_indent);
+        if (parser.m_pos < parser.m_lines.size()) {
+            parser.fail("unexpected indentation");
+        }
+        return root;
+    }
+
+private:
+    struct Line {
+        size_t m_indent;
+        std::string m_text;
+        size_t m_number;
+    };
+
+    std::vector<Line> m_lines;
+    size_t m_pos = 0;
+
+    explicit JobFileParser(const std::string& text) {
+        std::istringstream in(text);
+        std::string raw;
+        size_t number = 0;
+        while (std::getline(in, raw)) {
+            ++number;
+            if (!raw.empty() && raw.back() == '\r') {
+                raw.pop_back();
+            }
+            std::string text_part = strip_comment(raw);
+            size_t indent = text_part.find_first_not_of(' ');
+            if (indent == std::string::npos) {
+                continue;
+            }
+            if (text_part.find('\t') < indent) {
+                throw std::runtime_error("Job file line " + std::to_string(number) +
+                                         ": tabs are not allowed for indentation");
+            }
+            size_t end = text_part.find_last_not_of(' ');
+            m_lines.push_back({indent, text_part.substr(indent, end - indent + 1), number});
+        }
+    }
+
+    // Remove a '#' comment that starts a line or follows whitespace, outside quotes
+    static std::string strip_comment(const std::string& line) {
+        char quote = 0;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (quote) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '#' && (i == 0 || line[i - 1] == ' ')) {
+                return line.substr(0, i);
+            }
+        }
+        return line;
+    }
+
+    static bool is_item(const std::string& text) {
+        return text == "-" || text.compare(0, 2, "- ") == 0;
+    }
+
+    // Position of the ':' that separates a mapping key, or npos
+    static size_t key_separator(const std::string& text) {
+        if (text.empty() || text[0] == '"' || text[0] == '\'') {
+            return std::string::npos;
+        }
+        size_t pos = text.find(": ");
+        if (pos != std::string::npos) {
+            return pos;
+        }
+        return text.back() == ':' ? text.size() - 1 : std::string::npos;
+    }
+
+    JobNode scalar(const std::string& text) const {
+        if (text[0] == '[' || text[0] == '{') {
+            fail("flow collections are not supported, use a block list or mapping");
+        }
+        JobNode node;
+        node.m_value = text;
+        if (text.size() >= 2 && (text[0] == '"' || text[0] == '\'') && text.back() == text[0]) {
+            node.m_value = text.substr(1, text.size() - 2);
+        }
+        return node;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        size_t number = m_pos < m_lines.size() ? m_lines[m_pos].m_number : m_lines.back().m_number;
+        throw std::runtime_error("Job file line " + std::to_string(number) + ": " + message);
+    }
+
+    JobNode parse_block(size_t indent) {
+        return is_item(m_lines[m_pos].m_text) ? parse_list(indent) : parse_map(indent);
+    }
+
+    JobNode parse_map(size_t indent) {
+        JobNode node;
+        node.m_kind = JobNode::Kind::MAP;
+        while (m_pos < m_lines.size() && m_lines[m_pos].m_indent == indent &&
+               !is_item(m_lines[m_pos].m_text)) {
+            const std::string& text = m_lines[m_pos].m_text;
+            size_t colon = key_separator(text);
+            if (colon == std::string::npos) {
+                fail("expected 'key: value'");
+            }
+            std::string key = text.substr(0, colon);
+            std::string rest = colon + 1 < text.size() ? text.substr(colon + 2) : "";
+            size_t start = rest.find_first_not_of(' ');
+            rest = start == std::string::npos ? "" : rest.substr(start);
+            ++m_pos;
+
+            JobNode value;
+            if (!rest.empty()) {
+                --m_pos;
+                value = scalar(rest);
+                ++m_pos;
+            } else if (m_pos < m_lines.size() &&
+                       (m_lines[m_pos].m_indent > indent ||
+                        (m_lines[m_pos].m_indent == indent && is_item(m_lines[m_pos].m_text)))) {
+                value = parse_block(m_lines[m_pos].m_indent);
+            }
+            if (node.find(key)) {
+                --m_pos;
+                fail("duplicate key '" + key + "'");
+            }
+            node.m_entries.emplace_back(key, std::move(value));
+        }
+        return node;
+    }
+
+    JobNode parse_list(size_t indent) {
+        JobNode node;
+        node.m_kind = JobNode::Kind::LIST;
+        while (m_pos < m_lines.size() && m_lines[m_pos].m_indent == indent &&
+               is_item(m_lines[m_pos].m_text)) {
+            Line& line = m_lines[m_pos];
+            std::string item = line.m_text.size() > 1 ? line.m_text.substr(2) : "";
+            size_t start = item.find_first_not_of(' ');
+            if (start == std::string::npos) {
+                ++m_pos;
+                if (m_pos < m_lines.size() && m_lines[m_pos].m_indent > indent) {
+                    node.m_items.push_back(parse_block(m_lines[m_pos].m_indent));
+                } else {
+                    node.m_items.push_back(JobNode());
+                }
+            } else if (key_separator(item.substr(start)) != std::string::npos) {
+                // "- key: value" starts a mapping aligned with the text after the dash
+                line.m_indent = indent + 2 + start;
+                line.m_text = item.substr(start);
+                node.m_items.push_back(parse_map(line.m_indent));
+            } else {
+                node.m_items.push_back(scalar(item.substr(start)));
+                ++m_pos;
+            }
+        }
+        return node;
+    }
+};
+
+} // namespace flowstats
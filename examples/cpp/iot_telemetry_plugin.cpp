@@ -0,0 +1,136 @@
+/**
+ * Example pattern plugin: IoT telemetry
+ *
+ * Devices in the source subnets report small readings to brokers in the
+ * destination subnets over MQTT (TCP 1883/8883) or CoAP (UDP 5683).
+ * Built as a module into <build>/plugins; use it with
+ *
+ *   FLOWGEN_PLUGIN_PATH=build/plugins ./flowdump ...
+ *
+ * and a traffic pattern of type "iot_telemetry". Config keys:
+ *   coap_fraction  - share of CoAP flows (default 0.3)
+ *   tls_fraction   - share of MQTT flows on 8883 (default 0.5)
+ *   report_bytes   - mean payload per packet (default 120)
+ *
+ * Uses only the C ABI in flowgen/plugin_abi.h; it does not link against
+ * libflowgen.
+ */
+
+#include "flowgen/plugin_abi.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+struct IotTelemetry {
+    const flowgen_pattern_env* env;
+    double coap_fraction = 0.3;
+    double tls_fraction = 0.5;
+    double report_bytes = 120.0;
+
+    // Scratch for random draws, sized to the largest batch seen
+    double* unit = nullptr;
+    size_t capacity = 0;
+};
+
+bool parse_fraction(const char* text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0' && value >= 0.0 && value <= 1.0;
+}
+
+void* create(const flowgen_pattern_env* env,
+             const char* const* keys, const char* const* values, size_t config_count,
+             char* error, size_t error_size) {
+    auto* self = new (std::nothrow) IotTelemetry();
+    if (!self) {
+        return nullptr;
+    }
+    self->env = env;
+
+    for (size_t i = 0; i < config_count; ++i) {
+        bool ok = true;
+        if (std::strcmp(keys[i], "coap_fraction") == 0) {
+            ok = parse_fraction(values[i], self->coap_fraction);
+        } else if (std::strcmp(keys[i], "tls_fraction") == 0) {
+            ok = parse_fraction(values[i], self->tls_fraction);
+        } else if (std::strcmp(keys[i], "report_bytes") == 0) {
+            char* end = nullptr;
+            self->report_bytes = std::strtod(values[i], &end);
+            ok = end != values[i] && *end == '\0' && self->report_bytes > 0.0;
+        }
+        if (!ok) {
+            std::snprintf(error, error_size, "invalid %s: %s", keys[i], values[i]);
+            delete self;
+            return nullptr;
+        }
+    }
+    return self;
+}
+
+void generate(void* instance, flowgen_pattern_batch* batch) {
+    auto* self = static_cast<IotTelemetry*>(instance);
+    const flowgen_pattern_env* env = self->env;
+    size_t n = batch->count;
+
+    // Three uniform draws per flow: protocol/port, size, packet count
+    if (self->capacity < 3 * n) {
+        delete[] self->unit;
+        self->unit = new double[3 * n];
+        self->capacity = 3 * n;
+    }
+    double* unit = self->unit;
+    env->random_unit(env->rng, unit, 3 * n);
+    env->sample_endpoints(env->endpoints, batch->source_ip, batch->destination_ip, n);
+    env->random_u32(env->rng, batch->packet_count, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        double kind = unit[3 * i];
+        bool coap = kind < self->coap_fraction;
+        bool tls = !coap && (kind - self->coap_fraction) <
+                                self->tls_fraction * (1.0 - self->coap_fraction);
+
+        batch->protocol[i] = coap ? 17 : 6;  // UDP : TCP
+        batch->destination_port[i] = coap ? 5683 : (tls ? 8883 : 1883);
+        batch->source_port[i] = static_cast<uint16_t>(49152 + batch->packet_count[i] % 16384);
+
+        // Payload plus headers, +-50% around the mean
+        double size = self->report_bytes * (0.5 + unit[3 * i + 1]) + (coap ? 28.0 : 52.0);
+        if (size < env->min_packet_size) size = env->min_packet_size;
+        if (size > env->max_packet_size) size = env->max_packet_size;
+        batch->packet_length[i] = static_cast<uint32_t>(size);
+
+        // CoAP: request/response; MQTT: a few publishes on a kept-alive session
+        uint32_t packets = coap ? 2 : 4 + static_cast<uint32_t>(unit[3 * i + 2] * 12.0);
+        batch->packet_count[i] = packets;
+        batch->byte_count[i] = static_cast<uint64_t>(packets) * batch->packet_length[i];
+        batch->duration_ns[i] = coap ? 20000000ULL : packets * 1000000000ULL;
+    }
+    batch->stats_filled = 1;
+}
+
+void destroy(void* instance) {
+    auto* self = static_cast<IotTelemetry*>(instance);
+    delete[] self->unit;
+    delete self;
+}
+
+// Every draw comes from the environment and nothing carries over between
+// batches, so there is no per-run state to drop
+void reset(void* /*instance*/) {}
+
+const flowgen_pattern_type TYPES[] = {
+    {"iot_telemetry", create, generate, destroy, reset},
+};
+
+const flowgen_plugin PLUGIN = {
+    FLOWGEN_PLUGIN_ABI_VERSION, "iot_telemetry_plugin", 1, TYPES,
+};
+
+} // namespace
+
+extern "C" FLOWGEN_PLUGIN_EXPORT const flowgen_plugin* flowgen_plugin_init(uint32_t abi_version) {
+    return abi_version == FLOWGEN_PLUGIN_ABI_VERSION ? &PLUGIN : nullptr;
+}
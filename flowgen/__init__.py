@@ -5,6 +5,8 @@ This package provides both C++ and Python interfaces for generating
 realistic network flow data.
 """
 
+import math
+
 from .config import ConfigParser, FlowGenConfig
 from .exporters import export_csv, export_json, export_jsonlines, FlowExporter
 
@@ -52,6 +54,8 @@ if HAS_CPP_CORE:
         def __init__(self):
             self._cpp_generator = _flowgen_core.FlowGenerator()
             self._config = None
+            self._flow_count = 0
+            self._start_timestamp_ns = 0
 
         def initialize(self, config_path: str) -> bool:
             """
@@ -73,24 +77,17 @@ if HAS_CPP_CORE:
             cpp_config = self._python_config_to_cpp(self._config)
 
             # Initialize C++ generator
-            return self._cpp_generator.initialize(cpp_config)
+            if not self._cpp_generator.initialize(cpp_config):
+                return False
+
+            self._flow_count = 0
+            self._start_timestamp_ns = self._cpp_generator.current_timestamp_ns()
+            return True
 
         def _python_config_to_cpp(self, py_config: FlowGenConfig):
             """Convert Python config to C++ GeneratorConfig"""
             cpp_config = _flowgen_core.GeneratorConfig()
 
-            # Rate configuration
-            if py_config.generation.rate.bandwidth_gbps is not None:
-                cpp_config.bandwidth_gbps = py_config.generation.rate.bandwidth_gbps
-            if py_config.generation.rate.flows_per_second is not None:
-                cpp_config.flows_per_second = py_config.generation.rate.flows_per_second
-
-            # Stop conditions
-            if py_config.generation.max_flows is not None:
-                cpp_config.max_flows = py_config.generation.max_flows
-            if py_config.generation.duration_seconds is not None:
-                cpp_config.duration_seconds = py_config.generation.duration_seconds
-
             # Timestamp (convert seconds to nanoseconds)
             if py_config.generation.start_timestamp is not None:
                 cpp_config.start_timestamp_ns = int(py_config.generation.start_timestamp * 1e9)
@@ -100,6 +97,19 @@ if HAS_CPP_CORE:
             cpp_config.destination_subnets = py_config.network.destination_subnets
             if py_config.network.source_weights:
                 cpp_config.source_weights = py_config.network.source_weights
+            for name in ("source_popularity", "destination_popularity"):
+                popularity = getattr(py_config.network, name)
+                if popularity:
+                    if isinstance(popularity, str):
+                        popularity = [popularity]
+                    setattr(cpp_config, name, list(popularity))
+            if py_config.network.communication_graph:
+                graph = _flowgen_core.CommunicationGraphOptions()
+                for key, value in py_config.network.communication_graph.items():
+                    if not hasattr(graph, key):
+                        raise ValueError(f"Unknown communication_graph option: {key}")
+                    setattr(graph, key, value)
+                cpp_config.communication_graph = graph
 
             # Packet configuration
             cpp_config.min_packet_size = py_config.packets.min_size
@@ -111,9 +121,20 @@ if HAS_CPP_CORE:
                     py_config.packets.min_size + py_config.packets.max_size
                 ) // 2
 
+            # Rate configuration - the C++ generator is bandwidth driven, so an
+            # explicit flow rate is converted using the average packet size
+            if py_config.generation.rate.bandwidth_gbps is not None:
+                cpp_config.bandwidth_gbps = py_config.generation.rate.bandwidth_gbps
+            elif py_config.generation.rate.flows_per_second is not None:
+                cpp_config.bandwidth_gbps = (
+                    py_config.generation.rate.flows_per_second *
+                    cpp_config.average_packet_size * 8 / 1e9
+                )
+
             # Bidirectional mode configuration
             cpp_config.bidirectional_mode = py_config.generation.bidirectional_mode
             cpp_config.bidirectional_probability = py_config.generation.bidirectional_probability
+            cpp_config.pacing = py_config.generation.pacing
 
             # Traffic patterns - build list and assign all at once
             patterns_list = []
@@ -121,35 +142,91 @@ if HAS_CPP_CORE:
                 cpp_pattern = _flowgen_core.TrafficPattern()
                 cpp_pattern.type = pattern.type
                 cpp_pattern.percentage = pattern.percentage
+                cpp_pattern.config = {k: str(v) for k, v in pattern.config.items()}
                 patterns_list.append(cpp_pattern)
             cpp_config.traffic_patterns = patterns_list
+            if py_config.schedule:
+                schedule = _flowgen_core.ScheduleOptions()
+                points = []
+                for key, value in py_config.schedule.items():
+                    if key == 'points':
+                        for point_data in value:
+                            point = _flowgen_core.SchedulePoint()
+                            point.time_s = float(point_data.get('time_s', 0.0))
+                            point.rate = float(point_data.get('rate', 1.0))
+                            point.mix = [float(w) for w in point_data.get('mix', [])]
+                            points.append(point)
+                    elif hasattr(schedule, key):
+                        setattr(schedule, key, value)
+                    else:
+                        raise ValueError(f"Unknown schedule option: {key}")
+                schedule.points = points
+                cpp_config.schedule = schedule
+            cpp_config.overlays = py_config.overlays
+            if py_config.plugin_dir:
+                cpp_config.plugin_dir = py_config.plugin_dir
 
             return cpp_config
 
         def __iter__(self):
             """Return iterator for flow records"""
-            return self._cpp_generator.__iter__()
+            return self
 
         def __next__(self):
             """Generate next flow record"""
-            return self._cpp_generator.__next__()
+            if self.is_done():
+                raise StopIteration
+            self._flow_count += 1
+            return self._cpp_generator.next()
 
         def is_done(self) -> bool:
-            """Check if generation is complete"""
-            return self._cpp_generator.is_done()
+            """Check if generation is complete (max_flows / duration_seconds)"""
+            return self.remaining_flows() == 0 or self._duration_reached()
+
+        def remaining_flows(self):
+            """Get flows left before max_flows, or None if unbounded"""
+            if self._config is None or self._config.generation.max_flows is None:
+                return None
+            return max(0, self._config.generation.max_flows - self._flow_count)
+
+        def _duration_reached(self) -> bool:
+            if self._config is None or self._config.generation.duration_seconds is None:
+                return False
+            elapsed_ns = self._cpp_generator.current_timestamp_ns() - self._start_timestamp_ns
+            return elapsed_ns >= self._config.generation.duration_seconds * 1e9
+
+        def end_timestamp_ns(self):
+            """Get the first flow timestamp past duration_seconds, or None if unbounded"""
+            if self._config is None or self._config.generation.duration_seconds is None:
+                return None
+            return self._start_timestamp_ns + math.ceil(self._config.generation.duration_seconds * 1e9)
+
+        def _advance(self, count: int):
+            """Account for flows generated natively (e.g. by native exporters)"""
+            self._flow_count += count
 
         def reset(self):
             """Reset generator to initial state"""
             self._cpp_generator.reset()
+            self._flow_count = 0
 
         def get_stats(self):
             """Get generation statistics"""
-            return self._cpp_generator.get_stats()
+            elapsed = (self._cpp_generator.current_timestamp_ns() - self._start_timestamp_ns) / 1e9
+            pacing = self._cpp_generator.pacing_report()
+            return {
+                'flows_generated': self._flow_count,
+                'elapsed_time_seconds': elapsed,
+                'current_timestamp_ns': self._cpp_generator.current_timestamp_ns(),
+                'target_gbps': pacing.target_gbps,
+                'achieved_gbps': pacing.achieved_gbps,
+                'utilization': pacing.utilization,
+            }
 
         @property
         def flow_count(self) -> int:
             """Get number of flows generated"""
-            return self._cpp_generator.flow_count()
+            return self._flow_count
 
         @property
         def current_timestamp_ns(self) -> int:
@@ -0,0 +1,157 @@
+"""
+Native flow aggregations.
+
+Aggregation runs in the C++ core (port tables, group-by, heavy-hitter
+sketches and time series) over a generator stream or NumPy column
+arrays, and only the compact results are returned to Python.
+"""
+
+from typing import Dict, List, Optional, Sequence
+
+from .exporters import _native_source, _UNBOUNDED_COUNT
+
+try:
+    from . import _flowgen_core
+except ImportError:
+    _flowgen_core = None
+
+
+_COLUMN_NAMES = (
+    'timestamp', 'source_ip', 'destination_ip', 'source_port',
+    'destination_port', 'protocol',
+)
+_OPTIONAL_COLUMN_NAMES = ('packet_length', 'packet_count', 'byte_count', 'duration_ns')
+
+
+def _require_core():
+    if _flowgen_core is None:
+        raise RuntimeError("Native aggregations require the C++ core (pip install -e .)")
+
+
+def _metric(metric: str):
+    return {
+        'flows': _flowgen_core.AggregateMetric.FLOWS,
+        'packets': _flowgen_core.AggregateMetric.PACKETS,
+        'bytes': _flowgen_core.AggregateMetric.BYTES,
+    }[metric]
+
+
+def aggregate(generator, aggregators: Sequence, count: Optional[int] = None) -> int:
+    """
+    Generate flows once and feed every native aggregator.
+
+    Args:
+        generator: flowgen.FlowGenerator (C++ backend) or _flowgen_core.FlowGenerator
+        aggregators: PortTable / GroupBy / HeavyHitters / TimeSeries instances
+        count: Number of flows (defaults to the generator's remaining max_flows)
+
+    Returns:
+        Number of flows aggregated
+    """
+    _require_core()
+    source = _native_source(generator, count)
+    if source is None or source[2] == _UNBOUNDED_COUNT:
+        raise ValueError("aggregate() needs a C++-backed generator and a flow count")
+
+    cpp_gen, wrapper, count, _ = source
+    processed = _flowgen_core.aggregate_flows(cpp_gen, count, list(aggregators))
+    if wrapper is not None:
+        wrapper._advance(processed)
+    return processed
+
+
+def add_columns(aggregator, columns) -> None:
+    """
+    Feed column data to a native aggregator.
+
+    Args:
+        aggregator: Native aggregator instance
+        columns: Mapping of column name to array (dict of NumPy arrays or a
+            pandas DataFrame). Required: timestamp, source_ip, destination_ip,
+            source_port, destination_port, protocol. Optional: packet_length,
+            packet_count, byte_count, duration_ns.
+    """
+    kwargs = {name: columns[name] for name in _COLUMN_NAMES}
+    for name in _OPTIONAL_COLUMN_NAMES:
+        if name in columns:
+            kwargs[name] = columns[name]
+    aggregator.add_columns(**kwargs)
+
+
+def port_stats(generator, count: Optional[int] = None) -> List[Dict]:
+    """Per-port flow, byte and packet counts (tx = source port, rx = destination port)"""
+    _require_core()
+    table = _flowgen_core.PortTable()
+    aggregate(generator, [table], count)
+    return [
+        {
+            'port': port,
+            'flow_count': flows,
+            'tx_bytes': tx_bytes,
+            'rx_bytes': rx_bytes,
+            'tx_packets': tx_packets,
+            'rx_packets': rx_packets,
+        }
+        for port, flows, tx_bytes, rx_bytes, tx_packets, rx_packets in table.ports()
+    ]
+
+
+def group_by(generator, fields: str, count: Optional[int] = None,
+             top: int = 0, metric: str = 'bytes') -> List[Dict]:
+    """
+    Exact group-by over a subset of the 5-tuple.
+
+    Args:
+        fields: Comma-separated fields, e.g. "src_ip,dst_port"
+        top: Return only the N largest groups (0 = all)
+        metric: Ranking metric ('flows', 'packets' or 'bytes')
+    """
+    _require_core()
+    groups = _flowgen_core.GroupBy(fields)
+    aggregate(generator, [groups], count)
+    return [
+        {'key': key, 'flow_count': flows, 'packet_count': packets, 'byte_count': byte_count}
+        for key, flows, packets, byte_count in groups.top(top, _metric(metric))
+    ]
+
+
+def top_talkers(generator, n: int = 10, fields: str = 'src_ip',
+                count: Optional[int] = None, metric: str = 'bytes',
+                capacity: int = 1024) -> List[Dict]:
+    """
+    Approximate top-N keys in bounded memory (Space-Saving sketch).
+
+    Each count overestimates the true value by at most 'error'.
+    """
+    _require_core()
+    sketch = _flowgen_core.HeavyHitters(capacity, fields, _metric(metric))
+    aggregate(generator, [sketch], count)
+    return [
+        {'key': key, 'count': value, 'error': error}
+        for key, value, error in sketch.top(n)
+    ]
+
+
+def time_series(generator, bucket_seconds: float = 1.0,
+                count: Optional[int] = None) -> List[Dict]:
+    """Flow, packet and byte counts per fixed-width time bucket"""
+    _require_core()
+    series = _flowgen_core.TimeSeries(int(bucket_seconds * 1e9))
+    aggregate(generator, [series], count)
+    return [
+        {'start_ns': start, 'flow_count': flows, 'packet_count': packets, 'byte_count': byte_count}
+        for start, flows, packets, byte_count in series.buckets()
+    ]
+
+
+def entropy_series(generator, window_seconds: float = 1.0, count: Optional[int] = None,
+                   registers: int = 128, metric: str = 'flows') -> List[Dict]:
+    """Source/destination address and destination port entropy (bits) per window"""
+    _require_core()
+    series = _flowgen_core.EntropyTimeSeries(int(window_seconds * 1e9), registers, _metric(metric))
+    aggregate(generator, [series], count)
+    return [
+        {'start_ns': start, 'flow_count': flows, 'src_ip_entropy': src,
+         'dst_ip_entropy': dst, 'dst_port_entropy': port}
+        for start, flows, src, dst, port in series.windows()
+    ]
@@ -6,7 +6,7 @@ import json
 import time
 from dataclasses import dataclass, field
 from pathlib import Path
-from typing import List, Dict, Optional, Any, Tuple
+from typing import List, Dict, Optional, Any, Tuple, Union
 
 try:
     import yaml
@@ -44,6 +44,7 @@ class GenerationConfig:
     start_timestamp: Optional[float] = None
     bidirectional_mode: str = "none"
     bidirectional_probability: float = 0.5
+    pacing: str = "flows"  # "flows" (one packet per flow) or "bytes" (enriched byte volume)
 
     def validate(self) -> Tuple[bool, Optional[str]]:
         """Validate generation configuration"""
@@ -74,6 +75,9 @@ class GenerationConfig:
         if self.bidirectional_probability < 0.0 or self.bidirectional_probability > 1.0:
             return False, f"bidirectional_probability must be between 0.0 and 1.0, got {self.bidirectional_probability}"
 
+        if self.pacing not in ["flows", "bytes"]:
+            return False, f"pacing must be 'flows' or 'bytes', got '{self.pacing}'"
+
         return True, None
 
 
@@ -101,6 +105,12 @@ class NetworkConfig:
     source_subnets: List[str] = field(default_factory=lambda: ["192.168.1.0/24"])
     destination_subnets: List[str] = field(default_factory=lambda: ["10.0.0.0/8"])
     source_weights: Optional[List[float]] = None
+    # Host popularity: one spec for all subnets or one per subnet
+    source_popularity: Optional[Union[str, List[str]]] = None
+    destination_popularity: Optional[Union[str, List[str]]] = None
+    # Fixed client-server graph: clients, servers, degree_exponent,
+    # max_degree, server_skew, locality
+    communication_graph: Optional[Dict[str, Any]] = None
 
     def validate(self) -> Tuple[bool, Optional[str]]:
         """Validate network configuration"""
@@ -118,6 +128,13 @@ class NetworkConfig:
             if abs(sum(self.source_weights) - 100.0) > 0.01:
                 return False, f"source_weights must sum to 100, got {sum(self.source_weights)}"
 
+        for name, popularity, subnets in (
+            ("source_popularity", self.source_popularity, self.source_subnets),
+            ("destination_popularity", self.destination_popularity, self.destination_subnets),
+        ):
+            if isinstance(popularity, list) and len(popularity) not in (1, len(subnets)):
+                return False, f"{name} must have one entry or one per subnet"
+
         return True, None
 
 
@@ -150,6 +167,13 @@ class FlowGenConfig:
     traffic_patterns: List[TrafficPatternConfig]
     network: NetworkConfig = field(default_factory=NetworkConfig)
     packets: PacketConfig = field(default_factory=PacketConfig)
+    # Rate/mix schedule: interpolation, period_s, resolution_s and
+    # points [{time_s, rate, mix}] (see README "Schedules")
+    schedule: Optional[Dict[str, Any]] = None
+    # Attack/anomaly overlays, e.g. "syn_flood target=10.0.0.5:80 rate=10 start=5s duration=30s"
+    overlays: List[str] = field(default_factory=list)
+    # Directory of pattern plugins (*.so) providing extra pattern types
+    plugin_dir: Optional[str] = None
 
     def validate(self) -> Tuple[bool, Optional[str]]:
         """
@@ -270,7 +294,8 @@ class ConfigParser:
             rate=rate_config,
             start_timestamp=gen_data.get('start_timestamp'),
             bidirectional_mode=gen_data.get('bidirectional_mode', 'none'),
-            bidirectional_probability=gen_data.get('bidirectional_probability', 0.5)
+            bidirectional_probability=gen_data.get('bidirectional_probability', 0.5),
+            pacing=gen_data.get('pacing', 'flows')
         )
 
         # Parse traffic patterns
@@ -289,7 +314,10 @@ class ConfigParser:
         network_config = NetworkConfig(
             source_subnets=net_data.get('source_subnets', ["192.168.1.0/24"]),
             destination_subnets=net_data.get('destination_subnets', ["10.0.0.0/8"]),
-            source_weights=net_data.get('source_weights')
+            source_weights=net_data.get('source_weights'),
+            source_popularity=net_data.get('source_popularity'),
+            destination_popularity=net_data.get('destination_popularity'),
+            communication_graph=net_data.get('communication_graph')
         )
 
         # Parse packet config
@@ -305,7 +333,10 @@ class ConfigParser:
             generation=generation_config,
             traffic_patterns=traffic_patterns,
             network=network_config,
-            packets=packet_config
+            packets=packet_config,
+            schedule=data.get('schedule'),
+            overlays=list(data.get('overlays', [])),
+            plugin_dir=data.get('plugin_dir')
         )
 
         # Validate configuration
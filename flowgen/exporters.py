@@ -3,11 +3,82 @@ Export flow records to various formats.
 """
 
 import json
-from typing import List, Iterator, Union
+from typing import List, Iterator, Union, Optional
 from pathlib import Path
 
 from .models import FlowRecord
 
+try:
+    from . import _flowgen_core
+except ImportError:
+    _flowgen_core = None
+
+# Count passed to native export when only duration_seconds bounds it
+_UNBOUNDED_COUNT = 2**64 - 1
+
+
+def _native_source(flows, count: Optional[int]):
+    """
+    Resolve a C++ generator, flow count and end timestamp for native export.
+
+    Returns (cpp_generator, wrapper, count, end_timestamp_ns) when flows is
+    backed by the C++ core and bounded by a count or the wrapper's
+    duration_seconds, otherwise None. Export stops at whichever limit is
+    reached first.
+    """
+    if _flowgen_core is None:
+        return None
+
+    wrapper = None
+    cpp_gen = flows
+    if hasattr(flows, '_cpp_generator'):
+        wrapper = flows
+        cpp_gen = flows._cpp_generator
+
+    if not isinstance(cpp_gen, _flowgen_core.FlowGenerator):
+        return None
+
+    end_ns = None
+    if wrapper is not None:
+        remaining = wrapper.remaining_flows()
+        if count is None:
+            count = remaining
+        elif remaining is not None:
+            count = min(count, remaining)
+        end_ns = wrapper.end_timestamp_ns()
+
+    if count is None:
+        if end_ns is None:
+            return None
+        count = _UNBOUNDED_COUNT
+
+    return cpp_gen, wrapper, count, end_ns
+
+
+def _native_export(flows, filename: str, count: Optional[int], fmt: str, **options) -> Optional[int]:
+    """
+    Export through the C++ sinks with the GIL released.
+
+    Returns number of flows written, or None if flows is not a native source.
+    """
+    source = _native_source(flows, count)
+    if source is None:
+        return None
+
+    cpp_gen, wrapper, count, end_ns = source
+    sink_options = _flowgen_core.SinkOptions()
+    sink_options.format = _flowgen_core.parse_sink_format(fmt)
+    for name, value in options.items():
+        setattr(sink_options, name, value)
+
+    if end_ns is None:
+        written = _flowgen_core.export_flows(cpp_gen, str(filename), count, sink_options)
+    else:
+        written = _flowgen_core.export_flows(cpp_gen, str(filename), count, sink_options, end_ns)
+    if wrapper is not None:
+        wrapper._advance(written)
+    return written
+
 
 class FlowExporter:
     """Export flow records to different formats"""
@@ -15,18 +86,28 @@ class FlowExporter:
     @staticmethod
     def export_to_csv(flows: Union[List[FlowRecord], Iterator[FlowRecord]],
                       filename: str,
-                      include_header: bool = True) -> int:
+                      include_header: bool = True,
+                      count: Optional[int] = None) -> int:
         """
         Export flows to CSV file.
 
+        When flows is a C++-backed generator, generation and serialization
+        run natively without the GIL.
+
         Args:
-            flows: List or iterator of FlowRecord objects
+            flows: List or iterator of FlowRecord objects, or a generator
             filename: Output CSV filename
             include_header: Whether to include CSV header row
+            count: Number of flows to take from a generator (default: its max_flows)
 
         Returns:
             Number of flows written
         """
+        written = _native_export(flows, filename, count, 'csv',
+                                 include_header=include_header)
+        if written is not None:
+            return written
+
         count = 0
         with open(filename, 'w') as f:
             if include_header:
@@ -54,18 +135,24 @@ class FlowExporter:
     @staticmethod
     def export_to_json(flows: Union[List[FlowRecord], Iterator[FlowRecord]],
                        filename: str,
-                       pretty: bool = True) -> int:
+                       pretty: bool = True,
+                       count: Optional[int] = None) -> int:
         """
         Export flows to JSON file.
 
         Args:
-            flows: List or iterator of FlowRecord objects
+            flows: List or iterator of FlowRecord objects, or a generator
             filename: Output JSON filename
             pretty: Whether to use pretty formatting
+            count: Number of flows to take from a generator (default: its max_flows)
 
         Returns:
             Number of flows written
         """
+        written = _native_export(flows, filename, count, 'json', pretty=pretty)
+        if written is not None:
+            return written
+
         flow_list = []
 
         # Convert to list of dicts
@@ -83,18 +170,24 @@ class FlowExporter:
 
     @staticmethod
     def export_to_jsonlines(flows: Union[List[FlowRecord], Iterator[FlowRecord]],
-                           filename: str) -> int:
+                           filename: str,
+                           count: Optional[int] = None) -> int:
         """
         Export flows to JSON Lines format (one JSON object per line).
         More efficient for streaming large datasets.
 
         Args:
-            flows: List or iterator of FlowRecord objects
+            flows: List or iterator of FlowRecord objects, or a generator
             filename: Output file name
+            count: Number of flows to take from a generator (default: its max_flows)
 
         Returns:
             Number of flows written
         """
+        written = _native_export(flows, filename, count, 'jsonl')
+        if written is not None:
+            return written
+
         count = 0
         with open(filename, 'w') as f:
             for flow in flows:
@@ -103,6 +196,41 @@ class FlowExporter:
 
         return count
 
+    @staticmethod
+    def export_to_file(flows,
+                       filename: str,
+                       format: str = 'csv',
+                       count: Optional[int] = None,
+                       compress: bool = False,
+                       rotate_flows: int = 0,
+                       fields: str = '') -> int:
+        """
+        Export a C++-backed generator through a native sink.
+
+        Supports formats the Python exporters do not (binary, and the
+        ClickHouse/PostgreSQL bulk-load formats), gzip compression and
+        file rotation.
+
+        Args:
+            flows: C++-backed generator
+            filename: Output filename (rotated files get a _NNNNNN suffix)
+            format: csv, json, jsonl, binary, rowbinary, native or pgcopy
+            count: Number of flows (default: generator's max_flows)
+            compress: gzip the output (".gz" is appended)
+            rotate_flows: Start a new file every N flows (0 = single file)
+            fields: Optional columns, e.g. "tcp_flags,tos,src_as" or "all"
+
+        Returns:
+            Number of flows written
+        """
+        options = {'compress': compress, 'rotate_flows': rotate_flows}
+        if fields and _flowgen_core is not None:
+            options['schema'] = _flowgen_core.FlowSchema.parse(fields)
+        written = _native_export(flows, filename, count, format, **options)
+        if written is None:
+            raise ValueError("export_to_file requires a C++-backed generator and a known flow count")
+        return written
+
     @staticmethod
     def stream_to_csv(flows: Iterator[FlowRecord],
                      filename: str,
@@ -144,48 +272,54 @@ class FlowExporter:
 
 def export_csv(flows: Union[List[FlowRecord], Iterator[FlowRecord]],
                filename: str,
-               include_header: bool = True) -> int:
+               include_header: bool = True,
+               count: Optional[int] = None) -> int:
     """
     Convenience function to export flows to CSV.
 
     Args:
-        flows: List or iterator of FlowRecord objects
+        flows: List or iterator of FlowRecord objects, or a generator
         filename: Output CSV filename
         include_header: Whether to include CSV header row
+        count: Number of flows to take from a generator
 
     Returns:
         Number of flows written
     """
-    return FlowExporter.export_to_csv(flows, filename, include_header)
+    return FlowExporter.export_to_csv(flows, filename, include_header, count)
 
 
 def export_json(flows: Union[List[FlowRecord], Iterator[FlowRecord]],
                 filename: str,
-                pretty: bool = True) -> int:
+                pretty: bool = True,
+                count: Optional[int] = None) -> int:
     """
     Convenience function to export flows to JSON.
 
     Args:
-        flows: List or iterator of FlowRecord objects
+        flows: List or iterator of FlowRecord objects, or a generator
         filename: Output JSON filename
         pretty: Whether to use pretty formatting
+        count: Number of flows to take from a generator
 
     Returns:
         Number of flows written
     """
-    return FlowExporter.export_to_json(flows, filename, pretty)
+    return FlowExporter.export_to_json(flows, filename, pretty, count)
 
 
 def export_jsonlines(flows: Union[List[FlowRecord], Iterator[FlowRecord]],
-                    filename: str) -> int:
+                    filename: str,
+                    count: Optional[int] = None) -> int:
     """
     Convenience function to export flows to JSON Lines format.
 
     Args:
-        flows: List or iterator of FlowRecord objects
+        flows: List or iterator of FlowRecord objects, or a generator
         filename: Output filename
+        count: Number of flows to take from a generator
 
     Returns:
         Number of flows written
     """
-    return FlowExporter.export_to_jsonlines(flows, filename)
+    return FlowExporter.export_to_jsonlines(flows, filename, count)